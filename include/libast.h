@@ -38,9 +38,11 @@
 #include <libast/sysdefs.h>
 
 #include <stdio.h>
+#include <stdarg.h>
 #include <stdlib.h>
 #include <time.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 #include <sys/wait.h>
 #include <unistd.h>
 #include <ctype.h>
@@ -85,6 +87,7 @@ void *alloca(size_t);
 #include <netdb.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <netinet/in.h>
 #include <sys/un.h>
 #include <arpa/inet.h>
@@ -133,11 +136,16 @@ extern int re_exec();
 
 /* Basic objects */
 #include <libast/mbuff.h>
+#include <libast/iobuf_chain.h>
+#include <libast/linereader.h>
 #include <libast/module.h>
 #include <libast/objpair.h>
 #include <libast/regexp.h>
 #include <libast/socket.h>
 #include <libast/str.h>
+#include <libast/strview.h>
+#include <libast/searcher.h>
+#include <libast/rope.h>
 #include <libast/tok.h>
 #include <libast/url.h>
 #include <libast/ustr.h>
@@ -155,10 +163,22 @@ extern int re_exec();
 #include <libast/array.h>
 #include <libast/linked_list.h>
 #include <libast/dlinked_list.h>
+#include <libast/mapview.h>
+#include <libast/ilist.h>
+#include <libast/itree.h>
+#include <libast/hamt.h>
+
+/* Objects built from lists */
+#include <libast/multisearch.h>
 
 /* Thread/condition/mutex implementations */
 #include <libast/pthreads.h>
 
+/* Objects that need the mutex implementation */
+#include <libast/pool.h>
+#include <libast/symtab.h>
+#include <libast/lru_cache.h>
+
 #include <libast/avl_tree.h>
 
 /******************************* GENERIC GOOP *********************************/
@@ -1397,6 +1417,14 @@ typedef struct spifmem_memrec_t {
  * @ingroup DOXGRP_STRINGS
  */
 #define BEG_STRCASECMP(s, constr)  (strncasecmp((char *) (s), constr, CONST_STRLEN(constr)))
+/**
+ * Size of a buffer big enough for any number printed by the
+ * spiftool_format_*() routines, including the trailing NUL.
+ *
+ * @see @link DOXGRP_STRINGS String Utility Routines @endlink
+ * @ingroup DOXGRP_STRINGS
+ */
+#define SPIFTOOL_NUM_BUFF_SIZE     32
 
 
 
@@ -2865,6 +2893,42 @@ extern void spiftool_free_array(void *, size_t);
 
 /* file.c */
 extern int spiftool_temp_file(spif_charptr_t, size_t);
+extern spif_byteptr_t spiftool_read_fd(int, size_t *, size_t);
+
+/* number.c */
+extern spif_bool_t spiftool_parse_int64(const spif_charptr_t, size_t, int, spif_int64_t *, size_t *);
+extern spif_bool_t spiftool_parse_uint64(const spif_charptr_t, size_t, int, spif_uint64_t *, size_t *);
+extern spif_bool_t spiftool_parse_double(const spif_charptr_t, size_t, double *, size_t *);
+extern size_t spiftool_format_int64(spif_charptr_t, spif_int64_t);
+extern size_t spiftool_format_uint64(spif_charptr_t, spif_uint64_t);
+extern size_t spiftool_format_double(spif_charptr_t, double);
+
+/* simd.c */
+extern int spiftool_simd_level(int);
+extern spif_charptr_t spiftool_strnchr(const spif_charptr_t, size_t, spif_char_t);
+extern spif_charptr_t spiftool_strnrchr(const spif_charptr_t, size_t, spif_char_t);
+extern size_t spiftool_find_pair(const spif_byteptr_t, size_t, spif_uint8_t, spif_uint8_t, size_t);
+extern size_t spiftool_find_space(const spif_charptr_t, size_t);
+extern size_t spiftool_span_space(const spif_charptr_t, size_t);
+extern size_t spiftool_rspan_space(const spif_charptr_t, size_t);
+extern void spiftool_downcase_buff(spif_charptr_t, size_t);
+extern void spiftool_upcase_buff(spif_charptr_t, size_t);
+extern int spiftool_strncasecmp(const spif_charptr_t, const spif_charptr_t, size_t);
+extern size_t spiftool_utf8_decode(const spif_charptr_t, size_t, spif_uint32_t *);
+extern size_t spiftool_utf8_encode(spif_charptr_t, spif_uint32_t);
+extern spif_bool_t spiftool_utf8_scan(const spif_charptr_t, size_t, size_t *);
+
+/**
+ * A set of split delimiters.
+ *
+ * Built once with spiftool_split_set() and handed to
+ * spiftool_split_next_set() for each word, so splitting a string word
+ * by word doesn't rebuild the set on every call.
+ */
+typedef struct spiftool_splitset_t_struct {
+    /** One bit per byte value. */
+    spif_uint8_t bits[32];
+} spiftool_splitset_t;
 
 /* strings.c */
 extern spif_bool_t spiftool_safe_strncpy(spif_charptr_t dest, const spif_charptr_t src, spif_int32_t size);
@@ -2875,6 +2939,10 @@ extern spif_bool_t spiftool_regexp_match(const spif_charptr_t, const spif_charpt
 extern spif_bool_t spiftool_regexp_match_r(const spif_charptr_t str, const spif_charptr_t pattern, regex_t **rexp);
 #endif
 extern spif_charptr_t *spiftool_split(const spif_charptr_t, const spif_charptr_t);
+extern spif_charptr_t *spiftool_split_packed(const spif_charptr_t, const spif_charptr_t, size_t *);
+extern void spiftool_split_set(const spif_charptr_t, spiftool_splitset_t *);
+extern spif_bool_t spiftool_split_next(const spif_charptr_t, spif_charptr_t *, spif_charptr_t, size_t *);
+extern spif_bool_t spiftool_split_next_set(const spiftool_splitset_t *, spif_charptr_t *, spif_charptr_t, size_t *);
 extern spif_charptr_t *spiftool_split_regexp(const spif_charptr_t, const spif_charptr_t);
 extern spif_charptr_t spiftool_join(spif_charptr_t, spif_charptr_t *);
 extern spif_charptr_t spiftool_get_word(unsigned long, const spif_charptr_t);
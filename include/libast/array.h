@@ -34,10 +34,51 @@ SPIF_DECL_OBJ(array) {
     SPIF_DECL_PARENT_TYPE(obj);
     spif_listidx_t len;
     spif_obj_t *items;
+    spif_class_t elem_class;
+    spif_cmp_func_t cmp_func;
+    spif_key_func_t key_func;
 };
 
 extern spif_listclass_t SPIF_LISTCLASS_VAR(array);
 extern spif_vectorclass_t SPIF_VECTORCLASS_VAR(array);
 extern spif_mapclass_t SPIF_MAPCLASS_VAR(array);
+extern spif_bool_t spif_array_set_comparator(spif_array_t, spif_class_t, spif_cmp_func_t, spif_key_func_t);
+
+/*
+ * Parallel bulk operations.  Each splits the array into contiguous
+ * slices and hands one slice to each of up to nthreads workers (0 means
+ * one per online CPU); arrays too short to give every worker at least
+ * SPIF_ARRAY_PARALLEL_MIN items use fewer workers, down to just the
+ * calling thread.  Callbacks run concurrently and must be thread-safe
+ * (note that run-time memory debugging, DEBUG_MEM, is not).
+ *
+ * spif_array_sort() is a stable merge sort using cmp, or the array's own
+ * ordering if cmp is NULL; NULL items sort first.  Only list arrays may
+ * be sorted by a foreign cmp.
+ *
+ * spif_array_map_into() replaces the contents of dest (or a new array of
+ * the same class as self, if dest is NULL) with func() of each item, in
+ * order; vector and map destinations are then sorted.  If dest is bound
+ * to an element class (see spif_array_set_comparator()) and any result
+ * is of another class, all results are deleted, dest is left unchanged,
+ * and NULL is returned.
+ *
+ * spif_array_reduce() folds each slice into a private DUP of init with
+ * func(acc, item, data), then folds the slice results together, left to
+ * right, with combine(acc, other, data) (or func if combine is NULL).
+ * Both take ownership of acc and return the new accumulator; other is
+ * deleted afterward.  The result belongs to the caller.
+ */
+#define SPIF_ARRAY_PARALLEL_MIN              4096
+
+typedef void (*spif_array_each_func_t)(spif_obj_t, spif_ptr_t);
+typedef spif_obj_t (*spif_array_map_func_t)(spif_obj_t, spif_ptr_t);
+typedef spif_obj_t (*spif_array_reduce_func_t)(spif_obj_t, spif_obj_t, spif_ptr_t);
+
+extern spif_bool_t spif_array_sort(spif_array_t, spif_cmp_func_t, spif_uint32_t);
+extern spif_bool_t spif_array_for_each(spif_array_t, spif_array_each_func_t, spif_ptr_t, spif_uint32_t);
+extern spif_array_t spif_array_map_into(spif_array_t, spif_array_t, spif_array_map_func_t, spif_ptr_t, spif_uint32_t);
+extern spif_obj_t spif_array_reduce(spif_array_t, spif_array_reduce_func_t, spif_array_reduce_func_t, spif_obj_t,
+                                    spif_ptr_t, spif_uint32_t);
 
 #endif /* _LIBAST_ARRAY_H_ */
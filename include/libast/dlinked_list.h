@@ -42,10 +42,14 @@ SPIF_DECL_OBJ(dlinked_list) {
     SPIF_DECL_PROPERTY(listidx, len);
     SPIF_DECL_PROPERTY(dlinked_list_item, head);
     SPIF_DECL_PROPERTY(dlinked_list_item, tail);
+    SPIF_DECL_PROPERTY(class, elem_class);
+    SPIF_DECL_PROPERTY_C(spif_cmp_func_t, cmp_func);
+    SPIF_DECL_PROPERTY_C(spif_key_func_t, key_func);
 };
 
 extern spif_listclass_t SPIF_LISTCLASS_VAR(dlinked_list);
 extern spif_vectorclass_t SPIF_VECTORCLASS_VAR(dlinked_list);
 extern spif_mapclass_t SPIF_MAPCLASS_VAR(dlinked_list);
+extern spif_bool_t spif_dlinked_list_set_comparator(spif_dlinked_list_t, spif_class_t, spif_cmp_func_t, spif_key_func_t);
 
 #endif /* _LIBAST_DLINKED_LIST_H_ */
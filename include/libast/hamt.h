@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 1997-2013, Michael Jennings <mej@eterm.org>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies of the Software, its documentation and marketing & publicity
+ * materials, and acknowledgment shall be given in the documentation, materials
+ * and software packages that this Software was used.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef _LIBAST_HAMT_H_
+#define _LIBAST_HAMT_H_
+
+/*
+ * Persistent hash array mapped trie.  Trie nodes are immutable and
+ * reference-counted, so a snapshot (SPIF_MAP_DUP(), or the maps returned
+ * by spif_hamt_with() and spif_hamt_without()) costs O(1) and shares all
+ * of its structure with the original.  SPIF_MAP_SET() and SPIF_MAP_REMOVE()
+ * on a map copy only the path to the changed leaf; no other map sees the
+ * change.  A snapshot may be read by any number of threads at once with
+ * no locking, as long as each map object is only modified by one thread.
+ *
+ * In transient mode (spif_hamt_transient()), nodes that no other map can
+ * see are edited in place instead of copied, which makes large batches
+ * of updates much cheaper.  spif_hamt_persistent() ends the batch.
+ *
+ * Keys that compare equal must hash equal.  The default hash handles
+ * spif_str_t and spif_atom_t keys only, and a map using it refuses any
+ * other key (sets fail, lookups find nothing).  Maps keyed by other
+ * classes must be created with spif_hamt_new_with_hash().
+ */
+
+/* Standard typecast macros.... */
+#define SPIF_HAMT(obj)                       ((spif_hamt_t) (obj))
+
+#define SPIF_HAMT_ISNULL(o)                  (SPIF_HAMT(o) == (spif_hamt_t) NULL)
+#define SPIF_OBJ_IS_HAMT(o)                  ((!SPIF_OBJ_ISNULL(o)) && (SPIF_OBJ_CLASS(o) == SPIF_CLASS(SPIF_MAPCLASS_VAR(hamt))))
+
+/* Bits of hash consumed per trie level. */
+#define SPIF_HAMT_BITS                       5
+
+typedef spif_hash_func_t spif_hamt_hash_func_t;
+
+/* Whether hash function f can hash key k by value. */
+#define SPIF_HAMT_CAN_HASH(f, k)             (((f) != spif_hamt_hash_default) || SPIF_OBJ_IS_STR(k) \
+                                              || SPIF_OBJ_IS_ATOM(k))
+
+SPIF_DECL_TYPE(hamt_node, SPIF_DECL_OBJ_STRUCT(hamt_node));
+
+SPIF_DECL_OBJ(hamt) {
+    SPIF_DECL_PARENT_TYPE(obj);
+    SPIF_DECL_PROPERTY(listidx, len);
+    SPIF_DECL_PROPERTY(hamt_node, root);
+    SPIF_DECL_PROPERTY_C(spif_hamt_hash_func_t, hash_func);
+    SPIF_DECL_PROPERTY(bool, transient);
+};
+
+extern spif_mapclass_t SPIF_MAPCLASS_VAR(hamt);
+extern spif_hamt_t spif_hamt_new_with_hash(spif_hamt_hash_func_t);
+extern spif_bool_t spif_hamt_init_with_hash(spif_hamt_t, spif_hamt_hash_func_t);
+extern spif_uint32_t spif_hamt_hash_default(spif_obj_t);
+extern spif_hamt_t spif_hamt_with(spif_hamt_t, spif_obj_t, spif_obj_t);
+extern spif_hamt_t spif_hamt_without(spif_hamt_t, spif_obj_t);
+extern spif_bool_t spif_hamt_transient(spif_hamt_t);
+extern spif_bool_t spif_hamt_persistent(spif_hamt_t);
+
+#endif /* _LIBAST_HAMT_H_ */
@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 1997-2013, Michael Jennings <mej@eterm.org>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies of the Software, its documentation and marketing & publicity
+ * materials, and acknowledgment shall be given in the documentation, materials
+ * and software packages that this Software was used.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef _LIBAST_ILIST_H_
+#define _LIBAST_ILIST_H_
+
+/*
+ * Intrusive doubly-linked list.  Instead of wrapping each element in a
+ * separately-allocated list item, the element object itself embeds a
+ * spif_const_ilist_link_t, and the list is told where that link lives
+ * within the element.  An element may be on only one list per
+ * embedded link, and the list does not own its elements:  removing
+ * an element or deleting the list just unlinks it.
+ *
+ * SPIF_DECL_OBJ(conn) {
+ *     SPIF_DECL_PARENT_TYPE(obj);
+ *     spif_const_ilist_link_t link;
+ *     ...
+ * };
+ *
+ * conns = spif_ilist_new_from_offset(SPIF_ILIST_OFFSET(conn, link));
+ * spif_ilist_link_init(&conn->link);
+ * SPIF_LIST_APPEND(conns, conn);
+ * ...
+ * spif_ilist_unlink(&conn->link);
+ */
+
+/* Standard typecast macros.... */
+#define SPIF_ILIST_LINK(obj)                 ((spif_ilist_link_t) (obj))
+#define SPIF_ILIST(obj)                      ((spif_ilist_t) (obj))
+
+#define SPIF_ILIST_LINK_ISNULL(o)            (SPIF_ILIST_LINK(o) == (spif_ilist_link_t) NULL)
+#define SPIF_ILIST_ISNULL(o)                 (SPIF_ILIST(o) == (spif_ilist_t) NULL)
+#define SPIF_OBJ_IS_ILIST(o)                 ((!SPIF_OBJ_ISNULL(o)) && (SPIF_OBJ_CLASS(o) == SPIF_CLASS(SPIF_LISTCLASS_VAR(ilist))))
+
+/* Offset of the embedded link named member within objects of the given type. */
+#define SPIF_ILIST_OFFSET(type, member)      ((size_t) offsetof(SPIF_CONST_TYPE(type), member))
+
+/* Convert between an element and its embedded link. */
+#define SPIF_ILIST_LINK_OF(l, o)             SPIF_ILIST_LINK((spif_uint8_t *) (o) + SPIF_ILIST(l)->offset)
+#define SPIF_ILIST_OBJ_OF(l, lk)             SPIF_OBJ((spif_uint8_t *) (lk) - SPIF_ILIST(l)->offset)
+
+/* Whether or not a link is currently on a list. */
+#define SPIF_ILIST_LINK_IS_LINKED(lk)        (!SPIF_ILIST_ISNULL(SPIF_ILIST_LINK(lk)->list))
+
+SPIF_DECL_TYPE(ilist_link, SPIF_DECL_OBJ_STRUCT(ilist_link));
+
+SPIF_DECL_OBJ(ilist) {
+    SPIF_DECL_PARENT_TYPE(obj);
+    SPIF_DECL_PROPERTY(listidx, len);
+    SPIF_DECL_PROPERTY_C(size_t, offset);
+    SPIF_DECL_PROPERTY(ilist_link, head);
+    SPIF_DECL_PROPERTY(ilist_link, tail);
+    SPIF_DECL_PROPERTY(class, elem_class);
+    SPIF_DECL_PROPERTY_C(spif_cmp_func_t, cmp_func);
+    SPIF_DECL_PROPERTY_C(spif_key_func_t, key_func);
+};
+
+SPIF_DECL_OBJ_STRUCT(ilist_link) {
+    SPIF_DECL_PROPERTY(ilist_link, prev);
+    SPIF_DECL_PROPERTY(ilist_link, next);
+    SPIF_DECL_PROPERTY(ilist, list);
+};
+
+extern spif_listclass_t SPIF_LISTCLASS_VAR(ilist);
+extern spif_ilist_t spif_ilist_new_from_offset(size_t);
+extern spif_bool_t spif_ilist_init_from_offset(spif_ilist_t, size_t);
+extern spif_bool_t spif_ilist_set_comparator(spif_ilist_t, spif_class_t, spif_cmp_func_t, spif_key_func_t);
+extern spif_bool_t spif_ilist_link_init(spif_ilist_link_t);
+extern spif_obj_t spif_ilist_unlink(spif_ilist_link_t);
+
+#endif /* _LIBAST_ILIST_H_ */
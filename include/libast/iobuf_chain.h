@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 1997-2013, Michael Jennings <mej@eterm.org>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies of the Software, its documentation and marketing & publicity
+ * materials, and acknowledgment shall be given in the documentation, materials
+ * and software packages that this Software was used.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef _LIBAST_IOBUF_CHAIN_H_
+#define _LIBAST_IOBUF_CHAIN_H_
+
+/*
+ * I/O buffer chains.  A chain is a sequence of segments, each a byte
+ * range of a reference-counted block, so appending, prepending,
+ * slicing, and duplicating move references around instead of copying
+ * bytes.  Blocks can wrap memory the caller already has (optionally
+ * freed when the last segment using it goes away) or an mbuff the
+ * chain takes over; small pieces appended by copy are packed into the
+ * unused tail of the last block.
+ *
+ * A chain is meant to be handed to the kernel as it is:
+ * spif_iobuf_chain_to_iovec() fills in a struct iovec array for
+ * writev(), and spif_iobuf_chain_writev() does the write and drops
+ * whatever was written.  spif_iobuf_chain_flatten() makes one
+ * contiguous mbuff for code that needs it.
+ *
+ * The bytes a segment covers are never changed once written, but the
+ * reference counts are not atomic; chains which share blocks must not
+ * be used from different threads without locking.
+ */
+
+/* Cast an arbitrary object pointer to an I/O buffer chain. */
+#define SPIF_IOBUF_CHAIN(o)               ((spif_iobuf_chain_t) (o))
+
+/* Check to see if a pointer references an I/O buffer chain. */
+#define SPIF_OBJ_IS_IOBUF_CHAIN(o)        (SPIF_OBJ_IS_TYPE(o, iobuf_chain))
+
+/* Used for testing the NULL-ness of I/O buffer chains. */
+#define SPIF_IOBUF_CHAIN_ISNULL(o)        (SPIF_IOBUF_CHAIN(o) == (spif_iobuf_chain_t) NULL)
+
+/* Calls to the basic functions. */
+#define SPIF_IOBUF_CHAIN_NEW()            (spif_iobuf_chain_t) (SPIF_CLASS(SPIF_CLASS_VAR(iobuf_chain)))->(noo)()
+#define SPIF_IOBUF_CHAIN_DEL(o)           SPIF_OBJ_DEL(o)
+#define SPIF_IOBUF_CHAIN_SHOW(o, b, i)    SPIF_OBJ_SHOW(o, b, i)
+
+/* Called with the owner of a block's memory once nothing uses it. */
+typedef void (*spif_iobuf_chain_free_func_t)(spif_ptr_t);
+
+SPIF_DECL_TYPE(iobuf_block, SPIF_DECL_OBJ_STRUCT(iobuf_block));
+SPIF_DECL_TYPE(iobuf_seg, SPIF_DECL_OBJ_STRUCT(iobuf_seg));
+
+SPIF_DECL_OBJ(iobuf_chain) {
+    SPIF_DECL_PARENT_TYPE(obj);
+    spif_iobuf_seg_t segs;
+    spif_memidx_t first, count, size;
+    SPIF_DECL_PROPERTY_C(spif_memidx_t, len);
+};
+
+extern spif_class_t SPIF_CLASS_VAR(iobuf_chain);
+extern spif_iobuf_chain_t spif_iobuf_chain_new(void);
+extern spif_bool_t spif_iobuf_chain_init(spif_iobuf_chain_t);
+extern spif_bool_t spif_iobuf_chain_done(spif_iobuf_chain_t);
+extern spif_bool_t spif_iobuf_chain_del(spif_iobuf_chain_t);
+extern spif_str_t spif_iobuf_chain_show(spif_iobuf_chain_t, spif_charptr_t, spif_str_t, size_t);
+extern spif_cmp_t spif_iobuf_chain_comp(spif_iobuf_chain_t, spif_iobuf_chain_t);
+extern spif_iobuf_chain_t spif_iobuf_chain_dup(spif_iobuf_chain_t);
+extern spif_classname_t spif_iobuf_chain_type(spif_iobuf_chain_t);
+
+extern spif_bool_t spif_iobuf_chain_append(spif_iobuf_chain_t, spif_iobuf_chain_t);
+extern spif_bool_t spif_iobuf_chain_append_buff(spif_iobuf_chain_t, spif_byteptr_t, spif_memidx_t, spif_iobuf_chain_free_func_t);
+extern spif_bool_t spif_iobuf_chain_append_from_ptr(spif_iobuf_chain_t, spif_byteptr_t, spif_memidx_t);
+extern spif_bool_t spif_iobuf_chain_append_mbuff(spif_iobuf_chain_t, spif_mbuff_t);
+extern spif_bool_t spif_iobuf_chain_clear(spif_iobuf_chain_t);
+extern spif_memidx_t spif_iobuf_chain_consume(spif_iobuf_chain_t, spif_memidx_t);
+extern spif_mbuff_t spif_iobuf_chain_flatten(spif_iobuf_chain_t);
+extern spif_memidx_t spif_iobuf_chain_get_count(spif_iobuf_chain_t);
+extern spif_bool_t spif_iobuf_chain_prepend(spif_iobuf_chain_t, spif_iobuf_chain_t);
+extern spif_bool_t spif_iobuf_chain_prepend_buff(spif_iobuf_chain_t, spif_byteptr_t, spif_memidx_t, spif_iobuf_chain_free_func_t);
+extern spif_bool_t spif_iobuf_chain_prepend_from_ptr(spif_iobuf_chain_t, spif_byteptr_t, spif_memidx_t);
+extern spif_bool_t spif_iobuf_chain_prepend_mbuff(spif_iobuf_chain_t, spif_mbuff_t);
+extern spif_memidx_t spif_iobuf_chain_readv(spif_iobuf_chain_t, int, spif_memidx_t);
+extern spif_iobuf_chain_t spif_iobuf_chain_slice(spif_iobuf_chain_t, spif_memidx_t, spif_memidx_t);
+extern int spif_iobuf_chain_to_iovec(spif_iobuf_chain_t, struct iovec *, int);
+extern spif_memidx_t spif_iobuf_chain_writev(spif_iobuf_chain_t, int);
+SPIF_DECL_PROPERTY_FUNC_C(iobuf_chain, spif_memidx_t, len);
+
+#endif /* _LIBAST_IOBUF_CHAIN_H_ */
@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 1997-2013, Michael Jennings <mej@eterm.org>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies of the Software, its documentation and marketing & publicity
+ * materials, and acknowledgment shall be given in the documentation, materials
+ * and software packages that this Software was used.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef _LIBAST_ITREE_H_
+#define _LIBAST_ITREE_H_
+
+/*
+ * Intrusive AVL tree.  This is the ordered (vector) counterpart to
+ * spif_ilist:  each element embeds a spif_const_itree_node_t, the tree
+ * is told where that node lives within the element, and the tree does
+ * not own its elements.  Nodes carry parent pointers, so an element
+ * can remove itself given only its node (O(log n) for the rebalance)
+ * and iteration needs no auxiliary stack.  Equal elements are allowed.
+ */
+
+/* Standard typecast macros.... */
+#define SPIF_ITREE_NODE(obj)                 ((spif_itree_node_t) (obj))
+#define SPIF_ITREE(obj)                      ((spif_itree_t) (obj))
+
+#define SPIF_ITREE_NODE_ISNULL(o)            (SPIF_ITREE_NODE(o) == (spif_itree_node_t) NULL)
+#define SPIF_ITREE_ISNULL(o)                 (SPIF_ITREE(o) == (spif_itree_t) NULL)
+#define SPIF_OBJ_IS_ITREE(o)                 ((!SPIF_OBJ_ISNULL(o)) && (SPIF_OBJ_CLASS(o) == SPIF_CLASS(SPIF_VECTORCLASS_VAR(itree))))
+
+/* Offset of the embedded node named member within objects of the given type. */
+#define SPIF_ITREE_OFFSET(type, member)      ((size_t) offsetof(SPIF_CONST_TYPE(type), member))
+
+/* Convert between an element and its embedded node. */
+#define SPIF_ITREE_NODE_OF(t, o)             SPIF_ITREE_NODE((spif_uint8_t *) (o) + SPIF_ITREE(t)->offset)
+#define SPIF_ITREE_OBJ_OF(t, n)              SPIF_OBJ((spif_uint8_t *) (n) - SPIF_ITREE(t)->offset)
+
+/* Whether or not a node is currently in a tree. */
+#define SPIF_ITREE_NODE_IS_LINKED(n)         (!SPIF_ITREE_ISNULL(SPIF_ITREE_NODE(n)->tree))
+
+SPIF_DECL_TYPE(itree_node, SPIF_DECL_OBJ_STRUCT(itree_node));
+
+SPIF_DECL_OBJ(itree) {
+    SPIF_DECL_PARENT_TYPE(obj);
+    SPIF_DECL_PROPERTY(listidx, len);
+    SPIF_DECL_PROPERTY_C(size_t, offset);
+    SPIF_DECL_PROPERTY(itree_node, root);
+    SPIF_DECL_PROPERTY(class, elem_class);
+    SPIF_DECL_PROPERTY_C(spif_cmp_func_t, cmp_func);
+    SPIF_DECL_PROPERTY_C(spif_key_func_t, key_func);
+};
+
+SPIF_DECL_OBJ_STRUCT(itree_node) {
+    SPIF_DECL_PROPERTY(itree_node, parent);
+    SPIF_DECL_PROPERTY(itree_node, left);
+    SPIF_DECL_PROPERTY(itree_node, right);
+    SPIF_DECL_PROPERTY(itree, tree);
+    SPIF_DECL_PROPERTY_C(spif_int32_t, height);
+};
+
+extern spif_vectorclass_t SPIF_VECTORCLASS_VAR(itree);
+extern spif_itree_t spif_itree_new_from_offset(size_t);
+extern spif_bool_t spif_itree_init_from_offset(spif_itree_t, size_t);
+extern spif_bool_t spif_itree_set_comparator(spif_itree_t, spif_class_t, spif_cmp_func_t, spif_key_func_t);
+extern spif_bool_t spif_itree_node_init(spif_itree_node_t);
+extern spif_obj_t spif_itree_unlink(spif_itree_node_t);
+
+#endif /* _LIBAST_ITREE_H_ */
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 1997-2013, Michael Jennings <mej@eterm.org>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies of the Software, its documentation and marketing & publicity
+ * materials, and acknowledgment shall be given in the documentation, materials
+ * and software packages that this Software was used.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef _LIBAST_LINEREADER_H_
+#define _LIBAST_LINEREADER_H_
+
+/*
+ * Line reader.  Wraps a file descriptor or stdio stream in a large,
+ * refillable buffer and returns one line at a time.  Lines end with
+ * LF or CR/LF; the terminator is stripped.  There is no limit on line
+ * length other than memory.
+ *
+ * spif_linereader_next() returns a pointer into the reader's own
+ * buffer, NUL-terminated in place, which is valid until the next call.
+ * spif_linereader_next_str() copies the line into a caller-supplied
+ * string instead, reusing that string's storage from line to line.
+ *
+ * The reader does not own the descriptor or stream it is given, except
+ * for readers created with spif_linereader_new_from_file(), which
+ * close their file when deleted.
+ */
+
+/* Cast an arbitrary object pointer to a line reader. */
+#define SPIF_LINEREADER(o)                ((spif_linereader_t) (o))
+
+/* Check to see if a pointer references a line reader. */
+#define SPIF_OBJ_IS_LINEREADER(o)         (SPIF_OBJ_IS_TYPE(o, linereader))
+
+/* Used for testing the NULL-ness of line readers. */
+#define SPIF_LINEREADER_ISNULL(o)         (SPIF_LINEREADER(o) == (spif_linereader_t) NULL)
+
+/* Calls to the basic functions. */
+#define SPIF_LINEREADER_NEW()             (spif_linereader_t) (SPIF_CLASS(SPIF_CLASS_VAR(linereader)))->(noo)()
+#define SPIF_LINEREADER_DEL(o)            SPIF_OBJ_DEL(o)
+#define SPIF_LINEREADER_SHOW(o, b, i)     SPIF_OBJ_SHOW(o, b, i)
+
+SPIF_DECL_OBJ(linereader) {
+    SPIF_DECL_PARENT_TYPE(obj);
+    SPIF_DECL_PROPERTY_C(int, fd);
+    SPIF_DECL_PROPERTY_C(FILE *, fp);
+    SPIF_DECL_PROPERTY_C(spif_memidx_t, lineno);
+    spif_byteptr_t buff;
+    spif_memidx_t size, start, end;
+    spif_bool_t eof, owned;
+};
+
+extern spif_class_t SPIF_CLASS_VAR(linereader);
+extern spif_linereader_t spif_linereader_new(void);
+extern spif_linereader_t spif_linereader_new_from_fd(int);
+extern spif_linereader_t spif_linereader_new_from_fp(FILE *);
+extern spif_linereader_t spif_linereader_new_from_file(spif_charptr_t);
+extern spif_bool_t spif_linereader_init(spif_linereader_t);
+extern spif_bool_t spif_linereader_init_from_fd(spif_linereader_t, int);
+extern spif_bool_t spif_linereader_init_from_fp(spif_linereader_t, FILE *);
+extern spif_bool_t spif_linereader_init_from_file(spif_linereader_t, spif_charptr_t);
+extern spif_bool_t spif_linereader_done(spif_linereader_t);
+extern spif_bool_t spif_linereader_del(spif_linereader_t);
+extern spif_str_t spif_linereader_show(spif_linereader_t, spif_charptr_t, spif_str_t, size_t);
+extern spif_cmp_t spif_linereader_comp(spif_linereader_t, spif_linereader_t);
+extern spif_linereader_t spif_linereader_dup(spif_linereader_t);
+extern spif_classname_t spif_linereader_type(spif_linereader_t);
+extern spif_bool_t spif_linereader_next(spif_linereader_t, spif_charptr_t *, spif_memidx_t *);
+extern spif_bool_t spif_linereader_next_str(spif_linereader_t, spif_str_t);
+extern spif_bool_t spif_linereader_eof(spif_linereader_t);
+SPIF_DECL_PROPERTY_FUNC_C(linereader, spif_memidx_t, lineno);
+
+#endif /* _LIBAST_LINEREADER_H_ */
@@ -44,10 +44,14 @@ SPIF_DECL_OBJ(linked_list) {
     SPIF_DECL_PARENT_TYPE(obj);
     SPIF_DECL_PROPERTY(listidx, len);
     SPIF_DECL_PROPERTY(linked_list_item, head);
+    SPIF_DECL_PROPERTY(class, elem_class);
+    SPIF_DECL_PROPERTY_C(spif_cmp_func_t, cmp_func);
+    SPIF_DECL_PROPERTY_C(spif_key_func_t, key_func);
 };
 
 extern spif_listclass_t SPIF_LISTCLASS_VAR(linked_list);
 extern spif_vectorclass_t SPIF_VECTORCLASS_VAR(linked_list);
 extern spif_mapclass_t SPIF_MAPCLASS_VAR(linked_list);
+extern spif_bool_t spif_linked_list_set_comparator(spif_linked_list_t, spif_class_t, spif_cmp_func_t, spif_key_func_t);
 
 #endif /* _LIBAST_LINKED_LIST_H_ */
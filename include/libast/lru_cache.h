@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 1997-2013, Michael Jennings <mej@eterm.org>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies of the Software, its documentation and marketing & publicity
+ * materials, and acknowledgment shall be given in the documentation, materials
+ * and software packages that this Software was used.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef _LIBAST_LRU_CACHE_H_
+#define _LIBAST_LRU_CACHE_H_
+
+/*
+ * Least-recently-used cache.  Entries are bounded by count, by a byte
+ * budget measured with a user sizing function, or both (0 means no
+ * limit).  Like maps, the cache stores copies of the keys and values
+ * it is given.  spif_lru_cache_get() and spif_lru_cache_peek() return
+ * the cached value itself, which stays valid until that entry is
+ * replaced, removed, or evicted.
+ *
+ * A sharded cache splits its entries and budget across several
+ * independently locked caches and may be shared between threads; use
+ * spif_lru_cache_get_dup() there, since another thread can evict an
+ * entry as soon as the shard lock is dropped.
+ *
+ * The default hash (spif_hamt_hash_default()) only handles str and atom
+ * keys; a cache using it refuses any other key.  Caches keyed by other
+ * classes must set a hash function with spif_lru_cache_set_funcs().
+ */
+
+/* Cast an arbitrary object pointer to an LRU cache. */
+#define SPIF_LRU_CACHE(o)                ((spif_lru_cache_t) (o))
+
+/* Check to see if a pointer references an LRU cache. */
+#define SPIF_OBJ_IS_LRU_CACHE(o)         (SPIF_OBJ_IS_TYPE(o, lru_cache))
+
+/* Used for testing the NULL-ness of LRU caches. */
+#define SPIF_LRU_CACHE_ISNULL(o)         (SPIF_LRU_CACHE(o) == (spif_lru_cache_t) NULL)
+
+/* Calls to the basic functions. */
+#define SPIF_LRU_CACHE_NEW()             (spif_lru_cache_t) (SPIF_CLASS(SPIF_CLASS_VAR(lru_cache)))->(noo)()
+#define SPIF_LRU_CACHE_DEL(o)            SPIF_OBJ_DEL(o)
+#define SPIF_LRU_CACHE_SHOW(o, b, i)     SPIF_OBJ_SHOW(o, b, i)
+
+/* Returns the cost of an entry against the cache's byte budget. */
+typedef spif_memidx_t (*spif_lru_cache_size_func_t)(spif_obj_t, spif_obj_t);
+
+/* Called with the key, value, and user data just before an entry is
+   evicted to make room.  Not called for removes or on deletion.  The
+   cache (or shard) is locked at the time, so don't call back into it. */
+typedef void (*spif_lru_cache_evict_func_t)(spif_obj_t, spif_obj_t, spif_ptr_t);
+
+SPIF_DECL_TYPE(lru_entry, SPIF_DECL_OBJ_STRUCT(lru_entry));
+
+SPIF_DECL_OBJ(lru_cache) {
+    SPIF_DECL_PARENT_TYPE(obj);
+    SPIF_DECL_PROPERTY(listidx, len);
+    SPIF_DECL_PROPERTY(listidx, max_count);
+    SPIF_DECL_PROPERTY_C(spif_memidx_t, bytes);
+    SPIF_DECL_PROPERTY_C(spif_memidx_t, max_bytes);
+    SPIF_DECL_PROPERTY_C(spif_hash_func_t, hash_func);
+    SPIF_DECL_PROPERTY_C(spif_lru_cache_size_func_t, size_func);
+    SPIF_DECL_PROPERTY_C(spif_lru_cache_evict_func_t, evict_func);
+    SPIF_DECL_PROPERTY(ptr, evict_data);
+    SPIF_DECL_PROPERTY_C(spif_uint64_t, hits);
+    SPIF_DECL_PROPERTY_C(spif_uint64_t, misses);
+    SPIF_DECL_PROPERTY_C(spif_uint64_t, evictions);
+    SPIF_DECL_PROPERTY(pthreads_mutex, lock);
+    spif_uint32_t mask;
+    spif_lru_entry_t *buckets;
+    spif_lru_entry_t head, tail;
+    spif_uint32_t nshards;
+    spif_lru_cache_t *shards;
+};
+
+extern spif_class_t SPIF_CLASS_VAR(lru_cache);
+extern spif_lru_cache_t spif_lru_cache_new(void);
+extern spif_lru_cache_t spif_lru_cache_new_with_limits(spif_listidx_t, spif_memidx_t);
+extern spif_lru_cache_t spif_lru_cache_new_sharded(spif_uint32_t, spif_listidx_t, spif_memidx_t);
+extern spif_bool_t spif_lru_cache_init(spif_lru_cache_t);
+extern spif_bool_t spif_lru_cache_init_with_limits(spif_lru_cache_t, spif_listidx_t, spif_memidx_t);
+extern spif_bool_t spif_lru_cache_init_sharded(spif_lru_cache_t, spif_uint32_t, spif_listidx_t, spif_memidx_t);
+extern spif_bool_t spif_lru_cache_done(spif_lru_cache_t);
+extern spif_bool_t spif_lru_cache_del(spif_lru_cache_t);
+extern spif_str_t spif_lru_cache_show(spif_lru_cache_t, spif_charptr_t, spif_str_t, size_t);
+extern spif_cmp_t spif_lru_cache_comp(spif_lru_cache_t, spif_lru_cache_t);
+extern spif_lru_cache_t spif_lru_cache_dup(spif_lru_cache_t);
+extern spif_classname_t spif_lru_cache_type(spif_lru_cache_t);
+extern spif_bool_t spif_lru_cache_set_funcs(spif_lru_cache_t, spif_hash_func_t, spif_lru_cache_size_func_t,
+                                            spif_lru_cache_evict_func_t, spif_ptr_t);
+extern spif_bool_t spif_lru_cache_put(spif_lru_cache_t, spif_obj_t, spif_obj_t);
+extern spif_obj_t spif_lru_cache_get(spif_lru_cache_t, spif_obj_t);
+extern spif_obj_t spif_lru_cache_get_dup(spif_lru_cache_t, spif_obj_t);
+extern spif_obj_t spif_lru_cache_peek(spif_lru_cache_t, spif_obj_t);
+extern spif_obj_t spif_lru_cache_remove(spif_lru_cache_t, spif_obj_t);
+extern spif_bool_t spif_lru_cache_clear(spif_lru_cache_t);
+extern spif_listidx_t spif_lru_cache_count(spif_lru_cache_t);
+extern spif_bool_t spif_lru_cache_get_stats(spif_lru_cache_t, spif_uint64_t *, spif_uint64_t *, spif_uint64_t *);
+
+#endif /* _LIBAST_LRU_CACHE_H_ */
@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 1997-2013, Michael Jennings <mej@eterm.org>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies of the Software, its documentation and marketing & publicity
+ * materials, and acknowledgment shall be given in the documentation, materials
+ * and software packages that this Software was used.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef _LIBAST_MAPVIEW_H_
+#define _LIBAST_MAPVIEW_H_
+
+/*
+ * A mapview is a read-only list which borrows the keys, values, or
+ * key/value pairs of a map without copying them.  Nothing is
+ * allocated per element, and deleting the view leaves the map and its
+ * contents untouched.  A view is only valid while its map exists, and
+ * its iterators must not be used across changes to the map.
+ */
+
+/* Standard typecast macros.... */
+#define SPIF_MAPVIEW(obj)                      ((spif_mapview_t) (obj))
+
+#define SPIF_MAPVIEW_ISNULL(o)                 (SPIF_MAPVIEW(o) == (spif_mapview_t) NULL)
+#define SPIF_OBJ_IS_MAPVIEW(o)                 ((!SPIF_OBJ_ISNULL(o)) && (SPIF_OBJ_CLASS(o) == SPIF_CLASS(SPIF_LISTCLASS_VAR(mapview))))
+
+/* Which part of each map entry the view presents. */
+#define SPIF_MAPVIEW_KEYS                      ((spif_uint8_t) 0)
+#define SPIF_MAPVIEW_VALUES                    ((spif_uint8_t) 1)
+#define SPIF_MAPVIEW_PAIRS                     ((spif_uint8_t) 2)
+
+/* Zero-copy counterparts to SPIF_MAP_GET_KEYS() and friends. */
+#define SPIF_MAP_KEYS_VIEW(o)                  SPIF_LIST(spif_mapview_new_from_map(SPIF_MAP(o), SPIF_MAPVIEW_KEYS))
+#define SPIF_MAP_VALUES_VIEW(o)                SPIF_LIST(spif_mapview_new_from_map(SPIF_MAP(o), SPIF_MAPVIEW_VALUES))
+#define SPIF_MAP_PAIRS_VIEW(o)                 SPIF_LIST(spif_mapview_new_from_map(SPIF_MAP(o), SPIF_MAPVIEW_PAIRS))
+
+SPIF_DECL_OBJ(mapview) {
+    SPIF_DECL_PARENT_TYPE(obj);
+    SPIF_DECL_PROPERTY(map, subject);
+    SPIF_DECL_PROPERTY(uint8, what);
+};
+
+extern spif_listclass_t SPIF_LISTCLASS_VAR(mapview);
+extern spif_mapview_t spif_mapview_new_from_map(spif_map_t, spif_uint8_t);
+extern spif_bool_t spif_mapview_init_from_map(spif_mapview_t, spif_map_t, spif_uint8_t);
+
+#endif /* _LIBAST_MAPVIEW_H_ */
@@ -78,11 +78,26 @@
                                                          : (SPIF_MBUFF(obj)->buff)))
 typedef spif_int64_t spif_memidx_t;
 
+/* Flags for spif_mbuff_new_from_mmap().  Without SPIF_MBUFF_MAP_COPY,
+   the mapping is read-only, and an mbuff copies it to the heap before
+   it's first changed. */
+#define SPIF_MBUFF_MAP_COPY            (1 << 0)  /* Writable copy-on-write mapping; the file never changes. */
+#define SPIF_MBUFF_MAP_POPULATE        (1 << 1)  /* Read the whole range in up front. */
+#define SPIF_MBUFF_MAP_SEQUENTIAL      (1 << 2)  /* Mostly sequential access; read ahead aggressively. */
+#define SPIF_MBUFF_MAP_RANDOM          (1 << 3)  /* Mostly random access; don't read ahead. */
+
+/* Check whether an mbuff's bytes are a file mapping. */
+#define SPIF_MBUFF_IS_MAPPED(o)        (SPIF_MBUFF(o)->map != (spif_ptr_t) NULL)
+
 SPIF_DECL_OBJ(mbuff) {
     SPIF_DECL_PARENT_TYPE(obj);
     spif_byteptr_t buff;
     SPIF_DECL_PROPERTY_C(spif_memidx_t, size);
     SPIF_DECL_PROPERTY_C(spif_memidx_t, len);
+    spif_ptr_t map;
+    size_t map_len;
+    int map_flags;
+    spif_memidx_t head;
 };
 
 SPIF_DECL_OBJ(mbuffclass) {
@@ -125,12 +140,16 @@ extern spif_mbuff_t spif_mbuff_new_from_ptr(spif_byteptr_t, spif_memidx_t);
 extern spif_mbuff_t spif_mbuff_new_from_buff(spif_byteptr_t, spif_memidx_t, spif_memidx_t);
 extern spif_mbuff_t spif_mbuff_new_from_fp(FILE *);
 extern spif_mbuff_t spif_mbuff_new_from_fd(int);
+extern spif_mbuff_t spif_mbuff_new_from_file(spif_charptr_t);
+extern spif_mbuff_t spif_mbuff_new_from_mmap(spif_charptr_t, spif_memidx_t, spif_memidx_t, int);
 extern spif_bool_t spif_mbuff_del(spif_mbuff_t);
 extern spif_bool_t spif_mbuff_init(spif_mbuff_t);
 extern spif_bool_t spif_mbuff_init_from_ptr(spif_mbuff_t, spif_byteptr_t, spif_memidx_t);
 extern spif_bool_t spif_mbuff_init_from_buff(spif_mbuff_t, spif_byteptr_t, spif_memidx_t, spif_memidx_t);
 extern spif_bool_t spif_mbuff_init_from_fp(spif_mbuff_t, FILE *);
 extern spif_bool_t spif_mbuff_init_from_fd(spif_mbuff_t, int);
+extern spif_bool_t spif_mbuff_init_from_file(spif_mbuff_t, spif_charptr_t);
+extern spif_bool_t spif_mbuff_init_from_mmap(spif_mbuff_t, spif_charptr_t, spif_memidx_t, spif_memidx_t, int);
 extern spif_bool_t spif_mbuff_done(spif_mbuff_t);
 extern spif_str_t spif_mbuff_show(spif_mbuff_t, spif_byteptr_t, spif_str_t, size_t);
 extern spif_cmp_t spif_mbuff_comp(spif_mbuff_t, spif_mbuff_t);
@@ -138,17 +157,27 @@ extern spif_mbuff_t spif_mbuff_dup(spif_mbuff_t);
 extern spif_classname_t spif_mbuff_type(spif_mbuff_t);
 
 extern spif_bool_t spif_mbuff_append(spif_mbuff_t, spif_mbuff_t);
+extern spif_bool_t spif_mbuff_append_double(spif_mbuff_t, double);
 extern spif_bool_t spif_mbuff_append_from_ptr(spif_mbuff_t, spif_byteptr_t, spif_memidx_t);
+extern spif_bool_t spif_mbuff_append_int(spif_mbuff_t, spif_int64_t);
+extern spif_bool_t spif_mbuff_append_printf(spif_mbuff_t, spif_charptr_t, ...);
+extern spif_bool_t spif_mbuff_append_vprintf(spif_mbuff_t, spif_charptr_t, va_list);
+extern spif_bool_t spif_mbuff_append_uint(spif_mbuff_t, spif_uint64_t);
 extern spif_bool_t spif_mbuff_clear(spif_mbuff_t, spif_uint8_t);
 extern spif_cmp_t spif_mbuff_cmp(spif_mbuff_t, spif_mbuff_t);
 extern spif_cmp_t spif_mbuff_cmp_with_ptr(spif_mbuff_t, spif_byteptr_t, spif_memidx_t);
+extern spif_memidx_t spif_mbuff_consume(spif_mbuff_t, spif_memidx_t);
 extern spif_memidx_t spif_mbuff_find(spif_mbuff_t, spif_mbuff_t);
 extern spif_memidx_t spif_mbuff_find_from_ptr(spif_mbuff_t, spif_byteptr_t, spif_memidx_t);
 extern spif_memidx_t spif_mbuff_index(spif_mbuff_t, spif_uint8_t);
 extern spif_cmp_t spif_mbuff_ncmp(spif_mbuff_t, spif_mbuff_t, spif_memidx_t);
 extern spif_cmp_t spif_mbuff_ncmp_with_ptr(spif_mbuff_t, spif_byteptr_t, spif_memidx_t);
+extern spif_bool_t spif_mbuff_parse_double(spif_mbuff_t, spif_memidx_t, double *, spif_memidx_t *);
+extern spif_bool_t spif_mbuff_parse_int(spif_mbuff_t, spif_memidx_t, int, spif_int64_t *, spif_memidx_t *);
+extern spif_bool_t spif_mbuff_parse_uint(spif_mbuff_t, spif_memidx_t, int, spif_uint64_t *, spif_memidx_t *);
 extern spif_bool_t spif_mbuff_prepend(spif_mbuff_t, spif_mbuff_t);
 extern spif_bool_t spif_mbuff_prepend_from_ptr(spif_mbuff_t, spif_byteptr_t, spif_memidx_t);
+extern spif_memidx_t spif_mbuff_read_up_to(spif_mbuff_t, int, spif_memidx_t);
 extern spif_bool_t spif_mbuff_reverse(spif_mbuff_t);
 extern spif_memidx_t spif_mbuff_rindex(spif_mbuff_t, spif_uint8_t);
 extern spif_bool_t spif_mbuff_splice(spif_mbuff_t, spif_memidx_t, spif_memidx_t, spif_mbuff_t);
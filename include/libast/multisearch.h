@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 1997-2013, Michael Jennings <mej@eterm.org>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies of the Software, its documentation and marketing & publicity
+ * materials, and acknowledgment shall be given in the documentation, materials
+ * and software packages that this Software was used.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+#ifndef _LIBAST_MULTISEARCH_H_
+#define _LIBAST_MULTISEARCH_H_
+
+/*
+ * Multi-pattern matcher.  Compiles a list of spif_str_t and/or
+ * spif_mbuff_t patterns into an Aho-Corasick automaton which finds
+ * every occurrence of every pattern, overlapping ones included, in a
+ * single pass over the input.  Matching can optionally ignore case.
+ *
+ * Each match is reported to a callback with the pattern's index in
+ * the original list and the offset at which the match starts.  Matches
+ * are reported in order of where they end; several matches ending at
+ * the same byte are reported longest first.  Empty patterns (and list
+ * items that are neither strings nor buffers) never match.
+ *
+ * spif_multisearch_find() searches a single buffer.
+ * spif_multisearch_feed() continues a stream delivered in chunks, so
+ * matches spanning chunk boundaries are found too; offsets are then
+ * from the start of the stream.
+ */
+
+/* Cast an arbitrary object pointer to a multi-pattern matcher. */
+#define SPIF_MULTISEARCH(o)               ((spif_multisearch_t) (o))
+
+/* Check to see if a pointer references a multi-pattern matcher. */
+#define SPIF_OBJ_IS_MULTISEARCH(o)        (SPIF_OBJ_IS_TYPE(o, multisearch))
+
+/* Used for testing the NULL-ness of multi-pattern matchers. */
+#define SPIF_MULTISEARCH_ISNULL(o)        (SPIF_MULTISEARCH(o) == (spif_multisearch_t) NULL)
+
+/* Calls to the basic functions. */
+#define SPIF_MULTISEARCH_NEW()            (spif_multisearch_t) (SPIF_CLASS(SPIF_CLASS_VAR(multisearch)))->(noo)()
+#define SPIF_MULTISEARCH_DEL(o)           SPIF_OBJ_DEL(o)
+#define SPIF_MULTISEARCH_SHOW(o, b, i)    SPIF_OBJ_SHOW(o, b, i)
+
+/* Called with the pattern index, the offset of the start of the match,
+   and the user data for each match.  Return FALSE to stop searching. */
+typedef spif_bool_t (*spif_multisearch_func_t)(spif_listidx_t, spif_memidx_t, spif_ptr_t);
+
+SPIF_DECL_OBJ(multisearch) {
+    SPIF_DECL_PARENT_TYPE(obj);
+    spif_listidx_t npatterns;
+    spif_memidx_t *lens;
+    spif_listidx_t *next;
+    spif_bool_t casefold;
+    spif_uint16_t classes[256];
+    spif_int32_t nclasses, nstates;
+    spif_int32_t *delta, *out, *link, *dict;
+    spif_int32_t state;
+    spif_memidx_t pos;
+};
+
+extern spif_class_t SPIF_CLASS_VAR(multisearch);
+extern spif_multisearch_t spif_multisearch_new(void);
+extern spif_multisearch_t spif_multisearch_new_from_list(spif_list_t, spif_bool_t);
+extern spif_bool_t spif_multisearch_init(spif_multisearch_t);
+extern spif_bool_t spif_multisearch_init_from_list(spif_multisearch_t, spif_list_t, spif_bool_t);
+extern spif_bool_t spif_multisearch_done(spif_multisearch_t);
+extern spif_bool_t spif_multisearch_del(spif_multisearch_t);
+extern spif_str_t spif_multisearch_show(spif_multisearch_t, spif_charptr_t, spif_str_t, size_t);
+extern spif_cmp_t spif_multisearch_comp(spif_multisearch_t, spif_multisearch_t);
+extern spif_multisearch_t spif_multisearch_dup(spif_multisearch_t);
+extern spif_classname_t spif_multisearch_type(spif_multisearch_t);
+extern spif_listidx_t spif_multisearch_count(spif_multisearch_t);
+extern spif_memidx_t spif_multisearch_find(spif_multisearch_t, spif_byteptr_t, spif_memidx_t,
+                                           spif_multisearch_func_t, spif_ptr_t);
+extern spif_memidx_t spif_multisearch_find_str(spif_multisearch_t, spif_str_t, spif_multisearch_func_t, spif_ptr_t);
+extern spif_memidx_t spif_multisearch_feed(spif_multisearch_t, spif_byteptr_t, spif_memidx_t,
+                                           spif_multisearch_func_t, spif_ptr_t);
+extern spif_bool_t spif_multisearch_reset(spif_multisearch_t);
+
+#endif /* _LIBAST_MULTISEARCH_H_ */
@@ -563,6 +563,38 @@
  */
 #define SPIF_OBJ_COMP(o1, o2)            (spif_cmp_t) (SPIF_OBJ_CALL_METHOD((o1),  comp)(o1, o2))
 
+/**
+ * Compare two objects using a bound comparison function.
+ *
+ * This macro calls the comparison function @a f directly if one is
+ * given, bypassing the class method lookup and type dispatch done by
+ * SPIF_OBJ_COMP().  If @a f is NULL, it falls back to SPIF_OBJ_COMP().
+ * Containers which have been bound to a single element class use this
+ * in their search and insertion loops.
+ *
+ * @param f  A spif_cmp_func_t, or NULL.
+ * @param o1 Object #1.
+ * @param o2 Object #2.
+ * @return   A spif_cmp_t value containing the comparison result.
+ *
+ * @see @link DOXGRP_OBJ LibAST Object Infrastructure @endlink, SPIF_OBJ_COMP(), spif_cmp_func_t
+ */
+#define SPIF_OBJ_COMP_FUNC(f, o1, o2)    (((f) != (spif_cmp_func_t) NULL) ? ((f)(SPIF_OBJ(o1), SPIF_OBJ(o2))) : (SPIF_OBJ_COMP((o1), (o2))))
+
+/**
+ * Extract the comparison key from an object.
+ *
+ * This macro calls the key extraction function @a f on @a o if both
+ * are non-NULL.  Otherwise, @a o itself is the key.
+ *
+ * @param f A spif_key_func_t, or NULL.
+ * @param o The object.
+ * @return  The key portion of @a o.
+ *
+ * @see @link DOXGRP_OBJ LibAST Object Infrastructure @endlink, spif_key_func_t
+ */
+#define SPIF_OBJ_KEY_FUNC(f, o)          ((((f) != (spif_key_func_t) NULL) && !SPIF_OBJ_ISNULL(o)) ? ((f)(SPIF_OBJ(o))) : (SPIF_OBJ(o)))
+
 /**
  * Duplicate an object.
  *
@@ -631,24 +663,31 @@
  *
  * @param t   The type of the NULL object.
  * @param n   The name of the NULL object (variable name).
- * @param b   A str object to which to assign the result.
+ * @param b   A str object to which to append the result (or NULL,
+ *            in which case a new one is assigned to it).
  * @param i   Number of spaces to indent.
- * @param tmp A char[] buffer of fixed size used for temporary
- *            storage.
  *
  * @see @link DOXGRP_OBJ LibAST Object Infrastructure @endlink, spif_obj_show()
  */
-#define SPIF_OBJ_SHOW_NULL(t, n, b, i, tmp)  do { \
-                                               memset(tmp, ' ', (i)); \
-                                               snprintf((char *) tmp + (i), sizeof(tmp) - (i), \
-                                                        "(spif_" #t "_t) %s:  " SPIF_NULLSTR_TYPE(t) "\n", \
-                                                        NONULL(n)); \
-                                               if (SPIF_STR_ISNULL(b)) { \
-                                                 (b) = spif_str_new_from_ptr((spif_charptr_t) tmp); \
-                                               } else { \
-                                                 spif_str_append_from_ptr((b), (spif_charptr_t) tmp); \
-                                               } \
-                                             } while (0)
+#define SPIF_OBJ_SHOW_NULL_INTO(t, n, b, i)  ((b) = spif_str_show_printf((b), (i), (spif_charptr_t) "(spif_" #t "_t) %s:  " \
+                                                                         SPIF_NULLSTR_TYPE(t) "\n", NONULL(n)))
+
+/**
+ * Convenience macro for displaying a NULL value for an object.
+ *
+ * This is the original form of SPIF_OBJ_SHOW_NULL_INTO(), kept for
+ * existing callers.  The output is now formatted directly into @a b,
+ * so the scratch buffer is no longer used.
+ *
+ * @param t   The type of the NULL object.
+ * @param n   The name of the NULL object (variable name).
+ * @param b   A str object to which to assign the result.
+ * @param i   Number of spaces to indent.
+ * @param tmp Ignored.
+ *
+ * @see @link DOXGRP_OBJ LibAST Object Infrastructure @endlink, SPIF_OBJ_SHOW_NULL_INTO()
+ */
+#define SPIF_OBJ_SHOW_NULL(t, n, b, i, tmp)  SPIF_OBJ_SHOW_NULL_INTO(t, n, b, i)
 
 /**
  * Convenience macro for handling NULL objects in a comparison.
@@ -738,6 +777,38 @@ SPIF_DECL_OBJ(class) {
 SPIF_DECL_OBJ(obj) {
     spif_class_t cls;
 };
+
+/**
+ * Direct comparison function.
+ *
+ * A function of this type compares two objects of a known class
+ * without going through the class's @c comp method.  Any existing
+ * comp method (e.g., spif_str_cmp()) can be used, cast to this type.
+ *
+ * @see @link DOXGRP_OBJ LibAST Object Infrastructure @endlink, SPIF_OBJ_COMP_FUNC()
+ */
+typedef spif_cmp_t (*spif_cmp_func_t)(spif_obj_t, spif_obj_t);
+
+/**
+ * Key extraction function.
+ *
+ * A function of this type returns the part of an object which should
+ * be compared when searching, such as spif_objpair_get_key() for the
+ * key/value pairs stored in maps.
+ *
+ * @see @link DOXGRP_OBJ LibAST Object Infrastructure @endlink, SPIF_OBJ_KEY_FUNC()
+ */
+typedef spif_obj_t (*spif_key_func_t)(spif_obj_t);
+
+/**
+ * Hash function.
+ *
+ * A function of this type hashes an object for a hash-based
+ * container.  Objects which compare equal must hash equal.
+ *
+ * @see @link DOXGRP_OBJ LibAST Object Infrastructure @endlink, spif_hamt_hash_default()
+ */
+typedef spif_uint32_t (*spif_hash_func_t)(spif_obj_t);
 /*@}*/
 
 
@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 1997-2013, Michael Jennings <mej@eterm.org>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies of the Software, its documentation and marketing & publicity
+ * materials, and acknowledgment shall be given in the documentation, materials
+ * and software packages that this Software was used.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef _LIBAST_POOL_H_
+#define _LIBAST_POOL_H_
+
+/*
+ * Per-class recycling pools.  Once a pool is enabled for a class, the
+ * del method of that class hands finished objects to the pool instead
+ * of freeing them, and its constructors take them back out.  Strings
+ * and mbuffs keep their buffers while pooled, so a recycled one can
+ * often be filled without touching the allocator at all.
+ *
+ * A pool holds at most high objects; when it is full, it is trimmed
+ * back to low before taking the next one.  Pools are off by default.
+ * They are safe to use from several threads.
+ *
+ * Only classes whose del method goes through SPIF_POOL_DEALLOC()
+ * participate:  currently str, mbuff, and objpair.
+ */
+
+/* Most classes that can have pools at once. */
+#define SPIF_POOL_MAX_CLASSES            32
+
+/* Allocate an object of the given type, recycling one if possible.
+   The result still needs to be initialized. */
+#define SPIF_POOL_ALLOC(type)            ((SPIF_TYPE(type)) spif_pool_alloc(SPIF_CLASS_VAR(type), SPIF_SIZEOF_TYPE(type)))
+
+/* Pool a finished object, or free it if its class has no room. */
+#define SPIF_POOL_DEALLOC(obj)           do {if (!spif_pool_give(SPIF_OBJ(obj))) {SPIF_DEALLOC(obj);}} while (0)
+
+extern spif_bool_t spif_pool_enable(spif_class_t, spif_listidx_t, spif_listidx_t);
+extern spif_bool_t spif_pool_disable(spif_class_t);
+extern spif_bool_t spif_pool_trim(spif_class_t);
+extern spif_obj_t spif_pool_take(spif_class_t);
+extern spif_bool_t spif_pool_give(spif_obj_t);
+extern spif_ptr_t spif_pool_alloc(spif_class_t, size_t);
+extern spif_bool_t spif_pool_get_stats(spif_class_t, spif_listidx_t *, spif_uint64_t *, spif_uint64_t *, spif_uint64_t *);
+
+#endif /* _LIBAST_POOL_H_ */
@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 1997-2013, Michael Jennings <mej@eterm.org>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies of the Software, its documentation and marketing & publicity
+ * materials, and acknowledgment shall be given in the documentation, materials
+ * and software packages that this Software was used.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+#ifndef _LIBAST_ROPE_H_
+#define _LIBAST_ROPE_H_
+
+/*
+ * Ropes.  A rope holds its text as a balanced (AVL) tree of immutable
+ * chunks, so insertions, deletions, and substrings cost O(log n)
+ * rather than a copy of the whole string, and concatenation and
+ * duplication just share subtrees.  This makes ropes the right choice
+ * for large text that is edited in many small places, such as editor
+ * and scrollback buffers; plain spif_str_t is faster for everything
+ * else.
+ *
+ * The rope class implements the spif_strclass_t interface, so the
+ * SPIF_STR_*() method macros work on ropes as well, with other ropes
+ * in place of string arguments.  Unlike strings, ropes are not stored
+ * contiguously; use spif_rope_chunk() to walk the text in place or
+ * spif_rope_to_str() to flatten it.  Ropes which share chunks must not
+ * be used from different threads without locking.
+ */
+
+/* Cast an arbitrary object pointer to a rope. */
+#define SPIF_ROPE(o)                      ((spif_rope_t) (o))
+
+/* Check to see if a pointer references a rope. */
+#define SPIF_OBJ_IS_ROPE(o)               (SPIF_OBJ_IS_TYPE(o, rope))
+
+/* Used for testing the NULL-ness of ropes. */
+#define SPIF_ROPE_ISNULL(o)               (SPIF_ROPE(o) == (spif_rope_t) NULL)
+
+/* Calls to the basic functions. */
+#define SPIF_ROPE_NEW()                   (spif_rope_t) (SPIF_CLASS(SPIF_CLASS_VAR(rope)))->(noo)()
+#define SPIF_ROPE_DEL(o)                  SPIF_OBJ_DEL(o)
+#define SPIF_ROPE_SHOW(o, b, i)           SPIF_OBJ_SHOW(o, b, i)
+
+SPIF_DECL_TYPE(rope_node, SPIF_DECL_OBJ_STRUCT(rope_node));
+
+SPIF_DECL_OBJ(rope) {
+    SPIF_DECL_PARENT_TYPE(obj);
+    spif_rope_node_t root;
+};
+
+extern spif_class_t SPIF_CLASS_VAR(rope);
+extern spif_strclass_t SPIF_STRCLASS_VAR(rope);
+extern spif_rope_t spif_rope_new(void);
+extern spif_rope_t spif_rope_new_from_ptr(spif_charptr_t);
+extern spif_rope_t spif_rope_new_from_buff(spif_charptr_t, spif_stridx_t);
+extern spif_rope_t spif_rope_new_from_fp(FILE *);
+extern spif_rope_t spif_rope_new_from_fd(int);
+extern spif_rope_t spif_rope_new_from_num(long);
+extern spif_rope_t spif_rope_new_from_str(spif_str_t);
+extern spif_bool_t spif_rope_del(spif_rope_t);
+extern spif_bool_t spif_rope_init(spif_rope_t);
+extern spif_bool_t spif_rope_init_from_ptr(spif_rope_t, spif_charptr_t);
+extern spif_bool_t spif_rope_init_from_buff(spif_rope_t, spif_charptr_t, spif_stridx_t);
+extern spif_bool_t spif_rope_init_from_fp(spif_rope_t, FILE *);
+extern spif_bool_t spif_rope_init_from_fd(spif_rope_t, int);
+extern spif_bool_t spif_rope_init_from_num(spif_rope_t, long);
+extern spif_bool_t spif_rope_init_from_str(spif_rope_t, spif_str_t);
+extern spif_bool_t spif_rope_done(spif_rope_t);
+extern spif_str_t spif_rope_show(spif_rope_t, spif_charptr_t, spif_str_t, size_t);
+extern spif_cmp_t spif_rope_comp(spif_rope_t, spif_rope_t);
+extern spif_rope_t spif_rope_dup(spif_rope_t);
+extern spif_classname_t spif_rope_type(spif_rope_t);
+
+extern spif_bool_t spif_rope_append(spif_rope_t, spif_rope_t);
+extern spif_bool_t spif_rope_append_buff(spif_rope_t, spif_charptr_t, spif_stridx_t);
+extern spif_bool_t spif_rope_append_char(spif_rope_t, spif_char_t);
+extern spif_bool_t spif_rope_append_from_ptr(spif_rope_t, spif_charptr_t);
+extern spif_cmp_t spif_rope_casecmp(spif_rope_t, spif_rope_t);
+extern spif_cmp_t spif_rope_casecmp_with_ptr(spif_rope_t, spif_charptr_t);
+extern spif_char_t spif_rope_char_at(spif_rope_t, spif_stridx_t);
+extern spif_charptr_t spif_rope_chunk(spif_rope_t, spif_stridx_t, spif_stridx_t *);
+extern spif_bool_t spif_rope_clear(spif_rope_t, spif_char_t);
+extern spif_cmp_t spif_rope_cmp(spif_rope_t, spif_rope_t);
+extern spif_cmp_t spif_rope_cmp_with_ptr(spif_rope_t, spif_charptr_t);
+extern spif_bool_t spif_rope_delete(spif_rope_t, spif_stridx_t, spif_stridx_t);
+extern spif_bool_t spif_rope_downcase(spif_rope_t);
+extern spif_stridx_t spif_rope_find(spif_rope_t, spif_rope_t);
+extern spif_stridx_t spif_rope_find_from_ptr(spif_rope_t, spif_charptr_t);
+extern spif_stridx_t spif_rope_get_len(spif_rope_t);
+extern spif_stridx_t spif_rope_index(spif_rope_t, spif_char_t);
+extern spif_bool_t spif_rope_insert(spif_rope_t, spif_stridx_t, spif_rope_t);
+extern spif_bool_t spif_rope_insert_buff(spif_rope_t, spif_stridx_t, spif_charptr_t, spif_stridx_t);
+extern spif_cmp_t spif_rope_ncasecmp(spif_rope_t, spif_rope_t, spif_stridx_t);
+extern spif_cmp_t spif_rope_ncasecmp_with_ptr(spif_rope_t, spif_charptr_t, spif_stridx_t);
+extern spif_cmp_t spif_rope_ncmp(spif_rope_t, spif_rope_t, spif_stridx_t);
+extern spif_cmp_t spif_rope_ncmp_with_ptr(spif_rope_t, spif_charptr_t, spif_stridx_t);
+extern spif_bool_t spif_rope_prepend(spif_rope_t, spif_rope_t);
+extern spif_bool_t spif_rope_prepend_char(spif_rope_t, spif_char_t);
+extern spif_bool_t spif_rope_prepend_from_ptr(spif_rope_t, spif_charptr_t);
+extern spif_bool_t spif_rope_reverse(spif_rope_t);
+extern spif_stridx_t spif_rope_rindex(spif_rope_t, spif_char_t);
+extern spif_bool_t spif_rope_splice(spif_rope_t, spif_stridx_t, spif_stridx_t, spif_rope_t);
+extern spif_bool_t spif_rope_splice_from_ptr(spif_rope_t, spif_stridx_t, spif_stridx_t, spif_charptr_t);
+extern spif_bool_t spif_rope_sprintf(spif_rope_t, spif_charptr_t, ...);
+extern spif_rope_t spif_rope_substr(spif_rope_t, spif_stridx_t, spif_stridx_t);
+extern spif_charptr_t spif_rope_substr_to_ptr(spif_rope_t, spif_stridx_t, spif_stridx_t);
+extern double spif_rope_to_float(spif_rope_t);
+extern size_t spif_rope_to_num(spif_rope_t, int);
+extern spif_str_t spif_rope_to_str(spif_rope_t);
+extern spif_bool_t spif_rope_trim(spif_rope_t);
+extern spif_bool_t spif_rope_upcase(spif_rope_t);
+
+#endif /* _LIBAST_ROPE_H_ */
@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 1997-2013, Michael Jennings <mej@eterm.org>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies of the Software, its documentation and marketing & publicity
+ * materials, and acknowledgment shall be given in the documentation, materials
+ * and software packages that this Software was used.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+#ifndef _LIBAST_SEARCHER_H_
+#define _LIBAST_SEARCHER_H_
+
+/*
+ * Substring searcher.  A searcher preprocesses one needle when it is
+ * created and can then look for it in any number of haystacks without
+ * redoing that work.  Needles are arbitrary bytes; NULs are allowed in
+ * both the needle and the haystack.
+ *
+ * spif_searcher_find() and friends search a single buffer.
+ * spif_searcher_feed() searches a stream delivered in chunks,
+ * remembering the tail of each chunk so that matches spanning a chunk
+ * boundary are found too.
+ */
+
+/* Cast an arbitrary object pointer to a searcher. */
+#define SPIF_SEARCHER(o)                  ((spif_searcher_t) (o))
+
+/* Check to see if a pointer references a searcher. */
+#define SPIF_OBJ_IS_SEARCHER(o)           (SPIF_OBJ_IS_TYPE(o, searcher))
+
+/* Used for testing the NULL-ness of searchers. */
+#define SPIF_SEARCHER_ISNULL(o)           (SPIF_SEARCHER(o) == (spif_searcher_t) NULL)
+
+/* Calls to the basic functions. */
+#define SPIF_SEARCHER_NEW()               (spif_searcher_t) (SPIF_CLASS(SPIF_CLASS_VAR(searcher)))->(noo)()
+#define SPIF_SEARCHER_DEL(o)              SPIF_OBJ_DEL(o)
+#define SPIF_SEARCHER_SHOW(o, b, i)       SPIF_OBJ_SHOW(o, b, i)
+
+SPIF_DECL_OBJ(searcher) {
+    SPIF_DECL_PARENT_TYPE(obj);
+    spif_byteptr_t needle;
+    spif_memidx_t len;
+    spif_memidx_t skip[256];
+    spif_byteptr_t carry;
+    spif_memidx_t carried, pos;
+};
+
+extern spif_class_t SPIF_CLASS_VAR(searcher);
+extern spif_searcher_t spif_searcher_new(void);
+extern spif_searcher_t spif_searcher_new_from_ptr(spif_byteptr_t, spif_memidx_t);
+extern spif_searcher_t spif_searcher_new_from_str(spif_str_t);
+extern spif_bool_t spif_searcher_init(spif_searcher_t);
+extern spif_bool_t spif_searcher_init_from_ptr(spif_searcher_t, spif_byteptr_t, spif_memidx_t);
+extern spif_bool_t spif_searcher_init_from_str(spif_searcher_t, spif_str_t);
+extern spif_bool_t spif_searcher_done(spif_searcher_t);
+extern spif_bool_t spif_searcher_del(spif_searcher_t);
+extern spif_str_t spif_searcher_show(spif_searcher_t, spif_charptr_t, spif_str_t, size_t);
+extern spif_cmp_t spif_searcher_comp(spif_searcher_t, spif_searcher_t);
+extern spif_searcher_t spif_searcher_dup(spif_searcher_t);
+extern spif_classname_t spif_searcher_type(spif_searcher_t);
+extern spif_bool_t spif_searcher_set_needle(spif_searcher_t, spif_byteptr_t, spif_memidx_t);
+extern spif_memidx_t spif_searcher_find(spif_searcher_t, spif_byteptr_t, spif_memidx_t);
+extern spif_stridx_t spif_searcher_find_str(spif_searcher_t, spif_str_t);
+extern spif_memidx_t spif_searcher_find_mbuff(spif_searcher_t, spif_mbuff_t);
+extern spif_memidx_t spif_searcher_feed(spif_searcher_t, spif_byteptr_t, spif_memidx_t, spif_memidx_t *);
+extern spif_bool_t spif_searcher_reset(spif_searcher_t);
+
+#endif /* _LIBAST_SEARCHER_H_ */
@@ -86,11 +86,25 @@
                                                       : (SPIF_STR(obj)->s)))
 typedef spif_int64_t spif_stridx_t;
 
+/* Strings whose buffer needs no more than this many bytes (terminating
+   NUL included) keep it inside the object instead of on the heap. */
+#define SPIF_STR_INLINE_SIZE                    16
+
+/* Check whether a string's buffer is the inline one. */
+#define SPIF_STR_IS_INLINE(o)                   (SPIF_STR(o)->s == SPIF_STR(o)->inl)
+
+/* Forget a string's cached hash.  Code that writes into a string's
+   buffer directly must do this before the string is hashed again. */
+#define SPIF_STR_CHANGED(o)                     (SPIF_STR(o)->hashed = FALSE)
+
 SPIF_DECL_OBJ(str) {
     SPIF_DECL_PARENT_TYPE(obj);
     spif_charptr_t s;
     SPIF_DECL_PROPERTY_C(spif_stridx_t, size);
     SPIF_DECL_PROPERTY_C(spif_stridx_t, len);
+    spif_uint32_t hash;
+    spif_bool_t hashed;
+    char inl[SPIF_STR_INLINE_SIZE];
 };
 
 SPIF_DECL_OBJ(strclass) {
@@ -145,6 +159,7 @@ extern spif_str_t spif_str_new_from_ptr(spif_charptr_t);
 extern spif_str_t spif_str_new_from_buff(spif_charptr_t, spif_stridx_t);
 extern spif_str_t spif_str_new_from_fp(FILE *);
 extern spif_str_t spif_str_new_from_fd(int);
+extern spif_str_t spif_str_new_from_file(spif_charptr_t);
 extern spif_str_t spif_str_new_from_num(long);
 extern spif_bool_t spif_str_del(spif_str_t);
 extern spif_bool_t spif_str_init(spif_str_t);
@@ -152,32 +167,49 @@ extern spif_bool_t spif_str_init_from_ptr(spif_str_t, spif_charptr_t);
 extern spif_bool_t spif_str_init_from_buff(spif_str_t, spif_charptr_t, spif_stridx_t);
 extern spif_bool_t spif_str_init_from_fp(spif_str_t, FILE *);
 extern spif_bool_t spif_str_init_from_fd(spif_str_t, int);
+extern spif_bool_t spif_str_init_from_file(spif_str_t, spif_charptr_t);
 extern spif_bool_t spif_str_init_from_num(spif_str_t, long);
 extern spif_bool_t spif_str_done(spif_str_t);
 extern spif_str_t spif_str_show(spif_str_t, spif_charptr_t, spif_str_t, size_t);
+extern spif_str_t spif_str_show_printf(spif_str_t, size_t, spif_charptr_t, ...);
 extern spif_cmp_t spif_str_comp(spif_str_t, spif_str_t);
 extern spif_str_t spif_str_dup(spif_str_t);
 extern spif_classname_t spif_str_type(spif_str_t);
 
 extern spif_bool_t spif_str_append(spif_str_t, spif_str_t);
+extern spif_bool_t spif_str_append_buff(spif_str_t, spif_charptr_t, spif_stridx_t);
 extern spif_bool_t spif_str_append_char(spif_str_t, spif_char_t);
+extern spif_bool_t spif_str_append_double(spif_str_t, double);
 extern spif_bool_t spif_str_append_from_ptr(spif_str_t, spif_charptr_t);
+extern spif_bool_t spif_str_append_int(spif_str_t, spif_int64_t);
+extern spif_bool_t spif_str_append_printf(spif_str_t, spif_charptr_t, ...);
+extern spif_bool_t spif_str_append_uint(spif_str_t, spif_uint64_t);
+extern spif_bool_t spif_str_append_vprintf(spif_str_t, spif_charptr_t, va_list);
 extern spif_cmp_t spif_str_casecmp(spif_str_t, spif_str_t);
 extern spif_cmp_t spif_str_casecmp_with_ptr(spif_str_t, spif_charptr_t);
 extern spif_bool_t spif_str_clear(spif_str_t, spif_char_t);
 extern spif_cmp_t spif_str_cmp(spif_str_t, spif_str_t);
 extern spif_cmp_t spif_str_cmp_with_ptr(spif_str_t, spif_charptr_t);
 extern spif_bool_t spif_str_downcase(spif_str_t);
+extern spif_bool_t spif_str_eq(spif_str_t, spif_str_t);
+extern spif_bool_t spif_str_eq_with_ptr(spif_str_t, spif_charptr_t);
 extern spif_stridx_t spif_str_find(spif_str_t, spif_str_t);
 extern spif_stridx_t spif_str_find_from_ptr(spif_str_t, spif_charptr_t);
+extern spif_bool_t spif_str_finish(spif_str_t);
+extern spif_uint32_t spif_str_hash(spif_str_t);
 extern spif_stridx_t spif_str_index(spif_str_t, spif_char_t);
 extern spif_cmp_t spif_str_ncasecmp(spif_str_t, spif_str_t, spif_stridx_t);
 extern spif_cmp_t spif_str_ncasecmp_with_ptr(spif_str_t, spif_charptr_t, spif_stridx_t);
 extern spif_cmp_t spif_str_ncmp(spif_str_t, spif_str_t, spif_stridx_t);
 extern spif_cmp_t spif_str_ncmp_with_ptr(spif_str_t, spif_charptr_t, spif_stridx_t);
+extern spif_bool_t spif_str_parse_double(spif_str_t, spif_stridx_t, double *, spif_stridx_t *);
+extern spif_bool_t spif_str_parse_int(spif_str_t, spif_stridx_t, int, spif_int64_t *, spif_stridx_t *);
+extern spif_bool_t spif_str_parse_uint(spif_str_t, spif_stridx_t, int, spif_uint64_t *, spif_stridx_t *);
 extern spif_bool_t spif_str_prepend(spif_str_t, spif_str_t);
 extern spif_bool_t spif_str_prepend_char(spif_str_t, spif_char_t);
 extern spif_bool_t spif_str_prepend_from_ptr(spif_str_t, spif_charptr_t);
+extern spif_stridx_t spif_str_read_up_to(spif_str_t, int, spif_stridx_t);
+extern spif_bool_t spif_str_reserve(spif_str_t, spif_stridx_t);
 extern spif_bool_t spif_str_reverse(spif_str_t);
 extern spif_stridx_t spif_str_rindex(spif_str_t, spif_char_t);
 extern spif_bool_t spif_str_splice(spif_str_t, spif_stridx_t, spif_stridx_t, spif_str_t);
@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 1997-2013, Michael Jennings <mej@eterm.org>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies of the Software, its documentation and marketing & publicity
+ * materials, and acknowledgment shall be given in the documentation, materials
+ * and software packages that this Software was used.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef _LIBAST_STRVIEW_H_
+#define _LIBAST_STRVIEW_H_
+
+/*
+ * String views.  A view is a pointer and a length referring to bytes
+ * owned by someone else -- a spif_str_t, a buffer, or a string
+ * literal.  Views are small structures passed by value, never
+ * allocated, and need not be NUL-terminated.  A view is only valid as
+ * long as the storage it points into is unchanged, so modifying or
+ * deleting the parent string invalidates any views of it.
+ */
+
+/* Check to see if a view refers to anything at all. */
+#define SPIF_STRVIEW_ISNULL(v)            ((v).s == (spif_charptr_t) NULL)
+
+/* Check to see if a view is empty. */
+#define SPIF_STRVIEW_ISEMPTY(v)           ((v).len == 0)
+
+typedef struct spif_strview_struct {
+    spif_charptr_t s;
+    spif_stridx_t len;
+} spif_strview_t;
+
+extern spif_strview_t spif_strview_from_ptr(spif_charptr_t);
+extern spif_strview_t spif_strview_from_buff(spif_charptr_t, spif_stridx_t);
+extern spif_strview_t spif_strview_from_str(spif_str_t);
+extern spif_str_t spif_strview_to_str(spif_strview_t);
+
+extern spif_cmp_t spif_strview_casecmp(spif_strview_t, spif_strview_t);
+extern spif_cmp_t spif_strview_casecmp_with_ptr(spif_strview_t, spif_charptr_t);
+extern spif_cmp_t spif_strview_cmp(spif_strview_t, spif_strview_t);
+extern spif_cmp_t spif_strview_cmp_with_ptr(spif_strview_t, spif_charptr_t);
+extern spif_stridx_t spif_strview_find(spif_strview_t, spif_strview_t);
+extern spif_stridx_t spif_strview_find_from_ptr(spif_strview_t, spif_charptr_t);
+extern spif_uint32_t spif_strview_hash(spif_strview_t);
+extern spif_stridx_t spif_strview_index(spif_strview_t, spif_char_t);
+extern spif_bool_t spif_strview_next_token(spif_strview_t *, spif_charptr_t, spif_strview_t *);
+extern spif_stridx_t spif_strview_rindex(spif_strview_t, spif_char_t);
+extern spif_strview_t spif_strview_substr(spif_strview_t, spif_stridx_t, spif_stridx_t);
+extern double spif_strview_to_float(spif_strview_t);
+extern size_t spif_strview_to_num(spif_strview_t, int);
+extern spif_strview_t spif_strview_trim(spif_strview_t);
+
+/* View-returning counterpart of spif_str_substr(). */
+extern spif_strview_t spif_str_substr_view(spif_str_t, spif_stridx_t, spif_stridx_t);
+
+#endif /* _LIBAST_STRVIEW_H_ */
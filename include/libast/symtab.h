@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 1997-2013, Michael Jennings <mej@eterm.org>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies of the Software, its documentation and marketing & publicity
+ * materials, and acknowledgment shall be given in the documentation, materials
+ * and software packages that this Software was used.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef _LIBAST_SYMTAB_H_
+#define _LIBAST_SYMTAB_H_
+
+/*
+ * Symbol tables intern byte strings as atoms:  one immutable str per
+ * distinct string, so two atoms from the same table are equal iff
+ * their pointers are equal, and each carries its hash precomputed.
+ * Atoms belong to their table and live until it is deleted; never
+ * modify or free one yourself (SPIF_OBJ_DUP() gives a mutable copy).
+ *
+ * Tables are safe to share between threads.  With an arena, atoms are
+ * packed into large chunks rather than allocated one by one.  The
+ * spif_atom_from_*() functions use a process-wide table.
+ */
+
+/* Cast an arbitrary object pointer to an atom or symbol table. */
+#define SPIF_ATOM(o)                     ((spif_atom_t) (o))
+#define SPIF_SYMTAB(o)                   ((spif_symtab_t) (o))
+
+/* Check to see if a pointer references an atom or symbol table. */
+#define SPIF_OBJ_IS_ATOM(o)              (SPIF_OBJ_IS_TYPE(o, atom))
+#define SPIF_OBJ_IS_SYMTAB(o)            (SPIF_OBJ_IS_TYPE(o, symtab))
+
+/* Used for testing the NULL-ness of atoms and symbol tables. */
+#define SPIF_ATOM_ISNULL(o)              (SPIF_ATOM(o) == (spif_atom_t) NULL)
+#define SPIF_SYMTAB_ISNULL(o)            (SPIF_SYMTAB(o) == (spif_symtab_t) NULL)
+
+/* Atoms from the same table compare by address. */
+#define SPIF_ATOM_EQ(a1, a2)             (SPIF_ATOM(a1) == SPIF_ATOM(a2))
+#define SPIF_ATOM_HASH(a)                (SPIF_ATOM(a)->hash)
+
+/* Calls to the basic functions. */
+#define SPIF_SYMTAB_NEW()                (spif_symtab_t) (SPIF_CLASS(SPIF_CLASS_VAR(symtab)))->(noo)()
+#define SPIF_SYMTAB_DEL(o)               SPIF_OBJ_DEL(o)
+#define SPIF_SYMTAB_SHOW(o, b, i)        SPIF_OBJ_SHOW(o, b, i)
+
+/* Default arena chunk size. */
+#define SPIF_SYMTAB_ARENA_CHUNK          4096
+
+SPIF_DECL_TYPE(symtab, SPIF_DECL_OBJ_STRUCT(symtab));
+
+SPIF_DECL_OBJ(atom) {
+    SPIF_DECL_PARENT_TYPE(str);
+    SPIF_DECL_PROPERTY_C(spif_uint32_t, hash);
+    SPIF_DECL_PROPERTY(symtab, table);
+    spif_atom_t next;
+};
+
+SPIF_DECL_OBJ_STRUCT(symtab) {
+    SPIF_DECL_PARENT_TYPE(obj);
+    SPIF_DECL_PROPERTY(listidx, len);
+    SPIF_DECL_PROPERTY_C(spif_uint32_t, mask);
+    spif_atom_t *buckets;
+    SPIF_DECL_PROPERTY(pthreads_mutex, lock);
+    SPIF_DECL_PROPERTY_C(spif_memidx_t, arena_chunk);
+    spif_ptr_t arena;
+    spif_memidx_t arena_used;
+};
+
+extern spif_class_t SPIF_CLASS_VAR(atom);
+extern spif_str_t spif_atom_show(spif_atom_t, spif_charptr_t, spif_str_t, size_t);
+extern spif_cmp_t spif_atom_comp(spif_atom_t, spif_atom_t);
+extern spif_str_t spif_atom_dup(spif_atom_t);
+extern spif_classname_t spif_atom_type(spif_atom_t);
+extern spif_atom_t spif_atom_from_ptr(spif_charptr_t);
+extern spif_atom_t spif_atom_from_buff(spif_charptr_t, spif_stridx_t);
+extern spif_atom_t spif_atom_from_str(spif_str_t);
+extern spif_uint32_t spif_atom_get_hash(spif_atom_t);
+extern spif_symtab_t spif_atom_get_table(spif_atom_t);
+
+extern spif_class_t SPIF_CLASS_VAR(symtab);
+extern spif_symtab_t spif_symtab_new(void);
+extern spif_symtab_t spif_symtab_new_with_arena(spif_memidx_t);
+extern spif_bool_t spif_symtab_init(spif_symtab_t);
+extern spif_bool_t spif_symtab_init_with_arena(spif_symtab_t, spif_memidx_t);
+extern spif_bool_t spif_symtab_done(spif_symtab_t);
+extern spif_bool_t spif_symtab_del(spif_symtab_t);
+extern spif_str_t spif_symtab_show(spif_symtab_t, spif_charptr_t, spif_str_t, size_t);
+extern spif_cmp_t spif_symtab_comp(spif_symtab_t, spif_symtab_t);
+extern spif_symtab_t spif_symtab_dup(spif_symtab_t);
+extern spif_classname_t spif_symtab_type(spif_symtab_t);
+extern spif_symtab_t spif_symtab_global(void);
+extern spif_atom_t spif_symtab_intern(spif_symtab_t, spif_str_t);
+extern spif_atom_t spif_symtab_intern_from_ptr(spif_symtab_t, spif_charptr_t);
+extern spif_atom_t spif_symtab_intern_from_buff(spif_symtab_t, spif_charptr_t, spif_stridx_t);
+extern spif_atom_t spif_symtab_lookup_from_buff(spif_symtab_t, spif_charptr_t, spif_stridx_t);
+extern spif_listidx_t spif_symtab_get_len(spif_symtab_t);
+
+#endif /* _LIBAST_SYMTAB_H_ */
@@ -24,19 +24,20 @@
 #ifndef _LIBAST_USTR_H_
 #define _LIBAST_USTR_H_
 
+/* Length of the UTF-8 sequence introduced by the byte at s, or 0 if
+   that byte can't start one (a continuation byte, or 0xf8 and up). */
 #define SPIF_UTF8_CHAR_LEN(s)         (((((spif_uchar_t) (*(s))) & 0x80) == 0x00) \
                                        ? (1) \
-                                       : (((((spif_uchar_t) (*(s))) & 0xc0) == 0x80) \
+                                       : (((((spif_uchar_t) (*(s))) & 0xe0) == 0xc0) \
                                           ? (2) \
-                                          : (((((spif_uchar_t) (*(s))) & 0xe0) == 0xc0) \
+                                          : (((((spif_uchar_t) (*(s))) & 0xf0) == 0xe0) \
                                              ? (3) \
-                                             : (((((spif_uchar_t) (*(s))) & 0xf0) == 0xe0) \
+                                             : (((((spif_uchar_t) (*(s))) & 0xf8) == 0xf0) \
                                                 ? (4) \
-                                                : (((((spif_uchar_t) (*(s))) & 0xf8) == 0xf0) \
-                                                   ? (5) \
-                                                   : (((((spif_uchar_t) (*(s))) & 0xfc) == 0xf8) \
-                                                      ? (6) \
-                                                      : (0)))))))
+                                                : (0)))))
+
+/* Characters between entries of the character-to-byte offset index. */
+#define SPIF_USTR_INDEX_STEP          64
 
 #define SPIF_USTR(obj)                ((spif_ustr_t) (obj))
 #define SPIF_OBJ_IS_USTR(obj)         (SPIF_OBJ_IS_TYPE(obj, ustr))
@@ -103,6 +104,13 @@ SPIF_DECL_OBJ(ustr) {
     spif_charptr_t s;
     SPIF_DECL_PROPERTY_C(spif_ustridx_t, size);
     SPIF_DECL_PROPERTY_C(spif_ustridx_t, len);
+    /* Cached by the character-position methods and dropped by anything
+       that changes s:  the number of characters (-1 until counted),
+       whether s is well-formed UTF-8, and the byte offset of every
+       SPIF_USTR_INDEX_STEP-th character (NULL until needed). */
+    spif_ustridx_t chars;
+    spif_bool_t valid;
+    spif_ustridx_t *offsets;
 };
 
 extern spif_class_t SPIF_CLASS_VAR(ustr);
@@ -128,7 +136,13 @@ extern spif_classname_t spif_ustr_type(spif_ustr_t);
 
 extern spif_bool_t spif_ustr_append(spif_ustr_t, spif_ustr_t);
 extern spif_bool_t spif_ustr_append_char(spif_ustr_t, spif_char_t);
+extern spif_bool_t spif_ustr_append_double(spif_ustr_t, double);
 extern spif_bool_t spif_ustr_append_from_ptr(spif_ustr_t, spif_charptr_t);
+extern spif_bool_t spif_ustr_append_int(spif_ustr_t, spif_int64_t);
+extern spif_bool_t spif_ustr_append_uint(spif_ustr_t, spif_uint64_t);
+extern spif_uint32_t spif_ustr_char_at(spif_ustr_t, spif_ustridx_t);
+extern spif_ustridx_t spif_ustr_char_count(spif_ustr_t);
+extern spif_ustridx_t spif_ustr_char_offset(spif_ustr_t, spif_ustridx_t);
 extern spif_cmp_t spif_ustr_casecmp(spif_ustr_t, spif_ustr_t);
 extern spif_cmp_t spif_ustr_casecmp_with_ptr(spif_ustr_t, spif_charptr_t);
 extern spif_bool_t spif_ustr_clear(spif_ustr_t, spif_char_t);
@@ -138,10 +152,14 @@ extern spif_bool_t spif_ustr_downcase(spif_ustr_t);
 extern spif_ustridx_t spif_ustr_find(spif_ustr_t, spif_ustr_t);
 extern spif_ustridx_t spif_ustr_find_from_ptr(spif_ustr_t, spif_charptr_t);
 extern spif_ustridx_t spif_ustr_index(spif_ustr_t, spif_char_t);
+extern spif_bool_t spif_ustr_is_valid(spif_ustr_t);
 extern spif_cmp_t spif_ustr_ncasecmp(spif_ustr_t, spif_ustr_t, spif_ustridx_t);
 extern spif_cmp_t spif_ustr_ncasecmp_with_ptr(spif_ustr_t, spif_charptr_t, spif_ustridx_t);
 extern spif_cmp_t spif_ustr_ncmp(spif_ustr_t, spif_ustr_t, spif_ustridx_t);
 extern spif_cmp_t spif_ustr_ncmp_with_ptr(spif_ustr_t, spif_charptr_t, spif_ustridx_t);
+extern spif_bool_t spif_ustr_parse_double(spif_ustr_t, spif_ustridx_t, double *, spif_ustridx_t *);
+extern spif_bool_t spif_ustr_parse_int(spif_ustr_t, spif_ustridx_t, int, spif_int64_t *, spif_ustridx_t *);
+extern spif_bool_t spif_ustr_parse_uint(spif_ustr_t, spif_ustridx_t, int, spif_uint64_t *, spif_ustridx_t *);
 extern spif_bool_t spif_ustr_prepend(spif_ustr_t, spif_ustr_t);
 extern spif_bool_t spif_ustr_prepend_char(spif_ustr_t, spif_char_t);
 extern spif_bool_t spif_ustr_prepend_from_ptr(spif_ustr_t, spif_charptr_t);
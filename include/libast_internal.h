@@ -356,6 +356,56 @@ typedef struct spifconf_var_t {
 
 
 
+/****************************** CONTAINER GOOP *********************************/
+
+/*
+ * The list/vector/map implementations (array, linked_list, etc.) may be
+ * bound to a single element class along with a direct comparison
+ * function and an optional key extraction function.  Each such
+ * container object has elem_class, cmp_func, and key_func members,
+ * all of which are NULL when unbound.  These macros are used in the
+ * search and insertion loops so that an unbound container behaves
+ * exactly as it always has (i.e., SPIF_OBJ_COMP() on each element).
+ */
+
+/* Whether or not object o may be stored in container c. */
+#define SPIF_CONTAINER_ACCEPTS(c, o)       (((c)->elem_class == (spif_class_t) NULL) || SPIF_OBJ_ISNULL(o) \
+                                            || (SPIF_OBJ_CLASS(o) == (c)->elem_class))
+
+/* The comparison key of a stored element. */
+#define SPIF_CONTAINER_ITEM_KEY(c, o)      SPIF_OBJ_KEY_FUNC((c)->key_func, (o))
+
+/* The comparison key of a search probe.  A probe of the bound element
+   class (e.g., an objpair handed to a map) is reduced to its key;
+   anything else is assumed to be a key already. */
+#define SPIF_CONTAINER_PROBE_KEY(c, o)     ((((c)->key_func != (spif_key_func_t) NULL) && !SPIF_OBJ_ISNULL(o) \
+                                             && (SPIF_OBJ_CLASS(o) == (c)->elem_class)) \
+                                            ? (((c)->key_func)(SPIF_OBJ(o))) : (SPIF_OBJ(o)))
+
+/* Compare a stored element with a probe key, in that order. */
+#define SPIF_CONTAINER_COMP(c, item, key)  SPIF_OBJ_COMP_FUNC((c)->cmp_func, SPIF_CONTAINER_ITEM_KEY((c), (item)), (key))
+
+/* Compare a probe key with a stored element, in that order. */
+#define SPIF_CONTAINER_COMP_PROBE(c, key, item)  SPIF_OBJ_COMP_FUNC((c)->cmp_func, (key), SPIF_CONTAINER_ITEM_KEY((c), (item)))
+
+
+
+/******************************* FORMAT GOOP ***********************************/
+
+/*
+ * spiftool_vformat() appends formatted text to any object with a
+ * growable buffer.  When it runs out of room, it calls the object's
+ * grow function, which must make the buffer hold at least the given
+ * number of bytes, store the new size, and return the (possibly
+ * moved) buffer.
+ */
+typedef spif_charptr_t (*spiftool_format_grow_func_t)(spif_obj_t, spif_stridx_t, spif_stridx_t *);
+
+extern spif_stridx_t spiftool_vformat(spif_obj_t, spiftool_format_grow_func_t, spif_charptr_t, spif_stridx_t,
+                                      spif_stridx_t, const char *, va_list);
+
+
+
 /******************************* OPTIONS GOOP **********************************/
 
 /**
@@ -273,6 +273,34 @@ AC_DEFUN([AST_MMX_SUPPORT], [
     AC_SUBST(LIBAST_MMX_SUPPORT)
 ])
 
+dnl#
+dnl# LibAST macro for SSE2/AVX2 string routines
+dnl#
+AC_DEFUN([AST_SIMD_SUPPORT], [
+    AC_MSG_CHECKING(for SSE2/AVX2 string routine support)
+    HAVE_SIMD="yes"
+    AC_ARG_ENABLE(simd, [  --disable-simd          disable SSE2/AVX2 string routines], [
+                     test x$enableval = xno && HAVE_SIMD=""
+                  ])
+    if test -n "$HAVE_SIMD"; then
+        AC_TRY_LINK([
+#include <immintrin.h>
+__attribute__((target("avx2"))) static int avx2_test(const char *p) {
+    return _mm256_movemask_epi8(_mm256_loadu_si256((const __m256i *) p));
+}
+        ], [
+    __builtin_cpu_init();
+    return (__builtin_cpu_supports("avx2") ? avx2_test((const char *) 0) : 0);
+        ], [], [HAVE_SIMD=""])
+    fi
+    if test -n "$HAVE_SIMD"; then
+        AC_MSG_RESULT(yes)
+        AC_DEFINE([LIBAST_SIMD_SUPPORT], [1], [Define for SSE2/AVX2 string routines.])
+    else
+        AC_MSG_RESULT(no)
+    fi
+])
+
 dnl#
 dnl# LibAST macros for standard checks
 dnl#
@@ -33,6 +33,20 @@ SPIF_DECL_OBJ(array_iterator) {
     spif_array_t subject;
     spif_listidx_t current_index;
 };
+
+/* One worker's slice of a parallel bulk operation. */
+typedef struct spif_array_job_t_struct {
+    void (*run)(struct spif_array_job_t_struct *);
+    spif_array_t self;
+    spif_listidx_t start, mid, end;
+    spif_obj_t *buff;
+    spif_cmp_func_t cmp;
+    spif_array_each_func_t each;
+    spif_array_map_func_t map;
+    spif_array_reduce_func_t reduce;
+    spif_ptr_t data;
+    spif_obj_t result;
+} spif_array_job_t;
 /* *INDENT-ON* */
 
 static spif_array_t spif_array_list_new(void);
@@ -73,6 +87,17 @@ static spif_obj_t spif_array_map_remove(spif_array_t self, spif_obj_t item);
 static spif_bool_t spif_array_reverse(spif_array_t);
 static spif_bool_t spif_array_set(spif_array_t self, spif_obj_t key, spif_obj_t value);
 static spif_obj_t *spif_array_to_array(spif_array_t);
+static spif_uint32_t spif_array_workers(spif_listidx_t, spif_uint32_t);
+static spif_thread_data_t spif_array_job_thread(spif_thread_data_t);
+static void spif_array_run_jobs(spif_array_job_t *, spif_uint32_t);
+static spif_cmp_t spif_array_sort_comp(spif_array_job_t *, spif_obj_t, spif_obj_t);
+static void spif_array_merge(spif_array_job_t *, spif_obj_t *, spif_obj_t *, spif_listidx_t, spif_listidx_t, spif_listidx_t);
+static void spif_array_merge_sort(spif_array_job_t *, spif_listidx_t, spif_listidx_t);
+static void spif_array_sort_job(spif_array_job_t *);
+static void spif_array_merge_job(spif_array_job_t *);
+static void spif_array_for_each_job(spif_array_job_t *);
+static void spif_array_map_job(spif_array_job_t *);
+static void spif_array_reduce_job(spif_array_job_t *);
 static spif_array_iterator_t spif_array_iterator_new(spif_array_t subject);
 static spif_bool_t spif_array_iterator_init(spif_array_iterator_t self, spif_array_t subject);
 static spif_bool_t spif_array_iterator_done(spif_array_iterator_t self);
@@ -203,6 +228,9 @@ spif_array_list_init(spif_array_t self)
     }
     self->len = 0;
     self->items = (spif_obj_t *) NULL;
+    self->elem_class = (spif_class_t) NULL;
+    self->cmp_func = (spif_cmp_func_t) NULL;
+    self->key_func = (spif_key_func_t) NULL;
     return TRUE;
 }
 
@@ -243,6 +271,9 @@ spif_array_vector_init(spif_array_t self)
     }
     self->len = 0;
     self->items = (spif_obj_t *) NULL;
+    self->elem_class = (spif_class_t) NULL;
+    self->cmp_func = (spif_cmp_func_t) NULL;
+    self->key_func = (spif_key_func_t) NULL;
     return TRUE;
 }
 
@@ -257,6 +288,9 @@ spif_array_map_init(spif_array_t self)
     }
     self->len = 0;
     self->items = (spif_obj_t *) NULL;
+    self->elem_class = (spif_class_t) NULL;
+    self->cmp_func = (spif_cmp_func_t) NULL;
+    self->key_func = (spif_key_func_t) NULL;
     return TRUE;
 }
 
@@ -294,18 +328,11 @@ spif_array_show(spif_array_t self, spif_charptr_t name, spif_str_t buff, size_t
     spif_listidx_t i;
 
     if (SPIF_LIST_ISNULL(self)) {
-        SPIF_OBJ_SHOW_NULL(array, name, buff, indent, tmp);
+        SPIF_OBJ_SHOW_NULL_INTO(array, name, buff, indent);
         return buff;
     }
 
-    memset(tmp, ' ', indent);
-    snprintf((char *) tmp + indent, sizeof(tmp) - indent,
-             "(spif_array_t) %s:  %10p {\n", name, (spif_ptr_t) self);
-    if (SPIF_STR_ISNULL(buff)) {
-        buff = spif_str_new_from_ptr(tmp);
-    } else {
-        spif_str_append_from_ptr(buff, (spif_charptr_t) tmp);
-    }
+    buff = spif_str_show_printf(buff, indent, "(spif_array_t) %s:  %10p {\n", name, (spif_ptr_t) self);
 
     if (SPIF_ARRAY_ISNULL(self->items)) {
         spif_str_append_from_ptr(buff, (spif_charptr_t) SPIF_NULLSTR_TYPE_PTR(obj));
@@ -314,18 +341,14 @@ spif_array_show(spif_array_t self, spif_charptr_t name, spif_str_t buff, size_t
             spif_obj_t o = self->items[i];
             sprintf((char *) tmp, "item %d", i);
             if (SPIF_OBJ_ISNULL(o)) {
-                char tmp2[4096];
-
-                SPIF_OBJ_SHOW_NULL(obj, tmp, buff, indent + 2, tmp2);
+                SPIF_OBJ_SHOW_NULL_INTO(obj, tmp, buff, indent + 2);
             } else {
                 buff = SPIF_OBJ_CALL_METHOD(o, show)(o, tmp, buff, indent + 2);
             }
         }
     }
 
-    memset(tmp, ' ', indent);
-    snprintf((char *) tmp + indent, sizeof(tmp) - indent, "}\n");
-    spif_str_append_from_ptr(buff, (spif_charptr_t) tmp);
+    buff = spif_str_show_printf(buff, indent, "}\n");
     return buff;
 }
 
@@ -418,6 +441,7 @@ static spif_bool_t
 spif_array_append(spif_array_t self, spif_obj_t obj)
 {
     ASSERT_RVAL(!SPIF_ARRAY_ISNULL(self), FALSE);
+    REQUIRE_RVAL(SPIF_CONTAINER_ACCEPTS(self, obj), FALSE);
     self->len++;
     if (self->items) {
         self->items = (spif_obj_t *) REALLOC(self->items, sizeof(spif_obj_t) * self->len);
@@ -456,11 +480,12 @@ spif_array_list_find(spif_array_t self, spif_obj_t obj)
 
     ASSERT_RVAL(!SPIF_ARRAY_ISNULL(self), (spif_obj_t) NULL);
     REQUIRE_RVAL(!SPIF_OBJ_ISNULL(obj), (spif_obj_t) NULL);
+    obj = SPIF_CONTAINER_PROBE_KEY(self, obj);
     for (i = 0; i < self->len; i++) {
         if (SPIF_OBJ_ISNULL(self->items[i])) {
             continue;
         }
-        if (SPIF_CMP_IS_EQUAL(SPIF_OBJ_COMP(self->items[i], obj))) {
+        if (SPIF_CMP_IS_EQUAL(SPIF_CONTAINER_COMP(self, self->items[i], obj))) {
             return self->items[i];
         }
     }
@@ -477,9 +502,10 @@ spif_array_vector_find(spif_array_t self, spif_obj_t obj)
     REQUIRE_RVAL(!SPIF_OBJ_ISNULL(obj), (spif_obj_t) NULL);
     REQUIRE_RVAL(self->len > 0, (spif_obj_t) NULL);
 
+    obj = SPIF_CONTAINER_PROBE_KEY(self, obj);
     for (start = 0, end = self->len - 1; start <= end; ) {
         mid = (end - start) / 2 + start;
-        diff = SPIF_OBJ_COMP(self->items[mid], obj);
+        diff = SPIF_CONTAINER_COMP(self, self->items[mid], obj);
         if (SPIF_CMP_IS_EQUAL(diff)) {
             return self->items[mid];
         } else if (SPIF_CMP_IS_LESS(diff)) {
@@ -514,9 +540,10 @@ spif_array_map_get(spif_array_t self, spif_obj_t key)
     REQUIRE_RVAL(!SPIF_OBJ_ISNULL(key), (spif_obj_t) NULL);
     REQUIRE_RVAL(self->len > 0, (spif_obj_t) NULL);
 
+    key = SPIF_CONTAINER_PROBE_KEY(self, key);
     for (start = 0, end = self->len - 1; start <= end; ) {
         mid = (end - start) / 2 + start;
-        diff = SPIF_OBJ_COMP(self->items[mid], key);
+        diff = SPIF_CONTAINER_COMP(self, self->items[mid], key);
         if (SPIF_CMP_IS_EQUAL(diff)) {
             return SPIF_OBJPAIR(self->items[mid])->value;
         } else if (SPIF_CMP_IS_LESS(diff)) {
@@ -611,6 +638,7 @@ spif_array_index(spif_array_t self, spif_obj_t obj)
     spif_listidx_t i;
 
     ASSERT_RVAL(!SPIF_ARRAY_ISNULL(self), (spif_listidx_t) -1);
+    obj = SPIF_CONTAINER_PROBE_KEY(self, obj);
     for (i = 0; i < self->len; i++) {
         if (SPIF_OBJ_ISNULL(self->items[i])) {
             if (SPIF_OBJ_ISNULL(obj)) {
@@ -618,7 +646,7 @@ spif_array_index(spif_array_t self, spif_obj_t obj)
             }
             continue;
         }
-        if (SPIF_CMP_IS_EQUAL(SPIF_OBJ_COMP(self->items[i], obj))) {
+        if (SPIF_CMP_IS_EQUAL(SPIF_CONTAINER_COMP(self, self->items[i], obj))) {
             return i;
         }
     }
@@ -628,17 +656,20 @@ spif_array_index(spif_array_t self, spif_obj_t obj)
 static spif_bool_t
 spif_array_insert(spif_array_t self, spif_obj_t obj)
 {
+    spif_obj_t key;
     spif_listidx_t i, left;
 
     ASSERT_RVAL(!SPIF_ARRAY_ISNULL(self), FALSE);
     REQUIRE_RVAL(!SPIF_OBJ_ISNULL(obj), FALSE);
+    REQUIRE_RVAL(SPIF_CONTAINER_ACCEPTS(self, obj), FALSE);
     if (self->items) {
         self->items = (spif_obj_t *) REALLOC(self->items, sizeof(spif_obj_t) * (self->len + 1));
     } else {
         self->items = (spif_obj_t *) MALLOC(sizeof(spif_obj_t) * (self->len + 1));
     }
 
-    for (i = 0; i < self->len && SPIF_CMP_IS_GREATER(SPIF_OBJ_COMP(obj, self->items[i])); i++);
+    key = SPIF_CONTAINER_PROBE_KEY(self, obj);
+    for (i = 0; i < self->len && SPIF_CMP_IS_GREATER(SPIF_CONTAINER_COMP_PROBE(self, key, self->items[i])); i++);
     left = self->len - i;
     if (left) {
         memmove(self->items + i + 1, self->items + i, sizeof(spif_obj_t) * left);
@@ -655,6 +686,7 @@ spif_array_insert_at(spif_array_t self, spif_obj_t obj, spif_listidx_t idx)
 
     ASSERT_RVAL(!SPIF_ARRAY_ISNULL(self), FALSE);
     REQUIRE_RVAL(!SPIF_OBJ_ISNULL(obj), FALSE);
+    REQUIRE_RVAL(SPIF_CONTAINER_ACCEPTS(self, obj), FALSE);
     if (idx < 0) {
         /* Negative indexes go backward from the end of the list. */
         idx += self->len;
@@ -700,6 +732,7 @@ spif_array_prepend(spif_array_t self, spif_obj_t obj)
 {
     ASSERT_RVAL(!SPIF_ARRAY_ISNULL(self), FALSE);
     REQUIRE_RVAL(!SPIF_OBJ_ISNULL(obj), FALSE);
+    REQUIRE_RVAL(SPIF_CONTAINER_ACCEPTS(self, obj), FALSE);
     if (self->items) {
         self->items = (spif_obj_t *) REALLOC(self->items, sizeof(spif_obj_t) * (self->len + 1));
     } else {
@@ -720,7 +753,8 @@ spif_array_remove(spif_array_t self, spif_obj_t item)
 
     ASSERT_RVAL(!SPIF_ARRAY_ISNULL(self), (spif_obj_t) NULL);
     REQUIRE_RVAL(!SPIF_OBJ_ISNULL(item), (spif_obj_t) NULL);
-    for (i = 0; i < self->len && !SPIF_CMP_IS_EQUAL(SPIF_OBJ_COMP(item, self->items[i])); i++);
+    item = SPIF_CONTAINER_PROBE_KEY(self, item);
+    for (i = 0; i < self->len && !SPIF_CMP_IS_EQUAL(SPIF_CONTAINER_COMP_PROBE(self, item, self->items[i])); i++);
     if (i == self->len) {
         return (spif_obj_t) NULL;
     }
@@ -742,7 +776,8 @@ spif_array_map_remove(spif_array_t self, spif_obj_t item)
 
     ASSERT_RVAL(!SPIF_ARRAY_ISNULL(self), (spif_obj_t) NULL);
     REQUIRE_RVAL(!SPIF_OBJ_ISNULL(item), (spif_obj_t) NULL);
-    for (i = 0; i < self->len && !SPIF_CMP_IS_EQUAL(SPIF_OBJ_COMP(self->items[i], item)); i++);
+    item = SPIF_CONTAINER_PROBE_KEY(self, item);
+    for (i = 0; i < self->len && !SPIF_CMP_IS_EQUAL(SPIF_CONTAINER_COMP(self, self->items[i], item)); i++);
     if (i == self->len) {
         return (spif_obj_t) NULL;
     }
@@ -805,7 +840,7 @@ spif_array_set(spif_array_t self, spif_obj_t key, spif_obj_t value)
         key = SPIF_OBJ(SPIF_OBJPAIR(key)->key);
     }
 
-    for (i = 0; i < self->len && !SPIF_CMP_IS_EQUAL(SPIF_OBJ_COMP(self->items[i], key)); i++);
+    for (i = 0; i < self->len && !SPIF_CMP_IS_EQUAL(SPIF_CONTAINER_COMP(self, self->items[i], key)); i++);
     if (i == self->len) {
         spif_array_insert(self, SPIF_OBJ(spif_objpair_new_from_both(key, value)));
         return FALSE;
@@ -815,6 +850,361 @@ spif_array_set(spif_array_t self, spif_obj_t key, spif_obj_t value)
     }
 }
 
+spif_bool_t
+spif_array_set_comparator(spif_array_t self, spif_class_t cls, spif_cmp_func_t cmp, spif_key_func_t key)
+{
+    ASSERT_RVAL(!SPIF_ARRAY_ISNULL(self), FALSE);
+    REQUIRE_RVAL(self->len == 0, FALSE);
+    REQUIRE_RVAL((key == (spif_key_func_t) NULL) || (cls != (spif_class_t) NULL), FALSE);
+    self->elem_class = cls;
+    self->cmp_func = cmp;
+    self->key_func = key;
+    return TRUE;
+}
+
+static spif_uint32_t
+spif_array_workers(spif_listidx_t len, spif_uint32_t nthreads)
+{
+    if (nthreads == 0) {
+#ifdef _SC_NPROCESSORS_ONLN
+        long ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+        nthreads = ((ncpus > 0) ? ((spif_uint32_t) ncpus) : (1));
+#else
+        nthreads = 1;
+#endif
+    }
+    if (len < 0 || (spif_uint32_t) (len / SPIF_ARRAY_PARALLEL_MIN) < nthreads) {
+        nthreads = (spif_uint32_t) (len / SPIF_ARRAY_PARALLEL_MIN);
+    }
+    return ((nthreads) ? (nthreads) : (1));
+}
+
+static spif_thread_data_t
+spif_array_job_thread(spif_thread_data_t thread)
+{
+    spif_array_job_t *job;
+
+    job = (spif_array_job_t *) SPIF_PTHREADS(thread)->data;
+    job->run(job);
+    return (spif_thread_data_t) NULL;
+}
+
+static void
+spif_array_run_jobs(spif_array_job_t *jobs, spif_uint32_t njobs)
+{
+    spif_pthreads_t *threads;
+    spif_uint32_t i;
+
+    /* The calling thread takes the first job itself.  Any job whose
+       thread can't be started is run here too. */
+    threads = (spif_pthreads_t *) MALLOC(sizeof(spif_pthreads_t) * njobs);
+    for (i = 1; i < njobs; i++) {
+        threads[i] = spif_pthreads_new_with_func(spif_array_job_thread, (spif_thread_data_t) &jobs[i]);
+        if (!SPIF_PTHREADS_ISNULL(threads[i]) && !spif_pthreads_run(threads[i])) {
+            spif_pthreads_del(threads[i]);
+            threads[i] = (spif_pthreads_t) NULL;
+        }
+        if (SPIF_PTHREADS_ISNULL(threads[i])) {
+            jobs[i].run(&jobs[i]);
+        }
+    }
+    jobs[0].run(&jobs[0]);
+    for (i = 1; i < njobs; i++) {
+        if (!SPIF_PTHREADS_ISNULL(threads[i])) {
+            spif_pthreads_wait_for((spif_pthreads_t) NULL, threads[i]);
+            spif_pthreads_del(threads[i]);
+        }
+    }
+    FREE(threads);
+}
+
+static spif_cmp_t
+spif_array_sort_comp(spif_array_job_t *job, spif_obj_t a, spif_obj_t b)
+{
+    if (SPIF_OBJ_ISNULL(a)) {
+        return ((SPIF_OBJ_ISNULL(b)) ? (SPIF_CMP_EQUAL) : (SPIF_CMP_LESS));
+    } else if (SPIF_OBJ_ISNULL(b)) {
+        return SPIF_CMP_GREATER;
+    } else if (job->cmp) {
+        return job->cmp(a, b);
+    }
+    return SPIF_OBJ_COMP_FUNC(job->self->cmp_func, SPIF_CONTAINER_ITEM_KEY(job->self, a),
+                              SPIF_CONTAINER_ITEM_KEY(job->self, b));
+}
+
+static void
+spif_array_merge(spif_array_job_t *job, spif_obj_t *src, spif_obj_t *dest, spif_listidx_t start,
+                 spif_listidx_t mid, spif_listidx_t end)
+{
+    spif_listidx_t i, j, k;
+
+    /* Ties go to the left run, which keeps the sort stable. */
+    for (i = start, j = mid, k = start; i < mid && j < end; k++) {
+        if (SPIF_CMP_IS_GREATER(spif_array_sort_comp(job, src[i], src[j]))) {
+            dest[k] = src[j++];
+        } else {
+            dest[k] = src[i++];
+        }
+    }
+    for (; i < mid; i++, k++) {
+        dest[k] = src[i];
+    }
+    for (; j < end; j++, k++) {
+        dest[k] = src[j];
+    }
+}
+
+static void
+spif_array_merge_sort(spif_array_job_t *job, spif_listidx_t start, spif_listidx_t end)
+{
+    spif_obj_t *items = job->self->items;
+    spif_listidx_t i, j, mid;
+
+    if (end - start <= 16) {
+        for (i = start + 1; i < end; i++) {
+            spif_obj_t tmp = items[i];
+
+            for (j = i; j > start && SPIF_CMP_IS_GREATER(spif_array_sort_comp(job, items[j - 1], tmp)); j--) {
+                items[j] = items[j - 1];
+            }
+            items[j] = tmp;
+        }
+        return;
+    }
+    mid = start + (end - start) / 2;
+    spif_array_merge_sort(job, start, mid);
+    spif_array_merge_sort(job, mid, end);
+    if (!SPIF_CMP_IS_GREATER(spif_array_sort_comp(job, items[mid - 1], items[mid]))) {
+        /* Already in order. */
+        return;
+    }
+    memcpy(job->buff + start, items + start, sizeof(spif_obj_t) * (end - start));
+    spif_array_merge(job, job->buff, items, start, mid, end);
+}
+
+static void
+spif_array_sort_job(spif_array_job_t *job)
+{
+    spif_array_merge_sort(job, job->start, job->end);
+}
+
+static void
+spif_array_merge_job(spif_array_job_t *job)
+{
+    spif_obj_t *items = job->self->items;
+
+    if (job->mid >= job->end
+        || !SPIF_CMP_IS_GREATER(spif_array_sort_comp(job, items[job->mid - 1], items[job->mid]))) {
+        return;
+    }
+    memcpy(job->buff + job->start, items + job->start, sizeof(spif_obj_t) * (job->end - job->start));
+    spif_array_merge(job, job->buff, items, job->start, job->mid, job->end);
+}
+
+spif_bool_t
+spif_array_sort(spif_array_t self, spif_cmp_func_t cmp, spif_uint32_t nthreads)
+{
+    spif_array_job_t *jobs;
+    spif_obj_t *buff;
+    spif_uint32_t i, n, runs;
+
+    ASSERT_RVAL(!SPIF_ARRAY_ISNULL(self), FALSE);
+    /* Vectors and maps must stay in their own order. */
+    REQUIRE_RVAL((cmp == (spif_cmp_func_t) NULL)
+                 || (SPIF_OBJ_CLASS(self) == SPIF_CLASS(SPIF_LISTCLASS_VAR(array))), FALSE);
+    if (self->len < 2) {
+        return TRUE;
+    }
+
+    n = spif_array_workers(self->len, nthreads);
+    buff = (spif_obj_t *) MALLOC(sizeof(spif_obj_t) * self->len);
+    jobs = (spif_array_job_t *) MALLOC(sizeof(spif_array_job_t) * n);
+    memset(jobs, 0, sizeof(spif_array_job_t) * n);
+
+    /* Sort each slice, then merge neighboring runs pairwise until only
+       one is left.  Run boundaries live in jobs[i].start/end. */
+    for (i = 0; i < n; i++) {
+        jobs[i].run = spif_array_sort_job;
+        jobs[i].self = self;
+        jobs[i].buff = buff;
+        jobs[i].cmp = cmp;
+        jobs[i].start = (spif_listidx_t) (((spif_uint64_t) self->len * i) / n);
+        jobs[i].end = (spif_listidx_t) (((spif_uint64_t) self->len * (i + 1)) / n);
+    }
+    spif_array_run_jobs(jobs, n);
+
+    for (runs = n; runs > 1; runs = (runs + 1) / 2) {
+        for (i = 0; i + 1 < runs; i += 2) {
+            jobs[i / 2].run = spif_array_merge_job;
+            jobs[i / 2].start = jobs[i].start;
+            jobs[i / 2].mid = jobs[i].end;
+            jobs[i / 2].end = jobs[i + 1].end;
+        }
+        if (runs & 1) {
+            /* The odd run out carries over unmerged. */
+            jobs[i / 2].run = spif_array_merge_job;
+            jobs[i / 2].start = jobs[i].start;
+            jobs[i / 2].mid = jobs[i].end;
+            jobs[i / 2].end = jobs[i].end;
+        }
+        spif_array_run_jobs(jobs, (runs + 1) / 2);
+    }
+
+    FREE(jobs);
+    FREE(buff);
+    return TRUE;
+}
+
+static void
+spif_array_for_each_job(spif_array_job_t *job)
+{
+    spif_listidx_t i;
+
+    for (i = job->start; i < job->end; i++) {
+        job->each(job->self->items[i], job->data);
+    }
+}
+
+static void
+spif_array_map_job(spif_array_job_t *job)
+{
+    spif_listidx_t i;
+
+    for (i = job->start; i < job->end; i++) {
+        job->buff[i] = job->map(job->self->items[i], job->data);
+    }
+}
+
+static void
+spif_array_reduce_job(spif_array_job_t *job)
+{
+    spif_listidx_t i;
+
+    for (i = job->start; i < job->end; i++) {
+        job->result = job->reduce(job->result, job->self->items[i], job->data);
+    }
+}
+
+spif_bool_t
+spif_array_for_each(spif_array_t self, spif_array_each_func_t func, spif_ptr_t data, spif_uint32_t nthreads)
+{
+    spif_array_job_t *jobs;
+    spif_uint32_t i, n;
+
+    ASSERT_RVAL(!SPIF_ARRAY_ISNULL(self), FALSE);
+    REQUIRE_RVAL(func != (spif_array_each_func_t) NULL, FALSE);
+    n = spif_array_workers(self->len, nthreads);
+    jobs = (spif_array_job_t *) MALLOC(sizeof(spif_array_job_t) * n);
+    memset(jobs, 0, sizeof(spif_array_job_t) * n);
+    for (i = 0; i < n; i++) {
+        jobs[i].run = spif_array_for_each_job;
+        jobs[i].self = self;
+        jobs[i].each = func;
+        jobs[i].data = data;
+        jobs[i].start = (spif_listidx_t) (((spif_uint64_t) self->len * i) / n);
+        jobs[i].end = (spif_listidx_t) (((spif_uint64_t) self->len * (i + 1)) / n);
+    }
+    spif_array_run_jobs(jobs, n);
+    FREE(jobs);
+    return TRUE;
+}
+
+spif_array_t
+spif_array_map_into(spif_array_t self, spif_array_t dest, spif_array_map_func_t func, spif_ptr_t data, spif_uint32_t nthreads)
+{
+    spif_array_job_t *jobs;
+    spif_obj_t *items;
+    spif_uint32_t i, n;
+
+    ASSERT_RVAL(!SPIF_ARRAY_ISNULL(self), (spif_array_t) NULL);
+    REQUIRE_RVAL(func != (spif_array_map_func_t) NULL, (spif_array_t) NULL);
+    REQUIRE_RVAL(dest != self, (spif_array_t) NULL);
+
+    items = (spif_obj_t *) MALLOC(sizeof(spif_obj_t) * self->len);
+    n = spif_array_workers(self->len, nthreads);
+    jobs = (spif_array_job_t *) MALLOC(sizeof(spif_array_job_t) * n);
+    memset(jobs, 0, sizeof(spif_array_job_t) * n);
+    for (i = 0; i < n; i++) {
+        jobs[i].run = spif_array_map_job;
+        jobs[i].self = self;
+        jobs[i].buff = items;
+        jobs[i].map = func;
+        jobs[i].data = data;
+        jobs[i].start = (spif_listidx_t) (((spif_uint64_t) self->len * i) / n);
+        jobs[i].end = (spif_listidx_t) (((spif_uint64_t) self->len * (i + 1)) / n);
+    }
+    spif_array_run_jobs(jobs, n);
+    FREE(jobs);
+
+    if (!SPIF_ARRAY_ISNULL(dest)) {
+        spif_listidx_t j;
+
+        /* Every result must be storable in dest; if one is not, dest is
+           left as it was and the results are thrown away. */
+        for (j = 0; j < self->len && SPIF_CONTAINER_ACCEPTS(dest, items[j]); j++);
+        if (j < self->len) {
+            for (j = 0; j < self->len; j++) {
+                if (!SPIF_OBJ_ISNULL(items[j])) {
+                    SPIF_OBJ_DEL(items[j]);
+                }
+            }
+            FREE(items);
+            return (spif_array_t) NULL;
+        }
+    }
+    if (SPIF_ARRAY_ISNULL(dest)) {
+        dest = SPIF_ARRAY(SPIF_OBJ_CLASS(self)->noo());
+    } else {
+        spif_array_done(dest);
+    }
+    dest->items = items;
+    dest->len = self->len;
+    if (SPIF_OBJ_CLASS(dest) != SPIF_CLASS(SPIF_LISTCLASS_VAR(array))) {
+        spif_array_sort(dest, (spif_cmp_func_t) NULL, nthreads);
+    }
+    return dest;
+}
+
+spif_obj_t
+spif_array_reduce(spif_array_t self, spif_array_reduce_func_t func, spif_array_reduce_func_t combine, spif_obj_t init,
+                  spif_ptr_t data, spif_uint32_t nthreads)
+{
+    spif_array_job_t *jobs;
+    spif_obj_t result;
+    spif_uint32_t i, n;
+
+    ASSERT_RVAL(!SPIF_ARRAY_ISNULL(self), (spif_obj_t) NULL);
+    REQUIRE_RVAL(func != (spif_array_reduce_func_t) NULL, (spif_obj_t) NULL);
+    if (combine == (spif_array_reduce_func_t) NULL) {
+        combine = func;
+    }
+
+    n = spif_array_workers(self->len, nthreads);
+    jobs = (spif_array_job_t *) MALLOC(sizeof(spif_array_job_t) * n);
+    memset(jobs, 0, sizeof(spif_array_job_t) * n);
+    for (i = 0; i < n; i++) {
+        jobs[i].run = spif_array_reduce_job;
+        jobs[i].self = self;
+        jobs[i].reduce = func;
+        jobs[i].data = data;
+        jobs[i].result = ((SPIF_OBJ_ISNULL(init)) ? ((spif_obj_t) NULL) : (SPIF_OBJ_DUP(init)));
+        jobs[i].start = (spif_listidx_t) (((spif_uint64_t) self->len * i) / n);
+        jobs[i].end = (spif_listidx_t) (((spif_uint64_t) self->len * (i + 1)) / n);
+    }
+    spif_array_run_jobs(jobs, n);
+
+    result = jobs[0].result;
+    for (i = 1; i < n; i++) {
+        result = combine(result, jobs[i].result, data);
+        if (!SPIF_OBJ_ISNULL(jobs[i].result) && jobs[i].result != result) {
+            SPIF_OBJ_DEL(jobs[i].result);
+        }
+    }
+    FREE(jobs);
+    return result;
+}
+
 static spif_obj_t *
 spif_array_to_array(spif_array_t self)
 {
@@ -879,32 +1269,19 @@ spif_array_iterator_del(spif_array_iterator_t self)
 static spif_str_t
 spif_array_iterator_show(spif_array_iterator_t self, spif_charptr_t name, spif_str_t buff, size_t indent)
 {
-    spif_char_t tmp[4096];
-
     if (SPIF_ITERATOR_ISNULL(self)) {
-        SPIF_OBJ_SHOW_NULL(iterator, name, buff, indent, tmp);
+        SPIF_OBJ_SHOW_NULL_INTO(iterator, name, buff, indent);
         return buff;
     }
 
-    memset(tmp, ' ', indent);
-    snprintf((char *) tmp + indent, sizeof(tmp) - indent,
-             "(spif_array_iterator_t) %s:  %10p {\n", name, (spif_ptr_t) self);
-    if (SPIF_STR_ISNULL(buff)) {
-        buff = spif_str_new_from_ptr(tmp);
-    } else {
-        spif_str_append_from_ptr(buff, tmp);
-    }
+    buff = spif_str_show_printf(buff, indent, "(spif_array_iterator_t) %s:  %10p {\n", name, (spif_ptr_t) self);
 
     buff = spif_array_show(self->subject, (spif_charptr_t) "subject", buff, indent + 2);
 
-    memset(tmp, ' ', indent + 2);
-    snprintf((char *) tmp + indent, sizeof(tmp) - indent,
-             "  (spif_listidx_t) current_index:  %lu\n",
-             (unsigned long) self->current_index);
-    spif_str_append_from_ptr(buff, tmp);
+    buff = spif_str_show_printf(buff, indent, "  (spif_listidx_t) current_index:  %lu\n",
+                                (unsigned long) self->current_index);
 
-    snprintf((char *) tmp + indent, sizeof(tmp) - indent, "}\n");
-    spif_str_append_from_ptr(buff, tmp);
+    buff = spif_str_show_printf(buff, indent, "}\n");
     return buff;
 }
 
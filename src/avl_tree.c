@@ -162,36 +162,25 @@ spif_avl_tree_node_del(spif_avl_tree_node_t self)
 static spif_str_t
 spif_avl_tree_node_show(spif_avl_tree_node_t self, spif_charptr_t name, spif_str_t buff, size_t indent)
 {
-    spif_char_t tmp[4096];
-
     if (SPIF_AVL_TREE_NODE_ISNULL(self)) {
-        SPIF_OBJ_SHOW_NULL(avl_tree_node, name, buff, indent, tmp);
+        SPIF_OBJ_SHOW_NULL_INTO(avl_tree_node, name, buff, indent);
         return buff;
     }
 
-    memset(tmp, ' ', indent);
-    snprintf(tmp + indent, sizeof(tmp) - indent, "(spif_avl_tree_node_t) %s:  %10p {\n",
-             name, self);
-    if (SPIF_STR_ISNULL(buff)) {
-        buff = spif_str_new_from_ptr(tmp);
-    } else {
-        spif_str_append_from_ptr(buff, tmp);
-    }
+    buff = spif_str_show_printf(buff, indent, "(spif_avl_tree_node_t) %s:  %10p {\n", name, self);
     if (SPIF_OBJ_ISNULL(self->data)) {
         spif_str_append_from_ptr(buff, SPIF_NULLSTR_TYPE(obj));
     } else {
         buff = SPIF_OBJ_SHOW(self->data, buff, 0);
     }
-    memset(tmp, ' ', indent + 2);
-    snprintf(tmp + indent + 2, sizeof(tmp) - indent - 2, "(spif_int8_t) balance:  %s (%d)\n",
-             ((self->balance == LEFT_HEAVY)
-              ? ("LEFT_HEAVY")
-              : ((self->balance == RIGHT_HEAVY)
-                 ? ("RIGHT_HEAVY")
-                 : ((self->balance == BALANCED)
-                    ? ("BALANCED")
-                    : ("UNKNOWN")))), (int) self->balance);
-    spif_str_append_from_ptr(buff, tmp);
+    buff = spif_str_show_printf(buff, indent + 2, "(spif_int8_t) balance:  %s (%d)\n",
+                                ((self->balance == LEFT_HEAVY)
+                                 ? ("LEFT_HEAVY")
+                                 : ((self->balance == RIGHT_HEAVY)
+                                    ? ("RIGHT_HEAVY")
+                                    : ((self->balance == BALANCED)
+                                       ? ("BALANCED")
+                                       : ("UNKNOWN")))), (int) self->balance);
 
     if (!SPIF_AVL_TREE_NODE_ISNULL(self->left)) {
         buff = spif_avl_tree_node_show(self->left, "left", buff, indent + 2);
@@ -199,9 +188,7 @@ spif_avl_tree_node_show(spif_avl_tree_node_t self, spif_charptr_t name, spif_str
     if (!SPIF_AVL_TREE_NODE_ISNULL(self->right)) {
         buff = spif_avl_tree_node_show(self->right, "right", buff, indent + 2);
     }
-    memset(tmp, ' ', indent);
-    snprintf(tmp + indent, sizeof(tmp) - indent, "}\n");
-    spif_str_append_from_ptr(buff, tmp);
+    buff = spif_str_show_printf(buff, indent, "}\n");
     return buff;
 }
 
@@ -292,23 +279,13 @@ spif_avl_tree_del(spif_avl_tree_t self)
 static spif_str_t
 spif_avl_tree_show(spif_avl_tree_t self, spif_charptr_t name, spif_str_t buff, size_t indent)
 {
-    spif_char_t tmp[4096];
-
     if (SPIF_VECTOR_ISNULL(self)) {
-        SPIF_OBJ_SHOW_NULL(avl_tree, name, buff, indent, tmp);
+        SPIF_OBJ_SHOW_NULL_INTO(avl_tree, name, buff, indent);
         return buff;
     }
 
-    memset(tmp, ' ', indent);
-    snprintf(tmp + indent, sizeof(tmp) - indent, "(spif_avl_tree_t) %s:  {\n", name);
-    if (SPIF_STR_ISNULL(buff)) {
-        buff = spif_str_new_from_ptr(tmp);
-    } else {
-        spif_str_append_from_ptr(buff, tmp);
-    }
-
-    snprintf(tmp + indent, sizeof(tmp) - indent, "  len:  %lu\n", (unsigned long) self->len);
-    spif_str_append_from_ptr(buff, tmp);
+    buff = spif_str_show_printf(buff, indent, "(spif_avl_tree_t) %s:  {\n", name);
+    buff = spif_str_show_printf(buff, indent, "  len:  %lu\n", (unsigned long) self->len);
 
     if (SPIF_AVL_TREE_NODE_ISNULL(self->root)) {
         spif_str_append_from_ptr(buff, SPIF_NULLSTR_TYPE(obj));
@@ -316,9 +293,7 @@ spif_avl_tree_show(spif_avl_tree_t self, spif_charptr_t name, spif_str_t buff, s
         buff = spif_avl_tree_node_show(self->root, "root", buff, indent + 2);
     }
 
-    memset(tmp, ' ', indent);
-    snprintf(tmp + indent, sizeof(tmp) - indent, "}\n");
-    spif_str_append_from_ptr(buff, tmp);
+    buff = spif_str_show_printf(buff, indent, "}\n");
     return buff;
 }
 
@@ -258,23 +258,14 @@ spif_dlinked_list_item_del(spif_dlinked_list_item_t self)
 static spif_str_t
 spif_dlinked_list_item_show(spif_dlinked_list_item_t self, spif_charptr_t name, spif_str_t buff, size_t indent)
 {
-    spif_char_t tmp[4096];
-
     if (SPIF_DLINKED_LIST_ITEM_ISNULL(self)) {
-        SPIF_OBJ_SHOW_NULL(dlinked_list_item, name, buff, indent, tmp);
+        SPIF_OBJ_SHOW_NULL_INTO(dlinked_list_item, name, buff, indent);
         return buff;
     }
 
-    memset(tmp, ' ', indent);
-    snprintf((char *) tmp + indent, sizeof(tmp) - indent,
-             "(spif_dlinked_list_item_t) %s (%9p <- %9p -> %9p):  ",
-             name, (spif_ptr_t) self->prev, (spif_ptr_t) self,
-             (spif_ptr_t) self->next);
-    if (SPIF_STR_ISNULL(buff)) {
-        buff = spif_str_new_from_ptr(tmp);
-    } else {
-        spif_str_append_from_ptr(buff, (spif_charptr_t) tmp);
-    }
+    buff = spif_str_show_printf(buff, indent, "(spif_dlinked_list_item_t) %s (%9p <- %9p -> %9p):  ",
+                                name, (spif_ptr_t) self->prev, (spif_ptr_t) self,
+                                (spif_ptr_t) self->next);
     if (SPIF_DLINKED_LIST_ITEM_ISNULL(self->data)) {
         spif_str_append_from_ptr(buff, (spif_charptr_t) SPIF_NULLSTR_TYPE(obj));
     } else {
@@ -361,6 +352,9 @@ spif_dlinked_list_init(spif_dlinked_list_t self)
     self->len = 0;
     self->head = (spif_dlinked_list_item_t) NULL;
     self->tail = (spif_dlinked_list_item_t) NULL;
+    self->elem_class = (spif_class_t) NULL;
+    self->cmp_func = (spif_cmp_func_t) NULL;
+    self->key_func = (spif_key_func_t) NULL;
     return TRUE;
 }
 
@@ -373,6 +367,9 @@ spif_dlinked_list_vector_init(spif_dlinked_list_t self)
     self->len = 0;
     self->head = (spif_dlinked_list_item_t) NULL;
     self->tail = (spif_dlinked_list_item_t) NULL;
+    self->elem_class = (spif_class_t) NULL;
+    self->cmp_func = (spif_cmp_func_t) NULL;
+    self->key_func = (spif_key_func_t) NULL;
     return TRUE;
 }
 
@@ -385,6 +382,9 @@ spif_dlinked_list_map_init(spif_dlinked_list_t self)
     self->len = 0;
     self->head = (spif_dlinked_list_item_t) NULL;
     self->tail = (spif_dlinked_list_item_t) NULL;
+    self->elem_class = (spif_class_t) NULL;
+    self->cmp_func = (spif_cmp_func_t) NULL;
+    self->key_func = (spif_key_func_t) NULL;
     return TRUE;
 }
 
@@ -426,18 +426,11 @@ spif_dlinked_list_show(spif_dlinked_list_t self, spif_charptr_t name, spif_str_t
     spif_listidx_t i;
 
     if (SPIF_LIST_ISNULL(self)) {
-        SPIF_OBJ_SHOW_NULL(dlinked_list, name, buff, indent, tmp);
+        SPIF_OBJ_SHOW_NULL_INTO(dlinked_list, name, buff, indent);
         return buff;
     }
 
-    memset(tmp, ' ', indent);
-    snprintf((char *) tmp + indent, sizeof(tmp) - indent,
-             "(spif_dlinked_list_t) %s:  %10p {\n", name, (spif_ptr_t) self);
-    if (SPIF_STR_ISNULL(buff)) {
-        buff = spif_str_new_from_ptr(tmp);
-    } else {
-        spif_str_append_from_ptr(buff, tmp);
-    }
+    buff = spif_str_show_printf(buff, indent, "(spif_dlinked_list_t) %s:  %10p {\n", name, (spif_ptr_t) self);
 
     if (SPIF_DLINKED_LIST_ITEM_ISNULL(self->head)) {
         spif_str_append_from_ptr(buff, (spif_charptr_t) SPIF_NULLSTR_TYPE(obj));
@@ -448,9 +441,7 @@ spif_dlinked_list_show(spif_dlinked_list_t self, spif_charptr_t name, spif_str_t
         }
     }
 
-    memset(tmp, ' ', indent);
-    snprintf((char *) tmp + indent, sizeof(tmp) - indent, "}\n");
-    spif_str_append_from_ptr(buff, tmp);
+    buff = spif_str_show_printf(buff, indent, "}\n");
     return buff;
 }
 
@@ -537,6 +528,7 @@ spif_dlinked_list_append(spif_dlinked_list_t self, spif_obj_t obj)
     spif_dlinked_list_item_t item;
 
     ASSERT_RVAL(!SPIF_LIST_ISNULL(self), FALSE);
+    REQUIRE_RVAL(SPIF_CONTAINER_ACCEPTS(self, obj), FALSE);
     /* Create list member object "item" */
     item = spif_dlinked_list_item_new();
     spif_dlinked_list_item_set_data(item, obj);
@@ -583,8 +575,9 @@ spif_dlinked_list_find(spif_dlinked_list_t self, spif_obj_t obj)
 
     ASSERT_RVAL(!SPIF_LIST_ISNULL(self), (spif_obj_t) NULL);
     REQUIRE_RVAL(!SPIF_OBJ_ISNULL(obj), (spif_obj_t) NULL);
+    obj = SPIF_CONTAINER_PROBE_KEY(self, obj);
     for (current = self->head; current; current = current->next) {
-        if (SPIF_CMP_IS_EQUAL(SPIF_OBJ_COMP(obj, current->data))) {
+        if (SPIF_CMP_IS_EQUAL(SPIF_CONTAINER_COMP_PROBE(self, obj, current->data))) {
             return current->data;
         }
     }
@@ -598,10 +591,11 @@ spif_dlinked_list_vector_find(spif_dlinked_list_t self, spif_obj_t obj)
 
     ASSERT_RVAL(!SPIF_VECTOR_ISNULL(self), (spif_obj_t) NULL);
     REQUIRE_RVAL(!SPIF_OBJ_ISNULL(obj), (spif_obj_t) NULL);
+    obj = SPIF_CONTAINER_PROBE_KEY(self, obj);
     for (current = self->head; current; current = current->next) {
         spif_cmp_t c;
 
-        c = SPIF_OBJ_COMP(obj, current->data);
+        c = SPIF_CONTAINER_COMP_PROBE(self, obj, current->data);
         if (SPIF_CMP_IS_EQUAL(c)) {
             return current->data;
         } else if (SPIF_CMP_IS_LESS(c)) {
@@ -641,12 +635,13 @@ spif_dlinked_list_map_get(spif_dlinked_list_t self, spif_obj_t key)
 
     ASSERT_RVAL(!SPIF_VECTOR_ISNULL(self), (spif_obj_t) NULL);
     REQUIRE_RVAL(!SPIF_OBJ_ISNULL(key), (spif_obj_t) NULL);
+    key = SPIF_CONTAINER_PROBE_KEY(self, key);
     for (current = self->head; current; current = current->next) {
         spif_cmp_t c;
 
         /* current->data is always non-NULL in maps. */
         ASSERT_RVAL(!SPIF_OBJ_ISNULL(current->data), (spif_obj_t) NULL);
-        c = SPIF_OBJ_COMP(current->data, key);
+        c = SPIF_CONTAINER_COMP(self, current->data, key);
         if (SPIF_CMP_IS_EQUAL(c)) {
             return SPIF_OBJPAIR(current->data)->value;
         } else if (SPIF_CMP_IS_GREATER(c)) {
@@ -738,7 +733,8 @@ spif_dlinked_list_index(spif_dlinked_list_t self, spif_obj_t obj)
     spif_dlinked_list_item_t current;
 
     ASSERT_RVAL(!SPIF_LIST_ISNULL(self), (spif_listidx_t) -1);
-    for (current = self->head, i = 0; current && !SPIF_CMP_IS_EQUAL(SPIF_OBJ_COMP(obj, current->data)); i++, current = current->next);
+    obj = SPIF_CONTAINER_PROBE_KEY(self, obj);
+    for (current = self->head, i = 0; current && !SPIF_CMP_IS_EQUAL(SPIF_CONTAINER_COMP_PROBE(self, obj, current->data)); i++, current = current->next);
     return (current ? i : ((spif_listidx_t) (-1)));
 }
 
@@ -746,24 +742,28 @@ static spif_bool_t
 spif_dlinked_list_insert(spif_dlinked_list_t self, spif_obj_t obj)
 {
     spif_dlinked_list_item_t item, current;
+    spif_obj_t key;
 
     ASSERT_RVAL(!SPIF_LIST_ISNULL(self), FALSE);
+    REQUIRE_RVAL(!SPIF_OBJ_ISNULL(obj), FALSE);
+    REQUIRE_RVAL(SPIF_CONTAINER_ACCEPTS(self, obj), FALSE);
     item = spif_dlinked_list_item_new();
     spif_dlinked_list_item_set_data(item, obj);
 
+    key = SPIF_CONTAINER_PROBE_KEY(self, obj);
     if (SPIF_DLINKED_LIST_ITEM_ISNULL(self->head)) {
         self->head = self->tail = item;
-    } else if (SPIF_CMP_IS_LESS(spif_dlinked_list_item_comp(item, self->head))) {
+    } else if (SPIF_CMP_IS_LESS(SPIF_CONTAINER_COMP_PROBE(self, key, self->head->data))) {
         item->next = self->head;
         self->head->prev = item;
         self->head = item;
-    } else if (SPIF_CMP_IS_GREATER(spif_dlinked_list_item_comp(item, self->tail))) {
+    } else if (SPIF_CMP_IS_GREATER(SPIF_CONTAINER_COMP_PROBE(self, key, self->tail->data))) {
         item->prev = self->tail;
         self->tail->next = item;
         self->tail = item;
     } else {
         for (current = self->head;
-             current->next && SPIF_CMP_IS_GREATER(spif_dlinked_list_item_comp(item, current->next));
+             current->next && SPIF_CMP_IS_GREATER(SPIF_CONTAINER_COMP_PROBE(self, key, current->next->data));
              current = current->next);
         item->next = current->next;
         item->prev = current;
@@ -786,6 +786,7 @@ spif_dlinked_list_insert_at(spif_dlinked_list_t self, spif_obj_t obj, spif_listi
         idx += self->len;
     }
     REQUIRE_RVAL((idx + 1) > 0, FALSE);
+    REQUIRE_RVAL(SPIF_CONTAINER_ACCEPTS(self, obj), FALSE);
 
     if (idx == 0 || SPIF_DLINKED_LIST_ITEM_ISNULL(self->head)) {
         return spif_dlinked_list_prepend(self, obj);
@@ -831,6 +832,7 @@ spif_dlinked_list_prepend(spif_dlinked_list_t self, spif_obj_t obj)
     spif_dlinked_list_item_t item, current;
 
     ASSERT_RVAL(!SPIF_LIST_ISNULL(self), FALSE);
+    REQUIRE_RVAL(SPIF_CONTAINER_ACCEPTS(self, obj), FALSE);
     /* Create list member object "item" */
     item = spif_dlinked_list_item_new();
     spif_dlinked_list_item_set_data(item, obj);
@@ -858,7 +860,8 @@ spif_dlinked_list_remove(spif_dlinked_list_t self, spif_obj_t item)
         return (spif_obj_t) NULL;
     }
 
-    for (current = self->head; current && !SPIF_CMP_IS_EQUAL(SPIF_OBJ_COMP(item, current->data)); current = current->next);
+    item = SPIF_CONTAINER_PROBE_KEY(self, item);
+    for (current = self->head; current && !SPIF_CMP_IS_EQUAL(SPIF_CONTAINER_COMP_PROBE(self, item, current->data)); current = current->next);
     if (SPIF_DLINKED_LIST_ITEM_ISNULL(current)) {
         return (spif_obj_t) NULL;
     }
@@ -890,13 +893,14 @@ spif_dlinked_list_map_remove(spif_dlinked_list_t self, spif_obj_t item)
 
     ASSERT_RVAL(!SPIF_LIST_ISNULL(self), (spif_obj_t) NULL);
     REQUIRE_RVAL(!SPIF_OBJ_ISNULL(item), (spif_obj_t) NULL);
+    item = SPIF_CONTAINER_PROBE_KEY(self, item);
     if (SPIF_DLINKED_LIST_ITEM_ISNULL(self->head)) {
         return (spif_obj_t) NULL;
-    } else if (SPIF_CMP_IS_EQUAL(SPIF_OBJ_COMP(self->head->data, item))) {
+    } else if (SPIF_CMP_IS_EQUAL(SPIF_CONTAINER_COMP(self, self->head->data, item))) {
         tmp = self->head;
         self->head = self->head->next;
     } else {
-        for (current = self->head; current->next && !SPIF_CMP_IS_EQUAL(SPIF_OBJ_COMP(current->next->data, item)); current = current->next);
+        for (current = self->head; current->next && !SPIF_CMP_IS_EQUAL(SPIF_CONTAINER_COMP(self, current->next->data, item)); current = current->next);
         if (current->next) {
             tmp = current->next;
             current->next = current->next->next;
@@ -989,7 +993,7 @@ spif_dlinked_list_set(spif_dlinked_list_t self, spif_obj_t key, spif_obj_t value
         key = SPIF_OBJ(SPIF_OBJPAIR(key)->key);
     }
     for (current = self->head; current; current = current->next) {
-        if (SPIF_CMP_IS_EQUAL(SPIF_OBJ_COMP(current->data, key))) {
+        if (SPIF_CMP_IS_EQUAL(SPIF_CONTAINER_COMP(self, current->data, key))) {
             break;
         }
     }
@@ -1003,6 +1007,18 @@ spif_dlinked_list_set(spif_dlinked_list_t self, spif_obj_t key, spif_obj_t value
     }
 }
 
+spif_bool_t
+spif_dlinked_list_set_comparator(spif_dlinked_list_t self, spif_class_t cls, spif_cmp_func_t cmp, spif_key_func_t key)
+{
+    ASSERT_RVAL(!SPIF_LIST_ISNULL(self), FALSE);
+    REQUIRE_RVAL(self->len == 0, FALSE);
+    REQUIRE_RVAL((key == (spif_key_func_t) NULL) || (cls != (spif_class_t) NULL), FALSE);
+    self->elem_class = cls;
+    self->cmp_func = cmp;
+    self->key_func = key;
+    return TRUE;
+}
+
 static spif_obj_t *
 spif_dlinked_list_to_array(spif_dlinked_list_t self)
 {
@@ -1072,30 +1088,20 @@ spif_dlinked_list_iterator_del(spif_dlinked_list_iterator_t self)
 static spif_str_t
 spif_dlinked_list_iterator_show(spif_dlinked_list_iterator_t self, spif_charptr_t name, spif_str_t buff, size_t indent)
 {
-    spif_char_t tmp[4096];
-
     if (SPIF_ITERATOR_ISNULL(self)) {
-        SPIF_OBJ_SHOW_NULL(iterator, name, buff, indent, tmp);
+        SPIF_OBJ_SHOW_NULL_INTO(iterator, name, buff, indent);
         return buff;
     }
 
-    memset(tmp, ' ', indent);
-    snprintf((char *) tmp + indent, sizeof(tmp) - indent,
-             "(spif_dlinked_list_iterator_t) %s:  %10p {\n", name,
-             (spif_ptr_t) self);
-    if (SPIF_STR_ISNULL(buff)) {
-        buff = spif_str_new_from_ptr(tmp);
-    } else {
-        spif_str_append_from_ptr(buff, tmp);
-    }
+    buff = spif_str_show_printf(buff, indent, "(spif_dlinked_list_iterator_t) %s:  %10p {\n", name,
+                                (spif_ptr_t) self);
 
     buff = spif_dlinked_list_show(self->subject, (spif_charptr_t) "subject",
                                   buff, indent + 2);
     buff = spif_dlinked_list_item_show(self->current, (spif_charptr_t) "current",
                                        buff, indent + 2);
 
-    snprintf((char *) tmp + indent, sizeof(tmp) - indent, "}\n");
-    spif_str_append_from_ptr(buff, tmp);
+    buff = spif_str_show_printf(buff, indent, "}\n");
     return buff;
 }
 
@@ -87,3 +87,64 @@ spiftool_temp_file(spif_charptr_t ftemplate, size_t len)
     }
     return (fd);
 }
+
+/**
+ * Read the rest of a file descriptor into memory.
+ *
+ * This function reads everything from the current position of @a fd
+ * to EOF into a single newly-allocated buffer.  For regular files,
+ * the size reported by @c fstat() is used to allocate the buffer once
+ * up front and fill it with as few @c read() calls as possible.  For
+ * pipes, sockets, and files which grow while being read, the buffer
+ * doubles in size as needed.  Interrupted reads are restarted, and a
+ * non-blocking descriptor with no more data ready is treated as EOF.  The
+ * returned buffer is exactly *@a len + @a extra bytes long, so
+ * callers can reserve room for, e.g., a NUL terminator.
+ *
+ * @param fd    The file descriptor to read from.
+ * @param len   Location in which to store the number of bytes read.
+ * @param extra The number of bytes to allocate past the data.
+ * @return      The buffer (to be freed by the caller), or NULL if a
+ *              read error occurred.
+ */
+spif_byteptr_t
+spiftool_read_fd(int fd, size_t *len, size_t extra)
+{
+    struct stat st;
+    spif_byteptr_t buff;
+    size_t size, used = 0;
+    ssize_t n;
+    off_t pos;
+
+    ASSERT_RVAL(fd >= 0, (spif_byteptr_t) NULL);
+    ASSERT_RVAL(!SPIF_PTR_ISNULL(len), (spif_byteptr_t) NULL);
+
+    /* One byte beyond the expected size lets the EOF read succeed
+       without growing the buffer. */
+    size = 65536;
+    if (!fstat(fd, &st) && S_ISREG(st.st_mode) && ((pos = lseek(fd, (off_t) 0, SEEK_CUR)) >= 0)
+        && (st.st_size > pos)) {
+        size = (size_t) (st.st_size - pos) + 1;
+    }
+    buff = (spif_byteptr_t) MALLOC(size + extra);
+    for (;;) {
+        if (used == size) {
+            size *= 2;
+            buff = (spif_byteptr_t) REALLOC(buff, size + extra);
+        }
+        n = read(fd, buff + used, size - used);
+        if (n > 0) {
+            used += n;
+        } else if ((n == 0) || (errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+            break;
+        } else if (errno != EINTR) {
+            FREE(buff);
+            return (spif_byteptr_t) NULL;
+        }
+    }
+    if ((used != size) && (used + extra)) {
+        buff = (spif_byteptr_t) REALLOC(buff, used + extra);
+    }
+    *len = used;
+    return buff;
+}
@@ -0,0 +1,463 @@
+/*
+ * Copyright (C) 1997-2013, Michael Jennings <mej@eterm.org>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies of the Software, its documentation and marketing & publicity
+ * materials, and acknowledgment shall be given in the documentation, materials
+ * and software packages that this Software was used.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <libast_internal.h>
+#include <stddef.h>
+
+/*
+ * A printf() engine that writes straight into the spare room of a
+ * growable buffer.  vsnprintf() can't say how much room it needs
+ * without formatting everything once, so appending with it means
+ * either formatting twice or guessing a size; here each conversion is
+ * sized before it's written, and the buffer is grown (through the
+ * owner's callback) only when it actually runs out.  Integers,
+ * pointers, strings and characters are converted here.  Floating
+ * point conversions, which are rare in this library and hard to get
+ * bit-for-bit right, are passed to snprintf() one at a time.
+ */
+
+/* Length modifiers. */
+#define FMT_LEN_INT            0
+#define FMT_LEN_CHAR           1
+#define FMT_LEN_SHORT          2
+#define FMT_LEN_LONG           3
+#define FMT_LEN_LLONG          4
+#define FMT_LEN_SIZE           5
+#define FMT_LEN_PTRDIFF        6
+#define FMT_LEN_LDOUBLE        7
+
+/* Flags. */
+#define FMT_FLAG_LEFT          (1 << 0)
+#define FMT_FLAG_ZERO          (1 << 1)
+#define FMT_FLAG_PLUS          (1 << 2)
+#define FMT_FLAG_SPACE         (1 << 3)
+#define FMT_FLAG_ALT           (1 << 4)
+
+/* Longest conversion spec handed to snprintf(). */
+#define FMT_SPEC_MAX           64
+
+static const char fmt_digits_lower[] = "0123456789abcdef";
+static const char fmt_digits_upper[] = "0123456789ABCDEF";
+
+/* The output buffer and what's needed to grow it. */
+typedef struct {
+    spif_obj_t owner;
+    spiftool_format_grow_func_t grow;
+    spif_charptr_t buff;
+    spif_stridx_t size, len;
+} fmt_out_t;
+
+/* Make room for cnt more bytes plus a NUL. */
+static spif_charptr_t
+fmt_reserve(fmt_out_t *out, spif_stridx_t cnt)
+{
+    if (out->len + cnt + 1 > out->size) {
+        out->buff = out->grow(out->owner, out->len + cnt + 1, &out->size);
+    }
+    return out->buff + out->len;
+}
+
+static void
+fmt_pad(fmt_out_t *out, int c, spif_stridx_t cnt)
+{
+    if (cnt > 0) {
+        memset(fmt_reserve(out, cnt), c, cnt);
+        out->len += cnt;
+    }
+}
+
+static void
+fmt_put(fmt_out_t *out, const char *s, spif_stridx_t cnt)
+{
+    if (cnt > 0) {
+        memcpy(fmt_reserve(out, cnt), s, cnt);
+        out->len += cnt;
+    }
+}
+
+/* Write s, padded to width, with the precision already applied. */
+static void
+fmt_field(fmt_out_t *out, const char *s, spif_stridx_t cnt, int flags, int width)
+{
+    if (!(flags & FMT_FLAG_LEFT)) {
+        fmt_pad(out, ' ', width - cnt);
+    }
+    fmt_put(out, s, cnt);
+    if (flags & FMT_FLAG_LEFT) {
+        fmt_pad(out, ' ', width - cnt);
+    }
+}
+
+/* Convert an integer whose magnitude is val and sign is neg. */
+static void
+fmt_integer(fmt_out_t *out, unsigned long long val, int neg, int conv, int flags, int width, int prec)
+{
+    char digits[3 * sizeof(val) + 1], prefix[3], *p;
+    const char *set = ((conv == 'X') ? (fmt_digits_upper) : (fmt_digits_lower));
+    unsigned base;
+    int ndigits, nprefix = 0, zeros, pad;
+    spif_bool_t nonzero = (val != 0);
+
+    base = (((conv == 'x') || (conv == 'X') || (conv == 'p')) ? (16) : ((conv == 'o') ? (8) : (10)));
+    p = digits + sizeof(digits);
+    if (base == 10) {
+        for (; val; val /= 10) {
+            *--p = (char) ('0' + (val % 10));
+        }
+    } else {
+        for (; val; val /= base) {
+            *--p = set[val % base];
+        }
+    }
+    ndigits = (int) (digits + sizeof(digits) - p);
+
+    /* Zero with a precision of 0 prints no digits at all. */
+    if (prec < 0) {
+        prec = 1;
+    } else {
+        flags &= ~FMT_FLAG_ZERO;
+    }
+    zeros = MAX(prec - ndigits, 0);
+
+    if (neg) {
+        prefix[nprefix++] = '-';
+    } else if (flags & FMT_FLAG_PLUS) {
+        prefix[nprefix++] = '+';
+    } else if (flags & FMT_FLAG_SPACE) {
+        prefix[nprefix++] = ' ';
+    }
+    if (conv == 'p' || ((flags & FMT_FLAG_ALT) && nonzero && (base == 16))) {
+        prefix[nprefix++] = '0';
+        prefix[nprefix++] = ((conv == 'X') ? ('X') : ('x'));
+    } else if ((flags & FMT_FLAG_ALT) && (base == 8) && !zeros) {
+        zeros = 1;
+    }
+
+    pad = width - nprefix - zeros - ndigits;
+    if ((flags & FMT_FLAG_ZERO) && !(flags & FMT_FLAG_LEFT)) {
+        zeros += MAX(pad, 0);
+        pad = 0;
+    }
+    if (!(flags & FMT_FLAG_LEFT)) {
+        fmt_pad(out, ' ', pad);
+    }
+    fmt_put(out, prefix, nprefix);
+    fmt_pad(out, '0', zeros);
+    fmt_put(out, p, ndigits);
+    if (flags & FMT_FLAG_LEFT) {
+        fmt_pad(out, ' ', pad);
+    }
+}
+
+/* Hand one floating point conversion to snprintf(). */
+static void
+fmt_float(fmt_out_t *out, const char *start, const char *end, int lenmod, int width, int prec, va_list *ap)
+{
+    char spec[FMT_SPEC_MAX], *s = spec;
+    const char *p;
+    spif_stridx_t room;
+    long double ld = 0;
+    double d = 0;
+    int c;
+
+    /* Rebuild the spec with any '*' already resolved. */
+    *s++ = '%';
+    for (p = start; (p < end) && (s < spec + 16); p++) {
+        if (strchr("-+ #0", *p)) {
+            *s++ = *p;
+        } else {
+            break;
+        }
+    }
+    if (width > 0) {
+        s += snprintf(s, spec + sizeof(spec) - s, "%d", width);
+    }
+    if (prec >= 0) {
+        s += snprintf(s, spec + sizeof(spec) - s, ".%d", prec);
+    }
+    if (lenmod == FMT_LEN_LDOUBLE) {
+        *s++ = 'L';
+        ld = va_arg(*ap, long double);
+    } else {
+        d = va_arg(*ap, double);
+    }
+    *s++ = end[-1];
+    *s = 0;
+
+    for (room = out->size - out->len;;) {
+        if (lenmod == FMT_LEN_LDOUBLE) {
+            c = snprintf((char *) out->buff + out->len, room, spec, ld);
+        } else {
+            c = snprintf((char *) out->buff + out->len, room, spec, d);
+        }
+        if ((c < 0) || (c < room)) {
+            break;
+        }
+        fmt_reserve(out, c);
+        room = out->size - out->len;
+    }
+    if (c > 0) {
+        out->len += c;
+    }
+}
+
+/**
+ * Append formatted text to a growable buffer.
+ *
+ * Supports the flags, field widths, precisions and length modifiers
+ * (hh, h, l, ll, j, z, t, L) of C99 printf() with the d, i, u, o, x,
+ * X, c, s, p, e, E, f, F, g, G, a, A and % conversions.  The output is
+ * always NUL-terminated, though the NUL isn't counted in the length.
+ *
+ * @param owner  The object that owns the buffer, passed to @a grow.
+ * @param grow   Called to enlarge the buffer.
+ * @param buff   The buffer (may be NULL if @a size is 0).
+ * @param size   The buffer's current size.
+ * @param len    The number of bytes already in use.
+ * @param format The format string.
+ * @param ap     The arguments.
+ * @return       The new length, or -1 if the format was invalid (in
+ *               which case the text up to the bad conversion is kept).
+ */
+spif_stridx_t
+spiftool_vformat(spif_obj_t owner, spiftool_format_grow_func_t grow, spif_charptr_t buff, spif_stridx_t size,
+                 spif_stridx_t len, const char *format, va_list ap)
+{
+    fmt_out_t out;
+    const char *p, *start, *s;
+    unsigned long long uval;
+    long long sval;
+    int flags, width, prec, lenmod, conv;
+    char c;
+    va_list args;
+
+    ASSERT_RVAL(grow != (spiftool_format_grow_func_t) NULL, -1);
+    REQUIRE_RVAL(format != (const char *) NULL, -1);
+    out.owner = owner;
+    out.grow = grow;
+    out.buff = buff;
+    out.size = size;
+    out.len = len;
+    fmt_reserve(&out, 0);
+    va_copy(args, ap);
+
+    for (p = format; *p;) {
+        /* Copy literal text up to the next conversion in one go. */
+        for (start = p; *p && (*p != '%'); p++);
+        fmt_put(&out, start, p - start);
+        if (!*p) {
+            break;
+        }
+
+        start = ++p;
+        flags = 0;
+        for (;; p++) {
+            if (*p == '-') {
+                flags |= FMT_FLAG_LEFT;
+            } else if (*p == '0') {
+                flags |= FMT_FLAG_ZERO;
+            } else if (*p == '+') {
+                flags |= FMT_FLAG_PLUS;
+            } else if (*p == ' ') {
+                flags |= FMT_FLAG_SPACE;
+            } else if (*p == '#') {
+                flags |= FMT_FLAG_ALT;
+            } else {
+                break;
+            }
+        }
+
+        width = 0;
+        if (*p == '*') {
+            width = va_arg(args, int);
+            if (width < 0) {
+                flags |= FMT_FLAG_LEFT;
+                width = -width;
+            }
+            p++;
+        } else {
+            for (; isdigit((unsigned char) *p); p++) {
+                width = width * 10 + (*p - '0');
+            }
+        }
+
+        prec = -1;
+        if (*p == '.') {
+            p++;
+            if (*p == '*') {
+                prec = va_arg(args, int);
+                LOWER_BOUND(prec, -1);
+                p++;
+            } else {
+                for (prec = 0; isdigit((unsigned char) *p); p++) {
+                    prec = prec * 10 + (*p - '0');
+                }
+            }
+        }
+
+        lenmod = FMT_LEN_INT;
+        switch (*p) {
+            case 'h':
+                if (*++p == 'h') {
+                    lenmod = FMT_LEN_CHAR;
+                    p++;
+                } else {
+                    lenmod = FMT_LEN_SHORT;
+                }
+                break;
+            case 'l':
+                if (*++p == 'l') {
+                    lenmod = FMT_LEN_LLONG;
+                    p++;
+                } else {
+                    lenmod = FMT_LEN_LONG;
+                }
+                break;
+            case 'j':
+                lenmod = FMT_LEN_LLONG;
+                p++;
+                break;
+            case 'z':
+                lenmod = FMT_LEN_SIZE;
+                p++;
+                break;
+            case 't':
+                lenmod = FMT_LEN_PTRDIFF;
+                p++;
+                break;
+            case 'L':
+                lenmod = FMT_LEN_LDOUBLE;
+                p++;
+                break;
+            default:
+                break;
+        }
+
+        conv = *p++;
+        switch (conv) {
+            case 'd':
+            case 'i':
+                switch (lenmod) {
+                    case FMT_LEN_CHAR:
+                        sval = (signed char) va_arg(args, int);
+                        break;
+                    case FMT_LEN_SHORT:
+                        sval = (short) va_arg(args, int);
+                        break;
+                    case FMT_LEN_LONG:
+                        sval = va_arg(args, long);
+                        break;
+                    case FMT_LEN_LLONG:
+                        sval = va_arg(args, long long);
+                        break;
+                    case FMT_LEN_SIZE:
+                        sval = (long long) va_arg(args, size_t);
+                        break;
+                    case FMT_LEN_PTRDIFF:
+                        sval = va_arg(args, ptrdiff_t);
+                        break;
+                    default:
+                        sval = va_arg(args, int);
+                        break;
+                }
+                uval = ((sval < 0) ? (0ULL - (unsigned long long) sval) : ((unsigned long long) sval));
+                fmt_integer(&out, uval, (sval < 0), conv, flags, width, prec);
+                break;
+            case 'u':
+            case 'o':
+            case 'x':
+            case 'X':
+                switch (lenmod) {
+                    case FMT_LEN_CHAR:
+                        uval = (unsigned char) va_arg(args, unsigned);
+                        break;
+                    case FMT_LEN_SHORT:
+                        uval = (unsigned short) va_arg(args, unsigned);
+                        break;
+                    case FMT_LEN_LONG:
+                        uval = va_arg(args, unsigned long);
+                        break;
+                    case FMT_LEN_LLONG:
+                        uval = va_arg(args, unsigned long long);
+                        break;
+                    case FMT_LEN_SIZE:
+                        uval = va_arg(args, size_t);
+                        break;
+                    case FMT_LEN_PTRDIFF:
+                        uval = (unsigned long long) va_arg(args, ptrdiff_t);
+                        break;
+                    default:
+                        uval = va_arg(args, unsigned);
+                        break;
+                }
+                fmt_integer(&out, uval, 0, conv, flags & ~(FMT_FLAG_PLUS | FMT_FLAG_SPACE), width, prec);
+                break;
+            case 'p':
+                uval = (unsigned long long) (size_t) va_arg(args, void *);
+                if (uval) {
+                    fmt_integer(&out, uval, 0, conv, flags, width, -1);
+                } else {
+                    fmt_field(&out, "(nil)", 5, flags, width);
+                }
+                break;
+            case 's':
+                s = va_arg(args, const char *);
+                if (!s) {
+                    s = (((prec < 0) || (prec >= 6)) ? ("(null)") : (""));
+                }
+                fmt_field(&out, s, ((prec < 0) ? ((spif_stridx_t) strlen(s)) : ((spif_stridx_t) strnlen(s, prec))),
+                          flags, width);
+                break;
+            case 'c':
+                c = (char) va_arg(args, int);
+                fmt_field(&out, &c, 1, flags, width);
+                break;
+            case '%':
+                fmt_put(&out, "%", 1);
+                break;
+            case 'e':
+            case 'E':
+            case 'f':
+            case 'F':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A':
+                fmt_float(&out, start, p, lenmod, width, prec, &args);
+                break;
+            default:
+                va_end(args);
+                out.buff[out.len] = 0;
+                return -1;
+        }
+    }
+    va_end(args);
+    out.buff[out.len] = 0;
+    return out.len;
+}
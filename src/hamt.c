@@ -0,0 +1,907 @@
+/*
+ * Copyright (C) 1997-2013, Michael Jennings <mej@eterm.org>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies of the Software, its documentation and marketing & publicity
+ * materials, and acknowledgment shall be given in the documentation, materials
+ * and software packages that this Software was used.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <libast_internal.h>
+
+/* Trie levels needed to use up a 32-bit hash, plus one for collisions. */
+#define HAMT_MAX_DEPTH          ((32 + SPIF_HAMT_BITS - 1) / SPIF_HAMT_BITS + 1)
+#define HAMT_INDEX(h, s)        (((h) >> (s)) & ((1U << SPIF_HAMT_BITS) - 1))
+#define HAMT_NODE_SIZE(n)       (SPIF_SIZEOF_TYPE(hamt_node) + sizeof(spif_hamt_slot_t) * (((n) > 0) ? ((n) - 1) : 0))
+#define HAMT_NODE_ISNULL(n)     ((n) == (spif_hamt_node_t) NULL)
+#define HAMT_LEAF_MATCHES(l, h, k)  (((l)->hash == (h)) && SPIF_CMP_IS_EQUAL(SPIF_OBJ_COMP((l)->pair->key, (k))))
+
+/* Nodes and leaves may be released by any thread holding a snapshot. */
+#ifdef __GNUC__
+# define HAMT_REF(p)            __sync_add_and_fetch(&(p)->refs, 1)
+# define HAMT_UNREF(p)          __sync_sub_and_fetch(&(p)->refs, 1)
+#else
+# define HAMT_REF(p)            (++(p)->refs)
+# define HAMT_UNREF(p)          (--(p)->refs)
+#endif
+
+/* *INDENT-OFF* */
+SPIF_DECL_TYPE(hamt_leaf, SPIF_DECL_OBJ_STRUCT(hamt_leaf));
+
+SPIF_DECL_OBJ_STRUCT(hamt_leaf) {
+    spif_uint32_t refs;
+    spif_uint32_t hash;
+    spif_objpair_t pair;
+};
+
+/* A slot holds either a leaf or a child node, never both. */
+typedef struct spif_hamt_slot_t_struct {
+    spif_hamt_leaf_t leaf;
+    spif_hamt_node_t child;
+} spif_hamt_slot_t;
+
+/* Below the last trie level, nodes are collision buckets:  the bitmap
+   is unused, and every leaf has the same full hash. */
+SPIF_DECL_OBJ_STRUCT(hamt_node) {
+    spif_uint32_t refs;
+    spif_uint32_t bitmap;
+    spif_uint32_t count;
+    spif_hamt_slot_t slots[1];
+};
+
+SPIF_DECL_OBJ(hamt_iterator) {
+    SPIF_DECL_PARENT_TYPE(obj);
+    SPIF_DECL_PROPERTY(hamt, subject);
+    SPIF_DECL_PROPERTY(hamt_node, root);
+    SPIF_DECL_PROPERTY(hamt_leaf, next);
+    spif_int32_t depth;
+    spif_hamt_node_t nodes[HAMT_MAX_DEPTH];
+    spif_uint32_t indices[HAMT_MAX_DEPTH];
+};
+/* *INDENT-ON* */
+
+static spif_hamt_t spif_hamt_new(void);
+static spif_bool_t spif_hamt_init(spif_hamt_t);
+static spif_bool_t spif_hamt_done(spif_hamt_t);
+static spif_bool_t spif_hamt_del(spif_hamt_t);
+static spif_str_t spif_hamt_show(spif_hamt_t, spif_charptr_t, spif_str_t, size_t);
+static spif_cmp_t spif_hamt_comp(spif_hamt_t, spif_hamt_t);
+static spif_hamt_t spif_hamt_dup(spif_hamt_t);
+static spif_classname_t spif_hamt_type(spif_hamt_t);
+static spif_listidx_t spif_hamt_count(spif_hamt_t self);
+static spif_obj_t spif_hamt_get(spif_hamt_t self, spif_obj_t key);
+static spif_list_t spif_hamt_get_keys(spif_hamt_t self, spif_list_t key_list);
+static spif_list_t spif_hamt_get_pairs(spif_hamt_t self, spif_list_t pair_list);
+static spif_list_t spif_hamt_get_values(spif_hamt_t self, spif_list_t value_list);
+static spif_bool_t spif_hamt_has_key(spif_hamt_t self, spif_obj_t key);
+static spif_bool_t spif_hamt_has_value(spif_hamt_t self, spif_obj_t value);
+static spif_iterator_t spif_hamt_iterator(spif_hamt_t self);
+static spif_obj_t spif_hamt_remove(spif_hamt_t self, spif_obj_t key);
+static spif_bool_t spif_hamt_set(spif_hamt_t self, spif_obj_t key, spif_obj_t value);
+
+static spif_uint32_t spif_hamt_popcount(spif_uint32_t);
+static spif_hamt_leaf_t spif_hamt_leaf_new(spif_uint32_t, spif_obj_t, spif_obj_t);
+static void spif_hamt_leaf_release(spif_hamt_leaf_t);
+static void spif_hamt_node_release(spif_hamt_node_t);
+static spif_hamt_node_t spif_hamt_node_edit(spif_hamt_node_t, spif_bool_t, spif_uint32_t);
+static spif_hamt_leaf_t spif_hamt_node_find(spif_hamt_node_t, spif_uint32_t, spif_obj_t);
+static spif_hamt_node_t spif_hamt_node_assoc(spif_hamt_node_t, spif_hamt_leaf_t, spif_uint32_t, spif_bool_t, spif_bool_t *);
+static spif_hamt_node_t spif_hamt_node_dissoc(spif_hamt_node_t, spif_uint32_t, spif_obj_t, spif_uint32_t, spif_bool_t,
+                                              spif_hamt_leaf_t *);
+
+static spif_hamt_iterator_t spif_hamt_iterator_new(spif_hamt_t subject);
+static spif_bool_t spif_hamt_iterator_init(spif_hamt_iterator_t self, spif_hamt_t subject);
+static spif_bool_t spif_hamt_iterator_done(spif_hamt_iterator_t self);
+static spif_bool_t spif_hamt_iterator_del(spif_hamt_iterator_t self);
+static spif_str_t spif_hamt_iterator_show(spif_hamt_iterator_t self, spif_charptr_t name, spif_str_t buff, size_t indent);
+static spif_cmp_t spif_hamt_iterator_comp(spif_hamt_iterator_t self, spif_hamt_iterator_t other);
+static spif_hamt_iterator_t spif_hamt_iterator_dup(spif_hamt_iterator_t self);
+static spif_classname_t spif_hamt_iterator_type(spif_hamt_iterator_t self);
+static spif_bool_t spif_hamt_iterator_has_next(spif_hamt_iterator_t self);
+static spif_obj_t spif_hamt_iterator_next(spif_hamt_iterator_t self);
+static void spif_hamt_iterator_advance(spif_hamt_iterator_t self);
+
+/* *INDENT-OFF* */
+static spif_const_mapclass_t hm_class = {
+    {
+        SPIF_DECL_CLASSNAME(hamt),
+        (spif_func_t) spif_hamt_new,
+        (spif_func_t) spif_hamt_init,
+        (spif_func_t) spif_hamt_done,
+        (spif_func_t) spif_hamt_del,
+        (spif_func_t) spif_hamt_show,
+        (spif_func_t) spif_hamt_comp,
+        (spif_func_t) spif_hamt_dup,
+        (spif_func_t) spif_hamt_type
+    },
+    (spif_func_t) spif_hamt_count,
+    (spif_func_t) spif_hamt_get,
+    (spif_func_t) spif_hamt_get_keys,
+    (spif_func_t) spif_hamt_get_pairs,
+    (spif_func_t) spif_hamt_get_values,
+    (spif_func_t) spif_hamt_has_key,
+    (spif_func_t) spif_hamt_has_value,
+    (spif_func_t) spif_hamt_iterator,
+    (spif_func_t) spif_hamt_remove,
+    (spif_func_t) spif_hamt_set
+};
+spif_mapclass_t SPIF_MAPCLASS_VAR(hamt) = &hm_class;
+
+static spif_const_iteratorclass_t hmi_class = {
+    {
+        SPIF_DECL_CLASSNAME(hamt),
+        (spif_func_t) spif_hamt_iterator_new,
+        (spif_func_t) spif_hamt_iterator_init,
+        (spif_func_t) spif_hamt_iterator_done,
+        (spif_func_t) spif_hamt_iterator_del,
+        (spif_func_t) spif_hamt_iterator_show,
+        (spif_func_t) spif_hamt_iterator_comp,
+        (spif_func_t) spif_hamt_iterator_dup,
+        (spif_func_t) spif_hamt_iterator_type
+    },
+    (spif_func_t) spif_hamt_iterator_has_next,
+    (spif_func_t) spif_hamt_iterator_next
+};
+spif_iteratorclass_t SPIF_ITERATORCLASS_VAR(hamt) = &hmi_class;
+/* *INDENT-ON* */
+
+static spif_uint32_t
+spif_hamt_popcount(spif_uint32_t x)
+{
+#ifdef __GNUC__
+    return (spif_uint32_t) __builtin_popcount(x);
+#else
+    x = x - ((x >> 1) & 0x55555555);
+    x = (x & 0x33333333) + ((x >> 2) & 0x33333333);
+    return (((x + (x >> 4)) & 0x0f0f0f0f) * 0x01010101) >> 24;
+#endif
+}
+
+static spif_hamt_leaf_t
+spif_hamt_leaf_new(spif_uint32_t hash, spif_obj_t key, spif_obj_t value)
+{
+    spif_hamt_leaf_t leaf;
+
+    leaf = (spif_hamt_leaf_t) MALLOC(SPIF_SIZEOF_TYPE(hamt_leaf));
+    leaf->refs = 1;
+    leaf->hash = hash;
+    leaf->pair = spif_objpair_new_from_both(key, value);
+    return leaf;
+}
+
+static void
+spif_hamt_leaf_release(spif_hamt_leaf_t leaf)
+{
+    if (HAMT_UNREF(leaf) == 0) {
+        spif_objpair_del(leaf->pair);
+        FREE(leaf);
+    }
+}
+
+static void
+spif_hamt_node_release(spif_hamt_node_t node)
+{
+    spif_uint32_t i;
+
+    if (HAMT_NODE_ISNULL(node) || HAMT_UNREF(node) != 0) {
+        return;
+    }
+    for (i = 0; i < node->count; i++) {
+        if (HAMT_NODE_ISNULL(node->slots[i].child)) {
+            spif_hamt_leaf_release(node->slots[i].leaf);
+        } else {
+            spif_hamt_node_release(node->slots[i].child);
+        }
+    }
+    FREE(node);
+}
+
+/* Get a node with room for count slots that an edit may change.  An
+   exclusively-owned node is resized in place; anything else is copied,
+   and the copy holds its own references to everything in it. */
+static spif_hamt_node_t
+spif_hamt_node_edit(spif_hamt_node_t node, spif_bool_t exclusive, spif_uint32_t count)
+{
+    spif_hamt_node_t tmp;
+    spif_uint32_t i;
+
+    if (HAMT_NODE_ISNULL(node)) {
+        tmp = (spif_hamt_node_t) MALLOC(HAMT_NODE_SIZE(count));
+        tmp->refs = 1;
+        tmp->bitmap = 0;
+        tmp->count = 0;
+        return tmp;
+    } else if (exclusive) {
+        if (count > node->count) {
+            node = (spif_hamt_node_t) REALLOC(node, HAMT_NODE_SIZE(count));
+        }
+        return node;
+    }
+
+    tmp = (spif_hamt_node_t) MALLOC(HAMT_NODE_SIZE(MAX(count, node->count)));
+    memcpy(tmp, node, HAMT_NODE_SIZE(node->count));
+    tmp->refs = 1;
+    for (i = 0; i < tmp->count; i++) {
+        if (HAMT_NODE_ISNULL(tmp->slots[i].child)) {
+            HAMT_REF(tmp->slots[i].leaf);
+        } else {
+            HAMT_REF(tmp->slots[i].child);
+        }
+    }
+    return tmp;
+}
+
+static spif_hamt_leaf_t
+spif_hamt_node_find(spif_hamt_node_t node, spif_uint32_t hash, spif_obj_t key)
+{
+    spif_uint32_t shift, bit, i;
+
+    for (shift = 0; !HAMT_NODE_ISNULL(node); shift += SPIF_HAMT_BITS) {
+        if (shift >= 32) {
+            for (i = 0; i < node->count; i++) {
+                if (HAMT_LEAF_MATCHES(node->slots[i].leaf, hash, key)) {
+                    return node->slots[i].leaf;
+                }
+            }
+            break;
+        }
+        bit = 1U << HAMT_INDEX(hash, shift);
+        if (!(node->bitmap & bit)) {
+            break;
+        }
+        i = spif_hamt_popcount(node->bitmap & (bit - 1));
+        if (HAMT_NODE_ISNULL(node->slots[i].child)) {
+            return ((HAMT_LEAF_MATCHES(node->slots[i].leaf, hash, key)) ? (node->slots[i].leaf) : ((spif_hamt_leaf_t) NULL));
+        }
+        node = node->slots[i].child;
+    }
+    return (spif_hamt_leaf_t) NULL;
+}
+
+/* Add leaf (whose reference passes to the trie) below node.  Returns
+   the node that takes node's place.  If exclusive and node->refs is 1,
+   node itself was edited and consumed; otherwise node is untouched and
+   the caller's reference to it is still the caller's problem. */
+static spif_hamt_node_t
+spif_hamt_node_assoc(spif_hamt_node_t node, spif_hamt_leaf_t leaf, spif_uint32_t shift, spif_bool_t exclusive,
+                     spif_bool_t *replaced)
+{
+    spif_hamt_node_t tmp, child;
+    spif_uint32_t bit, count, idx;
+    spif_bool_t consumed;
+
+    exclusive = (exclusive && !HAMT_NODE_ISNULL(node) && node->refs == 1);
+    count = ((HAMT_NODE_ISNULL(node)) ? (0) : (node->count));
+
+    if (shift >= 32) {
+        for (idx = 0; idx < count && !HAMT_LEAF_MATCHES(node->slots[idx].leaf, leaf->hash, leaf->pair->key); idx++);
+        if (idx < count) {
+            tmp = spif_hamt_node_edit(node, exclusive, count);
+            spif_hamt_leaf_release(tmp->slots[idx].leaf);
+            tmp->slots[idx].leaf = leaf;
+            *replaced = TRUE;
+        } else {
+            tmp = spif_hamt_node_edit(node, exclusive, count + 1);
+            tmp->slots[count].leaf = leaf;
+            tmp->slots[count].child = (spif_hamt_node_t) NULL;
+            tmp->count++;
+        }
+        return tmp;
+    }
+
+    bit = 1U << HAMT_INDEX(leaf->hash, shift);
+    idx = ((HAMT_NODE_ISNULL(node)) ? (0) : (spif_hamt_popcount(node->bitmap & (bit - 1))));
+    if (HAMT_NODE_ISNULL(node) || !(node->bitmap & bit)) {
+        tmp = spif_hamt_node_edit(node, exclusive, count + 1);
+        memmove(&tmp->slots[idx + 1], &tmp->slots[idx], sizeof(spif_hamt_slot_t) * (count - idx));
+        tmp->slots[idx].leaf = leaf;
+        tmp->slots[idx].child = (spif_hamt_node_t) NULL;
+        tmp->bitmap |= bit;
+        tmp->count++;
+        return tmp;
+    } else if (!HAMT_NODE_ISNULL(node->slots[idx].child)) {
+        consumed = (exclusive && node->slots[idx].child->refs == 1);
+        child = spif_hamt_node_assoc(node->slots[idx].child, leaf, shift + SPIF_HAMT_BITS, exclusive, replaced);
+        tmp = spif_hamt_node_edit(node, exclusive, count);
+        if (!consumed) {
+            spif_hamt_node_release(tmp->slots[idx].child);
+        }
+        tmp->slots[idx].child = child;
+        return tmp;
+    } else if (HAMT_LEAF_MATCHES(node->slots[idx].leaf, leaf->hash, leaf->pair->key)) {
+        tmp = spif_hamt_node_edit(node, exclusive, count);
+        spif_hamt_leaf_release(tmp->slots[idx].leaf);
+        tmp->slots[idx].leaf = leaf;
+        *replaced = TRUE;
+        return tmp;
+    }
+
+    /* Two different keys want the same slot:  push both down a level. */
+    HAMT_REF(node->slots[idx].leaf);
+    child = spif_hamt_node_assoc((spif_hamt_node_t) NULL, node->slots[idx].leaf, shift + SPIF_HAMT_BITS, TRUE, replaced);
+    child = spif_hamt_node_assoc(child, leaf, shift + SPIF_HAMT_BITS, TRUE, replaced);
+    tmp = spif_hamt_node_edit(node, exclusive, count);
+    spif_hamt_leaf_release(tmp->slots[idx].leaf);
+    tmp->slots[idx].leaf = (spif_hamt_leaf_t) NULL;
+    tmp->slots[idx].child = child;
+    return tmp;
+}
+
+/* Remove key from below node.  On success, *removed is the leaf (with a
+   reference held for the caller), and ownership works as for assoc.  If
+   the key isn't there, *removed is NULL and node is returned untouched. */
+static spif_hamt_node_t
+spif_hamt_node_dissoc(spif_hamt_node_t node, spif_uint32_t hash, spif_obj_t key, spif_uint32_t shift,
+                      spif_bool_t exclusive, spif_hamt_leaf_t *removed)
+{
+    spif_hamt_node_t tmp, child;
+    spif_uint32_t bit = 0, idx;
+    spif_bool_t consumed;
+
+    *removed = (spif_hamt_leaf_t) NULL;
+    exclusive = (exclusive && node->refs == 1);
+
+    if (shift >= 32) {
+        for (idx = 0; idx < node->count && !HAMT_LEAF_MATCHES(node->slots[idx].leaf, hash, key); idx++);
+        if (idx == node->count) {
+            return node;
+        }
+    } else {
+        bit = 1U << HAMT_INDEX(hash, shift);
+        if (!(node->bitmap & bit)) {
+            return node;
+        }
+        idx = spif_hamt_popcount(node->bitmap & (bit - 1));
+        if (!HAMT_NODE_ISNULL(node->slots[idx].child)) {
+            consumed = (exclusive && node->slots[idx].child->refs == 1);
+            child = spif_hamt_node_dissoc(node->slots[idx].child, hash, key, shift + SPIF_HAMT_BITS, exclusive, removed);
+            if (!*removed) {
+                return node;
+            }
+            tmp = spif_hamt_node_edit(node, exclusive, node->count);
+            if (!consumed) {
+                spif_hamt_node_release(tmp->slots[idx].child);
+            }
+            if (child->count == 1 && HAMT_NODE_ISNULL(child->slots[0].child)) {
+                /* Pull a lone leaf up in place of its node. */
+                tmp->slots[idx].leaf = child->slots[0].leaf;
+                tmp->slots[idx].child = (spif_hamt_node_t) NULL;
+                HAMT_REF(tmp->slots[idx].leaf);
+                spif_hamt_node_release(child);
+            } else if (child->count == 0) {
+                spif_hamt_node_release(child);
+                memmove(&tmp->slots[idx], &tmp->slots[idx + 1], sizeof(spif_hamt_slot_t) * (tmp->count - idx - 1));
+                tmp->bitmap &= ~bit;
+                tmp->count--;
+            } else {
+                tmp->slots[idx].child = child;
+            }
+            return tmp;
+        } else if (!HAMT_LEAF_MATCHES(node->slots[idx].leaf, hash, key)) {
+            return node;
+        }
+    }
+
+    *removed = node->slots[idx].leaf;
+    HAMT_REF(*removed);
+    tmp = spif_hamt_node_edit(node, exclusive, node->count);
+    spif_hamt_leaf_release(tmp->slots[idx].leaf);
+    memmove(&tmp->slots[idx], &tmp->slots[idx + 1], sizeof(spif_hamt_slot_t) * (tmp->count - idx - 1));
+    tmp->bitmap &= ~bit;
+    tmp->count--;
+    return tmp;
+}
+
+spif_uint32_t
+spif_hamt_hash_default(spif_obj_t key)
+{
+    ASSERT_RVAL(!SPIF_OBJ_ISNULL(key), 0);
+    if (SPIF_OBJ_IS_ATOM(key)) {
+        /* Same hash as a str with the same bytes, already computed. */
+        return SPIF_ATOM_HASH(key);
+    }
+    /* There is no way to hash an arbitrary object by value. */
+    REQUIRE_RVAL(SPIF_OBJ_IS_STR(key), 0);
+    return spif_str_hash(SPIF_STR(key));
+}
+
+static spif_hamt_t
+spif_hamt_new(void)
+{
+    spif_hamt_t self;
+
+    self = SPIF_ALLOC(hamt);
+    if (!spif_hamt_init(self)) {
+        SPIF_DEALLOC(self);
+        self = (spif_hamt_t) NULL;
+    }
+    return self;
+}
+
+spif_hamt_t
+spif_hamt_new_with_hash(spif_hamt_hash_func_t hash_func)
+{
+    spif_hamt_t self;
+
+    self = SPIF_ALLOC(hamt);
+    if (!spif_hamt_init_with_hash(self, hash_func)) {
+        SPIF_DEALLOC(self);
+        self = (spif_hamt_t) NULL;
+    }
+    return self;
+}
+
+static spif_bool_t
+spif_hamt_init(spif_hamt_t self)
+{
+    return spif_hamt_init_with_hash(self, spif_hamt_hash_default);
+}
+
+spif_bool_t
+spif_hamt_init_with_hash(spif_hamt_t self, spif_hamt_hash_func_t hash_func)
+{
+    ASSERT_RVAL(!SPIF_HAMT_ISNULL(self), FALSE);
+    /* ***NOT NEEDED*** spif_obj_init(SPIF_OBJ(self)); */
+    spif_obj_set_class(SPIF_OBJ(self), SPIF_CLASS(SPIF_MAPCLASS_VAR(hamt)));
+    self->len = 0;
+    self->root = (spif_hamt_node_t) NULL;
+    self->hash_func = ((hash_func) ? (hash_func) : (spif_hamt_hash_default));
+    self->transient = FALSE;
+    return TRUE;
+}
+
+static spif_bool_t
+spif_hamt_done(spif_hamt_t self)
+{
+    ASSERT_RVAL(!SPIF_HAMT_ISNULL(self), FALSE);
+    spif_hamt_node_release(self->root);
+    self->root = (spif_hamt_node_t) NULL;
+    self->len = 0;
+    self->transient = FALSE;
+    return TRUE;
+}
+
+static spif_bool_t
+spif_hamt_del(spif_hamt_t self)
+{
+    ASSERT_RVAL(!SPIF_HAMT_ISNULL(self), FALSE);
+    spif_hamt_done(self);
+    SPIF_DEALLOC(self);
+    return TRUE;
+}
+
+static spif_str_t
+spif_hamt_show(spif_hamt_t self, spif_charptr_t name, spif_str_t buff, size_t indent)
+{
+    spif_char_t tmp[4096];
+    spif_hamt_iterator_t it;
+    spif_listidx_t i;
+
+    if (SPIF_HAMT_ISNULL(self)) {
+        SPIF_OBJ_SHOW_NULL_INTO(hamt, name, buff, indent);
+        return buff;
+    }
+
+    buff = spif_str_show_printf(buff, indent, "(spif_hamt_t) %s:  %10p (%d pairs%s) {\n", name, (spif_ptr_t) self, (int) self->len,
+                                ((self->transient) ? ", transient" : ""));
+
+    it = spif_hamt_iterator_new(self);
+    for (i = 0; spif_hamt_iterator_has_next(it); i++) {
+        spif_obj_t pair = spif_hamt_iterator_next(it);
+
+        sprintf((char *) tmp, "item %d", i);
+        buff = SPIF_OBJ_CALL_METHOD(pair, show)(pair, tmp, buff, indent + 2);
+    }
+    spif_hamt_iterator_del(it);
+
+    buff = spif_str_show_printf(buff, indent, "}\n");
+    return buff;
+}
+
+static spif_cmp_t
+spif_hamt_comp(spif_hamt_t self, spif_hamt_t other)
+{
+    SPIF_OBJ_COMP_CHECK_NULL(self, other);
+    return (spif_obj_comp(SPIF_OBJ(self), SPIF_OBJ(other)));
+}
+
+static spif_hamt_t
+spif_hamt_dup(spif_hamt_t self)
+{
+    spif_hamt_t tmp;
+
+    /* Snapshots share the whole trie; nobody edits a shared node. */
+    ASSERT_RVAL(!SPIF_HAMT_ISNULL(self), (spif_hamt_t) NULL);
+    tmp = spif_hamt_new_with_hash(self->hash_func);
+    tmp->root = self->root;
+    if (!HAMT_NODE_ISNULL(tmp->root)) {
+        HAMT_REF(tmp->root);
+    }
+    tmp->len = self->len;
+    return tmp;
+}
+
+static spif_classname_t
+spif_hamt_type(spif_hamt_t self)
+{
+    ASSERT_RVAL(!SPIF_HAMT_ISNULL(self), (spif_classname_t) NULL);
+    return SPIF_OBJ_CLASSNAME(self);
+}
+
+static spif_listidx_t
+spif_hamt_count(spif_hamt_t self)
+{
+    ASSERT_RVAL(!SPIF_HAMT_ISNULL(self), 0);
+    return self->len;
+}
+
+static spif_obj_t
+spif_hamt_get(spif_hamt_t self, spif_obj_t key)
+{
+    spif_hamt_leaf_t leaf;
+
+    ASSERT_RVAL(!SPIF_HAMT_ISNULL(self), (spif_obj_t) NULL);
+    REQUIRE_RVAL(!SPIF_OBJ_ISNULL(key), (spif_obj_t) NULL);
+    REQUIRE_RVAL(SPIF_HAMT_CAN_HASH(self->hash_func, key), (spif_obj_t) NULL);
+    leaf = spif_hamt_node_find(self->root, self->hash_func(key), key);
+    return ((leaf) ? (leaf->pair->value) : ((spif_obj_t) NULL));
+}
+
+static spif_list_t
+spif_hamt_get_keys(spif_hamt_t self, spif_list_t key_list)
+{
+    spif_hamt_iterator_t it;
+
+    ASSERT_RVAL(!SPIF_HAMT_ISNULL(self), (spif_list_t) NULL);
+    if (SPIF_LIST_ISNULL(key_list)) {
+        key_list = SPIF_LIST_NEW(linked_list);
+    }
+    for (it = spif_hamt_iterator_new(self); spif_hamt_iterator_has_next(it); ) {
+        spif_objpair_t pair = SPIF_OBJPAIR(spif_hamt_iterator_next(it));
+
+        SPIF_LIST_APPEND(key_list, SPIF_OBJ_DUP(pair->key));
+    }
+    spif_hamt_iterator_del(it);
+    return key_list;
+}
+
+static spif_list_t
+spif_hamt_get_pairs(spif_hamt_t self, spif_list_t pair_list)
+{
+    spif_hamt_iterator_t it;
+
+    ASSERT_RVAL(!SPIF_HAMT_ISNULL(self), (spif_list_t) NULL);
+    if (SPIF_LIST_ISNULL(pair_list)) {
+        pair_list = SPIF_LIST_NEW(linked_list);
+    }
+    for (it = spif_hamt_iterator_new(self); spif_hamt_iterator_has_next(it); ) {
+        spif_obj_t pair = spif_hamt_iterator_next(it);
+
+        SPIF_LIST_APPEND(pair_list, SPIF_OBJ_DUP(pair));
+    }
+    spif_hamt_iterator_del(it);
+    return pair_list;
+}
+
+static spif_list_t
+spif_hamt_get_values(spif_hamt_t self, spif_list_t value_list)
+{
+    spif_hamt_iterator_t it;
+
+    ASSERT_RVAL(!SPIF_HAMT_ISNULL(self), (spif_list_t) NULL);
+    if (SPIF_LIST_ISNULL(value_list)) {
+        value_list = SPIF_LIST_NEW(linked_list);
+    }
+    for (it = spif_hamt_iterator_new(self); spif_hamt_iterator_has_next(it); ) {
+        spif_objpair_t pair = SPIF_OBJPAIR(spif_hamt_iterator_next(it));
+
+        SPIF_LIST_APPEND(value_list, SPIF_OBJ_DUP(pair->value));
+    }
+    spif_hamt_iterator_del(it);
+    return value_list;
+}
+
+static spif_bool_t
+spif_hamt_has_key(spif_hamt_t self, spif_obj_t key)
+{
+    ASSERT_RVAL(!SPIF_HAMT_ISNULL(self), FALSE);
+    REQUIRE_RVAL(!SPIF_OBJ_ISNULL(key), FALSE);
+    REQUIRE_RVAL(SPIF_HAMT_CAN_HASH(self->hash_func, key), FALSE);
+    return ((spif_hamt_node_find(self->root, self->hash_func(key), key)) ? (TRUE) : (FALSE));
+}
+
+static spif_bool_t
+spif_hamt_has_value(spif_hamt_t self, spif_obj_t value)
+{
+    spif_hamt_iterator_t it;
+    spif_bool_t found = FALSE;
+
+    ASSERT_RVAL(!SPIF_HAMT_ISNULL(self), FALSE);
+    for (it = spif_hamt_iterator_new(self); !found && spif_hamt_iterator_has_next(it); ) {
+        spif_objpair_t pair = SPIF_OBJPAIR(spif_hamt_iterator_next(it));
+
+        if (SPIF_OBJ_ISNULL(value) && SPIF_OBJ_ISNULL(pair->value)) {
+            found = TRUE;
+        } else if (!SPIF_OBJ_ISNULL(pair->value) && SPIF_CMP_IS_EQUAL(SPIF_OBJ_COMP(pair->value, value))) {
+            found = TRUE;
+        }
+    }
+    spif_hamt_iterator_del(it);
+    return found;
+}
+
+static spif_iterator_t
+spif_hamt_iterator(spif_hamt_t self)
+{
+    ASSERT_RVAL(!SPIF_HAMT_ISNULL(self), (spif_iterator_t) NULL);
+    return (spif_iterator_t) spif_hamt_iterator_new(self);
+}
+
+static spif_obj_t
+spif_hamt_remove(spif_hamt_t self, spif_obj_t key)
+{
+    spif_hamt_node_t root;
+    spif_hamt_leaf_t leaf;
+    spif_bool_t consumed;
+    spif_obj_t pair;
+
+    ASSERT_RVAL(!SPIF_HAMT_ISNULL(self), (spif_obj_t) NULL);
+    REQUIRE_RVAL(!SPIF_OBJ_ISNULL(key), (spif_obj_t) NULL);
+    REQUIRE_RVAL(SPIF_HAMT_CAN_HASH(self->hash_func, key), (spif_obj_t) NULL);
+    if (HAMT_NODE_ISNULL(self->root)) {
+        return (spif_obj_t) NULL;
+    }
+
+    consumed = (self->transient && self->root->refs == 1);
+    root = spif_hamt_node_dissoc(self->root, self->hash_func(key), key, 0, self->transient, &leaf);
+    if (!leaf) {
+        return (spif_obj_t) NULL;
+    }
+    if (!consumed) {
+        spif_hamt_node_release(self->root);
+    }
+    if (root->count == 0) {
+        spif_hamt_node_release(root);
+        root = (spif_hamt_node_t) NULL;
+    }
+    self->root = root;
+    self->len--;
+
+    /* The leaf's pair may still be shared with a snapshot. */
+    pair = SPIF_OBJ_DUP(leaf->pair);
+    spif_hamt_leaf_release(leaf);
+    return pair;
+}
+
+static spif_bool_t
+spif_hamt_set(spif_hamt_t self, spif_obj_t key, spif_obj_t value)
+{
+    spif_hamt_node_t root;
+    spif_bool_t consumed, replaced = FALSE;
+
+    ASSERT_RVAL(!SPIF_HAMT_ISNULL(self), FALSE);
+    REQUIRE_RVAL(!SPIF_OBJ_ISNULL(key), FALSE);
+
+    if (SPIF_OBJ_IS_OBJPAIR(key) && SPIF_OBJ_ISNULL(value)) {
+        value = SPIF_OBJ(SPIF_OBJPAIR(key)->value);
+        key = SPIF_OBJ(SPIF_OBJPAIR(key)->key);
+    }
+    REQUIRE_RVAL(!SPIF_OBJ_ISNULL(value), FALSE);
+    REQUIRE_RVAL(SPIF_HAMT_CAN_HASH(self->hash_func, key), FALSE);
+
+    consumed = (self->transient && !HAMT_NODE_ISNULL(self->root) && self->root->refs == 1);
+    root = spif_hamt_node_assoc(self->root, spif_hamt_leaf_new(self->hash_func(key), key, value), 0,
+                                self->transient, &replaced);
+    if (!consumed) {
+        spif_hamt_node_release(self->root);
+    }
+    self->root = root;
+    if (!replaced) {
+        self->len++;
+    }
+    return replaced;
+}
+
+spif_hamt_t
+spif_hamt_with(spif_hamt_t self, spif_obj_t key, spif_obj_t value)
+{
+    spif_hamt_t tmp;
+
+    ASSERT_RVAL(!SPIF_HAMT_ISNULL(self), (spif_hamt_t) NULL);
+    tmp = spif_hamt_dup(self);
+    spif_hamt_set(tmp, key, value);
+    return tmp;
+}
+
+spif_hamt_t
+spif_hamt_without(spif_hamt_t self, spif_obj_t key)
+{
+    spif_hamt_t tmp;
+    spif_obj_t pair;
+
+    ASSERT_RVAL(!SPIF_HAMT_ISNULL(self), (spif_hamt_t) NULL);
+    tmp = spif_hamt_dup(self);
+    pair = spif_hamt_remove(tmp, key);
+    if (!SPIF_OBJ_ISNULL(pair)) {
+        SPIF_OBJ_DEL(pair);
+    }
+    return tmp;
+}
+
+spif_bool_t
+spif_hamt_transient(spif_hamt_t self)
+{
+    ASSERT_RVAL(!SPIF_HAMT_ISNULL(self), FALSE);
+    self->transient = TRUE;
+    return TRUE;
+}
+
+spif_bool_t
+spif_hamt_persistent(spif_hamt_t self)
+{
+    ASSERT_RVAL(!SPIF_HAMT_ISNULL(self), FALSE);
+    self->transient = FALSE;
+    return TRUE;
+}
+
+
+static spif_hamt_iterator_t
+spif_hamt_iterator_new(spif_hamt_t subject)
+{
+    spif_hamt_iterator_t self;
+
+    self = SPIF_ALLOC(hamt_iterator);
+    if (!spif_hamt_iterator_init(self, subject)) {
+        SPIF_DEALLOC(self);
+        self = (spif_hamt_iterator_t) NULL;
+    }
+    return self;
+}
+
+static spif_bool_t
+spif_hamt_iterator_init(spif_hamt_iterator_t self, spif_hamt_t subject)
+{
+    ASSERT_RVAL(!SPIF_ITERATOR_ISNULL(self), FALSE);
+    /* ***NOT NEEDED*** spif_obj_init(SPIF_OBJ(self)); */
+    spif_obj_set_class(SPIF_OBJ(self), SPIF_CLASS(SPIF_ITERATORCLASS_VAR(hamt)));
+    self->subject = subject;
+    /* Hold on to the trie as it is now, so the iteration isn't
+       disturbed by later changes to the subject. */
+    self->root = ((SPIF_HAMT_ISNULL(subject)) ? ((spif_hamt_node_t) NULL) : (subject->root));
+    self->next = (spif_hamt_leaf_t) NULL;
+    self->depth = -1;
+    if (!HAMT_NODE_ISNULL(self->root)) {
+        HAMT_REF(self->root);
+        self->depth = 0;
+        self->nodes[0] = self->root;
+        self->indices[0] = 0;
+        spif_hamt_iterator_advance(self);
+    }
+    return TRUE;
+}
+
+static spif_bool_t
+spif_hamt_iterator_done(spif_hamt_iterator_t self)
+{
+    ASSERT_RVAL(!SPIF_ITERATOR_ISNULL(self), FALSE);
+    spif_hamt_node_release(self->root);
+    self->subject = (spif_hamt_t) NULL;
+    self->root = (spif_hamt_node_t) NULL;
+    self->next = (spif_hamt_leaf_t) NULL;
+    self->depth = -1;
+    return TRUE;
+}
+
+static spif_bool_t
+spif_hamt_iterator_del(spif_hamt_iterator_t self)
+{
+    ASSERT_RVAL(!SPIF_ITERATOR_ISNULL(self), FALSE);
+    spif_hamt_iterator_done(self);
+    SPIF_DEALLOC(self);
+    return TRUE;
+}
+
+static spif_str_t
+spif_hamt_iterator_show(spif_hamt_iterator_t self, spif_charptr_t name, spif_str_t buff, size_t indent)
+{
+    if (SPIF_ITERATOR_ISNULL(self)) {
+        SPIF_OBJ_SHOW_NULL_INTO(iterator, name, buff, indent);
+        return buff;
+    }
+
+    buff = spif_str_show_printf(buff, indent, "(spif_hamt_iterator_t) %s:  %10p {\n", name,
+                                (spif_ptr_t) self);
+
+    buff = spif_hamt_show(self->subject, (spif_charptr_t) "subject", buff, indent + 2);
+    buff = spif_str_show_printf(buff, indent + 2, "(spif_int32_t) depth:  %d\n", (int) self->depth);
+
+    buff = spif_str_show_printf(buff, indent, "}\n");
+    return buff;
+}
+
+static spif_cmp_t
+spif_hamt_iterator_comp(spif_hamt_iterator_t self, spif_hamt_iterator_t other)
+{
+    return spif_hamt_comp(self->subject, other->subject);
+}
+
+static spif_hamt_iterator_t
+spif_hamt_iterator_dup(spif_hamt_iterator_t self)
+{
+    spif_hamt_iterator_t tmp;
+
+    ASSERT_RVAL(!SPIF_ITERATOR_ISNULL(self), (spif_hamt_iterator_t) NULL);
+    tmp = SPIF_ALLOC(hamt_iterator);
+    memcpy(tmp, self, SPIF_SIZEOF_TYPE(hamt_iterator));
+    if (!HAMT_NODE_ISNULL(tmp->root)) {
+        HAMT_REF(tmp->root);
+    }
+    return tmp;
+}
+
+static spif_classname_t
+spif_hamt_iterator_type(spif_hamt_iterator_t self)
+{
+    ASSERT_RVAL(!SPIF_ITERATOR_ISNULL(self), (spif_classname_t) NULL);
+    return SPIF_OBJ_CLASSNAME(self);
+}
+
+static void
+spif_hamt_iterator_advance(spif_hamt_iterator_t self)
+{
+    self->next = (spif_hamt_leaf_t) NULL;
+    while (self->depth >= 0) {
+        spif_hamt_node_t node = self->nodes[self->depth];
+        spif_uint32_t i = self->indices[self->depth];
+
+        if (i >= node->count) {
+            self->depth--;
+            continue;
+        }
+        self->indices[self->depth]++;
+        if (HAMT_NODE_ISNULL(node->slots[i].child)) {
+            self->next = node->slots[i].leaf;
+            return;
+        }
+        self->depth++;
+        self->nodes[self->depth] = node->slots[i].child;
+        self->indices[self->depth] = 0;
+    }
+}
+
+static spif_bool_t
+spif_hamt_iterator_has_next(spif_hamt_iterator_t self)
+{
+    ASSERT_RVAL(!SPIF_ITERATOR_ISNULL(self), FALSE);
+    return ((self->next) ? (TRUE) : (FALSE));
+}
+
+static spif_obj_t
+spif_hamt_iterator_next(spif_hamt_iterator_t self)
+{
+    spif_obj_t tmp;
+
+    ASSERT_RVAL(!SPIF_ITERATOR_ISNULL(self), (spif_obj_t) NULL);
+    REQUIRE_RVAL(self->next, (spif_obj_t) NULL);
+    tmp = SPIF_OBJ(self->next->pair);
+    spif_hamt_iterator_advance(self);
+    return tmp;
+}
@@ -0,0 +1,640 @@
+/*
+ * Copyright (C) 1997-2013, Michael Jennings <mej@eterm.org>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies of the Software, its documentation and marketing & publicity
+ * materials, and acknowledgment shall be given in the documentation, materials
+ * and software packages that this Software was used.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <libast_internal.h>
+
+/* *INDENT-OFF* */
+SPIF_DECL_OBJ(ilist_iterator) {
+    SPIF_DECL_PARENT_TYPE(obj);
+    SPIF_DECL_PROPERTY(ilist, subject);
+    SPIF_DECL_PROPERTY(ilist_link, current);
+};
+/* *INDENT-ON* */
+
+static spif_ilist_t spif_ilist_new(void);
+static spif_bool_t spif_ilist_init(spif_ilist_t);
+static spif_bool_t spif_ilist_done(spif_ilist_t);
+static spif_bool_t spif_ilist_del(spif_ilist_t);
+static spif_str_t spif_ilist_show(spif_ilist_t, spif_charptr_t, spif_str_t, size_t);
+static spif_cmp_t spif_ilist_comp(spif_ilist_t, spif_ilist_t);
+static spif_ilist_t spif_ilist_dup(spif_ilist_t);
+static spif_classname_t spif_ilist_type(spif_ilist_t);
+static spif_bool_t spif_ilist_append(spif_ilist_t self, spif_obj_t obj);
+static spif_bool_t spif_ilist_contains(spif_ilist_t self, spif_obj_t obj);
+static spif_listidx_t spif_ilist_count(spif_ilist_t self);
+static spif_obj_t spif_ilist_find(spif_ilist_t self, spif_obj_t obj);
+static spif_obj_t spif_ilist_get(spif_ilist_t self, spif_listidx_t idx);
+static spif_listidx_t spif_ilist_index(spif_ilist_t self, spif_obj_t obj);
+static spif_bool_t spif_ilist_insert(spif_ilist_t self, spif_obj_t obj);
+static spif_bool_t spif_ilist_insert_at(spif_ilist_t self, spif_obj_t obj, spif_listidx_t idx);
+static spif_iterator_t spif_ilist_iterator(spif_ilist_t self);
+static spif_bool_t spif_ilist_prepend(spif_ilist_t self, spif_obj_t obj);
+static spif_obj_t spif_ilist_remove(spif_ilist_t self, spif_obj_t item);
+static spif_obj_t spif_ilist_remove_at(spif_ilist_t self, spif_listidx_t idx);
+static spif_bool_t spif_ilist_reverse(spif_ilist_t self);
+static spif_obj_t * spif_ilist_to_array(spif_ilist_t self);
+static spif_bool_t spif_ilist_link_before(spif_ilist_t self, spif_ilist_link_t link, spif_ilist_link_t before);
+static spif_ilist_link_t spif_ilist_link_at(spif_ilist_t self, spif_listidx_t idx);
+
+static spif_ilist_iterator_t spif_ilist_iterator_new(spif_ilist_t subject);
+static spif_bool_t spif_ilist_iterator_init(spif_ilist_iterator_t self, spif_ilist_t subject);
+static spif_bool_t spif_ilist_iterator_done(spif_ilist_iterator_t self);
+static spif_bool_t spif_ilist_iterator_del(spif_ilist_iterator_t self);
+static spif_str_t spif_ilist_iterator_show(spif_ilist_iterator_t self, spif_charptr_t name, spif_str_t buff, size_t indent);
+static spif_cmp_t spif_ilist_iterator_comp(spif_ilist_iterator_t self, spif_ilist_iterator_t other);
+static spif_ilist_iterator_t spif_ilist_iterator_dup(spif_ilist_iterator_t self);
+static spif_classname_t spif_ilist_iterator_type(spif_ilist_iterator_t self);
+static spif_bool_t spif_ilist_iterator_has_next(spif_ilist_iterator_t self);
+static spif_obj_t spif_ilist_iterator_next(spif_ilist_iterator_t self);
+
+/* *INDENT-OFF* */
+static spif_const_listclass_t il_class = {
+    {
+        SPIF_DECL_CLASSNAME(ilist),
+        (spif_func_t) spif_ilist_new,
+        (spif_func_t) spif_ilist_init,
+        (spif_func_t) spif_ilist_done,
+        (spif_func_t) spif_ilist_del,
+        (spif_func_t) spif_ilist_show,
+        (spif_func_t) spif_ilist_comp,
+        (spif_func_t) spif_ilist_dup,
+        (spif_func_t) spif_ilist_type
+    },
+    (spif_func_t) spif_ilist_append,
+    (spif_func_t) spif_ilist_contains,
+    (spif_func_t) spif_ilist_count,
+    (spif_func_t) spif_ilist_find,
+    (spif_func_t) spif_ilist_get,
+    (spif_func_t) spif_ilist_index,
+    (spif_func_t) spif_ilist_insert,
+    (spif_func_t) spif_ilist_insert_at,
+    (spif_func_t) spif_ilist_iterator,
+    (spif_func_t) spif_ilist_prepend,
+    (spif_func_t) spif_ilist_remove,
+    (spif_func_t) spif_ilist_remove_at,
+    (spif_func_t) spif_ilist_reverse,
+    (spif_func_t) spif_ilist_to_array
+};
+spif_listclass_t SPIF_LISTCLASS_VAR(ilist) = &il_class;
+
+static spif_const_iteratorclass_t ili_class = {
+    {
+        SPIF_DECL_CLASSNAME(ilist),
+        (spif_func_t) spif_ilist_iterator_new,
+        (spif_func_t) spif_ilist_iterator_init,
+        (spif_func_t) spif_ilist_iterator_done,
+        (spif_func_t) spif_ilist_iterator_del,
+        (spif_func_t) spif_ilist_iterator_show,
+        (spif_func_t) spif_ilist_iterator_comp,
+        (spif_func_t) spif_ilist_iterator_dup,
+        (spif_func_t) spif_ilist_iterator_type
+    },
+    (spif_func_t) spif_ilist_iterator_has_next,
+    (spif_func_t) spif_ilist_iterator_next
+};
+spif_iteratorclass_t SPIF_ITERATORCLASS_VAR(ilist) = &ili_class;
+/* *INDENT-ON* */
+
+spif_bool_t
+spif_ilist_link_init(spif_ilist_link_t link)
+{
+    ASSERT_RVAL(!SPIF_ILIST_LINK_ISNULL(link), FALSE);
+    link->prev = (spif_ilist_link_t) NULL;
+    link->next = (spif_ilist_link_t) NULL;
+    link->list = (spif_ilist_t) NULL;
+    return TRUE;
+}
+
+/* Remove a link from whatever list it's on in constant time.  Returns
+   the element that contains the link, or NULL if it wasn't linked. */
+spif_obj_t
+spif_ilist_unlink(spif_ilist_link_t link)
+{
+    spif_ilist_t list;
+
+    ASSERT_RVAL(!SPIF_ILIST_LINK_ISNULL(link), (spif_obj_t) NULL);
+    list = link->list;
+    REQUIRE_RVAL(!SPIF_ILIST_ISNULL(list), (spif_obj_t) NULL);
+
+    if (SPIF_ILIST_LINK_ISNULL(link->prev)) {
+        list->head = link->next;
+    } else {
+        link->prev->next = link->next;
+    }
+    if (SPIF_ILIST_LINK_ISNULL(link->next)) {
+        list->tail = link->prev;
+    } else {
+        link->next->prev = link->prev;
+    }
+    list->len--;
+    spif_ilist_link_init(link);
+    return SPIF_ILIST_OBJ_OF(list, link);
+}
+
+static spif_ilist_t
+spif_ilist_new(void)
+{
+    spif_ilist_t self;
+
+    self = SPIF_ALLOC(ilist);
+    if (!spif_ilist_init(self)) {
+        SPIF_DEALLOC(self);
+        self = (spif_ilist_t) NULL;
+    }
+    return self;
+}
+
+spif_ilist_t
+spif_ilist_new_from_offset(size_t offset)
+{
+    spif_ilist_t self;
+
+    self = SPIF_ALLOC(ilist);
+    if (!spif_ilist_init_from_offset(self, offset)) {
+        SPIF_DEALLOC(self);
+        self = (spif_ilist_t) NULL;
+    }
+    return self;
+}
+
+static spif_bool_t
+spif_ilist_init(spif_ilist_t self)
+{
+    ASSERT_RVAL(!SPIF_ILIST_ISNULL(self), FALSE);
+    /* ***NOT NEEDED*** spif_obj_init(SPIF_OBJ(self)); */
+    spif_obj_set_class(SPIF_OBJ(self), SPIF_CLASS(SPIF_LISTCLASS_VAR(ilist)));
+    self->len = 0;
+    self->offset = 0;
+    self->head = (spif_ilist_link_t) NULL;
+    self->tail = (spif_ilist_link_t) NULL;
+    self->elem_class = (spif_class_t) NULL;
+    self->cmp_func = (spif_cmp_func_t) NULL;
+    self->key_func = (spif_key_func_t) NULL;
+    return TRUE;
+}
+
+spif_bool_t
+spif_ilist_init_from_offset(spif_ilist_t self, size_t offset)
+{
+    ASSERT_RVAL(!SPIF_ILIST_ISNULL(self), FALSE);
+    /* The link can't overlap the object header. */
+    REQUIRE_RVAL(offset >= SPIF_SIZEOF_TYPE(obj), FALSE);
+    spif_ilist_init(self);
+    self->offset = offset;
+    return TRUE;
+}
+
+static spif_bool_t
+spif_ilist_done(spif_ilist_t self)
+{
+    ASSERT_RVAL(!SPIF_ILIST_ISNULL(self), FALSE);
+    /* The list doesn't own its elements; just cut them loose. */
+    while (!SPIF_ILIST_LINK_ISNULL(self->head)) {
+        spif_ilist_unlink(self->head);
+    }
+    return TRUE;
+}
+
+static spif_bool_t
+spif_ilist_del(spif_ilist_t self)
+{
+    ASSERT_RVAL(!SPIF_ILIST_ISNULL(self), FALSE);
+    spif_ilist_done(self);
+    SPIF_DEALLOC(self);
+    return TRUE;
+}
+
+static spif_str_t
+spif_ilist_show(spif_ilist_t self, spif_charptr_t name, spif_str_t buff, size_t indent)
+{
+    spif_char_t tmp[4096];
+    spif_ilist_link_t current;
+    spif_listidx_t i;
+
+    if (SPIF_ILIST_ISNULL(self)) {
+        SPIF_OBJ_SHOW_NULL_INTO(ilist, name, buff, indent);
+        return buff;
+    }
+
+    buff = spif_str_show_printf(buff, indent, "(spif_ilist_t) %s:  %10p (offset %lu) {\n", name, (spif_ptr_t) self,
+                                (unsigned long) self->offset);
+
+    for (current = self->head, i = 0; current; current = current->next, i++) {
+        spif_obj_t obj = SPIF_ILIST_OBJ_OF(self, current);
+
+        sprintf((char *) tmp, "item %d", i);
+        buff = SPIF_OBJ_CALL_METHOD(obj, show)(obj, tmp, buff, indent + 2);
+    }
+
+    buff = spif_str_show_printf(buff, indent, "}\n");
+    return buff;
+}
+
+static spif_cmp_t
+spif_ilist_comp(spif_ilist_t self, spif_ilist_t other)
+{
+    spif_ilist_link_t a, b;
+
+    SPIF_OBJ_COMP_CHECK_NULL(self, other);
+    for (a = self->head, b = other->head; a && b; a = a->next, b = b->next) {
+        spif_cmp_t c;
+
+        c = SPIF_OBJ_COMP(SPIF_ILIST_OBJ_OF(self, a), SPIF_ILIST_OBJ_OF(other, b));
+        if (!SPIF_CMP_IS_EQUAL(c)) {
+            return c;
+        }
+    }
+    return SPIF_CMP_FROM_INT((int) self->len - (int) other->len);
+}
+
+static spif_ilist_t
+spif_ilist_dup(spif_ilist_t self)
+{
+    spif_ilist_t tmp;
+
+    /* An element can be on only one list per embedded link, so a
+       duplicate list gets the same configuration but no elements. */
+    ASSERT_RVAL(!SPIF_ILIST_ISNULL(self), (spif_ilist_t) NULL);
+    tmp = spif_ilist_new_from_offset(self->offset);
+    tmp->elem_class = self->elem_class;
+    tmp->cmp_func = self->cmp_func;
+    tmp->key_func = self->key_func;
+    return tmp;
+}
+
+static spif_classname_t
+spif_ilist_type(spif_ilist_t self)
+{
+    ASSERT_RVAL(!SPIF_ILIST_ISNULL(self), (spif_classname_t) NULL);
+    return SPIF_OBJ_CLASSNAME(self);
+}
+
+static spif_bool_t
+spif_ilist_link_before(spif_ilist_t self, spif_ilist_link_t link, spif_ilist_link_t before)
+{
+    /* Link "link" in ahead of "before," or at the end if "before" is NULL. */
+    REQUIRE_RVAL(self->offset != 0, FALSE);
+    REQUIRE_RVAL(SPIF_ILIST_ISNULL(link->list), FALSE);
+    link->list = self;
+    link->next = before;
+    if (SPIF_ILIST_LINK_ISNULL(before)) {
+        link->prev = self->tail;
+        self->tail = link;
+    } else {
+        link->prev = before->prev;
+        before->prev = link;
+    }
+    if (SPIF_ILIST_LINK_ISNULL(link->prev)) {
+        self->head = link;
+    } else {
+        link->prev->next = link;
+    }
+    self->len++;
+    return TRUE;
+}
+
+static spif_ilist_link_t
+spif_ilist_link_at(spif_ilist_t self, spif_listidx_t idx)
+{
+    spif_listidx_t i;
+    spif_ilist_link_t current;
+
+    if (idx > (self->len / 2)) {
+        for (current = self->tail, i = self->len - 1; current && i > idx; i--, current = current->prev);
+    } else {
+        for (current = self->head, i = 0; current && i < idx; i++, current = current->next);
+    }
+    return current;
+}
+
+static spif_bool_t
+spif_ilist_append(spif_ilist_t self, spif_obj_t obj)
+{
+    ASSERT_RVAL(!SPIF_ILIST_ISNULL(self), FALSE);
+    REQUIRE_RVAL(!SPIF_OBJ_ISNULL(obj), FALSE);
+    REQUIRE_RVAL(SPIF_CONTAINER_ACCEPTS(self, obj), FALSE);
+    return spif_ilist_link_before(self, SPIF_ILIST_LINK_OF(self, obj), (spif_ilist_link_t) NULL);
+}
+
+static spif_bool_t
+spif_ilist_contains(spif_ilist_t self, spif_obj_t obj)
+{
+    ASSERT_RVAL(!SPIF_ILIST_ISNULL(self), FALSE);
+    return ((SPIF_OBJ_ISNULL(spif_ilist_find(self, obj))) ? (FALSE) : (TRUE));
+}
+
+static spif_listidx_t
+spif_ilist_count(spif_ilist_t self)
+{
+    ASSERT_RVAL(!SPIF_ILIST_ISNULL(self), FALSE);
+    return self->len;
+}
+
+static spif_obj_t
+spif_ilist_find(spif_ilist_t self, spif_obj_t obj)
+{
+    spif_ilist_link_t current;
+
+    ASSERT_RVAL(!SPIF_ILIST_ISNULL(self), (spif_obj_t) NULL);
+    REQUIRE_RVAL(!SPIF_OBJ_ISNULL(obj), (spif_obj_t) NULL);
+    obj = SPIF_CONTAINER_PROBE_KEY(self, obj);
+    for (current = self->head; current; current = current->next) {
+        if (SPIF_CMP_IS_EQUAL(SPIF_CONTAINER_COMP_PROBE(self, obj, SPIF_ILIST_OBJ_OF(self, current)))) {
+            return SPIF_ILIST_OBJ_OF(self, current);
+        }
+    }
+    return (spif_obj_t) NULL;
+}
+
+static spif_obj_t
+spif_ilist_get(spif_ilist_t self, spif_listidx_t idx)
+{
+    spif_ilist_link_t current;
+
+    ASSERT_RVAL(!SPIF_ILIST_ISNULL(self), (spif_obj_t) NULL);
+    if (idx < 0) {
+        /* Negative indexes go backward from the end of the list. */
+        idx += self->len;
+    }
+    REQUIRE_RVAL(idx >= 0, (spif_obj_t) NULL);
+    REQUIRE_RVAL(idx < self->len, (spif_obj_t) NULL);
+    current = spif_ilist_link_at(self, idx);
+    return (current ? SPIF_ILIST_OBJ_OF(self, current) : (spif_obj_t) NULL);
+}
+
+static spif_listidx_t
+spif_ilist_index(spif_ilist_t self, spif_obj_t obj)
+{
+    spif_listidx_t i;
+    spif_ilist_link_t current;
+
+    ASSERT_RVAL(!SPIF_ILIST_ISNULL(self), (spif_listidx_t) -1);
+    REQUIRE_RVAL(!SPIF_OBJ_ISNULL(obj), (spif_listidx_t) -1);
+    obj = SPIF_CONTAINER_PROBE_KEY(self, obj);
+    for (current = self->head, i = 0;
+         current && !SPIF_CMP_IS_EQUAL(SPIF_CONTAINER_COMP_PROBE(self, obj, SPIF_ILIST_OBJ_OF(self, current)));
+         i++, current = current->next);
+    return (current ? i : ((spif_listidx_t) (-1)));
+}
+
+static spif_bool_t
+spif_ilist_insert(spif_ilist_t self, spif_obj_t obj)
+{
+    spif_ilist_link_t current;
+    spif_obj_t key;
+
+    ASSERT_RVAL(!SPIF_ILIST_ISNULL(self), FALSE);
+    REQUIRE_RVAL(!SPIF_OBJ_ISNULL(obj), FALSE);
+    REQUIRE_RVAL(SPIF_CONTAINER_ACCEPTS(self, obj), FALSE);
+
+    key = SPIF_CONTAINER_PROBE_KEY(self, obj);
+    for (current = self->head;
+         current && SPIF_CMP_IS_GREATER(SPIF_CONTAINER_COMP_PROBE(self, key, SPIF_ILIST_OBJ_OF(self, current)));
+         current = current->next);
+    return spif_ilist_link_before(self, SPIF_ILIST_LINK_OF(self, obj), current);
+}
+
+static spif_bool_t
+spif_ilist_insert_at(spif_ilist_t self, spif_obj_t obj, spif_listidx_t idx)
+{
+    ASSERT_RVAL(!SPIF_ILIST_ISNULL(self), FALSE);
+    REQUIRE_RVAL(!SPIF_OBJ_ISNULL(obj), FALSE);
+    if (idx < 0) {
+        /* Negative indexes go backward from the end of the list. */
+        idx += self->len;
+    }
+    /* There's nothing to pad with, so no inserting past the end. */
+    REQUIRE_RVAL(idx >= 0, FALSE);
+    REQUIRE_RVAL(idx <= self->len, FALSE);
+    REQUIRE_RVAL(SPIF_CONTAINER_ACCEPTS(self, obj), FALSE);
+    return spif_ilist_link_before(self, SPIF_ILIST_LINK_OF(self, obj),
+                                  ((idx == self->len) ? ((spif_ilist_link_t) NULL) : spif_ilist_link_at(self, idx)));
+}
+
+static spif_iterator_t
+spif_ilist_iterator(spif_ilist_t self)
+{
+    ASSERT_RVAL(!SPIF_ILIST_ISNULL(self), (spif_iterator_t) NULL);
+    return (spif_iterator_t) spif_ilist_iterator_new(self);
+}
+
+static spif_bool_t
+spif_ilist_prepend(spif_ilist_t self, spif_obj_t obj)
+{
+    ASSERT_RVAL(!SPIF_ILIST_ISNULL(self), FALSE);
+    REQUIRE_RVAL(!SPIF_OBJ_ISNULL(obj), FALSE);
+    REQUIRE_RVAL(SPIF_CONTAINER_ACCEPTS(self, obj), FALSE);
+    return spif_ilist_link_before(self, SPIF_ILIST_LINK_OF(self, obj), self->head);
+}
+
+static spif_obj_t
+spif_ilist_remove(spif_ilist_t self, spif_obj_t item)
+{
+    spif_ilist_link_t current;
+
+    ASSERT_RVAL(!SPIF_ILIST_ISNULL(self), (spif_obj_t) NULL);
+    REQUIRE_RVAL(!SPIF_OBJ_ISNULL(item), (spif_obj_t) NULL);
+    item = SPIF_CONTAINER_PROBE_KEY(self, item);
+    for (current = self->head;
+         current && !SPIF_CMP_IS_EQUAL(SPIF_CONTAINER_COMP_PROBE(self, item, SPIF_ILIST_OBJ_OF(self, current)));
+         current = current->next);
+    if (SPIF_ILIST_LINK_ISNULL(current)) {
+        return (spif_obj_t) NULL;
+    }
+    return spif_ilist_unlink(current);
+}
+
+static spif_obj_t
+spif_ilist_remove_at(spif_ilist_t self, spif_listidx_t idx)
+{
+    spif_ilist_link_t current;
+
+    ASSERT_RVAL(!SPIF_ILIST_ISNULL(self), (spif_obj_t) NULL);
+    if (idx < 0) {
+        /* Negative indexes go backward from the end of the list. */
+        idx += self->len;
+    }
+    REQUIRE_RVAL(idx >= 0, (spif_obj_t) NULL);
+    REQUIRE_RVAL(idx < self->len, (spif_obj_t) NULL);
+    current = spif_ilist_link_at(self, idx);
+    if (SPIF_ILIST_LINK_ISNULL(current)) {
+        return (spif_obj_t) NULL;
+    }
+    return spif_ilist_unlink(current);
+}
+
+static spif_bool_t
+spif_ilist_reverse(spif_ilist_t self)
+{
+    spif_ilist_link_t current, tmp;
+
+    ASSERT_RVAL(!SPIF_ILIST_ISNULL(self), FALSE);
+    for (current = self->head; current; ) {
+        tmp = current;
+        current = current->next;
+        SWAP(tmp->prev, tmp->next);
+    }
+    SWAP(self->head, self->tail);
+    return TRUE;
+}
+
+spif_bool_t
+spif_ilist_set_comparator(spif_ilist_t self, spif_class_t cls, spif_cmp_func_t cmp, spif_key_func_t key)
+{
+    ASSERT_RVAL(!SPIF_ILIST_ISNULL(self), FALSE);
+    REQUIRE_RVAL(self->len == 0, FALSE);
+    REQUIRE_RVAL((key == (spif_key_func_t) NULL) || (cls != (spif_class_t) NULL), FALSE);
+    self->elem_class = cls;
+    self->cmp_func = cmp;
+    self->key_func = key;
+    return TRUE;
+}
+
+static spif_obj_t *
+spif_ilist_to_array(spif_ilist_t self)
+{
+    spif_obj_t *tmp;
+    spif_ilist_link_t current;
+    spif_listidx_t i;
+
+    ASSERT_RVAL(!SPIF_ILIST_ISNULL(self), (spif_obj_t *) NULL);
+    tmp = (spif_obj_t *) MALLOC(SPIF_SIZEOF_TYPE(obj) * self->len);
+    for (i = 0, current = self->head; i < self->len; current = current->next, i++) {
+        tmp[i] = SPIF_ILIST_OBJ_OF(self, current);
+    }
+    return tmp;
+}
+
+
+static spif_ilist_iterator_t
+spif_ilist_iterator_new(spif_ilist_t subject)
+{
+    spif_ilist_iterator_t self;
+
+    self = SPIF_ALLOC(ilist_iterator);
+    if (!spif_ilist_iterator_init(self, subject)) {
+        SPIF_DEALLOC(self);
+        self = (spif_ilist_iterator_t) NULL;
+    }
+    return self;
+}
+
+static spif_bool_t
+spif_ilist_iterator_init(spif_ilist_iterator_t self, spif_ilist_t subject)
+{
+    ASSERT_RVAL(!SPIF_ITERATOR_ISNULL(self), FALSE);
+    /* ***NOT NEEDED*** spif_obj_init(SPIF_OBJ(self)); */
+    spif_obj_set_class(SPIF_OBJ(self), SPIF_CLASS(SPIF_ITERATORCLASS_VAR(ilist)));
+    self->subject = subject;
+    if (SPIF_ILIST_ISNULL(self->subject)) {
+        self->current = (spif_ilist_link_t) NULL;
+    } else {
+        self->current = self->subject->head;
+    }
+    return TRUE;
+}
+
+static spif_bool_t
+spif_ilist_iterator_done(spif_ilist_iterator_t self)
+{
+    ASSERT_RVAL(!SPIF_ITERATOR_ISNULL(self), FALSE);
+    self->subject = (spif_ilist_t) NULL;
+    self->current = (spif_ilist_link_t) NULL;
+    return TRUE;
+}
+
+static spif_bool_t
+spif_ilist_iterator_del(spif_ilist_iterator_t self)
+{
+    ASSERT_RVAL(!SPIF_ITERATOR_ISNULL(self), FALSE);
+    spif_ilist_iterator_done(self);
+    SPIF_DEALLOC(self);
+    return TRUE;
+}
+
+static spif_str_t
+spif_ilist_iterator_show(spif_ilist_iterator_t self, spif_charptr_t name, spif_str_t buff, size_t indent)
+{
+    if (SPIF_ITERATOR_ISNULL(self)) {
+        SPIF_OBJ_SHOW_NULL_INTO(iterator, name, buff, indent);
+        return buff;
+    }
+
+    buff = spif_str_show_printf(buff, indent, "(spif_ilist_iterator_t) %s:  %10p {\n", name,
+                                (spif_ptr_t) self);
+
+    buff = spif_ilist_show(self->subject, (spif_charptr_t) "subject", buff, indent + 2);
+    buff = spif_str_show_printf(buff, indent + 2, "(spif_ilist_link_t) current:  %10p\n", (spif_ptr_t) self->current);
+
+    buff = spif_str_show_printf(buff, indent, "}\n");
+    return buff;
+}
+
+static spif_cmp_t
+spif_ilist_iterator_comp(spif_ilist_iterator_t self, spif_ilist_iterator_t other)
+{
+    return spif_ilist_comp(self->subject, other->subject);
+}
+
+static spif_ilist_iterator_t
+spif_ilist_iterator_dup(spif_ilist_iterator_t self)
+{
+    spif_ilist_iterator_t tmp;
+
+    ASSERT_RVAL(!SPIF_ITERATOR_ISNULL(self), (spif_ilist_iterator_t) NULL);
+    tmp = spif_ilist_iterator_new(self->subject);
+    tmp->current = self->current;
+    return tmp;
+}
+
+static spif_classname_t
+spif_ilist_iterator_type(spif_ilist_iterator_t self)
+{
+    ASSERT_RVAL(!SPIF_ITERATOR_ISNULL(self), (spif_classname_t) NULL);
+    return SPIF_OBJ_CLASSNAME(self);
+}
+
+static spif_bool_t
+spif_ilist_iterator_has_next(spif_ilist_iterator_t self)
+{
+    ASSERT_RVAL(!SPIF_ITERATOR_ISNULL(self), FALSE);
+    REQUIRE_RVAL(!SPIF_ILIST_ISNULL(self->subject), FALSE);
+    return ((self->current) ? (TRUE) : (FALSE));
+}
+
+static spif_obj_t
+spif_ilist_iterator_next(spif_ilist_iterator_t self)
+{
+    spif_obj_t tmp;
+
+    ASSERT_RVAL(!SPIF_ITERATOR_ISNULL(self), (spif_obj_t) NULL);
+    REQUIRE_RVAL(!SPIF_ILIST_ISNULL(self->subject), (spif_obj_t) NULL);
+    REQUIRE_RVAL(!SPIF_ILIST_LINK_ISNULL(self->current), (spif_obj_t) NULL);
+    tmp = SPIF_ILIST_OBJ_OF(self->subject, self->current);
+    self->current = self->current->next;
+    return tmp;
+}
@@ -0,0 +1,787 @@
+/*
+ * Copyright (C) 1997-2013, Michael Jennings <mej@eterm.org>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies of the Software, its documentation and marketing & publicity
+ * materials, and acknowledgment shall be given in the documentation, materials
+ * and software packages that this Software was used.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <libast_internal.h>
+
+/* *INDENT-OFF* */
+static SPIF_CONST_TYPE(class) ic_class = {
+    SPIF_DECL_CLASSNAME(iobuf_chain),
+    (spif_func_t) spif_iobuf_chain_new,
+    (spif_func_t) spif_iobuf_chain_init,
+    (spif_func_t) spif_iobuf_chain_done,
+    (spif_func_t) spif_iobuf_chain_del,
+    (spif_func_t) spif_iobuf_chain_show,
+    (spif_func_t) spif_iobuf_chain_comp,
+    (spif_func_t) spif_iobuf_chain_dup,
+    (spif_func_t) spif_iobuf_chain_type
+};
+SPIF_TYPE(class) SPIF_CLASS_VAR(iobuf_chain) = &ic_class;
+/* *INDENT-ON* */
+
+/*
+ * A block is a run of memory shared by any number of segments.  Blocks
+ * the chain allocates itself keep their bytes in data[] and may have
+ * room left over; copies appended to the chain go there as long as the
+ * chain's last segment ends where the block's used bytes do, which
+ * never disturbs bytes another segment can see.  Blocks which wrap
+ * outside memory are always full, and call free_func on owner once
+ * their last reference goes away.
+ */
+SPIF_DECL_OBJ_STRUCT(iobuf_block) {
+    spif_uint32_t refs;
+    spif_byteptr_t buff;
+    spif_memidx_t size, used;
+    spif_iobuf_chain_free_func_t free_func;
+    spif_ptr_t owner;
+    spif_uint8_t data[1];
+};
+
+SPIF_DECL_OBJ_STRUCT(iobuf_seg) {
+    spif_iobuf_block_t block;
+    spif_memidx_t off, len;
+};
+
+#define IOBUF_BLOCK_IS_OWN(b)   ((b)->buff == (b)->data)
+#define IOBUF_SEG(c, i)         (&(c)->segs[(c)->first + (i)])
+
+#ifndef IOV_MAX
+# define IOV_MAX                1024
+#endif
+
+static const size_t block_min = 1024;
+static const size_t segs_init = 8;
+
+static spif_iobuf_block_t
+spif_iobuf_block_new(spif_memidx_t size)
+{
+    spif_iobuf_block_t block;
+
+    block = (spif_iobuf_block_t) MALLOC(sizeof(SPIF_DECL_OBJ_STRUCT(iobuf_block)) + size);
+    block->refs = 1;
+    block->buff = block->data;
+    block->size = size;
+    block->used = 0;
+    block->free_func = (spif_iobuf_chain_free_func_t) NULL;
+    block->owner = (spif_ptr_t) NULL;
+    return block;
+}
+
+static spif_iobuf_block_t
+spif_iobuf_block_new_from_buff(spif_byteptr_t buff, spif_memidx_t len, spif_iobuf_chain_free_func_t free_func,
+                               spif_ptr_t owner)
+{
+    spif_iobuf_block_t block;
+
+    block = (spif_iobuf_block_t) MALLOC(sizeof(SPIF_DECL_OBJ_STRUCT(iobuf_block)));
+    block->refs = 1;
+    block->buff = buff;
+    block->size = len;
+    block->used = len;
+    block->free_func = free_func;
+    block->owner = owner;
+    return block;
+}
+
+static void
+spif_iobuf_block_release(spif_iobuf_block_t block)
+{
+    if (--block->refs) {
+        return;
+    }
+    if (block->free_func) {
+        block->free_func(block->owner);
+    }
+    FREE(block);
+}
+
+/* The free function for blocks which took over an mbuff. */
+static void
+spif_iobuf_chain_free_mbuff(spif_ptr_t owner)
+{
+    spif_mbuff_del(SPIF_MBUFF(owner));
+}
+
+/* Make room for one more segment at the front or back of the segment
+   array.  The used slots are recentered when the array is less than
+   half full, so alternating prepends and appends don't keep growing
+   it; otherwise it doubles. */
+static void
+spif_iobuf_chain_room(spif_iobuf_chain_t self, spif_bool_t front)
+{
+    spif_memidx_t size, first;
+
+    if ((front) ? (self->first > 0) : (self->first + self->count < self->size)) {
+        return;
+    }
+    size = self->size;
+    if (self->count + 1 > size / 2) {
+        size = MAX(size * 2, (spif_memidx_t) segs_init);
+        self->segs = (spif_iobuf_seg_t) REALLOC(self->segs, size * sizeof(SPIF_DECL_OBJ_STRUCT(iobuf_seg)));
+    }
+    first = (size - self->count) / 2;
+    if (self->count) {
+        memmove(self->segs + first, self->segs + self->first, self->count * sizeof(SPIF_DECL_OBJ_STRUCT(iobuf_seg)));
+    }
+    self->first = first;
+    self->size = size;
+}
+
+/* Add a segment covering len bytes of block at off, taking over the
+   caller's reference to the block. */
+static void
+spif_iobuf_chain_add(spif_iobuf_chain_t self, spif_iobuf_block_t block, spif_memidx_t off, spif_memidx_t len,
+                     spif_bool_t front)
+{
+    spif_iobuf_seg_t seg;
+
+    spif_iobuf_chain_room(self, front);
+    if (front) {
+        self->first--;
+        seg = IOBUF_SEG(self, 0);
+    } else {
+        seg = IOBUF_SEG(self, self->count);
+    }
+    seg->block = block;
+    seg->off = off;
+    seg->len = len;
+    self->count++;
+    self->len += len;
+}
+
+/* Add references to the cnt bytes of other starting at idx.  Going
+   to the front, other's segments are walked backward so they end up
+   in order.  other must not be self. */
+static void
+spif_iobuf_chain_add_range(spif_iobuf_chain_t self, spif_iobuf_chain_t other, spif_memidx_t idx, spif_memidx_t cnt,
+                           spif_bool_t front)
+{
+    spif_memidx_t i, pos, lo, hi, end;
+    spif_iobuf_seg_t seg;
+
+    if (cnt <= 0) {
+        return;
+    }
+    end = idx + cnt;
+    if (front) {
+        for (i = 0, pos = 0; (i < other->count) && (pos < end); i++) {
+            pos += IOBUF_SEG(other, i)->len;
+        }
+        while (i-- > 0) {
+            seg = IOBUF_SEG(other, i);
+            pos -= seg->len;
+            if (pos + seg->len <= idx) {
+                break;
+            }
+            lo = MAX(idx, pos) - pos;
+            hi = MIN(end, pos + seg->len) - pos;
+            seg->block->refs++;
+            spif_iobuf_chain_add(self, seg->block, seg->off + lo, hi - lo, TRUE);
+        }
+        return;
+    }
+    for (i = 0, pos = 0; (i < other->count) && (pos < end); i++) {
+        seg = IOBUF_SEG(other, i);
+        if (pos + seg->len > idx) {
+            lo = MAX(idx, pos) - pos;
+            hi = MIN(end, pos + seg->len) - pos;
+            seg->block->refs++;
+            spif_iobuf_chain_add(self, seg->block, seg->off + lo, hi - lo, FALSE);
+        }
+        pos += seg->len;
+    }
+}
+
+spif_iobuf_chain_t
+spif_iobuf_chain_new(void)
+{
+    spif_iobuf_chain_t self;
+
+    self = SPIF_ALLOC(iobuf_chain);
+    if (!spif_iobuf_chain_init(self)) {
+        SPIF_DEALLOC(self);
+        self = (spif_iobuf_chain_t) NULL;
+    }
+    return self;
+}
+
+spif_bool_t
+spif_iobuf_chain_init(spif_iobuf_chain_t self)
+{
+    ASSERT_RVAL(!SPIF_IOBUF_CHAIN_ISNULL(self), FALSE);
+    if (!spif_obj_init(SPIF_OBJ(self))) {
+        return FALSE;
+    }
+    spif_obj_set_class(SPIF_OBJ(self), SPIF_CLASS_VAR(iobuf_chain));
+    self->segs = (spif_iobuf_seg_t) NULL;
+    self->first = 0;
+    self->count = 0;
+    self->size = 0;
+    self->len = 0;
+    return TRUE;
+}
+
+spif_bool_t
+spif_iobuf_chain_done(spif_iobuf_chain_t self)
+{
+    ASSERT_RVAL(!SPIF_IOBUF_CHAIN_ISNULL(self), FALSE);
+    spif_iobuf_chain_clear(self);
+    if (self->segs) {
+        FREE(self->segs);
+    }
+    self->first = 0;
+    self->size = 0;
+    return TRUE;
+}
+
+spif_bool_t
+spif_iobuf_chain_del(spif_iobuf_chain_t self)
+{
+    ASSERT_RVAL(!SPIF_IOBUF_CHAIN_ISNULL(self), FALSE);
+    spif_iobuf_chain_done(self);
+    SPIF_DEALLOC(self);
+    return TRUE;
+}
+
+spif_str_t
+spif_iobuf_chain_show(spif_iobuf_chain_t self, spif_charptr_t name, spif_str_t buff, size_t indent)
+{
+    spif_memidx_t i;
+    spif_iobuf_seg_t seg;
+
+    if (SPIF_IOBUF_CHAIN_ISNULL(self)) {
+        SPIF_OBJ_SHOW_NULL_INTO(iobuf_chain, name, buff, indent);
+        return buff;
+    }
+
+    buff = spif_str_show_printf(buff, indent, "(spif_iobuf_chain_t) %s:  %10p (length %lu, %lu segments) {\n",
+                                name, (spif_ptr_t) self, (spif_ulong_t) self->len, (spif_ulong_t) self->count);
+    for (i = 0; i < self->count; i++) {
+        seg = IOBUF_SEG(self, i);
+        buff = spif_str_show_printf(buff, indent + 2, "%10p + %lu, %lu bytes (%lu refs%s)\n", (spif_ptr_t) seg->block->buff,
+                                    (spif_ulong_t) seg->off, (spif_ulong_t) seg->len, (spif_ulong_t) seg->block->refs,
+                                    ((IOBUF_BLOCK_IS_OWN(seg->block)) ? ("") : (", external")));
+    }
+    buff = spif_str_show_printf(buff, indent, "}\n");
+    return buff;
+}
+
+/* Chains compare by their bytes, like mbuffs, however they're split. */
+spif_cmp_t
+spif_iobuf_chain_comp(spif_iobuf_chain_t self, spif_iobuf_chain_t other)
+{
+    spif_memidx_t i, j, ioff, joff, n;
+    spif_iobuf_seg_t a, b;
+    int c;
+
+    SPIF_OBJ_COMP_CHECK_NULL(self, other);
+    for (i = j = ioff = joff = 0; (i < self->count) && (j < other->count);) {
+        a = IOBUF_SEG(self, i);
+        b = IOBUF_SEG(other, j);
+        n = MIN(a->len - ioff, b->len - joff);
+        c = memcmp(a->block->buff + a->off + ioff, b->block->buff + b->off + joff, n);
+        if (c) {
+            return SPIF_CMP_FROM_INT(c);
+        }
+        ioff += n;
+        joff += n;
+        if (ioff == a->len) {
+            i++;
+            ioff = 0;
+        }
+        if (joff == b->len) {
+            j++;
+            joff = 0;
+        }
+    }
+    return SPIF_CMP_FROM_INT((self->len > other->len) - (self->len < other->len));
+}
+
+/* The copy shares all of self's blocks. */
+spif_iobuf_chain_t
+spif_iobuf_chain_dup(spif_iobuf_chain_t self)
+{
+    spif_iobuf_chain_t tmp;
+
+    ASSERT_RVAL(!SPIF_IOBUF_CHAIN_ISNULL(self), (spif_iobuf_chain_t) NULL);
+    tmp = spif_iobuf_chain_new();
+    spif_iobuf_chain_add_range(tmp, self, 0, self->len, FALSE);
+    return tmp;
+}
+
+spif_classname_t
+spif_iobuf_chain_type(spif_iobuf_chain_t self)
+{
+    ASSERT_RVAL(!SPIF_IOBUF_CHAIN_ISNULL(self), (spif_classname_t) NULL);
+    return SPIF_OBJ_CLASSNAME(self);
+}
+
+/**
+ * Append another chain's contents without copying them.
+ *
+ * @param self  The chain.
+ * @param other The chain to append; it may be @a self.
+ * @return      TRUE on success.
+ */
+spif_bool_t
+spif_iobuf_chain_append(spif_iobuf_chain_t self, spif_iobuf_chain_t other)
+{
+    ASSERT_RVAL(!SPIF_IOBUF_CHAIN_ISNULL(self), FALSE);
+    REQUIRE_RVAL(!SPIF_IOBUF_CHAIN_ISNULL(other), FALSE);
+    if (self == other) {
+        other = spif_iobuf_chain_dup(self);
+        spif_iobuf_chain_add_range(self, other, 0, other->len, FALSE);
+        spif_iobuf_chain_del(other);
+    } else {
+        spif_iobuf_chain_add_range(self, other, 0, other->len, FALSE);
+    }
+    return TRUE;
+}
+
+/**
+ * Append a buffer without copying it.
+ *
+ * The chain refers to @a buff directly, so it must not change while
+ * any chain holds it.  If @a free_func is non-NULL, it is called with
+ * @a buff once no chain uses it any longer; otherwise the caller keeps
+ * ownership and must keep @a buff around long enough.
+ *
+ * @param self      The chain.
+ * @param buff      The bytes.
+ * @param len       The number of bytes.
+ * @param free_func How to free @a buff, or NULL.
+ * @return          TRUE on success.
+ */
+spif_bool_t
+spif_iobuf_chain_append_buff(spif_iobuf_chain_t self, spif_byteptr_t buff, spif_memidx_t len,
+                             spif_iobuf_chain_free_func_t free_func)
+{
+    ASSERT_RVAL(!SPIF_IOBUF_CHAIN_ISNULL(self), FALSE);
+    REQUIRE_RVAL(buff != (spif_byteptr_t) NULL, FALSE);
+    REQUIRE_RVAL(len >= 0, FALSE);
+    if (!len) {
+        if (free_func) {
+            free_func((spif_ptr_t) buff);
+        }
+        return TRUE;
+    }
+    spif_iobuf_chain_add(self, spif_iobuf_block_new_from_buff(buff, len, free_func, (spif_ptr_t) buff), 0, len, FALSE);
+    return TRUE;
+}
+
+/**
+ * Append a copy of some bytes.
+ *
+ * This is for small pieces such as headers; they're packed into the
+ * free space at the end of the chain's last block when it has some,
+ * so a run of small appends makes one segment rather than many.
+ *
+ * @param self The chain.
+ * @param buff The bytes to copy.
+ * @param len  The number of bytes.
+ * @return     TRUE on success.
+ */
+spif_bool_t
+spif_iobuf_chain_append_from_ptr(spif_iobuf_chain_t self, spif_byteptr_t buff, spif_memidx_t len)
+{
+    spif_iobuf_seg_t seg;
+    spif_iobuf_block_t block;
+
+    ASSERT_RVAL(!SPIF_IOBUF_CHAIN_ISNULL(self), FALSE);
+    REQUIRE_RVAL(len >= 0, FALSE);
+    REQUIRE_RVAL((buff != (spif_byteptr_t) NULL) || (len == 0), FALSE);
+    if (!len) {
+        return TRUE;
+    }
+    if (self->count) {
+        seg = IOBUF_SEG(self, self->count - 1);
+        block = seg->block;
+        if (IOBUF_BLOCK_IS_OWN(block) && (seg->off + seg->len == block->used) && (block->size - block->used >= len)) {
+            memcpy(block->buff + block->used, buff, len);
+            block->used += len;
+            seg->len += len;
+            self->len += len;
+            return TRUE;
+        }
+    }
+    block = spif_iobuf_block_new(MAX(len, (spif_memidx_t) block_min));
+    memcpy(block->buff, buff, len);
+    block->used = len;
+    spif_iobuf_chain_add(self, block, 0, len, FALSE);
+    return TRUE;
+}
+
+/**
+ * Append an mbuff's contents without copying them.
+ *
+ * The chain takes over @a mbuff and deletes it once no chain uses its
+ * bytes.  The caller must not use or delete it afterward.
+ *
+ * @param self  The chain.
+ * @param mbuff The mbuff to take over.
+ * @return      TRUE on success.
+ */
+spif_bool_t
+spif_iobuf_chain_append_mbuff(spif_iobuf_chain_t self, spif_mbuff_t mbuff)
+{
+    ASSERT_RVAL(!SPIF_IOBUF_CHAIN_ISNULL(self), FALSE);
+    REQUIRE_RVAL(!SPIF_MBUFF_ISNULL(mbuff), FALSE);
+    if (!mbuff->len) {
+        spif_mbuff_del(mbuff);
+        return TRUE;
+    }
+    spif_iobuf_chain_add(self, spif_iobuf_block_new_from_buff(mbuff->buff, mbuff->len, spif_iobuf_chain_free_mbuff,
+                                                              (spif_ptr_t) mbuff), 0, mbuff->len, FALSE);
+    return TRUE;
+}
+
+spif_bool_t
+spif_iobuf_chain_clear(spif_iobuf_chain_t self)
+{
+    spif_memidx_t i;
+
+    ASSERT_RVAL(!SPIF_IOBUF_CHAIN_ISNULL(self), FALSE);
+    for (i = 0; i < self->count; i++) {
+        spif_iobuf_block_release(IOBUF_SEG(self, i)->block);
+    }
+    self->first = self->size / 2;
+    self->count = 0;
+    self->len = 0;
+    return TRUE;
+}
+
+/**
+ * Drop bytes from the front of a chain.
+ *
+ * Blocks are released as soon as the chain no longer covers any of
+ * their bytes, so a partly written chain gives back memory as it goes.
+ *
+ * @param self The chain.
+ * @param cnt  The number of bytes to drop.
+ * @return     The number of bytes dropped.
+ */
+spif_memidx_t
+spif_iobuf_chain_consume(spif_iobuf_chain_t self, spif_memidx_t cnt)
+{
+    spif_memidx_t left;
+    spif_iobuf_seg_t seg;
+
+    ASSERT_RVAL(!SPIF_IOBUF_CHAIN_ISNULL(self), 0);
+    REQUIRE_RVAL(cnt > 0, 0);
+    UPPER_BOUND(cnt, self->len);
+    for (left = cnt; left > 0;) {
+        seg = IOBUF_SEG(self, 0);
+        if (seg->len > left) {
+            seg->off += left;
+            seg->len -= left;
+            break;
+        }
+        left -= seg->len;
+        spif_iobuf_block_release(seg->block);
+        self->first++;
+        self->count--;
+    }
+    self->len -= cnt;
+    if (!self->count) {
+        self->first = self->size / 2;
+    }
+    return cnt;
+}
+
+/**
+ * Copy a chain's contents into one contiguous buffer.
+ *
+ * @param self The chain.
+ * @return     A new mbuff holding all of the chain's bytes.
+ */
+spif_mbuff_t
+spif_iobuf_chain_flatten(spif_iobuf_chain_t self)
+{
+    spif_mbuff_t tmp;
+    spif_memidx_t i;
+    spif_iobuf_seg_t seg;
+
+    ASSERT_RVAL(!SPIF_IOBUF_CHAIN_ISNULL(self), (spif_mbuff_t) NULL);
+    /* Sized up front (the mbuff may come from the pool with a buffer
+       of its own), so the appends never reallocate. */
+    tmp = spif_mbuff_new_from_buff((spif_byteptr_t) NULL, 0, self->len);
+    for (i = 0; i < self->count; i++) {
+        seg = IOBUF_SEG(self, i);
+        spif_mbuff_append_from_ptr(tmp, seg->block->buff + seg->off, seg->len);
+    }
+    return tmp;
+}
+
+spif_memidx_t
+spif_iobuf_chain_get_count(spif_iobuf_chain_t self)
+{
+    ASSERT_RVAL(!SPIF_IOBUF_CHAIN_ISNULL(self), 0);
+    return self->count;
+}
+
+/**
+ * Prepend another chain's contents without copying them.
+ *
+ * @param self  The chain.
+ * @param other The chain to prepend; it may be @a self.
+ * @return      TRUE on success.
+ */
+spif_bool_t
+spif_iobuf_chain_prepend(spif_iobuf_chain_t self, spif_iobuf_chain_t other)
+{
+    ASSERT_RVAL(!SPIF_IOBUF_CHAIN_ISNULL(self), FALSE);
+    REQUIRE_RVAL(!SPIF_IOBUF_CHAIN_ISNULL(other), FALSE);
+    if (self == other) {
+        other = spif_iobuf_chain_dup(self);
+        spif_iobuf_chain_add_range(self, other, 0, other->len, TRUE);
+        spif_iobuf_chain_del(other);
+    } else {
+        spif_iobuf_chain_add_range(self, other, 0, other->len, TRUE);
+    }
+    return TRUE;
+}
+
+/* Like spif_iobuf_chain_append_buff(), at the front. */
+spif_bool_t
+spif_iobuf_chain_prepend_buff(spif_iobuf_chain_t self, spif_byteptr_t buff, spif_memidx_t len,
+                              spif_iobuf_chain_free_func_t free_func)
+{
+    ASSERT_RVAL(!SPIF_IOBUF_CHAIN_ISNULL(self), FALSE);
+    REQUIRE_RVAL(buff != (spif_byteptr_t) NULL, FALSE);
+    REQUIRE_RVAL(len >= 0, FALSE);
+    if (!len) {
+        if (free_func) {
+            free_func((spif_ptr_t) buff);
+        }
+        return TRUE;
+    }
+    spif_iobuf_chain_add(self, spif_iobuf_block_new_from_buff(buff, len, free_func, (spif_ptr_t) buff), 0, len, TRUE);
+    return TRUE;
+}
+
+/* Like spif_iobuf_chain_append_from_ptr(), at the front.  The copy
+   gets its own block, which later appends can't pack into. */
+spif_bool_t
+spif_iobuf_chain_prepend_from_ptr(spif_iobuf_chain_t self, spif_byteptr_t buff, spif_memidx_t len)
+{
+    spif_iobuf_block_t block;
+
+    ASSERT_RVAL(!SPIF_IOBUF_CHAIN_ISNULL(self), FALSE);
+    REQUIRE_RVAL(len >= 0, FALSE);
+    REQUIRE_RVAL((buff != (spif_byteptr_t) NULL) || (len == 0), FALSE);
+    if (!len) {
+        return TRUE;
+    }
+    block = spif_iobuf_block_new(len);
+    memcpy(block->buff, buff, len);
+    block->used = len;
+    spif_iobuf_chain_add(self, block, 0, len, TRUE);
+    return TRUE;
+}
+
+/* Like spif_iobuf_chain_append_mbuff(), at the front. */
+spif_bool_t
+spif_iobuf_chain_prepend_mbuff(spif_iobuf_chain_t self, spif_mbuff_t mbuff)
+{
+    ASSERT_RVAL(!SPIF_IOBUF_CHAIN_ISNULL(self), FALSE);
+    REQUIRE_RVAL(!SPIF_MBUFF_ISNULL(mbuff), FALSE);
+    if (!mbuff->len) {
+        spif_mbuff_del(mbuff);
+        return TRUE;
+    }
+    spif_iobuf_chain_add(self, spif_iobuf_block_new_from_buff(mbuff->buff, mbuff->len, spif_iobuf_chain_free_mbuff,
+                                                              (spif_ptr_t) mbuff), 0, mbuff->len, TRUE);
+    return TRUE;
+}
+
+/**
+ * Read from a descriptor onto the end of a chain.
+ *
+ * Fills whatever room is left in the chain's last block before using
+ * a new one, with a single readv().
+ *
+ * @param self The chain.
+ * @param fd   The descriptor to read from.
+ * @param cnt  The most bytes to read.
+ * @return     The number of bytes read, 0 at EOF, or -1 on error.
+ */
+spif_memidx_t
+spif_iobuf_chain_readv(spif_iobuf_chain_t self, int fd, spif_memidx_t cnt)
+{
+    struct iovec iov[2];
+    spif_iobuf_seg_t seg;
+    spif_iobuf_block_t tail, block;
+    spif_memidx_t avail;
+    ssize_t n;
+    int i;
+
+    ASSERT_RVAL(!SPIF_IOBUF_CHAIN_ISNULL(self), ((spif_memidx_t) -1));
+    ASSERT_RVAL((fd >= 0), ((spif_memidx_t) -1));
+    REQUIRE_RVAL((cnt > 0), 0);
+    i = 0;
+    avail = 0;
+    tail = (spif_iobuf_block_t) NULL;
+    if (self->count) {
+        seg = IOBUF_SEG(self, self->count - 1);
+        if (IOBUF_BLOCK_IS_OWN(seg->block) && (seg->off + seg->len == seg->block->used)) {
+            tail = seg->block;
+            avail = MIN(tail->size - tail->used, cnt);
+        }
+    }
+    if (avail) {
+        iov[i].iov_base = (void *) (tail->buff + tail->used);
+        iov[i++].iov_len = avail;
+    }
+    block = (spif_iobuf_block_t) NULL;
+    if (cnt > avail) {
+        block = spif_iobuf_block_new(MAX(cnt - avail, (spif_memidx_t) block_min));
+        iov[i].iov_base = (void *) block->buff;
+        iov[i++].iov_len = cnt - avail;
+    }
+    do {
+        n = readv(fd, iov, i);
+    } while ((n < 0) && (errno == EINTR));
+    if (n > 0) {
+        if (avail) {
+            seg = IOBUF_SEG(self, self->count - 1);
+            tail->used += MIN(n, avail);
+            seg->len += MIN(n, avail);
+            self->len += MIN(n, avail);
+        }
+        if (n > avail) {
+            block->used = n - avail;
+            spif_iobuf_chain_add(self, block, 0, block->used, FALSE);
+            block = (spif_iobuf_block_t) NULL;
+        }
+    }
+    if (block) {
+        spif_iobuf_block_release(block);
+    }
+    return (spif_memidx_t) n;
+}
+
+/**
+ * Get part of a chain as a new chain, sharing its blocks.
+ *
+ * @a idx and @a cnt work as in spif_mbuff_subbuff():  a negative
+ * index counts from the end, and a count of zero or less is relative
+ * to the end.
+ *
+ * @param self The chain.
+ * @param idx  Where the slice starts.
+ * @param cnt  The length of the slice.
+ * @return     A new chain, or NULL if @a idx is out of range.
+ */
+spif_iobuf_chain_t
+spif_iobuf_chain_slice(spif_iobuf_chain_t self, spif_memidx_t idx, spif_memidx_t cnt)
+{
+    spif_iobuf_chain_t tmp;
+
+    ASSERT_RVAL(!SPIF_IOBUF_CHAIN_ISNULL(self), (spif_iobuf_chain_t) NULL);
+    if (idx < 0) {
+        idx = self->len + idx;
+    }
+    REQUIRE_RVAL(idx >= 0, (spif_iobuf_chain_t) NULL);
+    REQUIRE_RVAL(idx < self->len, (spif_iobuf_chain_t) NULL);
+    if (cnt <= 0) {
+        cnt = self->len - idx + cnt;
+    }
+    REQUIRE_RVAL(cnt >= 0, (spif_iobuf_chain_t) NULL);
+    UPPER_BOUND(cnt, self->len - idx);
+    tmp = spif_iobuf_chain_new();
+    spif_iobuf_chain_add_range(tmp, self, idx, cnt, FALSE);
+    return tmp;
+}
+
+/**
+ * Describe a chain's segments for writev().
+ *
+ * @param self The chain.
+ * @param iov  The array to fill in.
+ * @param max  The number of entries in @a iov.
+ * @return     The number of entries filled in, which is less than the
+ *             number of segments if @a max is too small.
+ */
+int
+spif_iobuf_chain_to_iovec(spif_iobuf_chain_t self, struct iovec *iov, int max)
+{
+    spif_iobuf_seg_t seg;
+    int i;
+
+    ASSERT_RVAL(!SPIF_IOBUF_CHAIN_ISNULL(self), 0);
+    REQUIRE_RVAL(iov != NULL, 0);
+    for (i = 0; (i < max) && (i < self->count); i++) {
+        seg = IOBUF_SEG(self, i);
+        iov[i].iov_base = (void *) (seg->block->buff + seg->off);
+        iov[i].iov_len = seg->len;
+    }
+    return i;
+}
+
+/**
+ * Write a chain to a descriptor.
+ *
+ * The chain is handed to writev() a batch of segments at a time, and
+ * whatever was written is consumed.  This stops at the first short
+ * write, so on a non-blocking descriptor the rest stays in the chain
+ * for next time.
+ *
+ * @param self The chain.
+ * @param fd   The descriptor to write to.
+ * @return     The number of bytes written, or -1 if nothing could be.
+ */
+spif_memidx_t
+spif_iobuf_chain_writev(spif_iobuf_chain_t self, int fd)
+{
+    struct iovec iov[64];
+    spif_memidx_t total, want;
+    ssize_t n;
+    int i, cnt;
+
+    ASSERT_RVAL(!SPIF_IOBUF_CHAIN_ISNULL(self), ((spif_memidx_t) -1));
+    ASSERT_RVAL((fd >= 0), ((spif_memidx_t) -1));
+    for (total = 0; self->len;) {
+        cnt = spif_iobuf_chain_to_iovec(self, iov, MIN((int) (sizeof(iov) / sizeof(iov[0])), IOV_MAX));
+        for (i = 0, want = 0; i < cnt; i++) {
+            want += iov[i].iov_len;
+        }
+        do {
+            n = writev(fd, iov, cnt);
+        } while ((n < 0) && (errno == EINTR));
+        if (n < 0) {
+            return ((total) ? (total) : ((spif_memidx_t) -1));
+        }
+        spif_iobuf_chain_consume(self, n);
+        total += n;
+        if (n < want) {
+            break;
+        }
+    }
+    return total;
+}
+
+SPIF_DEFINE_PROPERTY_FUNC_C(iobuf_chain, spif_memidx_t, len)
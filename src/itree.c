@@ -0,0 +1,666 @@
+/*
+ * Copyright (C) 1997-2013, Michael Jennings <mej@eterm.org>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies of the Software, its documentation and marketing & publicity
+ * materials, and acknowledgment shall be given in the documentation, materials
+ * and software packages that this Software was used.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <libast_internal.h>
+
+/* *INDENT-OFF* */
+SPIF_DECL_OBJ(itree_iterator) {
+    SPIF_DECL_PARENT_TYPE(obj);
+    SPIF_DECL_PROPERTY(itree, subject);
+    SPIF_DECL_PROPERTY(itree_node, current);
+};
+/* *INDENT-ON* */
+
+#define ITREE_HEIGHT(n)     ((n) ? ((n)->height) : 0)
+
+static spif_itree_t spif_itree_new(void);
+static spif_bool_t spif_itree_init(spif_itree_t);
+static spif_bool_t spif_itree_done(spif_itree_t);
+static spif_bool_t spif_itree_del(spif_itree_t);
+static spif_str_t spif_itree_show(spif_itree_t, spif_charptr_t, spif_str_t, size_t);
+static spif_cmp_t spif_itree_comp(spif_itree_t, spif_itree_t);
+static spif_itree_t spif_itree_dup(spif_itree_t);
+static spif_classname_t spif_itree_type(spif_itree_t);
+static spif_bool_t spif_itree_contains(spif_itree_t self, spif_obj_t obj);
+static spif_listidx_t spif_itree_count(spif_itree_t self);
+static spif_obj_t spif_itree_find(spif_itree_t self, spif_obj_t obj);
+static spif_bool_t spif_itree_insert(spif_itree_t self, spif_obj_t obj);
+static spif_iterator_t spif_itree_iterator(spif_itree_t self);
+static spif_obj_t spif_itree_remove(spif_itree_t self, spif_obj_t item);
+static spif_obj_t * spif_itree_to_array(spif_itree_t self);
+static spif_itree_node_t spif_itree_find_node(spif_itree_t self, spif_obj_t obj);
+static spif_itree_node_t spif_itree_first_node(spif_itree_node_t node);
+static spif_itree_node_t spif_itree_next_node(spif_itree_node_t node);
+static void spif_itree_update_height(spif_itree_node_t node);
+static void spif_itree_replace_child(spif_itree_t self, spif_itree_node_t parent, spif_itree_node_t old, spif_itree_node_t new);
+static spif_itree_node_t spif_itree_rotate_left(spif_itree_t self, spif_itree_node_t node);
+static spif_itree_node_t spif_itree_rotate_right(spif_itree_t self, spif_itree_node_t node);
+static void spif_itree_rebalance(spif_itree_t self, spif_itree_node_t node);
+
+static spif_itree_iterator_t spif_itree_iterator_new(spif_itree_t subject);
+static spif_bool_t spif_itree_iterator_init(spif_itree_iterator_t self, spif_itree_t subject);
+static spif_bool_t spif_itree_iterator_done(spif_itree_iterator_t self);
+static spif_bool_t spif_itree_iterator_del(spif_itree_iterator_t self);
+static spif_str_t spif_itree_iterator_show(spif_itree_iterator_t self, spif_charptr_t name, spif_str_t buff, size_t indent);
+static spif_cmp_t spif_itree_iterator_comp(spif_itree_iterator_t self, spif_itree_iterator_t other);
+static spif_itree_iterator_t spif_itree_iterator_dup(spif_itree_iterator_t self);
+static spif_classname_t spif_itree_iterator_type(spif_itree_iterator_t self);
+static spif_bool_t spif_itree_iterator_has_next(spif_itree_iterator_t self);
+static spif_obj_t spif_itree_iterator_next(spif_itree_iterator_t self);
+
+/* *INDENT-OFF* */
+static spif_const_vectorclass_t it_class = {
+    {
+        SPIF_DECL_CLASSNAME(itree),
+        (spif_func_t) spif_itree_new,
+        (spif_func_t) spif_itree_init,
+        (spif_func_t) spif_itree_done,
+        (spif_func_t) spif_itree_del,
+        (spif_func_t) spif_itree_show,
+        (spif_func_t) spif_itree_comp,
+        (spif_func_t) spif_itree_dup,
+        (spif_func_t) spif_itree_type
+    },
+    (spif_func_t) spif_itree_contains,
+    (spif_func_t) spif_itree_count,
+    (spif_func_t) spif_itree_find,
+    (spif_func_t) spif_itree_insert,
+    (spif_func_t) spif_itree_iterator,
+    (spif_func_t) spif_itree_remove,
+    (spif_func_t) spif_itree_to_array
+};
+spif_vectorclass_t SPIF_VECTORCLASS_VAR(itree) = &it_class;
+
+static spif_const_iteratorclass_t iti_class = {
+    {
+        SPIF_DECL_CLASSNAME(itree),
+        (spif_func_t) spif_itree_iterator_new,
+        (spif_func_t) spif_itree_iterator_init,
+        (spif_func_t) spif_itree_iterator_done,
+        (spif_func_t) spif_itree_iterator_del,
+        (spif_func_t) spif_itree_iterator_show,
+        (spif_func_t) spif_itree_iterator_comp,
+        (spif_func_t) spif_itree_iterator_dup,
+        (spif_func_t) spif_itree_iterator_type
+    },
+    (spif_func_t) spif_itree_iterator_has_next,
+    (spif_func_t) spif_itree_iterator_next
+};
+spif_iteratorclass_t SPIF_ITERATORCLASS_VAR(itree) = &iti_class;
+/* *INDENT-ON* */
+
+spif_bool_t
+spif_itree_node_init(spif_itree_node_t node)
+{
+    ASSERT_RVAL(!SPIF_ITREE_NODE_ISNULL(node), FALSE);
+    node->parent = (spif_itree_node_t) NULL;
+    node->left = (spif_itree_node_t) NULL;
+    node->right = (spif_itree_node_t) NULL;
+    node->tree = (spif_itree_t) NULL;
+    node->height = 0;
+    return TRUE;
+}
+
+static spif_itree_node_t
+spif_itree_first_node(spif_itree_node_t node)
+{
+    if (node) {
+        for (; node->left; node = node->left);
+    }
+    return node;
+}
+
+static spif_itree_node_t
+spif_itree_next_node(spif_itree_node_t node)
+{
+    if (node->right) {
+        return spif_itree_first_node(node->right);
+    }
+    for (; node->parent && node == node->parent->right; node = node->parent);
+    return node->parent;
+}
+
+static void
+spif_itree_update_height(spif_itree_node_t node)
+{
+    node->height = 1 + MAX(ITREE_HEIGHT(node->left), ITREE_HEIGHT(node->right));
+}
+
+static void
+spif_itree_replace_child(spif_itree_t self, spif_itree_node_t parent, spif_itree_node_t old, spif_itree_node_t new)
+{
+    if (SPIF_ITREE_NODE_ISNULL(parent)) {
+        self->root = new;
+    } else if (parent->left == old) {
+        parent->left = new;
+    } else {
+        parent->right = new;
+    }
+    if (new) {
+        new->parent = parent;
+    }
+}
+
+static spif_itree_node_t
+spif_itree_rotate_left(spif_itree_t self, spif_itree_node_t node)
+{
+    spif_itree_node_t pivot = node->right;
+
+    node->right = pivot->left;
+    if (pivot->left) {
+        pivot->left->parent = node;
+    }
+    spif_itree_replace_child(self, node->parent, node, pivot);
+    pivot->left = node;
+    node->parent = pivot;
+    spif_itree_update_height(node);
+    spif_itree_update_height(pivot);
+    return pivot;
+}
+
+static spif_itree_node_t
+spif_itree_rotate_right(spif_itree_t self, spif_itree_node_t node)
+{
+    spif_itree_node_t pivot = node->left;
+
+    node->left = pivot->right;
+    if (pivot->right) {
+        pivot->right->parent = node;
+    }
+    spif_itree_replace_child(self, node->parent, node, pivot);
+    pivot->right = node;
+    node->parent = pivot;
+    spif_itree_update_height(node);
+    spif_itree_update_height(pivot);
+    return pivot;
+}
+
+static void
+spif_itree_rebalance(spif_itree_t self, spif_itree_node_t node)
+{
+    /* Walk from the point of change up to the root, fixing heights
+       and rotating wherever the AVL invariant has been broken. */
+    for (; node; node = node->parent) {
+        spif_int32_t balance;
+
+        spif_itree_update_height(node);
+        balance = ITREE_HEIGHT(node->left) - ITREE_HEIGHT(node->right);
+        if (balance > 1) {
+            if (ITREE_HEIGHT(node->left->left) < ITREE_HEIGHT(node->left->right)) {
+                spif_itree_rotate_left(self, node->left);
+            }
+            node = spif_itree_rotate_right(self, node);
+        } else if (balance < -1) {
+            if (ITREE_HEIGHT(node->right->right) < ITREE_HEIGHT(node->right->left)) {
+                spif_itree_rotate_right(self, node->right);
+            }
+            node = spif_itree_rotate_left(self, node);
+        }
+    }
+}
+
+/* Remove a node from whatever tree it's in.  Returns the element that
+   contains the node, or NULL if it wasn't in a tree. */
+spif_obj_t
+spif_itree_unlink(spif_itree_node_t node)
+{
+    spif_itree_t tree;
+    spif_itree_node_t start;
+
+    ASSERT_RVAL(!SPIF_ITREE_NODE_ISNULL(node), (spif_obj_t) NULL);
+    tree = node->tree;
+    REQUIRE_RVAL(!SPIF_ITREE_ISNULL(tree), (spif_obj_t) NULL);
+
+    if (SPIF_ITREE_NODE_ISNULL(node->left)) {
+        start = node->parent;
+        spif_itree_replace_child(tree, node->parent, node, node->right);
+    } else if (SPIF_ITREE_NODE_ISNULL(node->right)) {
+        start = node->parent;
+        spif_itree_replace_child(tree, node->parent, node, node->left);
+    } else {
+        spif_itree_node_t succ;
+
+        /* Two children:  splice the in-order successor into our spot. */
+        succ = spif_itree_first_node(node->right);
+        if (succ->parent == node) {
+            start = succ;
+        } else {
+            start = succ->parent;
+            spif_itree_replace_child(tree, succ->parent, succ, succ->right);
+            succ->right = node->right;
+            succ->right->parent = succ;
+        }
+        spif_itree_replace_child(tree, node->parent, node, succ);
+        succ->left = node->left;
+        succ->left->parent = succ;
+        succ->height = node->height;
+    }
+    spif_itree_rebalance(tree, start);
+    tree->len--;
+    spif_itree_node_init(node);
+    return SPIF_ITREE_OBJ_OF(tree, node);
+}
+
+static spif_itree_t
+spif_itree_new(void)
+{
+    spif_itree_t self;
+
+    self = SPIF_ALLOC(itree);
+    if (!spif_itree_init(self)) {
+        SPIF_DEALLOC(self);
+        self = (spif_itree_t) NULL;
+    }
+    return self;
+}
+
+spif_itree_t
+spif_itree_new_from_offset(size_t offset)
+{
+    spif_itree_t self;
+
+    self = SPIF_ALLOC(itree);
+    if (!spif_itree_init_from_offset(self, offset)) {
+        SPIF_DEALLOC(self);
+        self = (spif_itree_t) NULL;
+    }
+    return self;
+}
+
+static spif_bool_t
+spif_itree_init(spif_itree_t self)
+{
+    ASSERT_RVAL(!SPIF_ITREE_ISNULL(self), FALSE);
+    /* ***NOT NEEDED*** spif_obj_init(SPIF_OBJ(self)); */
+    spif_obj_set_class(SPIF_OBJ(self), SPIF_CLASS(SPIF_VECTORCLASS_VAR(itree)));
+    self->len = 0;
+    self->offset = 0;
+    self->root = (spif_itree_node_t) NULL;
+    self->elem_class = (spif_class_t) NULL;
+    self->cmp_func = (spif_cmp_func_t) NULL;
+    self->key_func = (spif_key_func_t) NULL;
+    return TRUE;
+}
+
+spif_bool_t
+spif_itree_init_from_offset(spif_itree_t self, size_t offset)
+{
+    ASSERT_RVAL(!SPIF_ITREE_ISNULL(self), FALSE);
+    /* The node can't overlap the object header. */
+    REQUIRE_RVAL(offset >= SPIF_SIZEOF_TYPE(obj), FALSE);
+    spif_itree_init(self);
+    self->offset = offset;
+    return TRUE;
+}
+
+static spif_bool_t
+spif_itree_done(spif_itree_t self)
+{
+    spif_itree_node_t current, parent;
+
+    ASSERT_RVAL(!SPIF_ITREE_ISNULL(self), FALSE);
+    /* The tree doesn't own its elements.  Cut them loose leaves-first
+       so no rebalancing is needed along the way. */
+    for (current = self->root; current; current = parent) {
+        if (current->left) {
+            parent = current->left;
+        } else if (current->right) {
+            parent = current->right;
+        } else {
+            parent = current->parent;
+            if (parent) {
+                if (parent->left == current) {
+                    parent->left = (spif_itree_node_t) NULL;
+                } else {
+                    parent->right = (spif_itree_node_t) NULL;
+                }
+            }
+            spif_itree_node_init(current);
+        }
+    }
+    self->root = (spif_itree_node_t) NULL;
+    self->len = 0;
+    return TRUE;
+}
+
+static spif_bool_t
+spif_itree_del(spif_itree_t self)
+{
+    ASSERT_RVAL(!SPIF_ITREE_ISNULL(self), FALSE);
+    spif_itree_done(self);
+    SPIF_DEALLOC(self);
+    return TRUE;
+}
+
+static spif_str_t
+spif_itree_show(spif_itree_t self, spif_charptr_t name, spif_str_t buff, size_t indent)
+{
+    spif_char_t tmp[4096];
+    spif_itree_node_t current;
+    spif_listidx_t i;
+
+    if (SPIF_ITREE_ISNULL(self)) {
+        SPIF_OBJ_SHOW_NULL_INTO(itree, name, buff, indent);
+        return buff;
+    }
+
+    buff = spif_str_show_printf(buff, indent, "(spif_itree_t) %s:  %10p (offset %lu, height %d) {\n", name, (spif_ptr_t) self,
+                                (unsigned long) self->offset, (int) ITREE_HEIGHT(self->root));
+
+    for (current = spif_itree_first_node(self->root), i = 0; current; current = spif_itree_next_node(current), i++) {
+        spif_obj_t obj = SPIF_ITREE_OBJ_OF(self, current);
+
+        sprintf((char *) tmp, "item %d", i);
+        buff = SPIF_OBJ_CALL_METHOD(obj, show)(obj, tmp, buff, indent + 2);
+    }
+
+    buff = spif_str_show_printf(buff, indent, "}\n");
+    return buff;
+}
+
+static spif_cmp_t
+spif_itree_comp(spif_itree_t self, spif_itree_t other)
+{
+    spif_itree_node_t a, b;
+
+    SPIF_OBJ_COMP_CHECK_NULL(self, other);
+    for (a = spif_itree_first_node(self->root), b = spif_itree_first_node(other->root);
+         a && b; a = spif_itree_next_node(a), b = spif_itree_next_node(b)) {
+        spif_cmp_t c;
+
+        c = SPIF_OBJ_COMP(SPIF_ITREE_OBJ_OF(self, a), SPIF_ITREE_OBJ_OF(other, b));
+        if (!SPIF_CMP_IS_EQUAL(c)) {
+            return c;
+        }
+    }
+    return SPIF_CMP_FROM_INT((int) self->len - (int) other->len);
+}
+
+static spif_itree_t
+spif_itree_dup(spif_itree_t self)
+{
+    spif_itree_t tmp;
+
+    /* An element can be in only one tree per embedded node, so a
+       duplicate tree gets the same configuration but no elements. */
+    ASSERT_RVAL(!SPIF_ITREE_ISNULL(self), (spif_itree_t) NULL);
+    tmp = spif_itree_new_from_offset(self->offset);
+    tmp->elem_class = self->elem_class;
+    tmp->cmp_func = self->cmp_func;
+    tmp->key_func = self->key_func;
+    return tmp;
+}
+
+static spif_classname_t
+spif_itree_type(spif_itree_t self)
+{
+    ASSERT_RVAL(!SPIF_ITREE_ISNULL(self), (spif_classname_t) NULL);
+    return SPIF_OBJ_CLASSNAME(self);
+}
+
+static spif_bool_t
+spif_itree_contains(spif_itree_t self, spif_obj_t obj)
+{
+    ASSERT_RVAL(!SPIF_ITREE_ISNULL(self), FALSE);
+    return ((SPIF_ITREE_NODE_ISNULL(spif_itree_find_node(self, obj))) ? (FALSE) : (TRUE));
+}
+
+static spif_listidx_t
+spif_itree_count(spif_itree_t self)
+{
+    ASSERT_RVAL(!SPIF_ITREE_ISNULL(self), FALSE);
+    return self->len;
+}
+
+static spif_itree_node_t
+spif_itree_find_node(spif_itree_t self, spif_obj_t obj)
+{
+    spif_itree_node_t current;
+
+    REQUIRE_RVAL(!SPIF_OBJ_ISNULL(obj), (spif_itree_node_t) NULL);
+    obj = SPIF_CONTAINER_PROBE_KEY(self, obj);
+    for (current = self->root; current; ) {
+        spif_cmp_t c;
+
+        c = SPIF_CONTAINER_COMP_PROBE(self, obj, SPIF_ITREE_OBJ_OF(self, current));
+        if (SPIF_CMP_IS_EQUAL(c)) {
+            break;
+        } else if (SPIF_CMP_IS_LESS(c)) {
+            current = current->left;
+        } else {
+            current = current->right;
+        }
+    }
+    return current;
+}
+
+static spif_obj_t
+spif_itree_find(spif_itree_t self, spif_obj_t obj)
+{
+    spif_itree_node_t node;
+
+    ASSERT_RVAL(!SPIF_ITREE_ISNULL(self), (spif_obj_t) NULL);
+    node = spif_itree_find_node(self, obj);
+    return ((node) ? (SPIF_ITREE_OBJ_OF(self, node)) : ((spif_obj_t) NULL));
+}
+
+static spif_bool_t
+spif_itree_insert(spif_itree_t self, spif_obj_t obj)
+{
+    spif_itree_node_t node, parent, current;
+    spif_obj_t key;
+
+    ASSERT_RVAL(!SPIF_ITREE_ISNULL(self), FALSE);
+    REQUIRE_RVAL(self->offset != 0, FALSE);
+    REQUIRE_RVAL(!SPIF_OBJ_ISNULL(obj), FALSE);
+    REQUIRE_RVAL(SPIF_CONTAINER_ACCEPTS(self, obj), FALSE);
+    node = SPIF_ITREE_NODE_OF(self, obj);
+    REQUIRE_RVAL(SPIF_ITREE_ISNULL(node->tree), FALSE);
+
+    key = SPIF_CONTAINER_PROBE_KEY(self, obj);
+    for (parent = (spif_itree_node_t) NULL, current = self->root; current; ) {
+        parent = current;
+        /* Equal elements go to the right to keep insertion order. */
+        if (SPIF_CMP_IS_LESS(SPIF_CONTAINER_COMP_PROBE(self, key, SPIF_ITREE_OBJ_OF(self, current)))) {
+            current = current->left;
+        } else {
+            current = current->right;
+        }
+    }
+
+    node->tree = self;
+    node->left = node->right = (spif_itree_node_t) NULL;
+    node->height = 1;
+    node->parent = parent;
+    if (SPIF_ITREE_NODE_ISNULL(parent)) {
+        self->root = node;
+    } else if (SPIF_CMP_IS_LESS(SPIF_CONTAINER_COMP_PROBE(self, key, SPIF_ITREE_OBJ_OF(self, parent)))) {
+        parent->left = node;
+    } else {
+        parent->right = node;
+    }
+    spif_itree_rebalance(self, parent);
+    self->len++;
+    return TRUE;
+}
+
+static spif_iterator_t
+spif_itree_iterator(spif_itree_t self)
+{
+    ASSERT_RVAL(!SPIF_ITREE_ISNULL(self), (spif_iterator_t) NULL);
+    return (spif_iterator_t) spif_itree_iterator_new(self);
+}
+
+static spif_obj_t
+spif_itree_remove(spif_itree_t self, spif_obj_t item)
+{
+    spif_itree_node_t node;
+
+    ASSERT_RVAL(!SPIF_ITREE_ISNULL(self), (spif_obj_t) NULL);
+    node = spif_itree_find_node(self, item);
+    if (SPIF_ITREE_NODE_ISNULL(node)) {
+        return (spif_obj_t) NULL;
+    }
+    return spif_itree_unlink(node);
+}
+
+spif_bool_t
+spif_itree_set_comparator(spif_itree_t self, spif_class_t cls, spif_cmp_func_t cmp, spif_key_func_t key)
+{
+    ASSERT_RVAL(!SPIF_ITREE_ISNULL(self), FALSE);
+    REQUIRE_RVAL(self->len == 0, FALSE);
+    REQUIRE_RVAL((key == (spif_key_func_t) NULL) || (cls != (spif_class_t) NULL), FALSE);
+    self->elem_class = cls;
+    self->cmp_func = cmp;
+    self->key_func = key;
+    return TRUE;
+}
+
+static spif_obj_t *
+spif_itree_to_array(spif_itree_t self)
+{
+    spif_obj_t *tmp;
+    spif_itree_node_t current;
+    spif_listidx_t i;
+
+    ASSERT_RVAL(!SPIF_ITREE_ISNULL(self), (spif_obj_t *) NULL);
+    tmp = (spif_obj_t *) MALLOC(SPIF_SIZEOF_TYPE(obj) * self->len);
+    for (i = 0, current = spif_itree_first_node(self->root); current; current = spif_itree_next_node(current), i++) {
+        tmp[i] = SPIF_ITREE_OBJ_OF(self, current);
+    }
+    return tmp;
+}
+
+
+static spif_itree_iterator_t
+spif_itree_iterator_new(spif_itree_t subject)
+{
+    spif_itree_iterator_t self;
+
+    self = SPIF_ALLOC(itree_iterator);
+    if (!spif_itree_iterator_init(self, subject)) {
+        SPIF_DEALLOC(self);
+        self = (spif_itree_iterator_t) NULL;
+    }
+    return self;
+}
+
+static spif_bool_t
+spif_itree_iterator_init(spif_itree_iterator_t self, spif_itree_t subject)
+{
+    ASSERT_RVAL(!SPIF_ITERATOR_ISNULL(self), FALSE);
+    /* ***NOT NEEDED*** spif_obj_init(SPIF_OBJ(self)); */
+    spif_obj_set_class(SPIF_OBJ(self), SPIF_CLASS(SPIF_ITERATORCLASS_VAR(itree)));
+    self->subject = subject;
+    if (SPIF_ITREE_ISNULL(self->subject)) {
+        self->current = (spif_itree_node_t) NULL;
+    } else {
+        self->current = spif_itree_first_node(self->subject->root);
+    }
+    return TRUE;
+}
+
+static spif_bool_t
+spif_itree_iterator_done(spif_itree_iterator_t self)
+{
+    ASSERT_RVAL(!SPIF_ITERATOR_ISNULL(self), FALSE);
+    self->subject = (spif_itree_t) NULL;
+    self->current = (spif_itree_node_t) NULL;
+    return TRUE;
+}
+
+static spif_bool_t
+spif_itree_iterator_del(spif_itree_iterator_t self)
+{
+    ASSERT_RVAL(!SPIF_ITERATOR_ISNULL(self), FALSE);
+    spif_itree_iterator_done(self);
+    SPIF_DEALLOC(self);
+    return TRUE;
+}
+
+static spif_str_t
+spif_itree_iterator_show(spif_itree_iterator_t self, spif_charptr_t name, spif_str_t buff, size_t indent)
+{
+    if (SPIF_ITERATOR_ISNULL(self)) {
+        SPIF_OBJ_SHOW_NULL_INTO(iterator, name, buff, indent);
+        return buff;
+    }
+
+    buff = spif_str_show_printf(buff, indent, "(spif_itree_iterator_t) %s:  %10p {\n", name,
+                                (spif_ptr_t) self);
+
+    buff = spif_itree_show(self->subject, (spif_charptr_t) "subject", buff, indent + 2);
+    buff = spif_str_show_printf(buff, indent + 2, "(spif_itree_node_t) current:  %10p\n", (spif_ptr_t) self->current);
+
+    buff = spif_str_show_printf(buff, indent, "}\n");
+    return buff;
+}
+
+static spif_cmp_t
+spif_itree_iterator_comp(spif_itree_iterator_t self, spif_itree_iterator_t other)
+{
+    return spif_itree_comp(self->subject, other->subject);
+}
+
+static spif_itree_iterator_t
+spif_itree_iterator_dup(spif_itree_iterator_t self)
+{
+    spif_itree_iterator_t tmp;
+
+    ASSERT_RVAL(!SPIF_ITERATOR_ISNULL(self), (spif_itree_iterator_t) NULL);
+    tmp = spif_itree_iterator_new(self->subject);
+    tmp->current = self->current;
+    return tmp;
+}
+
+static spif_classname_t
+spif_itree_iterator_type(spif_itree_iterator_t self)
+{
+    ASSERT_RVAL(!SPIF_ITERATOR_ISNULL(self), (spif_classname_t) NULL);
+    return SPIF_OBJ_CLASSNAME(self);
+}
+
+static spif_bool_t
+spif_itree_iterator_has_next(spif_itree_iterator_t self)
+{
+    ASSERT_RVAL(!SPIF_ITERATOR_ISNULL(self), FALSE);
+    REQUIRE_RVAL(!SPIF_ITREE_ISNULL(self->subject), FALSE);
+    return ((self->current) ? (TRUE) : (FALSE));
+}
+
+static spif_obj_t
+spif_itree_iterator_next(spif_itree_iterator_t self)
+{
+    spif_obj_t tmp;
+
+    ASSERT_RVAL(!SPIF_ITERATOR_ISNULL(self), (spif_obj_t) NULL);
+    REQUIRE_RVAL(!SPIF_ITREE_ISNULL(self->subject), (spif_obj_t) NULL);
+    REQUIRE_RVAL(!SPIF_ITREE_NODE_ISNULL(self->current), (spif_obj_t) NULL);
+    tmp = SPIF_ITREE_OBJ_OF(self->subject, self->current);
+    self->current = spif_itree_next_node(self->current);
+    return tmp;
+}
@@ -0,0 +1,389 @@
+/*
+ * Copyright (C) 1997-2013, Michael Jennings <mej@eterm.org>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies of the Software, its documentation and marketing & publicity
+ * materials, and acknowledgment shall be given in the documentation, materials
+ * and software packages that this Software was used.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <libast_internal.h>
+
+/* *INDENT-OFF* */
+static SPIF_CONST_TYPE(class) lr_class = {
+    SPIF_DECL_CLASSNAME(linereader),
+    (spif_func_t) spif_linereader_new,
+    (spif_func_t) spif_linereader_init,
+    (spif_func_t) spif_linereader_done,
+    (spif_func_t) spif_linereader_del,
+    (spif_func_t) spif_linereader_show,
+    (spif_func_t) spif_linereader_comp,
+    (spif_func_t) spif_linereader_dup,
+    (spif_func_t) spif_linereader_type
+};
+SPIF_TYPE(class) SPIF_CLASS_VAR(linereader) = &lr_class;
+/* *INDENT-ON* */
+
+static const size_t buff_init = 65536;
+
+static spif_int64_t spif_linereader_fill(spif_linereader_t);
+
+spif_linereader_t
+spif_linereader_new(void)
+{
+    spif_linereader_t self;
+
+    self = SPIF_ALLOC(linereader);
+    if (!spif_linereader_init(self)) {
+        SPIF_DEALLOC(self);
+        self = (spif_linereader_t) NULL;
+    }
+    return self;
+}
+
+spif_linereader_t
+spif_linereader_new_from_fd(int fd)
+{
+    spif_linereader_t self;
+
+    self = SPIF_ALLOC(linereader);
+    if (!spif_linereader_init_from_fd(self, fd)) {
+        SPIF_DEALLOC(self);
+        self = (spif_linereader_t) NULL;
+    }
+    return self;
+}
+
+spif_linereader_t
+spif_linereader_new_from_fp(FILE *fp)
+{
+    spif_linereader_t self;
+
+    self = SPIF_ALLOC(linereader);
+    if (!spif_linereader_init_from_fp(self, fp)) {
+        SPIF_DEALLOC(self);
+        self = (spif_linereader_t) NULL;
+    }
+    return self;
+}
+
+spif_linereader_t
+spif_linereader_new_from_file(spif_charptr_t path)
+{
+    spif_linereader_t self;
+
+    self = SPIF_ALLOC(linereader);
+    if (!spif_linereader_init_from_file(self, path)) {
+        SPIF_DEALLOC(self);
+        self = (spif_linereader_t) NULL;
+    }
+    return self;
+}
+
+spif_bool_t
+spif_linereader_init(spif_linereader_t self)
+{
+    ASSERT_RVAL(!SPIF_LINEREADER_ISNULL(self), FALSE);
+    if (!spif_obj_init(SPIF_OBJ(self))) {
+        return FALSE;
+    }
+    spif_obj_set_class(SPIF_OBJ(self), SPIF_CLASS_VAR(linereader));
+    self->fd = -1;
+    self->fp = (FILE *) NULL;
+    self->lineno = 0;
+    self->buff = (spif_byteptr_t) NULL;
+    self->size = 0;
+    self->start = 0;
+    self->end = 0;
+    self->eof = TRUE;
+    self->owned = FALSE;
+    return TRUE;
+}
+
+spif_bool_t
+spif_linereader_init_from_fd(spif_linereader_t self, int fd)
+{
+    ASSERT_RVAL(!SPIF_LINEREADER_ISNULL(self), FALSE);
+    ASSERT_RVAL((fd >= 0), FALSE);
+    if (!spif_linereader_init(self)) {
+        return FALSE;
+    }
+    self->fd = fd;
+    self->size = buff_init;
+    self->buff = (spif_byteptr_t) MALLOC(self->size);
+    self->eof = FALSE;
+    return TRUE;
+}
+
+spif_bool_t
+spif_linereader_init_from_fp(spif_linereader_t self, FILE *fp)
+{
+    ASSERT_RVAL(!SPIF_LINEREADER_ISNULL(self), FALSE);
+    ASSERT_RVAL((fp != (FILE *) NULL), FALSE);
+    if (!spif_linereader_init(self)) {
+        return FALSE;
+    }
+    self->fp = fp;
+    self->size = buff_init;
+    self->buff = (spif_byteptr_t) MALLOC(self->size);
+    self->eof = FALSE;
+    return TRUE;
+}
+
+spif_bool_t
+spif_linereader_init_from_file(spif_linereader_t self, spif_charptr_t path)
+{
+    int fd;
+
+    ASSERT_RVAL(!SPIF_LINEREADER_ISNULL(self), FALSE);
+    REQUIRE_RVAL((path != NULL), FALSE);
+    if ((fd = open((const char *) path, O_RDONLY)) < 0) {
+        return FALSE;
+    }
+    if (!spif_linereader_init_from_fd(self, fd)) {
+        close(fd);
+        return FALSE;
+    }
+    self->owned = TRUE;
+    return TRUE;
+}
+
+spif_bool_t
+spif_linereader_done(spif_linereader_t self)
+{
+    ASSERT_RVAL(!SPIF_LINEREADER_ISNULL(self), FALSE);
+    if (self->owned && (self->fd >= 0)) {
+        close(self->fd);
+    }
+    if (self->buff) {
+        FREE(self->buff);
+    }
+    self->fd = -1;
+    self->fp = (FILE *) NULL;
+    self->size = 0;
+    self->start = 0;
+    self->end = 0;
+    self->eof = TRUE;
+    self->owned = FALSE;
+    return TRUE;
+}
+
+spif_bool_t
+spif_linereader_del(spif_linereader_t self)
+{
+    ASSERT_RVAL(!SPIF_LINEREADER_ISNULL(self), FALSE);
+    spif_linereader_done(self);
+    SPIF_DEALLOC(self);
+    return TRUE;
+}
+
+spif_str_t
+spif_linereader_show(spif_linereader_t self, spif_charptr_t name, spif_str_t buff, size_t indent)
+{
+    if (SPIF_LINEREADER_ISNULL(self)) {
+        SPIF_OBJ_SHOW_NULL_INTO(linereader, name, buff, indent);
+        return buff;
+    }
+
+    buff = spif_str_show_printf(buff, indent, "(spif_linereader_t) %s:  %10p { fd %d, fp %10p, line %lu, %lu/%lu bytes buffered%s }\n",
+                                name, (spif_ptr_t) self, self->fd, (spif_ptr_t) self->fp, (unsigned long) self->lineno,
+                                (unsigned long) (self->end - self->start), (unsigned long) self->size,
+                                ((self->eof) ? (", EOF") : ("")));
+    return buff;
+}
+
+spif_cmp_t
+spif_linereader_comp(spif_linereader_t self, spif_linereader_t other)
+{
+    return spif_obj_comp(SPIF_OBJ(self), SPIF_OBJ(other));
+}
+
+/* The copy shares the same descriptor or stream (without owning it)
+   and starts with a copy of whatever is currently buffered. */
+spif_linereader_t
+spif_linereader_dup(spif_linereader_t self)
+{
+    spif_linereader_t tmp;
+
+    ASSERT_RVAL(!SPIF_LINEREADER_ISNULL(self), (spif_linereader_t) NULL);
+    tmp = spif_linereader_new();
+    tmp->fd = self->fd;
+    tmp->fp = self->fp;
+    tmp->lineno = self->lineno;
+    tmp->eof = self->eof;
+    if (self->buff) {
+        tmp->size = self->size;
+        tmp->buff = (spif_byteptr_t) MALLOC(tmp->size);
+        tmp->end = self->end - self->start;
+        memcpy(tmp->buff, self->buff + self->start, tmp->end);
+    }
+    return tmp;
+}
+
+spif_classname_t
+spif_linereader_type(spif_linereader_t self)
+{
+    ASSERT_RVAL(!SPIF_LINEREADER_ISNULL(self), (spif_classname_t) NULL);
+    return SPIF_OBJ_CLASSNAME(self);
+}
+
+/* Read more data into the buffer after the unconsumed bytes, growing
+   the buffer if a single line has filled all of it.  One byte is
+   always left free so the last line can be terminated in place.
+   Returns the number of bytes read, 0 at EOF, or -1 on error (which
+   also ends input, except for EAGAIN on a non-blocking descriptor). */
+static spif_int64_t
+spif_linereader_fill(spif_linereader_t self)
+{
+    spif_memidx_t avail;
+    ssize_t n;
+
+    if (self->start) {
+        memmove(self->buff, self->buff + self->start, self->end - self->start);
+        self->end -= self->start;
+        self->start = 0;
+    }
+    if (self->end + 1 >= self->size) {
+        self->size *= 2;
+        self->buff = (spif_byteptr_t) REALLOC(self->buff, self->size);
+    }
+    avail = self->size - self->end - 1;
+
+    if (self->fp) {
+        n = fread(self->buff + self->end, 1, avail, self->fp);
+        if (!n && ferror(self->fp)) {
+            n = -1;
+        }
+    } else {
+        do {
+            n = read(self->fd, self->buff + self->end, avail);
+        } while ((n < 0) && (errno == EINTR));
+    }
+
+    if (n > 0) {
+        self->end += n;
+    } else if (!n) {
+        self->eof = TRUE;
+    } else if ((errno != EAGAIN) && (errno != EWOULDBLOCK)) {
+        libast_print_warning("read failed:  %s.\n", strerror(errno));
+        self->eof = TRUE;
+    }
+    return (spif_int64_t) n;
+}
+
+/**
+ * Return the next line.
+ *
+ * Finds the next line, refilling the buffer as needed, and stores a
+ * pointer to it and its length (not counting the stripped LF or CR/LF)
+ * in @a line and @a len.  The line is NUL-terminated in place and
+ * stays valid until the next call on this reader.  The final line of
+ * the input need not end with a newline.
+ *
+ * @param self The line reader.
+ * @param line Where to store a pointer to the line.
+ * @param len  Where to store the length of the line.
+ * @return     TRUE if a line was returned, FALSE at EOF, on a read
+ *             error, or when a non-blocking descriptor has no complete
+ *             line available yet.
+ */
+spif_bool_t
+spif_linereader_next(spif_linereader_t self, spif_charptr_t *line, spif_memidx_t *len)
+{
+    spif_byteptr_t p, nl;
+    spif_memidx_t scanned, next;
+
+    ASSERT_RVAL(!SPIF_LINEREADER_ISNULL(self), FALSE);
+    ASSERT_RVAL(!SPIF_PTR_ISNULL(line), FALSE);
+    ASSERT_RVAL(!SPIF_PTR_ISNULL(len), FALSE);
+    REQUIRE_RVAL(self->buff != NULL, FALSE);
+
+    /* scanned counts the bytes past start already known to have no LF,
+       so each byte is only searched once however often we refill. */
+    for (scanned = 0;;) {
+        p = self->buff + self->start;
+        nl = (spif_byteptr_t) memchr(p + scanned, '\n', self->end - self->start - scanned);
+        if (nl) {
+            next = nl - self->buff + 1;
+            break;
+        } else if (self->eof) {
+            if (self->start == self->end) {
+                return FALSE;
+            }
+            nl = self->buff + self->end;
+            next = self->end;
+            break;
+        }
+        scanned = self->end - self->start;
+        if ((spif_linereader_fill(self) < 0) && !self->eof) {
+            return FALSE;
+        }
+    }
+
+    if ((nl > p) && (nl[-1] == '\r')) {
+        nl--;
+    }
+    *nl = 0;
+    *line = SPIF_CHARPTR(p);
+    *len = nl - p;
+    self->start = next;
+    self->lineno++;
+    return TRUE;
+}
+
+/**
+ * Copy the next line into a string.
+ *
+ * Like spif_linereader_next(), but replaces the contents of @a str
+ * with the line.  Passing the same string for every line lets its
+ * buffer be reused rather than allocating a new string per line.
+ *
+ * @param self The line reader.
+ * @param str  The string to store the line in.
+ * @return     TRUE if a line was returned, FALSE otherwise.
+ */
+spif_bool_t
+spif_linereader_next_str(spif_linereader_t self, spif_str_t str)
+{
+    spif_charptr_t line;
+    spif_memidx_t len;
+
+    ASSERT_RVAL(!SPIF_LINEREADER_ISNULL(self), FALSE);
+    ASSERT_RVAL(!SPIF_STR_ISNULL(str), FALSE);
+    if (!spif_linereader_next(self, &line, &len)) {
+        return FALSE;
+    }
+    if (str->s) {
+        str->len = 0;
+        *(str->s) = 0;
+    }
+    return spif_str_append_buff(str, line, len);
+}
+
+spif_bool_t
+spif_linereader_eof(spif_linereader_t self)
+{
+    ASSERT_RVAL(!SPIF_LINEREADER_ISNULL(self), TRUE);
+    return ((self->eof && (self->start == self->end)) ? (TRUE) : (FALSE));
+}
+
+SPIF_DEFINE_PROPERTY_FUNC_C(linereader, spif_memidx_t, lineno)
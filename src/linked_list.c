@@ -254,22 +254,13 @@ spif_linked_list_item_del(spif_linked_list_item_t self)
 static spif_str_t
 spif_linked_list_item_show(spif_linked_list_item_t self, spif_charptr_t name, spif_str_t buff, size_t indent)
 {
-    spif_char_t tmp[4096];
-
     if (SPIF_LINKED_LIST_ITEM_ISNULL(self)) {
-        SPIF_OBJ_SHOW_NULL(linked_list_item, name, buff, indent, tmp);
+        SPIF_OBJ_SHOW_NULL_INTO(linked_list_item, name, buff, indent);
         return buff;
     }
 
-    memset(tmp, ' ', indent);
-    snprintf((char *) tmp + indent, sizeof(tmp) - indent,
-             "(spif_linked_list_item_t) %s (%9p -> %9p):  ",
-             name, (spif_ptr_t) self, (spif_ptr_t) self->next);
-    if (SPIF_STR_ISNULL(buff)) {
-        buff = spif_str_new_from_ptr(tmp);
-    } else {
-        spif_str_append_from_ptr(buff, tmp);
-    }
+    buff = spif_str_show_printf(buff, indent, "(spif_linked_list_item_t) %s (%9p -> %9p):  ",
+                                name, (spif_ptr_t) self, (spif_ptr_t) self->next);
     if (SPIF_LINKED_LIST_ITEM_ISNULL(self->data)) {
         spif_str_append_from_ptr(buff, (spif_charptr_t) SPIF_NULLSTR_TYPE(obj) "\n");
     } else {
@@ -359,6 +350,9 @@ spif_linked_list_init(spif_linked_list_t self)
     t = spif_obj_set_class(SPIF_OBJ(self), SPIF_CLASS(SPIF_LISTCLASS_VAR(linked_list)));
     self->len = 0;
     self->head = (spif_linked_list_item_t) NULL;
+    self->elem_class = (spif_class_t) NULL;
+    self->cmp_func = (spif_cmp_func_t) NULL;
+    self->key_func = (spif_key_func_t) NULL;
     return t;
 }
 
@@ -372,6 +366,9 @@ spif_linked_list_vector_init(spif_linked_list_t self)
     t = spif_obj_set_class(SPIF_OBJ(self), SPIF_CLASS(SPIF_VECTORCLASS_VAR(linked_list)));
     self->len = 0;
     self->head = (spif_linked_list_item_t) NULL;
+    self->elem_class = (spif_class_t) NULL;
+    self->cmp_func = (spif_cmp_func_t) NULL;
+    self->key_func = (spif_key_func_t) NULL;
     return t;
 }
 
@@ -385,6 +382,9 @@ spif_linked_list_map_init(spif_linked_list_t self)
     t = spif_obj_set_class(SPIF_OBJ(self), SPIF_CLASS(SPIF_MAPCLASS_VAR(linked_list)));
     self->len = 0;
     self->head = (spif_linked_list_item_t) NULL;
+    self->elem_class = (spif_class_t) NULL;
+    self->cmp_func = (spif_cmp_func_t) NULL;
+    self->key_func = (spif_key_func_t) NULL;
     return t;
 }
 
@@ -425,22 +425,14 @@ spif_linked_list_show(spif_linked_list_t self, spif_charptr_t name, spif_str_t b
     spif_listidx_t i;
 
     if (SPIF_LIST_ISNULL(self)) {
-        SPIF_OBJ_SHOW_NULL(linked_list, name, buff, indent, tmp);
+        SPIF_OBJ_SHOW_NULL_INTO(linked_list, name, buff, indent);
         return buff;
     }
 
-    memset(tmp, ' ', indent);
-    snprintf((char *) tmp + indent, sizeof(tmp) - indent,
-             "(spif_linked_list_t) %s:  %10p {\n", name, (spif_ptr_t) self);
-    if (SPIF_STR_ISNULL(buff)) {
-        buff = spif_str_new_from_ptr(tmp);
-    } else {
-        spif_str_append_from_ptr(buff, tmp);
-    }
+    buff = spif_str_show_printf(buff, indent, "(spif_linked_list_t) %s:  %10p {\n", name, (spif_ptr_t) self);
 
-    snprintf((char *) tmp + indent, sizeof(tmp) - indent, "  len:  %lu\n",
-             (unsigned long) self->len);
-    spif_str_append_from_ptr(buff, tmp);
+    buff = spif_str_show_printf(buff, indent, "  len:  %lu\n",
+                                (unsigned long) self->len);
 
     if (SPIF_LINKED_LIST_ITEM_ISNULL(self->head)) {
         spif_str_append_from_ptr(buff, (spif_charptr_t) SPIF_NULLSTR_TYPE(obj) "\n");
@@ -451,9 +443,7 @@ spif_linked_list_show(spif_linked_list_t self, spif_charptr_t name, spif_str_t b
         }
     }
 
-    memset(tmp, ' ', indent);
-    snprintf((char *) tmp + indent, sizeof(tmp) - indent, "}\n");
-    spif_str_append_from_ptr(buff, tmp);
+    buff = spif_str_show_printf(buff, indent, "}\n");
     return buff;
 }
 
@@ -529,6 +519,7 @@ spif_linked_list_append(spif_linked_list_t self, spif_obj_t obj)
     spif_linked_list_item_t item, current;
 
     ASSERT_RVAL(!SPIF_LIST_ISNULL(self), FALSE);
+    REQUIRE_RVAL(SPIF_CONTAINER_ACCEPTS(self, obj), FALSE);
     /* Create list member object "item" */
     item = spif_linked_list_item_new();
     spif_linked_list_item_set_data(item, obj);
@@ -573,9 +564,10 @@ spif_linked_list_find(spif_linked_list_t self, spif_obj_t obj)
 
     ASSERT_RVAL(!SPIF_LIST_ISNULL(self), (spif_obj_t) NULL);
     REQUIRE_RVAL(!SPIF_OBJ_ISNULL(obj), (spif_obj_t) NULL);
+    obj = SPIF_CONTAINER_PROBE_KEY(self, obj);
     for (current = self->head; current; current = current->next) {
         /* current->data may be NULL here, so use obj methods. */
-        if (SPIF_CMP_IS_EQUAL(SPIF_OBJ_COMP(obj, current->data))) {
+        if (SPIF_CMP_IS_EQUAL(SPIF_CONTAINER_COMP_PROBE(self, obj, current->data))) {
             return current->data;
         }
     }
@@ -589,12 +581,13 @@ spif_linked_list_vector_find(spif_linked_list_t self, spif_obj_t obj)
 
     ASSERT_RVAL(!SPIF_VECTOR_ISNULL(self), (spif_obj_t) NULL);
     REQUIRE_RVAL(!SPIF_OBJ_ISNULL(obj), (spif_obj_t) NULL);
+    obj = SPIF_CONTAINER_PROBE_KEY(self, obj);
     for (current = self->head; current; current = current->next) {
         spif_cmp_t c;
 
         /* current->data is always non-NULL in vectors. */
         ASSERT_RVAL(!SPIF_OBJ_ISNULL(current->data), (spif_obj_t) NULL);
-        c = SPIF_OBJ_COMP(current->data, obj);
+        c = SPIF_CONTAINER_COMP(self, current->data, obj);
         if (SPIF_CMP_IS_EQUAL(c)) {
             return current->data;
         } else if (SPIF_CMP_IS_GREATER(c)) {
@@ -628,12 +621,13 @@ spif_linked_list_map_get(spif_linked_list_t self, spif_obj_t key)
 
     ASSERT_RVAL(!SPIF_VECTOR_ISNULL(self), (spif_obj_t) NULL);
     REQUIRE_RVAL(!SPIF_OBJ_ISNULL(key), (spif_obj_t) NULL);
+    key = SPIF_CONTAINER_PROBE_KEY(self, key);
     for (current = self->head; current; current = current->next) {
         spif_cmp_t c;
 
         /* current->data is always non-NULL in maps. */
         ASSERT_RVAL(!SPIF_OBJ_ISNULL(current->data), (spif_obj_t) NULL);
-        c = SPIF_OBJ_COMP(current->data, key);
+        c = SPIF_CONTAINER_COMP(self, current->data, key);
         if (SPIF_CMP_IS_EQUAL(c)) {
             return SPIF_OBJPAIR(current->data)->value;
         } else if (SPIF_CMP_IS_GREATER(c)) {
@@ -725,7 +719,8 @@ spif_linked_list_index(spif_linked_list_t self, spif_obj_t obj)
     spif_linked_list_item_t current;
 
     ASSERT_RVAL(!SPIF_LIST_ISNULL(self), (spif_listidx_t) -1);
-    for (current = self->head, i = 0; current && !SPIF_CMP_IS_EQUAL(SPIF_OBJ_COMP(obj, current->data)); i++, current = current->next);
+    obj = SPIF_CONTAINER_PROBE_KEY(self, obj);
+    for (current = self->head, i = 0; current && !SPIF_CMP_IS_EQUAL(SPIF_CONTAINER_COMP_PROBE(self, obj, current->data)); i++, current = current->next);
     return (current ? i : ((spif_listidx_t) -1));
 }
 
@@ -733,19 +728,23 @@ static spif_bool_t
 spif_linked_list_insert(spif_linked_list_t self, spif_obj_t obj)
 {
     spif_linked_list_item_t item, current;
+    spif_obj_t key;
 
     ASSERT_RVAL(!SPIF_LIST_ISNULL(self), FALSE);
+    REQUIRE_RVAL(!SPIF_OBJ_ISNULL(obj), FALSE);
+    REQUIRE_RVAL(SPIF_CONTAINER_ACCEPTS(self, obj), FALSE);
     item = spif_linked_list_item_new();
     spif_linked_list_item_set_data(item, obj);
 
+    key = SPIF_CONTAINER_PROBE_KEY(self, obj);
     if (SPIF_LINKED_LIST_ITEM_ISNULL(self->head)) {
         self->head = item;
-    } else if (SPIF_CMP_IS_LESS(spif_linked_list_item_comp(item, self->head))) {
+    } else if (SPIF_CMP_IS_LESS(SPIF_CONTAINER_COMP_PROBE(self, key, self->head->data))) {
         item->next = self->head;
         self->head = item;
     } else {
         for (current = self->head;
-             current->next && SPIF_CMP_IS_GREATER(spif_linked_list_item_comp(item, current->next));
+             current->next && SPIF_CMP_IS_GREATER(SPIF_CONTAINER_COMP_PROBE(self, key, current->next->data));
              current = current->next);
         item->next = current->next;
         current->next = item;
@@ -766,6 +765,7 @@ spif_linked_list_insert_at(spif_linked_list_t self, spif_obj_t obj, spif_listidx
         idx += self->len;
     }
     REQUIRE_RVAL((idx + 1) >= 0, FALSE);
+    REQUIRE_RVAL(SPIF_CONTAINER_ACCEPTS(self, obj), FALSE);
 
     if (idx == 0 || SPIF_LINKED_LIST_ITEM_ISNULL(self->head)) {
         return spif_linked_list_prepend(self, obj);
@@ -797,6 +797,7 @@ spif_linked_list_prepend(spif_linked_list_t self, spif_obj_t obj)
     spif_linked_list_item_t item, current;
 
     ASSERT_RVAL(!SPIF_LIST_ISNULL(self), FALSE);
+    REQUIRE_RVAL(SPIF_CONTAINER_ACCEPTS(self, obj), FALSE);
     /* Create list member object "item" */
     item = spif_linked_list_item_new();
     spif_linked_list_item_set_data(item, obj);
@@ -817,13 +818,14 @@ spif_linked_list_remove(spif_linked_list_t self, spif_obj_t item)
 
     ASSERT_RVAL(!SPIF_LIST_ISNULL(self), (spif_obj_t) NULL);
     REQUIRE_RVAL(!SPIF_OBJ_ISNULL(item), (spif_obj_t) NULL);
+    item = SPIF_CONTAINER_PROBE_KEY(self, item);
     if (SPIF_LINKED_LIST_ITEM_ISNULL(self->head)) {
         return (spif_obj_t) NULL;
-    } else if (SPIF_CMP_IS_EQUAL(SPIF_OBJ_COMP(item, self->head->data))) {
+    } else if (SPIF_CMP_IS_EQUAL(SPIF_CONTAINER_COMP_PROBE(self, item, self->head->data))) {
         tmp = self->head;
         self->head = self->head->next;
     } else {
-        for (current = self->head; current->next && !SPIF_CMP_IS_EQUAL(SPIF_OBJ_COMP(item, current->next->data)); current = current->next);
+        for (current = self->head; current->next && !SPIF_CMP_IS_EQUAL(SPIF_CONTAINER_COMP_PROBE(self, item, current->next->data)); current = current->next);
         if (current->next) {
             tmp = current->next;
             current->next = current->next->next;
@@ -846,13 +848,14 @@ spif_linked_list_map_remove(spif_linked_list_t self, spif_obj_t item)
 
     ASSERT_RVAL(!SPIF_LIST_ISNULL(self), (spif_obj_t) NULL);
     REQUIRE_RVAL(!SPIF_OBJ_ISNULL(item), (spif_obj_t) NULL);
+    item = SPIF_CONTAINER_PROBE_KEY(self, item);
     if (SPIF_LINKED_LIST_ITEM_ISNULL(self->head)) {
         return (spif_obj_t) NULL;
-    } else if (SPIF_CMP_IS_EQUAL(SPIF_OBJ_COMP(self->head->data, item))) {
+    } else if (SPIF_CMP_IS_EQUAL(SPIF_CONTAINER_COMP(self, self->head->data, item))) {
         tmp = self->head;
         self->head = self->head->next;
     } else {
-        for (current = self->head; current->next && !SPIF_CMP_IS_EQUAL(SPIF_OBJ_COMP(current->next->data, item)); current = current->next);
+        for (current = self->head; current->next && !SPIF_CMP_IS_EQUAL(SPIF_CONTAINER_COMP(self, current->next->data, item)); current = current->next);
         if (current->next) {
             tmp = current->next;
             current->next = current->next->next;
@@ -931,7 +934,7 @@ spif_linked_list_set(spif_linked_list_t self, spif_obj_t key, spif_obj_t value)
         key = SPIF_OBJ(SPIF_OBJPAIR(key)->key);
     }
     for (current = self->head; current; current = current->next) {
-        if (SPIF_CMP_IS_EQUAL(SPIF_OBJ_COMP(current->data, key))) {
+        if (SPIF_CMP_IS_EQUAL(SPIF_CONTAINER_COMP(self, current->data, key))) {
             break;
         }
     }
@@ -945,6 +948,18 @@ spif_linked_list_set(spif_linked_list_t self, spif_obj_t key, spif_obj_t value)
     }
 }
 
+spif_bool_t
+spif_linked_list_set_comparator(spif_linked_list_t self, spif_class_t cls, spif_cmp_func_t cmp, spif_key_func_t key)
+{
+    ASSERT_RVAL(!SPIF_LIST_ISNULL(self), FALSE);
+    REQUIRE_RVAL(self->len == 0, FALSE);
+    REQUIRE_RVAL((key == (spif_key_func_t) NULL) || (cls != (spif_class_t) NULL), FALSE);
+    self->elem_class = cls;
+    self->cmp_func = cmp;
+    self->key_func = key;
+    return TRUE;
+}
+
 static spif_obj_t *
 spif_linked_list_to_array(spif_linked_list_t self)
 {
@@ -1014,28 +1029,18 @@ spif_linked_list_iterator_del(spif_linked_list_iterator_t self)
 static spif_str_t
 spif_linked_list_iterator_show(spif_linked_list_iterator_t self, spif_charptr_t name, spif_str_t buff, size_t indent)
 {
-    spif_char_t tmp[4096];
-
     if (SPIF_ITERATOR_ISNULL(self)) {
-        SPIF_OBJ_SHOW_NULL(iterator, name, buff, indent, tmp);
+        SPIF_OBJ_SHOW_NULL_INTO(iterator, name, buff, indent);
         return buff;
     }
 
-    memset(tmp, ' ', indent);
-    snprintf((char *) tmp + indent, sizeof(tmp) - indent,
-             "(spif_linked_list_iterator_t) %s:  %10p {\n",
-             name, (spif_ptr_t) self);
-    if (SPIF_STR_ISNULL(buff)) {
-        buff = spif_str_new_from_ptr(tmp);
-    } else {
-        spif_str_append_from_ptr(buff, tmp);
-    }
+    buff = spif_str_show_printf(buff, indent, "(spif_linked_list_iterator_t) %s:  %10p {\n",
+                                name, (spif_ptr_t) self);
 
     buff = spif_linked_list_show(self->subject, (spif_charptr_t) "subject", buff, indent + 2);
     buff = spif_linked_list_item_show(self->current, (spif_charptr_t) "current", buff, indent + 2);
 
-    snprintf((char *) tmp + indent, sizeof(tmp) - indent, "}\n");
-    spif_str_append_from_ptr(buff, tmp);
+    buff = spif_str_show_printf(buff, indent, "}\n");
     return buff;
 }
 
@@ -0,0 +1,641 @@
+/*
+ * Copyright (C) 1997-2013, Michael Jennings <mej@eterm.org>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies of the Software, its documentation and marketing & publicity
+ * materials, and acknowledgment shall be given in the documentation, materials
+ * and software packages that this Software was used.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <libast_internal.h>
+
+#define LRU_INITIAL_BUCKETS     16
+#define LRU_SHARD(c, h)         (((c)->nshards) ? ((c)->shards[((h) >> 16) % (c)->nshards]) : (c))
+#define LRU_LOCK(c)             do {if (!SPIF_PTHREADS_MUTEX_ISNULL((c)->lock)) {spif_pthreads_mutex_lock((c)->lock);}} while (0)
+#define LRU_UNLOCK(c)           do {if (!SPIF_PTHREADS_MUTEX_ISNULL((c)->lock)) {spif_pthreads_mutex_unlock((c)->lock);}} while (0)
+#define LRU_OVER_BUDGET(c)      ((((c)->max_count) && ((c)->len > (c)->max_count)) \
+                                 || (((c)->max_bytes) && ((c)->bytes > (c)->max_bytes)))
+
+/* *INDENT-OFF* */
+SPIF_DECL_OBJ_STRUCT(lru_entry) {
+    spif_lru_entry_t prev;
+    spif_lru_entry_t next;
+    spif_lru_entry_t chain;
+    spif_uint32_t hash;
+    spif_memidx_t size;
+    spif_obj_t key;
+    spif_obj_t value;
+};
+
+static SPIF_CONST_TYPE(class) lc_class = {
+    SPIF_DECL_CLASSNAME(lru_cache),
+    (spif_func_t) spif_lru_cache_new,
+    (spif_func_t) spif_lru_cache_init,
+    (spif_func_t) spif_lru_cache_done,
+    (spif_func_t) spif_lru_cache_del,
+    (spif_func_t) spif_lru_cache_show,
+    (spif_func_t) spif_lru_cache_comp,
+    (spif_func_t) spif_lru_cache_dup,
+    (spif_func_t) spif_lru_cache_type
+};
+SPIF_TYPE(class) SPIF_CLASS_VAR(lru_cache) = &lc_class;
+/* *INDENT-ON* */
+
+static spif_lru_entry_t spif_lru_cache_find(spif_lru_cache_t, spif_uint32_t, spif_obj_t);
+static void spif_lru_cache_unlink(spif_lru_cache_t, spif_lru_entry_t);
+static void spif_lru_cache_link_head(spif_lru_cache_t, spif_lru_entry_t);
+static void spif_lru_cache_drop(spif_lru_cache_t, spif_lru_entry_t);
+static void spif_lru_cache_grow(spif_lru_cache_t);
+static void spif_lru_cache_evict(spif_lru_cache_t, spif_lru_entry_t);
+static spif_bool_t spif_lru_cache_put_hashed(spif_lru_cache_t, spif_uint32_t, spif_obj_t, spif_obj_t);
+static spif_obj_t spif_lru_cache_remove_hashed(spif_lru_cache_t, spif_uint32_t, spif_obj_t);
+static spif_bool_t spif_lru_cache_copy_entries(spif_lru_cache_t, spif_lru_cache_t);
+
+spif_lru_cache_t
+spif_lru_cache_new(void)
+{
+    spif_lru_cache_t self;
+
+    self = SPIF_ALLOC(lru_cache);
+    if (!spif_lru_cache_init(self)) {
+        SPIF_DEALLOC(self);
+        self = (spif_lru_cache_t) NULL;
+    }
+    return self;
+}
+
+spif_lru_cache_t
+spif_lru_cache_new_with_limits(spif_listidx_t max_count, spif_memidx_t max_bytes)
+{
+    spif_lru_cache_t self;
+
+    self = SPIF_ALLOC(lru_cache);
+    if (!spif_lru_cache_init_with_limits(self, max_count, max_bytes)) {
+        SPIF_DEALLOC(self);
+        self = (spif_lru_cache_t) NULL;
+    }
+    return self;
+}
+
+spif_lru_cache_t
+spif_lru_cache_new_sharded(spif_uint32_t nshards, spif_listidx_t max_count, spif_memidx_t max_bytes)
+{
+    spif_lru_cache_t self;
+
+    self = SPIF_ALLOC(lru_cache);
+    if (!spif_lru_cache_init_sharded(self, nshards, max_count, max_bytes)) {
+        SPIF_DEALLOC(self);
+        self = (spif_lru_cache_t) NULL;
+    }
+    return self;
+}
+
+spif_bool_t
+spif_lru_cache_init(spif_lru_cache_t self)
+{
+    return spif_lru_cache_init_with_limits(self, 0, 0);
+}
+
+spif_bool_t
+spif_lru_cache_init_with_limits(spif_lru_cache_t self, spif_listidx_t max_count, spif_memidx_t max_bytes)
+{
+    ASSERT_RVAL(!SPIF_LRU_CACHE_ISNULL(self), FALSE);
+    REQUIRE_RVAL(max_count >= 0, FALSE);
+    REQUIRE_RVAL(max_bytes >= 0, FALSE);
+    if (!spif_obj_init(SPIF_OBJ(self))) {
+        return FALSE;
+    }
+    spif_obj_set_class(SPIF_OBJ(self), SPIF_CLASS_VAR(lru_cache));
+    self->len = 0;
+    self->max_count = max_count;
+    self->bytes = 0;
+    self->max_bytes = max_bytes;
+    self->hash_func = spif_hamt_hash_default;
+    self->size_func = (spif_lru_cache_size_func_t) NULL;
+    self->evict_func = (spif_lru_cache_evict_func_t) NULL;
+    self->evict_data = (spif_ptr_t) NULL;
+    self->hits = 0;
+    self->misses = 0;
+    self->evictions = 0;
+    self->lock = (spif_pthreads_mutex_t) NULL;
+    self->mask = LRU_INITIAL_BUCKETS - 1;
+    self->buckets = (spif_lru_entry_t *) CALLOC(spif_lru_entry_t, LRU_INITIAL_BUCKETS);
+    self->head = (spif_lru_entry_t) NULL;
+    self->tail = (spif_lru_entry_t) NULL;
+    self->nshards = 0;
+    self->shards = (spif_lru_cache_t *) NULL;
+    return TRUE;
+}
+
+spif_bool_t
+spif_lru_cache_init_sharded(spif_lru_cache_t self, spif_uint32_t nshards, spif_listidx_t max_count,
+                            spif_memidx_t max_bytes)
+{
+    spif_uint32_t i;
+
+    ASSERT_RVAL(!SPIF_LRU_CACHE_ISNULL(self), FALSE);
+    REQUIRE_RVAL(nshards > 0, FALSE);
+    if (!spif_lru_cache_init_with_limits(self, max_count, max_bytes)) {
+        return FALSE;
+    }
+    /* The shards hold the entries; this object only routes to them. */
+    FREE(self->buckets);
+    self->mask = 0;
+    self->nshards = nshards;
+    self->shards = (spif_lru_cache_t *) CALLOC(spif_lru_cache_t, nshards);
+    for (i = 0; i < nshards; i++) {
+        self->shards[i] = spif_lru_cache_new_with_limits((max_count + nshards - 1) / nshards,
+                                                         (max_bytes + nshards - 1) / nshards);
+        self->shards[i]->lock = spif_pthreads_mutex_new();
+    }
+    return TRUE;
+}
+
+spif_bool_t
+spif_lru_cache_done(spif_lru_cache_t self)
+{
+    spif_uint32_t i;
+
+    ASSERT_RVAL(!SPIF_LRU_CACHE_ISNULL(self), FALSE);
+    if (self->shards) {
+        for (i = 0; i < self->nshards; i++) {
+            spif_lru_cache_del(self->shards[i]);
+        }
+        FREE(self->shards);
+        self->nshards = 0;
+    } else {
+        spif_lru_cache_clear(self);
+    }
+    if (self->buckets) {
+        FREE(self->buckets);
+    }
+    if (!SPIF_PTHREADS_MUTEX_ISNULL(self->lock)) {
+        spif_pthreads_mutex_del(self->lock);
+        self->lock = (spif_pthreads_mutex_t) NULL;
+    }
+    self->mask = 0;
+    return TRUE;
+}
+
+spif_bool_t
+spif_lru_cache_del(spif_lru_cache_t self)
+{
+    ASSERT_RVAL(!SPIF_LRU_CACHE_ISNULL(self), FALSE);
+    spif_lru_cache_done(self);
+    SPIF_DEALLOC(self);
+    return TRUE;
+}
+
+spif_str_t
+spif_lru_cache_show(spif_lru_cache_t self, spif_charptr_t name, spif_str_t buff, size_t indent)
+{
+    spif_uint64_t hits, misses, evictions;
+    spif_memidx_t bytes;
+    spif_uint32_t i;
+
+    if (SPIF_LRU_CACHE_ISNULL(self)) {
+        SPIF_OBJ_SHOW_NULL_INTO(lru_cache, name, buff, indent);
+        return buff;
+    }
+
+    spif_lru_cache_get_stats(self, &hits, &misses, &evictions);
+    for (bytes = self->bytes, i = 0; i < self->nshards; i++) {
+        bytes += self->shards[i]->bytes;
+    }
+    buff = spif_str_show_printf(buff, indent, "(spif_lru_cache_t) %s:  %10p { %lu/%lu entries, %lu/%lu bytes, %lu shards, "
+                                "%lu hits, %lu misses, %lu evictions }\n",
+                                name, (spif_ptr_t) self, (unsigned long) spif_lru_cache_count(self), (unsigned long) self->max_count,
+                                (unsigned long) bytes, (unsigned long) self->max_bytes, (unsigned long) self->nshards,
+                                (unsigned long) hits, (unsigned long) misses, (unsigned long) evictions);
+    return buff;
+}
+
+spif_cmp_t
+spif_lru_cache_comp(spif_lru_cache_t self, spif_lru_cache_t other)
+{
+    return spif_obj_comp(SPIF_OBJ(self), SPIF_OBJ(other));
+}
+
+spif_lru_cache_t
+spif_lru_cache_dup(spif_lru_cache_t self)
+{
+    spif_lru_cache_t tmp;
+    spif_uint32_t i;
+
+    ASSERT_RVAL(!SPIF_LRU_CACHE_ISNULL(self), (spif_lru_cache_t) NULL);
+    if (self->shards) {
+        tmp = spif_lru_cache_new_sharded(self->nshards, self->max_count, self->max_bytes);
+        spif_lru_cache_set_funcs(tmp, self->hash_func, self->size_func, self->evict_func, self->evict_data);
+        for (i = 0; i < self->nshards; i++) {
+            LRU_LOCK(self->shards[i]);
+            spif_lru_cache_copy_entries(tmp, self->shards[i]);
+            LRU_UNLOCK(self->shards[i]);
+        }
+    } else {
+        tmp = spif_lru_cache_new_with_limits(self->max_count, self->max_bytes);
+        spif_lru_cache_set_funcs(tmp, self->hash_func, self->size_func, self->evict_func, self->evict_data);
+        LRU_LOCK(self);
+        spif_lru_cache_copy_entries(tmp, self);
+        LRU_UNLOCK(self);
+    }
+    return tmp;
+}
+
+spif_classname_t
+spif_lru_cache_type(spif_lru_cache_t self)
+{
+    ASSERT_RVAL(!SPIF_LRU_CACHE_ISNULL(self), (spif_classname_t) NULL);
+    return SPIF_OBJ_CLASSNAME(self);
+}
+
+spif_bool_t
+spif_lru_cache_set_funcs(spif_lru_cache_t self, spif_hash_func_t hash_func, spif_lru_cache_size_func_t size_func,
+                         spif_lru_cache_evict_func_t evict_func, spif_ptr_t evict_data)
+{
+    spif_uint32_t i;
+
+    ASSERT_RVAL(!SPIF_LRU_CACHE_ISNULL(self), FALSE);
+    /* Entries already stored were hashed and sized the old way. */
+    REQUIRE_RVAL(spif_lru_cache_count(self) == 0, FALSE);
+    self->hash_func = ((hash_func) ? (hash_func) : (spif_hamt_hash_default));
+    self->size_func = size_func;
+    self->evict_func = evict_func;
+    self->evict_data = evict_data;
+    for (i = 0; i < self->nshards; i++) {
+        spif_lru_cache_set_funcs(self->shards[i], hash_func, size_func, evict_func, evict_data);
+    }
+    return TRUE;
+}
+
+spif_bool_t
+spif_lru_cache_put(spif_lru_cache_t self, spif_obj_t key, spif_obj_t value)
+{
+    spif_lru_cache_t shard;
+    spif_uint32_t hash;
+    spif_bool_t ret;
+
+    ASSERT_RVAL(!SPIF_LRU_CACHE_ISNULL(self), FALSE);
+    REQUIRE_RVAL(!SPIF_OBJ_ISNULL(key), FALSE);
+    REQUIRE_RVAL(SPIF_HAMT_CAN_HASH(self->hash_func, key), FALSE);
+    hash = self->hash_func(key);
+    shard = LRU_SHARD(self, hash);
+    LRU_LOCK(shard);
+    ret = spif_lru_cache_put_hashed(shard, hash, key, value);
+    LRU_UNLOCK(shard);
+    return ret;
+}
+
+spif_obj_t
+spif_lru_cache_get(spif_lru_cache_t self, spif_obj_t key)
+{
+    spif_lru_cache_t shard;
+    spif_lru_entry_t entry;
+    spif_uint32_t hash;
+    spif_obj_t value = (spif_obj_t) NULL;
+
+    ASSERT_RVAL(!SPIF_LRU_CACHE_ISNULL(self), (spif_obj_t) NULL);
+    REQUIRE_RVAL(!SPIF_OBJ_ISNULL(key), (spif_obj_t) NULL);
+    REQUIRE_RVAL(SPIF_HAMT_CAN_HASH(self->hash_func, key), (spif_obj_t) NULL);
+    hash = self->hash_func(key);
+    shard = LRU_SHARD(self, hash);
+    LRU_LOCK(shard);
+    entry = spif_lru_cache_find(shard, hash, key);
+    if (entry) {
+        shard->hits++;
+        spif_lru_cache_unlink(shard, entry);
+        spif_lru_cache_link_head(shard, entry);
+        value = entry->value;
+    } else {
+        shard->misses++;
+    }
+    LRU_UNLOCK(shard);
+    return value;
+}
+
+spif_obj_t
+spif_lru_cache_get_dup(spif_lru_cache_t self, spif_obj_t key)
+{
+    spif_lru_cache_t shard;
+    spif_lru_entry_t entry;
+    spif_uint32_t hash;
+    spif_obj_t value = (spif_obj_t) NULL;
+
+    ASSERT_RVAL(!SPIF_LRU_CACHE_ISNULL(self), (spif_obj_t) NULL);
+    REQUIRE_RVAL(!SPIF_OBJ_ISNULL(key), (spif_obj_t) NULL);
+    REQUIRE_RVAL(SPIF_HAMT_CAN_HASH(self->hash_func, key), (spif_obj_t) NULL);
+    hash = self->hash_func(key);
+    shard = LRU_SHARD(self, hash);
+    LRU_LOCK(shard);
+    entry = spif_lru_cache_find(shard, hash, key);
+    if (entry) {
+        shard->hits++;
+        spif_lru_cache_unlink(shard, entry);
+        spif_lru_cache_link_head(shard, entry);
+        if (!SPIF_OBJ_ISNULL(entry->value)) {
+            value = SPIF_OBJ_DUP(entry->value);
+        }
+    } else {
+        shard->misses++;
+    }
+    LRU_UNLOCK(shard);
+    return value;
+}
+
+spif_obj_t
+spif_lru_cache_peek(spif_lru_cache_t self, spif_obj_t key)
+{
+    spif_lru_cache_t shard;
+    spif_lru_entry_t entry;
+    spif_uint32_t hash;
+
+    /* No change to recency or counters. */
+    ASSERT_RVAL(!SPIF_LRU_CACHE_ISNULL(self), (spif_obj_t) NULL);
+    REQUIRE_RVAL(!SPIF_OBJ_ISNULL(key), (spif_obj_t) NULL);
+    REQUIRE_RVAL(SPIF_HAMT_CAN_HASH(self->hash_func, key), (spif_obj_t) NULL);
+    hash = self->hash_func(key);
+    shard = LRU_SHARD(self, hash);
+    LRU_LOCK(shard);
+    entry = spif_lru_cache_find(shard, hash, key);
+    LRU_UNLOCK(shard);
+    return ((entry) ? (entry->value) : ((spif_obj_t) NULL));
+}
+
+spif_obj_t
+spif_lru_cache_remove(spif_lru_cache_t self, spif_obj_t key)
+{
+    spif_lru_cache_t shard;
+    spif_uint32_t hash;
+    spif_obj_t value;
+
+    ASSERT_RVAL(!SPIF_LRU_CACHE_ISNULL(self), (spif_obj_t) NULL);
+    REQUIRE_RVAL(!SPIF_OBJ_ISNULL(key), (spif_obj_t) NULL);
+    REQUIRE_RVAL(SPIF_HAMT_CAN_HASH(self->hash_func, key), (spif_obj_t) NULL);
+    hash = self->hash_func(key);
+    shard = LRU_SHARD(self, hash);
+    LRU_LOCK(shard);
+    value = spif_lru_cache_remove_hashed(shard, hash, key);
+    LRU_UNLOCK(shard);
+    return value;
+}
+
+spif_bool_t
+spif_lru_cache_clear(spif_lru_cache_t self)
+{
+    spif_lru_entry_t entry;
+    spif_uint32_t i;
+
+    ASSERT_RVAL(!SPIF_LRU_CACHE_ISNULL(self), FALSE);
+    for (i = 0; i < self->nshards; i++) {
+        spif_lru_cache_clear(self->shards[i]);
+    }
+    LRU_LOCK(self);
+    for (; self->head; self->head = entry) {
+        entry = self->head->next;
+        if (!SPIF_OBJ_ISNULL(self->head->key)) {
+            SPIF_OBJ_DEL(self->head->key);
+        }
+        if (!SPIF_OBJ_ISNULL(self->head->value)) {
+            SPIF_OBJ_DEL(self->head->value);
+        }
+        FREE(self->head);
+    }
+    if (self->buckets) {
+        memset(self->buckets, 0, sizeof(spif_lru_entry_t) * (self->mask + 1));
+    }
+    self->tail = (spif_lru_entry_t) NULL;
+    self->len = 0;
+    self->bytes = 0;
+    LRU_UNLOCK(self);
+    return TRUE;
+}
+
+spif_listidx_t
+spif_lru_cache_count(spif_lru_cache_t self)
+{
+    spif_listidx_t count;
+    spif_uint32_t i;
+
+    ASSERT_RVAL(!SPIF_LRU_CACHE_ISNULL(self), 0);
+    for (count = self->len, i = 0; i < self->nshards; i++) {
+        count += self->shards[i]->len;
+    }
+    return count;
+}
+
+spif_bool_t
+spif_lru_cache_get_stats(spif_lru_cache_t self, spif_uint64_t *hits, spif_uint64_t *misses, spif_uint64_t *evictions)
+{
+    spif_uint64_t h, m, e;
+    spif_uint32_t i;
+
+    ASSERT_RVAL(!SPIF_LRU_CACHE_ISNULL(self), FALSE);
+    h = self->hits;
+    m = self->misses;
+    e = self->evictions;
+    for (i = 0; i < self->nshards; i++) {
+        LRU_LOCK(self->shards[i]);
+        h += self->shards[i]->hits;
+        m += self->shards[i]->misses;
+        e += self->shards[i]->evictions;
+        LRU_UNLOCK(self->shards[i]);
+    }
+    if (hits) {
+        *hits = h;
+    }
+    if (misses) {
+        *misses = m;
+    }
+    if (evictions) {
+        *evictions = e;
+    }
+    return TRUE;
+}
+
+static spif_lru_entry_t
+spif_lru_cache_find(spif_lru_cache_t self, spif_uint32_t hash, spif_obj_t key)
+{
+    spif_lru_entry_t entry;
+
+    for (entry = self->buckets[hash & self->mask]; entry; entry = entry->chain) {
+        if (entry->hash == hash && SPIF_CMP_IS_EQUAL(SPIF_OBJ_COMP(entry->key, key))) {
+            break;
+        }
+    }
+    return entry;
+}
+
+static void
+spif_lru_cache_unlink(spif_lru_cache_t self, spif_lru_entry_t entry)
+{
+    if (entry->prev) {
+        entry->prev->next = entry->next;
+    } else {
+        self->head = entry->next;
+    }
+    if (entry->next) {
+        entry->next->prev = entry->prev;
+    } else {
+        self->tail = entry->prev;
+    }
+    entry->prev = entry->next = (spif_lru_entry_t) NULL;
+}
+
+static void
+spif_lru_cache_link_head(spif_lru_cache_t self, spif_lru_entry_t entry)
+{
+    entry->prev = (spif_lru_entry_t) NULL;
+    entry->next = self->head;
+    if (self->head) {
+        self->head->prev = entry;
+    } else {
+        self->tail = entry;
+    }
+    self->head = entry;
+}
+
+/* Take an entry out of the table and recency list, leaving the key and
+   value for the caller. */
+static void
+spif_lru_cache_drop(spif_lru_cache_t self, spif_lru_entry_t entry)
+{
+    spif_lru_entry_t *link;
+
+    for (link = &self->buckets[entry->hash & self->mask]; *link != entry; link = &(*link)->chain);
+    *link = entry->chain;
+    spif_lru_cache_unlink(self, entry);
+    self->len--;
+    self->bytes -= entry->size;
+}
+
+static void
+spif_lru_cache_grow(spif_lru_cache_t self)
+{
+    spif_lru_entry_t *buckets, entry, next;
+    spif_uint32_t i, mask;
+
+    mask = (self->mask << 1) | 1;
+    buckets = (spif_lru_entry_t *) CALLOC(spif_lru_entry_t, mask + 1);
+    for (i = 0; i <= self->mask; i++) {
+        for (entry = self->buckets[i]; entry; entry = next) {
+            next = entry->chain;
+            entry->chain = buckets[entry->hash & mask];
+            buckets[entry->hash & mask] = entry;
+        }
+    }
+    FREE(self->buckets);
+    self->buckets = buckets;
+    self->mask = mask;
+}
+
+/* Evict from the cold end until back within budget, sparing keep. */
+static void
+spif_lru_cache_evict(spif_lru_cache_t self, spif_lru_entry_t keep)
+{
+    spif_lru_entry_t entry;
+
+    while (LRU_OVER_BUDGET(self) && self->tail && self->tail != keep) {
+        entry = self->tail;
+        if (self->evict_func) {
+            self->evict_func(entry->key, entry->value, self->evict_data);
+        }
+        spif_lru_cache_drop(self, entry);
+        self->evictions++;
+        if (!SPIF_OBJ_ISNULL(entry->key)) {
+            SPIF_OBJ_DEL(entry->key);
+        }
+        if (!SPIF_OBJ_ISNULL(entry->value)) {
+            SPIF_OBJ_DEL(entry->value);
+        }
+        FREE(entry);
+    }
+}
+
+static spif_bool_t
+spif_lru_cache_put_hashed(spif_lru_cache_t self, spif_uint32_t hash, spif_obj_t key, spif_obj_t value)
+{
+    spif_lru_entry_t entry;
+    spif_memidx_t size;
+
+    size = ((self->size_func) ? (self->size_func(key, value)) : (1));
+    if (self->max_bytes && size > self->max_bytes) {
+        /* Can never fit; don't leave a stale value behind either. */
+        value = spif_lru_cache_remove_hashed(self, hash, key);
+        if (!SPIF_OBJ_ISNULL(value)) {
+            SPIF_OBJ_DEL(value);
+        }
+        return FALSE;
+    }
+
+    entry = spif_lru_cache_find(self, hash, key);
+    if (entry) {
+        spif_lru_cache_unlink(self, entry);
+        if (!SPIF_OBJ_ISNULL(entry->value)) {
+            SPIF_OBJ_DEL(entry->value);
+        }
+        self->bytes -= entry->size;
+    } else {
+        entry = (spif_lru_entry_t) MALLOC(SPIF_SIZEOF_TYPE(lru_entry));
+        entry->hash = hash;
+        entry->key = SPIF_OBJ_DUP(key);
+        entry->chain = self->buckets[hash & self->mask];
+        self->buckets[hash & self->mask] = entry;
+        if ((spif_uint32_t) ++self->len > self->mask) {
+            spif_lru_cache_grow(self);
+        }
+    }
+    entry->value = ((SPIF_OBJ_ISNULL(value)) ? ((spif_obj_t) NULL) : (SPIF_OBJ_DUP(value)));
+    entry->size = size;
+    self->bytes += size;
+    spif_lru_cache_link_head(self, entry);
+    spif_lru_cache_evict(self, entry);
+    return TRUE;
+}
+
+static spif_obj_t
+spif_lru_cache_remove_hashed(spif_lru_cache_t self, spif_uint32_t hash, spif_obj_t key)
+{
+    spif_lru_entry_t entry;
+    spif_obj_t value;
+
+    entry = spif_lru_cache_find(self, hash, key);
+    if (!entry) {
+        return (spif_obj_t) NULL;
+    }
+    spif_lru_cache_drop(self, entry);
+    value = entry->value;
+    if (!SPIF_OBJ_ISNULL(entry->key)) {
+        SPIF_OBJ_DEL(entry->key);
+    }
+    FREE(entry);
+    return value;
+}
+
+/* Copy from's entries into self, coldest first, so recency survives. */
+static spif_bool_t
+spif_lru_cache_copy_entries(spif_lru_cache_t self, spif_lru_cache_t from)
+{
+    spif_lru_entry_t entry;
+
+    for (entry = from->tail; entry; entry = entry->prev) {
+        spif_lru_cache_put(self, entry->key, entry->value);
+    }
+    return TRUE;
+}
@@ -0,0 +1,570 @@
+/*
+ * Copyright (C) 1997-2013, Michael Jennings <mej@eterm.org>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies of the Software, its documentation and marketing & publicity
+ * materials, and acknowledgment shall be given in the documentation, materials
+ * and software packages that this Software was used.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <libast_internal.h>
+
+/* *INDENT-OFF* */
+SPIF_DECL_OBJ(mapview_iterator) {
+    SPIF_DECL_PARENT_TYPE(obj);
+    spif_mapview_t subject;
+    spif_iterator_t it;
+};
+/* *INDENT-ON* */
+
+static spif_mapview_t spif_mapview_new(void);
+static spif_bool_t spif_mapview_init(spif_mapview_t);
+static spif_bool_t spif_mapview_done(spif_mapview_t);
+static spif_bool_t spif_mapview_del(spif_mapview_t);
+static spif_str_t spif_mapview_show(spif_mapview_t, spif_charptr_t, spif_str_t, size_t);
+static spif_cmp_t spif_mapview_comp(spif_mapview_t, spif_mapview_t);
+static spif_mapview_t spif_mapview_dup(spif_mapview_t);
+static spif_classname_t spif_mapview_type(spif_mapview_t);
+static spif_bool_t spif_mapview_append(spif_mapview_t, spif_obj_t);
+static spif_bool_t spif_mapview_contains(spif_mapview_t, spif_obj_t);
+static spif_listidx_t spif_mapview_count(spif_mapview_t);
+static spif_obj_t spif_mapview_find(spif_mapview_t, spif_obj_t);
+static spif_obj_t spif_mapview_get(spif_mapview_t, spif_listidx_t);
+static spif_listidx_t spif_mapview_index(spif_mapview_t, spif_obj_t);
+static spif_bool_t spif_mapview_insert(spif_mapview_t, spif_obj_t);
+static spif_bool_t spif_mapview_insert_at(spif_mapview_t, spif_obj_t, spif_listidx_t);
+static spif_iterator_t spif_mapview_iterator(spif_mapview_t);
+static spif_bool_t spif_mapview_prepend(spif_mapview_t, spif_obj_t);
+static spif_obj_t spif_mapview_remove(spif_mapview_t, spif_obj_t);
+static spif_obj_t spif_mapview_remove_at(spif_mapview_t, spif_listidx_t);
+static spif_bool_t spif_mapview_reverse(spif_mapview_t);
+static spif_obj_t *spif_mapview_to_array(spif_mapview_t);
+static spif_obj_t spif_mapview_project(spif_mapview_t, spif_obj_t);
+static spif_obj_t spif_mapview_scan(spif_mapview_t, spif_obj_t, spif_listidx_t *);
+static spif_mapview_iterator_t spif_mapview_iterator_new(spif_mapview_t subject);
+static spif_bool_t spif_mapview_iterator_init(spif_mapview_iterator_t self, spif_mapview_t subject);
+static spif_bool_t spif_mapview_iterator_done(spif_mapview_iterator_t self);
+static spif_bool_t spif_mapview_iterator_del(spif_mapview_iterator_t self);
+static spif_str_t spif_mapview_iterator_show(spif_mapview_iterator_t self, spif_charptr_t name, spif_str_t buff, size_t indent);
+static spif_cmp_t spif_mapview_iterator_comp(spif_mapview_iterator_t self, spif_mapview_iterator_t other);
+static spif_mapview_iterator_t spif_mapview_iterator_dup(spif_mapview_iterator_t self);
+static spif_classname_t spif_mapview_iterator_type(spif_mapview_iterator_t self);
+static spif_bool_t spif_mapview_iterator_has_next(spif_mapview_iterator_t self);
+static spif_obj_t spif_mapview_iterator_next(spif_mapview_iterator_t self);
+
+/* *INDENT-OFF* */
+static spif_const_listclass_t mv_class = {
+    {
+        SPIF_DECL_CLASSNAME(mapview),
+        (spif_func_t) spif_mapview_new,
+        (spif_func_t) spif_mapview_init,
+        (spif_func_t) spif_mapview_done,
+        (spif_func_t) spif_mapview_del,
+        (spif_func_t) spif_mapview_show,
+        (spif_func_t) spif_mapview_comp,
+        (spif_func_t) spif_mapview_dup,
+        (spif_func_t) spif_mapview_type
+    },
+    (spif_func_t) spif_mapview_append,
+    (spif_func_t) spif_mapview_contains,
+    (spif_func_t) spif_mapview_count,
+    (spif_func_t) spif_mapview_find,
+    (spif_func_t) spif_mapview_get,
+    (spif_func_t) spif_mapview_index,
+    (spif_func_t) spif_mapview_insert,
+    (spif_func_t) spif_mapview_insert_at,
+    (spif_func_t) spif_mapview_iterator,
+    (spif_func_t) spif_mapview_prepend,
+    (spif_func_t) spif_mapview_remove,
+    (spif_func_t) spif_mapview_remove_at,
+    (spif_func_t) spif_mapview_reverse,
+    (spif_func_t) spif_mapview_to_array
+};
+spif_listclass_t SPIF_LISTCLASS_VAR(mapview) = &mv_class;
+
+static spif_const_iteratorclass_t mvi_class = {
+    {
+        SPIF_DECL_CLASSNAME(mapview),
+        (spif_func_t) spif_mapview_iterator_new,
+        (spif_func_t) spif_mapview_iterator_init,
+        (spif_func_t) spif_mapview_iterator_done,
+        (spif_func_t) spif_mapview_iterator_del,
+        (spif_func_t) spif_mapview_iterator_show,
+        (spif_func_t) spif_mapview_iterator_comp,
+        (spif_func_t) spif_mapview_iterator_dup,
+        (spif_func_t) spif_mapview_iterator_type
+    },
+    (spif_func_t) spif_mapview_iterator_has_next,
+    (spif_func_t) spif_mapview_iterator_next
+};
+spif_iteratorclass_t SPIF_ITERATORCLASS_VAR(mapview) = &mvi_class;
+/* *INDENT-ON* */
+
+static spif_mapview_t
+spif_mapview_new(void)
+{
+    spif_mapview_t self;
+
+    self = SPIF_ALLOC(mapview);
+    if (!spif_mapview_init(self)) {
+        SPIF_DEALLOC(self);
+        self = (spif_mapview_t) NULL;
+    }
+    return self;
+}
+
+spif_mapview_t
+spif_mapview_new_from_map(spif_map_t subject, spif_uint8_t what)
+{
+    spif_mapview_t self;
+
+    self = SPIF_ALLOC(mapview);
+    if (!spif_mapview_init_from_map(self, subject, what)) {
+        SPIF_DEALLOC(self);
+        self = (spif_mapview_t) NULL;
+    }
+    return self;
+}
+
+static spif_bool_t
+spif_mapview_init(spif_mapview_t self)
+{
+    ASSERT_RVAL(!SPIF_MAPVIEW_ISNULL(self), FALSE);
+    if (!spif_obj_init(SPIF_OBJ(self))) {
+        return FALSE;
+    } else if (!spif_obj_set_class(SPIF_OBJ(self), SPIF_CLASS(SPIF_LISTCLASS_VAR(mapview)))) {
+        return FALSE;
+    }
+    self->subject = (spif_map_t) NULL;
+    self->what = SPIF_MAPVIEW_KEYS;
+    return TRUE;
+}
+
+spif_bool_t
+spif_mapview_init_from_map(spif_mapview_t self, spif_map_t subject, spif_uint8_t what)
+{
+    ASSERT_RVAL(!SPIF_MAPVIEW_ISNULL(self), FALSE);
+    REQUIRE_RVAL(!SPIF_MAP_ISNULL(subject), FALSE);
+    REQUIRE_RVAL(what <= SPIF_MAPVIEW_PAIRS, FALSE);
+    if (!spif_mapview_init(self)) {
+        return FALSE;
+    }
+    self->subject = subject;
+    self->what = what;
+    return TRUE;
+}
+
+static spif_bool_t
+spif_mapview_done(spif_mapview_t self)
+{
+    ASSERT_RVAL(!SPIF_MAPVIEW_ISNULL(self), FALSE);
+    /* The map is only borrowed, so there is nothing to free. */
+    self->subject = (spif_map_t) NULL;
+    self->what = SPIF_MAPVIEW_KEYS;
+    return TRUE;
+}
+
+static spif_bool_t
+spif_mapview_del(spif_mapview_t self)
+{
+    spif_bool_t t;
+
+    ASSERT_RVAL(!SPIF_MAPVIEW_ISNULL(self), FALSE);
+    t = spif_mapview_done(self);
+    SPIF_DEALLOC(self);
+    return t;
+}
+
+static spif_str_t
+spif_mapview_show(spif_mapview_t self, spif_charptr_t name, spif_str_t buff, size_t indent)
+{
+    if (SPIF_MAPVIEW_ISNULL(self)) {
+        SPIF_OBJ_SHOW_NULL_INTO(mapview, name, buff, indent);
+        return buff;
+    }
+
+    buff = spif_str_show_printf(buff, indent, "(spif_mapview_t) %s:  %10p {\n", name, (spif_ptr_t) self);
+
+    buff = spif_str_show_printf(buff, indent + 2, "(spif_uint8_t) what:  %s\n",
+                                ((self->what == SPIF_MAPVIEW_KEYS) ? ("keys")
+                                 : ((self->what == SPIF_MAPVIEW_VALUES) ? ("values") : ("pairs"))));
+
+    if (SPIF_MAP_ISNULL(self->subject)) {
+        SPIF_OBJ_SHOW_NULL_INTO(map, "subject", buff, indent + 2);
+    } else {
+        buff = SPIF_OBJ_CALL_METHOD(self->subject, show)(self->subject, (spif_charptr_t) "subject", buff, indent + 2);
+    }
+
+    buff = spif_str_show_printf(buff, indent, "}\n");
+    return buff;
+}
+
+static spif_cmp_t
+spif_mapview_comp(spif_mapview_t self, spif_mapview_t other)
+{
+    SPIF_OBJ_COMP_CHECK_NULL(self, other);
+    if (self->what != other->what) {
+        return SPIF_CMP_FROM_INT((int) self->what - (int) other->what);
+    }
+    SPIF_OBJ_COMP_CHECK_NULL(self->subject, other->subject);
+    return SPIF_MAP_COMP(self->subject, other->subject);
+}
+
+static spif_mapview_t
+spif_mapview_dup(spif_mapview_t self)
+{
+    ASSERT_RVAL(!SPIF_MAPVIEW_ISNULL(self), (spif_mapview_t) NULL);
+    return spif_mapview_new_from_map(self->subject, self->what);
+}
+
+static spif_classname_t
+spif_mapview_type(spif_mapview_t self)
+{
+    ASSERT_RVAL(!SPIF_MAPVIEW_ISNULL(self), (spif_classname_t) NULL);
+    return SPIF_OBJ_CLASSNAME(self);
+}
+
+static spif_bool_t
+spif_mapview_append(spif_mapview_t self, spif_obj_t obj)
+{
+    /* Views are read-only. */
+    USE_VAR(self);
+    USE_VAR(obj);
+    return FALSE;
+}
+
+static spif_bool_t
+spif_mapview_contains(spif_mapview_t self, spif_obj_t obj)
+{
+    ASSERT_RVAL(!SPIF_MAPVIEW_ISNULL(self), FALSE);
+    return ((SPIF_OBJ_ISNULL(spif_mapview_find(self, obj))) ? (FALSE) : (TRUE));
+}
+
+static spif_listidx_t
+spif_mapview_count(spif_mapview_t self)
+{
+    ASSERT_RVAL(!SPIF_MAPVIEW_ISNULL(self), (spif_listidx_t) 0);
+    REQUIRE_RVAL(!SPIF_MAP_ISNULL(self->subject), (spif_listidx_t) 0);
+    return (spif_listidx_t) SPIF_MAP_COUNT(self->subject);
+}
+
+static spif_obj_t
+spif_mapview_find(spif_mapview_t self, spif_obj_t obj)
+{
+    ASSERT_RVAL(!SPIF_MAPVIEW_ISNULL(self), (spif_obj_t) NULL);
+    REQUIRE_RVAL(!SPIF_OBJ_ISNULL(obj), (spif_obj_t) NULL);
+    return spif_mapview_scan(self, obj, (spif_listidx_t *) NULL);
+}
+
+static spif_obj_t
+spif_mapview_get(spif_mapview_t self, spif_listidx_t idx)
+{
+    spif_iterator_t it;
+    spif_listidx_t i, len;
+    spif_obj_t tmp;
+
+    ASSERT_RVAL(!SPIF_MAPVIEW_ISNULL(self), (spif_obj_t) NULL);
+    REQUIRE_RVAL(!SPIF_MAP_ISNULL(self->subject), (spif_obj_t) NULL);
+    len = (spif_listidx_t) SPIF_MAP_COUNT(self->subject);
+    if (idx < 0) {
+        /* Negative indexes go backward from the end of the list. */
+        idx += len;
+    }
+    REQUIRE_RVAL(idx >= 0, (spif_obj_t) NULL);
+    REQUIRE_RVAL(idx < len, (spif_obj_t) NULL);
+
+    if (SPIF_OBJ_CLASS(self->subject) == SPIF_CLASS(SPIF_MAPCLASS_VAR(array))) {
+        /* Arrays can be indexed directly. */
+        return spif_mapview_project(self, SPIF_ARRAY(self->subject)->items[idx]);
+    }
+
+    /* Everything else has to be walked. */
+    it = SPIF_MAP_ITERATOR(self->subject);
+    REQUIRE_RVAL(!SPIF_ITERATOR_ISNULL(it), (spif_obj_t) NULL);
+    for (i = 0; i < idx && SPIF_ITERATOR_HAS_NEXT(it); i++) {
+        SPIF_ITERATOR_NEXT(it);
+    }
+    tmp = ((SPIF_ITERATOR_HAS_NEXT(it)) ? (SPIF_ITERATOR_NEXT(it)) : ((spif_obj_t) NULL));
+    SPIF_ITERATOR_DEL(it);
+    return spif_mapview_project(self, tmp);
+}
+
+static spif_listidx_t
+spif_mapview_index(spif_mapview_t self, spif_obj_t obj)
+{
+    spif_listidx_t idx;
+
+    ASSERT_RVAL(!SPIF_MAPVIEW_ISNULL(self), (spif_listidx_t) -1);
+    idx = (spif_listidx_t) -1;
+    spif_mapview_scan(self, obj, &idx);
+    return idx;
+}
+
+static spif_bool_t
+spif_mapview_insert(spif_mapview_t self, spif_obj_t obj)
+{
+    USE_VAR(self);
+    USE_VAR(obj);
+    return FALSE;
+}
+
+static spif_bool_t
+spif_mapview_insert_at(spif_mapview_t self, spif_obj_t obj, spif_listidx_t idx)
+{
+    USE_VAR(self);
+    USE_VAR(obj);
+    USE_VAR(idx);
+    return FALSE;
+}
+
+static spif_iterator_t
+spif_mapview_iterator(spif_mapview_t self)
+{
+    ASSERT_RVAL(!SPIF_MAPVIEW_ISNULL(self), (spif_iterator_t) NULL);
+    return (spif_iterator_t) spif_mapview_iterator_new(self);
+}
+
+static spif_bool_t
+spif_mapview_prepend(spif_mapview_t self, spif_obj_t obj)
+{
+    USE_VAR(self);
+    USE_VAR(obj);
+    return FALSE;
+}
+
+static spif_obj_t
+spif_mapview_remove(spif_mapview_t self, spif_obj_t item)
+{
+    USE_VAR(self);
+    USE_VAR(item);
+    return (spif_obj_t) NULL;
+}
+
+static spif_obj_t
+spif_mapview_remove_at(spif_mapview_t self, spif_listidx_t idx)
+{
+    USE_VAR(self);
+    USE_VAR(idx);
+    return (spif_obj_t) NULL;
+}
+
+static spif_bool_t
+spif_mapview_reverse(spif_mapview_t self)
+{
+    USE_VAR(self);
+    return FALSE;
+}
+
+static spif_obj_t *
+spif_mapview_to_array(spif_mapview_t self)
+{
+    spif_obj_t *tmp;
+    spif_iterator_t it;
+    spif_listidx_t i, len;
+
+    ASSERT_RVAL(!SPIF_MAPVIEW_ISNULL(self), (spif_obj_t *) NULL);
+    REQUIRE_RVAL(!SPIF_MAP_ISNULL(self->subject), (spif_obj_t *) NULL);
+    len = (spif_listidx_t) SPIF_MAP_COUNT(self->subject);
+    tmp = (spif_obj_t *) MALLOC(sizeof(spif_obj_t) * len);
+    it = SPIF_MAP_ITERATOR(self->subject);
+    for (i = 0; i < len && SPIF_ITERATOR_HAS_NEXT(it); i++) {
+        tmp[i] = spif_mapview_project(self, SPIF_ITERATOR_NEXT(it));
+    }
+    SPIF_ITERATOR_DEL(it);
+    return tmp;
+}
+
+static spif_obj_t
+spif_mapview_project(spif_mapview_t self, spif_obj_t pair)
+{
+    if (SPIF_OBJ_ISNULL(pair) || (self->what == SPIF_MAPVIEW_PAIRS)) {
+        return pair;
+    } else if (self->what == SPIF_MAPVIEW_KEYS) {
+        return SPIF_OBJPAIR(pair)->key;
+    } else {
+        return SPIF_OBJPAIR(pair)->value;
+    }
+}
+
+/* Find the first element which compares equal to obj, returning it and
+   (optionally) its position. */
+static spif_obj_t
+spif_mapview_scan(spif_mapview_t self, spif_obj_t obj, spif_listidx_t *pidx)
+{
+    spif_iterator_t it;
+    spif_obj_t tmp;
+    spif_listidx_t i;
+
+    REQUIRE_RVAL(!SPIF_MAP_ISNULL(self->subject), (spif_obj_t) NULL);
+    if ((self->what == SPIF_MAPVIEW_KEYS) && !SPIF_OBJ_ISNULL(obj) && !SPIF_MAP_HAS_KEY(self->subject, obj)) {
+        /* Let the map rule out missing keys with its own lookup. */
+        return (spif_obj_t) NULL;
+    }
+
+    it = SPIF_MAP_ITERATOR(self->subject);
+    REQUIRE_RVAL(!SPIF_ITERATOR_ISNULL(it), (spif_obj_t) NULL);
+    for (i = 0; SPIF_ITERATOR_HAS_NEXT(it); i++) {
+        tmp = spif_mapview_project(self, SPIF_ITERATOR_NEXT(it));
+        if (SPIF_OBJ_ISNULL(tmp) || SPIF_OBJ_ISNULL(obj)) {
+            if (SPIF_OBJ_ISNULL(tmp) && SPIF_OBJ_ISNULL(obj)) {
+                break;
+            }
+        } else if (SPIF_CMP_IS_EQUAL(SPIF_OBJ_COMP(tmp, obj))) {
+            break;
+        }
+    }
+    if (i == (spif_listidx_t) SPIF_MAP_COUNT(self->subject)) {
+        tmp = (spif_obj_t) NULL;
+    } else if (pidx) {
+        *pidx = i;
+    }
+    SPIF_ITERATOR_DEL(it);
+    return tmp;
+}
+
+static spif_mapview_iterator_t
+spif_mapview_iterator_new(spif_mapview_t subject)
+{
+    spif_mapview_iterator_t self;
+
+    self = SPIF_ALLOC(mapview_iterator);
+    if (!spif_mapview_iterator_init(self, subject)) {
+        SPIF_DEALLOC(self);
+        self = (spif_mapview_iterator_t) NULL;
+    }
+    return self;
+}
+
+static spif_bool_t
+spif_mapview_iterator_init(spif_mapview_iterator_t self, spif_mapview_t subject)
+{
+    ASSERT_RVAL(!SPIF_ITERATOR_ISNULL(self), FALSE);
+    if (!spif_obj_init(SPIF_OBJ(self))) {
+        return FALSE;
+    } else if (!spif_obj_set_class(SPIF_OBJ(self), SPIF_CLASS(SPIF_ITERATORCLASS_VAR(mapview)))) {
+        return FALSE;
+    }
+    self->subject = subject;
+    if (SPIF_MAPVIEW_ISNULL(subject) || SPIF_MAP_ISNULL(subject->subject)) {
+        self->it = (spif_iterator_t) NULL;
+    } else {
+        self->it = SPIF_MAP_ITERATOR(subject->subject);
+    }
+    return TRUE;
+}
+
+static spif_bool_t
+spif_mapview_iterator_done(spif_mapview_iterator_t self)
+{
+    ASSERT_RVAL(!SPIF_ITERATOR_ISNULL(self), FALSE);
+    if (!SPIF_ITERATOR_ISNULL(self->it)) {
+        SPIF_ITERATOR_DEL(self->it);
+    }
+    self->it = (spif_iterator_t) NULL;
+    self->subject = (spif_mapview_t) NULL;
+    return TRUE;
+}
+
+static spif_bool_t
+spif_mapview_iterator_del(spif_mapview_iterator_t self)
+{
+    spif_bool_t t;
+
+    ASSERT_RVAL(!SPIF_ITERATOR_ISNULL(self), FALSE);
+    t = spif_mapview_iterator_done(self);
+    SPIF_DEALLOC(self);
+    return t;
+}
+
+static spif_str_t
+spif_mapview_iterator_show(spif_mapview_iterator_t self, spif_charptr_t name, spif_str_t buff, size_t indent)
+{
+    if (SPIF_ITERATOR_ISNULL(self)) {
+        SPIF_OBJ_SHOW_NULL_INTO(iterator, name, buff, indent);
+        return buff;
+    }
+
+    buff = spif_str_show_printf(buff, indent, "(spif_mapview_iterator_t) %s:  %10p {\n", name, (spif_ptr_t) self);
+
+    buff = spif_mapview_show(self->subject, (spif_charptr_t) "subject", buff, indent + 2);
+    if (SPIF_ITERATOR_ISNULL(self->it)) {
+        SPIF_OBJ_SHOW_NULL_INTO(iterator, "it", buff, indent + 2);
+    } else {
+        buff = SPIF_OBJ_CALL_METHOD(self->it, show)(self->it, (spif_charptr_t) "it", buff, indent + 2);
+    }
+
+    buff = spif_str_show_printf(buff, indent, "}\n");
+    return buff;
+}
+
+static spif_cmp_t
+spif_mapview_iterator_comp(spif_mapview_iterator_t self, spif_mapview_iterator_t other)
+{
+    spif_cmp_t c;
+
+    SPIF_OBJ_COMP_CHECK_NULL(self, other);
+    c = spif_mapview_comp(self->subject, other->subject);
+    if (SPIF_CMP_IS_EQUAL(c)) {
+        SPIF_OBJ_COMP_CHECK_NULL(self->it, other->it);
+        return SPIF_ITERATOR_COMP(self->it, other->it);
+    } else {
+        return c;
+    }
+}
+
+static spif_mapview_iterator_t
+spif_mapview_iterator_dup(spif_mapview_iterator_t self)
+{
+    spif_mapview_iterator_t tmp;
+
+    ASSERT_RVAL(!SPIF_ITERATOR_ISNULL(self), (spif_mapview_iterator_t) NULL);
+    tmp = spif_mapview_iterator_new(self->subject);
+    REQUIRE_RVAL(!SPIF_ITERATOR_ISNULL(tmp), (spif_mapview_iterator_t) NULL);
+    if (!SPIF_ITERATOR_ISNULL(tmp->it)) {
+        SPIF_ITERATOR_DEL(tmp->it);
+    }
+    tmp->it = ((SPIF_ITERATOR_ISNULL(self->it)) ? ((spif_iterator_t) NULL) : (SPIF_ITERATOR_DUP(self->it)));
+    return tmp;
+}
+
+static spif_classname_t
+spif_mapview_iterator_type(spif_mapview_iterator_t self)
+{
+    ASSERT_RVAL(!SPIF_ITERATOR_ISNULL(self), (spif_classname_t) NULL);
+    return SPIF_OBJ_CLASSNAME(self);
+}
+
+static spif_bool_t
+spif_mapview_iterator_has_next(spif_mapview_iterator_t self)
+{
+    ASSERT_RVAL(!SPIF_ITERATOR_ISNULL(self), FALSE);
+    REQUIRE_RVAL(!SPIF_ITERATOR_ISNULL(self->it), FALSE);
+    return SPIF_ITERATOR_HAS_NEXT(self->it);
+}
+
+static spif_obj_t
+spif_mapview_iterator_next(spif_mapview_iterator_t self)
+{
+    ASSERT_RVAL(!SPIF_ITERATOR_ISNULL(self), (spif_obj_t) NULL);
+    REQUIRE_RVAL(!SPIF_ITERATOR_ISNULL(self->it), (spif_obj_t) NULL);
+    REQUIRE_RVAL(SPIF_ITERATOR_HAS_NEXT(self->it), (spif_obj_t) NULL);
+    return spif_mapview_project(self->subject, SPIF_ITERATOR_NEXT(self->it));
+}
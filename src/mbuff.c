@@ -74,27 +74,145 @@ SPIF_TYPE(mbuffclass) SPIF_MBUFFCLASS_VAR(mbuff) = &mb_class;
 /* *INDENT-ON* */
 
 static const size_t buff_inc = 4096;
+static const size_t pool_keep_max = 16384;
 
-spif_mbuff_t
-spif_mbuff_new(void)
+/* Get an empty mbuff object, recycled from the mbuff pool if there is
+   one.  A recycled mbuff keeps its buffer if it can hold size bytes. */
+static spif_mbuff_t
+spif_mbuff_take(spif_memidx_t size)
 {
     spif_mbuff_t self;
 
-    self = SPIF_ALLOC(mbuff);
-    if (!spif_mbuff_init(self)) {
-        SPIF_DEALLOC(self);
-        self = (spif_mbuff_t) NULL;
+    self = SPIF_MBUFF(spif_pool_take(SPIF_CLASS_VAR(mbuff)));
+    if (SPIF_MBUFF_ISNULL(self)) {
+        self = SPIF_ALLOC(mbuff);
+        spif_mbuff_init(self);
+    } else if (self->size < size) {
+        spif_mbuff_done(self);
     }
     return self;
 }
 
+/*
+ * An mbuff's bytes start at buff, but the allocation behind it may
+ * start up to head bytes earlier:  spif_mbuff_consume() just moves
+ * buff forward, so taking bytes off the front of a buffer costs
+ * nothing.  That space is reused when the buffer needs room at either
+ * end, and otherwise goes back with the allocation.  Code other than
+ * spif_mbuff_grow() which reallocates or frees buff must
+ * spif_mbuff_reclaim() it first.
+ */
+
+/* Move the bytes of an mbuff with consumed space back to the start of
+   its allocation. */
+static void
+spif_mbuff_rewind(spif_mbuff_t self)
+{
+    if (!self->head || SPIF_MBUFF_IS_MAPPED(self)) {
+        return;
+    }
+    if (self->len) {
+        memmove(self->buff - self->head, self->buff, self->len);
+    }
+    self->buff -= self->head;
+    self->size += self->head;
+    self->head = 0;
+}
+
+/* Give an mbuff a heap buffer whose bytes start at the beginning of
+   its allocation, so it can be reallocated or freed.  A mapping is
+   copied to the heap, with room for at least size bytes, and dropped. */
+static void
+spif_mbuff_reclaim(spif_mbuff_t self, spif_memidx_t size)
+{
+    spif_byteptr_t buff;
+
+    if (!SPIF_MBUFF_IS_MAPPED(self)) {
+        spif_mbuff_rewind(self);
+        return;
+    }
+    size = MAX(size, self->len);
+    buff = (spif_byteptr_t) MALLOC(size);
+    memcpy(buff, self->buff, self->len);
+    munmap(self->map, self->map_len);
+    self->map = (spif_ptr_t) NULL;
+    self->map_len = 0;
+    self->map_flags = 0;
+    self->head = 0;
+    self->buff = buff;
+    self->size = size;
+}
+
+/* Make an mbuff's bytes safe to change in place.  Copy-on-write
+   mappings already are; read-only ones are copied to the heap. */
+static void
+spif_mbuff_writable(spif_mbuff_t self)
+{
+    if (SPIF_MBUFF_IS_MAPPED(self) && !(self->map_flags & SPIF_MBUFF_MAP_COPY)) {
+        spif_mbuff_reclaim(self, 0);
+    }
+}
+
+/* Make room for at least size bytes.  Consumed space is reused when
+   there's at least as much of it as there are bytes to move, so the
+   moves cost no more than the consuming did; otherwise the allocation
+   is reallocated where it is, consumed space and all, doubling so that
+   repeated small appends and reads don't reallocate every time. */
+static void
+spif_mbuff_grow(spif_mbuff_t self, spif_memidx_t size)
+{
+    if (size <= self->size) {
+        return;
+    }
+    if (!SPIF_MBUFF_IS_MAPPED(self) && (self->head >= self->len) && (size <= self->size + self->head)) {
+        spif_mbuff_rewind(self);
+        return;
+    }
+    size = MAX(size, self->size * 2);
+    if (SPIF_MBUFF_IS_MAPPED(self)) {
+        spif_mbuff_reclaim(self, size);
+        return;
+    }
+    self->buff = (spif_byteptr_t) REALLOC(self->buff - self->head, self->head + size) + self->head;
+    self->size = size;
+}
+
+/* Grow function for spiftool_vformat(). */
+static spif_charptr_t
+spif_mbuff_format_grow(spif_obj_t obj, spif_stridx_t size, spif_stridx_t *newsize)
+{
+    spif_mbuff_t self = SPIF_MBUFF(obj);
+    spif_memidx_t len;
+
+    /* The text formatted so far lies past len, so keep the whole
+       buffer while it grows. */
+    len = self->len;
+    self->len = self->size;
+    spif_mbuff_grow(self, size);
+    self->len = len;
+    *newsize = self->size;
+    return (spif_charptr_t) self->buff;
+}
+
+spif_mbuff_t
+spif_mbuff_new(void)
+{
+    return spif_mbuff_take(0);
+}
+
 spif_mbuff_t
 spif_mbuff_new_from_ptr(spif_byteptr_t old, spif_memidx_t len)
 {
     spif_mbuff_t self;
 
-    self = SPIF_ALLOC(mbuff);
-    if (!spif_mbuff_init_from_ptr(self, old, len)) {
+    if (old == (spif_byteptr_t) NULL) {
+        return spif_mbuff_new();
+    }
+    self = spif_mbuff_take(len);
+    if (self->size) {
+        memcpy(self->buff, old, len);
+        self->len = len;
+    } else if (!spif_mbuff_init_from_ptr(self, old, len)) {
         SPIF_DEALLOC(self);
         self = (spif_mbuff_t) NULL;
     }
@@ -106,8 +224,16 @@ spif_mbuff_new_from_buff(spif_byteptr_t buff, spif_memidx_t len, spif_memidx_t s
 {
     spif_mbuff_t self;
 
-    self = SPIF_ALLOC(mbuff);
-    if (!spif_mbuff_init_from_buff(self, buff, len, size)) {
+    if (buff == (spif_byteptr_t) NULL) {
+        len = 0;
+    }
+    self = spif_mbuff_take(MAX(size, len));
+    if (self->size) {
+        if (len) {
+            memcpy(self->buff, buff, len);
+        }
+        self->len = len;
+    } else if (!spif_mbuff_init_from_buff(self, buff, len, size)) {
         SPIF_DEALLOC(self);
         self = (spif_mbuff_t) NULL;
     }
@@ -140,6 +266,47 @@ spif_mbuff_new_from_fd(int fd)
     return self;
 }
 
+spif_mbuff_t
+spif_mbuff_new_from_file(spif_charptr_t path)
+{
+    spif_mbuff_t self;
+
+    self = SPIF_ALLOC(mbuff);
+    if (!spif_mbuff_init_from_file(self, path)) {
+        SPIF_DEALLOC(self);
+        self = (spif_mbuff_t) NULL;
+    }
+    return self;
+}
+
+/**
+ * Create an mbuff which maps part of a file instead of reading it.
+ *
+ * Pages are read only as they're touched and are shared with the page
+ * cache, so large files cost neither startup I/O nor a second copy in
+ * memory.  The lookup and comparison functions work on the mapping
+ * directly; anything that changes the buffer's size first copies it to
+ * the heap, as do in-place changes to a read-only mapping.
+ *
+ * @param path   The file to map.
+ * @param offset Where in the file to start.
+ * @param len    How many bytes to map, or 0 for the rest of the file.
+ * @param flags  SPIF_MBUFF_MAP_* flags.
+ * @return       A new mbuff, or NULL on failure.
+ */
+spif_mbuff_t
+spif_mbuff_new_from_mmap(spif_charptr_t path, spif_memidx_t offset, spif_memidx_t len, int flags)
+{
+    spif_mbuff_t self;
+
+    self = SPIF_ALLOC(mbuff);
+    if (!spif_mbuff_init_from_mmap(self, path, offset, len, flags)) {
+        SPIF_DEALLOC(self);
+        self = (spif_mbuff_t) NULL;
+    }
+    return self;
+}
+
 spif_bool_t
 spif_mbuff_init(spif_mbuff_t self)
 {
@@ -149,6 +316,10 @@ spif_mbuff_init(spif_mbuff_t self)
     self->buff = (spif_byteptr_t) NULL;
     self->len = 0;
     self->size = 0;
+    self->map = (spif_ptr_t) NULL;
+    self->map_len = 0;
+    self->map_flags = 0;
+    self->head = 0;
     return TRUE;
 }
 
@@ -159,6 +330,8 @@ spif_mbuff_init_from_ptr(spif_mbuff_t self, spif_byteptr_t old, spif_memidx_t le
     REQUIRE_RVAL((old != (spif_byteptr_t) NULL), spif_mbuff_init(self));
     /* ***NOT NEEDED*** spif_obj_init(SPIF_OBJ(self)); */
     spif_obj_set_class(SPIF_OBJ(self), SPIF_CLASS(SPIF_MBUFFCLASS_VAR(mbuff)));
+    self->map = (spif_ptr_t) NULL;
+    self->head = 0;
     self->len = self->size = len;
     self->buff = (spif_byteptr_t) MALLOC(self->size);
     memcpy(self->buff, old, self->len);
@@ -171,6 +344,8 @@ spif_mbuff_init_from_buff(spif_mbuff_t self, spif_byteptr_t buff, spif_memidx_t
     ASSERT_RVAL(!SPIF_MBUFF_ISNULL(self), FALSE);
     /* ***NOT NEEDED*** spif_obj_init(SPIF_OBJ(self)); */
     spif_obj_set_class(SPIF_OBJ(self), SPIF_CLASS(SPIF_MBUFFCLASS_VAR(mbuff)));
+    self->map = (spif_ptr_t) NULL;
+    self->head = 0;
     if (buff != (spif_byteptr_t) NULL) {
         self->len = len;
     } else {
@@ -194,11 +369,12 @@ spif_mbuff_init_from_fp(spif_mbuff_t self, FILE *fp)
     ASSERT_RVAL((fp != (FILE *) NULL), FALSE);
     /* ***NOT NEEDED*** spif_obj_init(SPIF_OBJ(self)); */
     spif_obj_set_class(SPIF_OBJ(self), SPIF_CLASS(SPIF_MBUFFCLASS_VAR(mbuff)));
+    self->map = (spif_ptr_t) NULL;
+    self->head = 0;
 
     file_pos = ftell(fp);
     LOWER_BOUND(file_pos, 0);
     if (fseek(fp, 0L, SEEK_END) < 0) {
-        spif_byteptr_t p;
         size_t cnt = 0;
 
         D_OBJ(("Unable to seek to EOF -- %s.\n", strerror(errno)));
@@ -206,17 +382,15 @@ spif_mbuff_init_from_fp(spif_mbuff_t self, FILE *fp)
         self->len = 0;
         self->buff = (spif_byteptr_t) MALLOC(self->size);
 
-        for (p = self->buff; (cnt = fread(p, 1, buff_inc, fp)) > 0; p += buff_inc) {
+        while ((cnt = fread(self->buff + self->len, 1, self->size - self->len, fp)) > 0) {
             self->len += cnt;
             if (feof(fp)) {
                 break;
             } else if (ferror(fp)) {
                 libast_print_warning("read failed:  %s.\n", strerror(errno));
                 break;
-            } else {
-                self->size += buff_inc;
-                self->buff = (spif_byteptr_t) REALLOC(self->buff, self->size);
             }
+            spif_mbuff_grow(self, self->len + buff_inc);
         }
         self->size = self->len;
         if (self->size) {
@@ -225,7 +399,7 @@ spif_mbuff_init_from_fp(spif_mbuff_t self, FILE *fp)
             FREE(self->buff);
         }
     } else {
-        file_size = ftell(fp);
+        file_size = ftell(fp) - file_pos;
         fseek(fp, file_pos, SEEK_SET);
         LOWER_BOUND(file_size, 0);
         if (file_size <= 0) {
@@ -246,51 +420,113 @@ spif_mbuff_init_from_fp(spif_mbuff_t self, FILE *fp)
 spif_bool_t
 spif_mbuff_init_from_fd(spif_mbuff_t self, int fd)
 {
-    spif_byteptr_t p;
-    off_t file_pos;
-    spif_memidx_t file_size;
+    size_t len;
 
     ASSERT_RVAL(!SPIF_MBUFF_ISNULL(self), FALSE);
     ASSERT_RVAL((fd >= 0), FALSE);
     /* ***NOT NEEDED*** spif_obj_init(SPIF_OBJ(self)); */
     spif_obj_set_class(SPIF_OBJ(self), SPIF_CLASS(SPIF_MBUFFCLASS_VAR(mbuff)));
+    self->map = (spif_ptr_t) NULL;
+    self->head = 0;
 
-    file_pos = lseek(fd, (off_t) 0, SEEK_CUR);
-    file_size = (spif_memidx_t) lseek(fd, (off_t) 0, SEEK_END);
-    lseek(fd, file_pos, SEEK_SET);
-    if (file_size < 0) {
-        spif_byteptr_t p;
-        size_t cnt = 0;
+    self->buff = spiftool_read_fd(fd, &len, 0);
+    if (!self->buff) {
+        spif_mbuff_init(self);
+        return FALSE;
+    }
+    self->len = self->size = (spif_memidx_t) len;
+    if (!self->size) {
+        FREE(self->buff);
+    }
+    return TRUE;
+}
 
-        D_OBJ(("Unable to seek to EOF -- %s.\n", strerror(errno)));
-        self->size = buff_inc;
-        self->len = 0;
-        self->buff = (spif_byteptr_t) MALLOC(self->size);
+spif_bool_t
+spif_mbuff_init_from_file(spif_mbuff_t self, spif_charptr_t path)
+{
+    spif_bool_t ret;
+    int fd;
 
-        for (p = self->buff; (cnt = read(fd, p, buff_inc)) > 0; p += buff_inc) {
-            self->len += cnt;
-            if (cnt < buff_inc) {
-                break;
-            } else {
-                self->size += buff_inc;
-                self->buff = (spif_byteptr_t) REALLOC(self->buff, self->size);
-            }
-        }
-        self->size = self->len;
-        if (self->size) {
-            self->buff = (spif_byteptr_t) REALLOC(self->buff, self->size);
-        } else {
-            FREE(self->buff);
-        }
-    } else {
-        self->len = self->size = file_size;
-        self->buff = (spif_byteptr_t) MALLOC(self->size);
+    ASSERT_RVAL(!SPIF_MBUFF_ISNULL(self), FALSE);
+    REQUIRE_RVAL((path != NULL), spif_mbuff_init(self));
+    if ((fd = open((const char *) path, O_RDONLY)) < 0) {
+        spif_mbuff_init(self);
+        return FALSE;
+    }
+    ret = spif_mbuff_init_from_fd(self, fd);
+    close(fd);
+    return ret;
+}
 
-        if (read(fd, p, file_size) < 1) {
-            FREE(self->buff);
-            return FALSE;
-        }
+/**
+ * Map part of a file into an mbuff.
+ *
+ * @see spif_mbuff_new_from_mmap()
+ */
+spif_bool_t
+spif_mbuff_init_from_mmap(spif_mbuff_t self, spif_charptr_t path, spif_memidx_t offset, spif_memidx_t len, int flags)
+{
+    struct stat st;
+    spif_memidx_t delta;
+    spif_ptr_t map;
+    int fd, mflags;
+
+    ASSERT_RVAL(!SPIF_MBUFF_ISNULL(self), FALSE);
+    spif_mbuff_init(self);
+    REQUIRE_RVAL((path != NULL), FALSE);
+    REQUIRE_RVAL((offset >= 0) && (len >= 0), FALSE);
+    if ((fd = open((const char *) path, O_RDONLY)) < 0) {
+        return FALSE;
+    }
+    if ((fstat(fd, &st) < 0) || (offset > (spif_memidx_t) st.st_size)) {
+        close(fd);
+        return FALSE;
+    }
+    if (!len) {
+        len = (spif_memidx_t) st.st_size - offset;
+    }
+    UPPER_BOUND(len, (spif_memidx_t) st.st_size - offset);
+    if (!len) {
+        /* Nothing to map; mmap() won't take a zero length. */
+        close(fd);
+        return TRUE;
+    }
+
+    /* The file offset of a mapping has to be page-aligned. */
+    delta = offset % (spif_memidx_t) sysconf(_SC_PAGESIZE);
+    if ((spif_uint64_t) (len + delta) > (spif_uint64_t) ((size_t) -1)) {
+        close(fd);
+        return FALSE;
+    }
+    mflags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+    if (flags & SPIF_MBUFF_MAP_POPULATE) {
+        mflags |= MAP_POPULATE;
+    }
+#endif
+    map = mmap(NULL, (size_t) (len + delta), PROT_READ | ((flags & SPIF_MBUFF_MAP_COPY) ? (PROT_WRITE) : (0)), mflags, fd,
+               (off_t) (offset - delta));
+    close(fd);
+    if (map == MAP_FAILED) {
+        return FALSE;
+    }
+#ifdef MADV_SEQUENTIAL
+    if (flags & SPIF_MBUFF_MAP_SEQUENTIAL) {
+        madvise(map, (size_t) (len + delta), MADV_SEQUENTIAL);
+    } else if (flags & SPIF_MBUFF_MAP_RANDOM) {
+        madvise(map, (size_t) (len + delta), MADV_RANDOM);
+    }
+#endif
+#if !defined(MAP_POPULATE) && defined(MADV_WILLNEED)
+    if (flags & SPIF_MBUFF_MAP_POPULATE) {
+        madvise(map, (size_t) (len + delta), MADV_WILLNEED);
     }
+#endif
+    self->map = map;
+    self->map_len = (size_t) (len + delta);
+    self->map_flags = flags;
+    self->buff = (spif_byteptr_t) map + delta;
+    self->len = self->size = len;
     return TRUE;
 }
 
@@ -298,7 +534,18 @@ spif_bool_t
 spif_mbuff_done(spif_mbuff_t self)
 {
     ASSERT_RVAL(!SPIF_MBUFF_ISNULL(self), FALSE);
-    if (self->size) {
+    if (SPIF_MBUFF_IS_MAPPED(self)) {
+        munmap(self->map, self->map_len);
+        self->map = (spif_ptr_t) NULL;
+        self->map_len = 0;
+        self->map_flags = 0;
+        self->head = 0;
+        self->len = 0;
+        self->size = 0;
+        self->buff = (spif_byteptr_t) NULL;
+    } else if (self->size || self->head) {
+        self->buff -= self->head;
+        self->head = 0;
         FREE(self->buff);
         self->len = 0;
         self->size = 0;
@@ -311,59 +558,49 @@ spif_bool_t
 spif_mbuff_del(spif_mbuff_t self)
 {
     ASSERT_RVAL(!SPIF_MBUFF_ISNULL(self), FALSE);
-    spif_mbuff_done(self);
-    SPIF_DEALLOC(self);
+    if ((self->size + self->head > (spif_memidx_t) pool_keep_max) || SPIF_MBUFF_IS_MAPPED(self)) {
+        spif_mbuff_done(self);
+    }
+    self->len = 0;
+    spif_mbuff_rewind(self);
+    if (!spif_pool_give(SPIF_OBJ(self))) {
+        spif_mbuff_done(self);
+        SPIF_DEALLOC(self);
+    }
     return TRUE;
 }
 
 spif_str_t
 spif_mbuff_show(spif_mbuff_t self, spif_byteptr_t name, spif_str_t buff, size_t indent)
 {
-    spif_char_t tmp[4096];
     spif_memidx_t j;
 
     if (SPIF_MBUFF_ISNULL(self)) {
-        SPIF_OBJ_SHOW_NULL(mbuff, name, buff, indent, tmp);
+        SPIF_OBJ_SHOW_NULL_INTO(mbuff, name, buff, indent);
         return buff;
     }
 
-    memset(tmp, ' ', indent);
-    snprintf((char *) tmp + indent, sizeof(tmp) - indent,
-             "(spif_mbuff_t) %s:  %10p (length %lu, size %lu) {\n",
-             name, (spif_ptr_t) self, (spif_ulong_t) self->len, (spif_ulong_t) self->size);
-    if (SPIF_MBUFF_ISNULL(buff)) {
-        buff = spif_str_new_from_ptr(tmp);
-    } else {
-        spif_str_append_from_ptr(buff, tmp);
-    }
+    buff = spif_str_show_printf(buff, indent, "(spif_mbuff_t) %s:  %10p (length %lu, size %lu) {\n",
+                                name, (spif_ptr_t) self, (spif_ulong_t) self->len, (spif_ulong_t) self->size);
 
-    memset(tmp, ' ', indent + 2);
     for (j = 0; j < self->len; j += 8) {
-        spif_memidx_t k, l, len;
-
-        snprintf((char *) tmp + indent + 2, sizeof(tmp) - indent - 2, "0x%08lx    ", (spif_long_t) j);
-        len = strlen((char *) tmp);
-        if ((sizeof(tmp) - indent - 2) > 46) {
-            spif_char_t buffr[9];
-
-            l = ((self->len - j < 8) ? (self->len - j) : (8));
-            memcpy(buffr, self->buff + j, l);
-            memset(buffr + l, 0, 9 - l);
-            for (k = 0; k < l; k++) {
-                sprintf((char *) tmp + 14 + (k * 3), "%02x ", self->buff[j + k]);
-            }
-            for (; k < 8; k++) {
-                strcat((char *) tmp + 14, "   ");
-            }
-            sprintf((char *) tmp + 38, "%-8s\n", spiftool_safe_str((spif_charptr_t) (buffr), l));
-        } else {
-            snprintf((char *) tmp + indent + 2, sizeof(tmp) - indent - 2, "!X!");
+        spif_memidx_t k, l;
+        spif_char_t buffr[9];
+
+        buff = spif_str_show_printf(buff, indent + 2, "0x%08lx    ", (spif_ulong_t) j);
+        l = ((self->len - j < 8) ? (self->len - j) : (8));
+        memcpy(buffr, self->buff + j, l);
+        memset(buffr + l, 0, 9 - l);
+        for (k = 0; k < l; k++) {
+            spif_str_append_printf(buff, "%02x ", self->buff[j + k]);
         }
-        spif_str_append_from_ptr(buff, tmp);
+        for (; k < 8; k++) {
+            spif_str_append_buff(buff, "   ", 3);
+        }
+        spif_str_append_printf(buff, "%-8s\n", spiftool_safe_str((spif_charptr_t) (buffr), l));
     }
 
-    snprintf((char *) tmp + indent, sizeof(tmp) - indent, "}\n");
-    spif_str_append_from_ptr(buff, tmp);
+    buff = spif_str_show_printf(buff, indent, "}\n");
     return buff;
 }
 
@@ -379,12 +616,17 @@ spif_mbuff_dup(spif_mbuff_t self)
     spif_mbuff_t tmp;
 
     ASSERT_RVAL(!SPIF_MBUFF_ISNULL(self), (spif_mbuff_t) NULL);
-    tmp = SPIF_ALLOC(mbuff);
-    memcpy(tmp, self, SPIF_SIZEOF_TYPE(mbuff));
-    tmp->buff = (spif_byteptr_t) MALLOC(self->size);
-    memcpy(tmp->buff, self->buff, self->size);
+    tmp = spif_mbuff_take(self->size);
+    spif_obj_set_class(SPIF_OBJ(tmp), SPIF_OBJ_CLASS(self));
+    if (!self->size) {
+        return tmp;
+    }
+    if (!tmp->size) {
+        tmp->size = self->size;
+        tmp->buff = (spif_byteptr_t) MALLOC(tmp->size);
+    }
+    memcpy(tmp->buff, self->buff, self->len);
     tmp->len = self->len;
-    tmp->size = self->size;
     return tmp;
 }
 
@@ -401,32 +643,101 @@ spif_mbuff_append(spif_mbuff_t self, spif_mbuff_t other)
     ASSERT_RVAL(!SPIF_MBUFF_ISNULL(self), FALSE);
     REQUIRE_RVAL(!SPIF_MBUFF_ISNULL(other), FALSE);
     if (other->size && other->len) {
-        self->size += other->size;
-        self->buff = (spif_byteptr_t) REALLOC(self->buff, self->size);
+        spif_mbuff_grow(self, self->len + other->len);
         memcpy(self->buff + self->len, SPIF_MBUFF_BUFF(other), other->len);
         self->len += other->len;
     }
     return TRUE;
 }
 
+/* Like spif_str_append_double(); no NUL is added. */
+spif_bool_t
+spif_mbuff_append_double(spif_mbuff_t self, double num)
+{
+    ASSERT_RVAL(!SPIF_MBUFF_ISNULL(self), FALSE);
+    spif_mbuff_grow(self, self->len + SPIFTOOL_NUM_BUFF_SIZE);
+    self->len += (spif_memidx_t) spiftool_format_double((spif_charptr_t) (self->buff + self->len), num);
+    return TRUE;
+}
+
 spif_bool_t
 spif_mbuff_append_from_ptr(spif_mbuff_t self, spif_byteptr_t other, spif_memidx_t len)
 {
     ASSERT_RVAL(!SPIF_MBUFF_ISNULL(self), FALSE);
     REQUIRE_RVAL((other != (spif_byteptr_t) NULL), FALSE);
     if (len) {
-        self->size += len;
-        self->buff = (spif_byteptr_t) REALLOC(self->buff, self->size);
+        spif_mbuff_grow(self, self->len + len);
         memcpy(self->buff + self->len, other, len);
         self->len += len;
     }
     return TRUE;
 }
 
+/* Like spif_str_append_int(); no NUL is added. */
+spif_bool_t
+spif_mbuff_append_int(spif_mbuff_t self, spif_int64_t num)
+{
+    ASSERT_RVAL(!SPIF_MBUFF_ISNULL(self), FALSE);
+    spif_mbuff_grow(self, self->len + SPIFTOOL_NUM_BUFF_SIZE);
+    self->len += (spif_memidx_t) spiftool_format_int64((spif_charptr_t) (self->buff + self->len), num);
+    return TRUE;
+}
+
+spif_bool_t
+spif_mbuff_append_printf(spif_mbuff_t self, spif_charptr_t format, ...)
+{
+    va_list ap;
+    spif_bool_t ret;
+
+    va_start(ap, format);
+    ret = spif_mbuff_append_vprintf(self, format, ap);
+    va_end(ap);
+    return ret;
+}
+
+/**
+ * Append formatted text.
+ *
+ * The text is formatted straight into the buffer's spare room in one
+ * pass, growing it as needed.  A NUL is kept after the text, outside
+ * the length, so the contents can be used as a C string.  If the
+ * format is invalid, the buffer is left as it was.
+ *
+ * @param self   The buffer.
+ * @param format A printf()-style format.
+ * @param ap     The arguments.
+ * @return       TRUE on success, FALSE if the format is invalid.
+ */
+spif_bool_t
+spif_mbuff_append_vprintf(spif_mbuff_t self, spif_charptr_t format, va_list ap)
+{
+    spif_memidx_t len;
+
+    ASSERT_RVAL(!SPIF_MBUFF_ISNULL(self), FALSE);
+    REQUIRE_RVAL((format != (spif_charptr_t) NULL), FALSE);
+    spif_mbuff_writable(self);
+    len = spiftool_vformat(SPIF_OBJ(self), spif_mbuff_format_grow, (spif_charptr_t) self->buff, self->size,
+                           self->len, (const char *) format, ap);
+    REQUIRE_RVAL(len >= 0, FALSE);
+    self->len = len;
+    return TRUE;
+}
+
+/* Like spif_str_append_uint(); no NUL is added. */
+spif_bool_t
+spif_mbuff_append_uint(spif_mbuff_t self, spif_uint64_t num)
+{
+    ASSERT_RVAL(!SPIF_MBUFF_ISNULL(self), FALSE);
+    spif_mbuff_grow(self, self->len + SPIFTOOL_NUM_BUFF_SIZE);
+    self->len += (spif_memidx_t) spiftool_format_uint64((spif_charptr_t) (self->buff + self->len), num);
+    return TRUE;
+}
+
 spif_bool_t
 spif_mbuff_clear(spif_mbuff_t self, spif_uint8_t c)
 {
     ASSERT_RVAL(!SPIF_MBUFF_ISNULL(self), FALSE);
+    spif_mbuff_writable(self);
     memset(self->buff, c, self->len);
     return TRUE;
 }
@@ -447,10 +758,41 @@ spif_mbuff_cmp_with_ptr(spif_mbuff_t self, spif_byteptr_t other, spif_memidx_t l
     int c;
 
     SPIF_OBJ_COMP_CHECK_NULL(self, other);
-    c = memcmp(SPIF_MBUFF_BUFF(self), other, len);
+    c = memcmp(SPIF_MBUFF_BUFF(self), other, MIN(self->len, len));
     return SPIF_CMP_FROM_INT(c);
 }
 
+/**
+ * Remove bytes from the front of an mbuff.
+ *
+ * This takes constant time:  nothing is moved or freed, and the space
+ * is reused as the mbuff needs room later.  An mbuff that is read and
+ * parsed from the front while more data is appended or read onto the
+ * end works like a ring buffer, except that SPIF_MBUFF_BUFF() is
+ * always a contiguous view of everything in it, however much has come
+ * and gone.
+ *
+ * @param self The mbuff.
+ * @param cnt  The number of bytes to remove.
+ * @return     The number of bytes removed.
+ */
+spif_memidx_t
+spif_mbuff_consume(spif_mbuff_t self, spif_memidx_t cnt)
+{
+    ASSERT_RVAL(!SPIF_MBUFF_ISNULL(self), 0);
+    REQUIRE_RVAL(cnt > 0, 0);
+    UPPER_BOUND(cnt, self->len);
+    self->buff += cnt;
+    self->head += cnt;
+    self->len -= cnt;
+    self->size -= cnt;
+    if (!self->len) {
+        /* Empty; start over at the front for free. */
+        spif_mbuff_rewind(self);
+    }
+    return cnt;
+}
+
 spif_memidx_t
 spif_mbuff_find(spif_mbuff_t self, spif_mbuff_t other)
 {
@@ -485,11 +827,11 @@ spif_memidx_t
 spif_mbuff_index(spif_mbuff_t self, spif_uint8_t c)
 {
     spif_byteptr_t tmp;
-    spif_memidx_t i;
 
     ASSERT_RVAL(!SPIF_MBUFF_ISNULL(self), ((spif_memidx_t) -1));
-    for (tmp = self->buff, i = 0; ((int) *tmp != (int) (c)) && (i < self->len); i++, tmp++);
-    return (spif_memidx_t) ((spif_long_t) tmp - (spif_long_t) self->buff);
+    REQUIRE_RVAL(self->len, 0);
+    tmp = (spif_byteptr_t) memchr(self->buff, c, self->len);
+    return ((tmp) ? ((spif_memidx_t) (tmp - self->buff)) : (self->len));
 }
 
 spif_cmp_t
@@ -511,17 +853,76 @@ spif_mbuff_ncmp_with_ptr(spif_mbuff_t self, spif_byteptr_t other, spif_memidx_t
     return spif_mbuff_cmp_with_ptr(self, other, cnt);
 }
 
+/* Like spif_str_parse_double(). */
+spif_bool_t
+spif_mbuff_parse_double(spif_mbuff_t self, spif_memidx_t idx, double *result, spif_memidx_t *end)
+{
+    spif_bool_t ret;
+    size_t n;
+
+    ASSERT_RVAL(!SPIF_MBUFF_ISNULL(self), FALSE);
+    ASSERT_RVAL(result != NULL, FALSE);
+    if (idx < 0) {
+        idx = self->len + idx;
+    }
+    REQUIRE_RVAL(idx >= 0, FALSE);
+    REQUIRE_RVAL(idx <= self->len, FALSE);
+    ret = spiftool_parse_double((spif_charptr_t) (self->buff + idx), self->len - idx, result, &n);
+    if (end) {
+        *end = idx + n;
+    }
+    return ret;
+}
+
+/* Like spif_str_parse_int(). */
+spif_bool_t
+spif_mbuff_parse_int(spif_mbuff_t self, spif_memidx_t idx, int base, spif_int64_t *result, spif_memidx_t *end)
+{
+    spif_bool_t ret;
+    size_t n;
+
+    ASSERT_RVAL(!SPIF_MBUFF_ISNULL(self), FALSE);
+    ASSERT_RVAL(result != NULL, FALSE);
+    if (idx < 0) {
+        idx = self->len + idx;
+    }
+    REQUIRE_RVAL(idx >= 0, FALSE);
+    REQUIRE_RVAL(idx <= self->len, FALSE);
+    ret = spiftool_parse_int64((spif_charptr_t) (self->buff + idx), self->len - idx, base, result, &n);
+    if (end) {
+        *end = idx + n;
+    }
+    return ret;
+}
+
+/* Like spif_str_parse_uint(). */
+spif_bool_t
+spif_mbuff_parse_uint(spif_mbuff_t self, spif_memidx_t idx, int base, spif_uint64_t *result, spif_memidx_t *end)
+{
+    spif_bool_t ret;
+    size_t n;
+
+    ASSERT_RVAL(!SPIF_MBUFF_ISNULL(self), FALSE);
+    ASSERT_RVAL(result != NULL, FALSE);
+    if (idx < 0) {
+        idx = self->len + idx;
+    }
+    REQUIRE_RVAL(idx >= 0, FALSE);
+    REQUIRE_RVAL(idx <= self->len, FALSE);
+    ret = spiftool_parse_uint64((spif_charptr_t) (self->buff + idx), self->len - idx, base, result, &n);
+    if (end) {
+        *end = idx + n;
+    }
+    return ret;
+}
+
 spif_bool_t
 spif_mbuff_prepend(spif_mbuff_t self, spif_mbuff_t other)
 {
     ASSERT_RVAL(!SPIF_MBUFF_ISNULL(self), FALSE);
     REQUIRE_RVAL(!SPIF_MBUFF_ISNULL(other), FALSE);
     if (other->size && other->len) {
-        self->size += other->size;
-        self->buff = (spif_byteptr_t) REALLOC(self->buff, self->size);
-        memmove(self->buff + other->len, self->buff, self->len);
-        memcpy(self->buff, SPIF_MBUFF_BUFF(other), other->len);
-        self->len += other->len;
+        return spif_mbuff_prepend_from_ptr(self, SPIF_MBUFF_BUFF(other), other->len);
     }
     return TRUE;
 }
@@ -531,7 +932,15 @@ spif_mbuff_prepend_from_ptr(spif_mbuff_t self, spif_byteptr_t other, spif_memidx
 {
     ASSERT_RVAL(!SPIF_MBUFF_ISNULL(self), FALSE);
     REQUIRE_RVAL((other != (spif_byteptr_t) NULL), FALSE);
-    if (len) {
+    if (len && (self->head >= len) && !SPIF_MBUFF_IS_MAPPED(self)) {
+        /* Put it back in the consumed space. */
+        self->buff -= len;
+        self->head -= len;
+        self->size += len;
+        memcpy(self->buff, other, len);
+        self->len += len;
+    } else if (len) {
+        spif_mbuff_reclaim(self, 0);
         self->size += len;
         self->buff = (spif_byteptr_t) REALLOC(self->buff, self->size);
         memmove(self->buff + len, self->buff, self->len);
@@ -541,14 +950,34 @@ spif_mbuff_prepend_from_ptr(spif_mbuff_t self, spif_byteptr_t other, spif_memidx
     return TRUE;
 }
 
+spif_memidx_t
+spif_mbuff_read_up_to(spif_mbuff_t self, int fd, spif_memidx_t cnt)
+{
+    ssize_t n;
+
+    ASSERT_RVAL(!SPIF_MBUFF_ISNULL(self), ((spif_memidx_t) -1));
+    ASSERT_RVAL((fd >= 0), ((spif_memidx_t) -1));
+    REQUIRE_RVAL((cnt > 0), 0);
+    spif_mbuff_grow(self, self->len + cnt);
+    do {
+        n = read(fd, self->buff + self->len, cnt);
+    } while ((n < 0) && (errno == EINTR));
+    if (n > 0) {
+        self->len += n;
+    }
+    return (spif_memidx_t) n;
+}
+
 spif_bool_t
 spif_mbuff_reverse(spif_mbuff_t self)
 {
-    spif_byteptr_t tmp = self->buff;
-    int i, j;
+    spif_byteptr_t tmp;
+    spif_memidx_t i, j;
 
     ASSERT_RVAL(!SPIF_MBUFF_ISNULL(self), FALSE);
     REQUIRE_RVAL(self->buff != (spif_byteptr_t) NULL, FALSE);
+    spif_mbuff_writable(self);
+    tmp = self->buff;
 
     for (j = 0, i = self->len - 1; i > j; i--, j++) {
         SWAP(tmp[j], tmp[i]);
@@ -562,13 +991,9 @@ spif_mbuff_rindex(spif_mbuff_t self, spif_uint8_t c)
     spif_byteptr_t tmp;
 
     ASSERT_RVAL(!SPIF_MBUFF_ISNULL(self), ((spif_memidx_t) -1));
-    for (tmp = self->buff + self->len - 1; (*tmp != c) && (tmp >= self->buff); tmp--);
-
-    if ((tmp == self->buff) && (*tmp != c)) {
-        return (spif_memidx_t) (self->len);
-    } else {
-        return (spif_memidx_t) ((spif_long_t) tmp - (spif_long_t) self->buff);
-    }
+    REQUIRE_RVAL(self->len, 0);
+    for (tmp = self->buff + self->len; (tmp > self->buff) && (tmp[-1] != c); tmp--);
+    return ((tmp > self->buff) ? ((spif_memidx_t) (tmp - self->buff - 1)) : (self->len));
 }
 
 spif_bool_t
@@ -588,6 +1013,7 @@ spif_mbuff_splice(spif_mbuff_t self, spif_memidx_t idx, spif_memidx_t cnt, spif_
     }
     REQUIRE_RVAL(cnt >= 0, FALSE);
     REQUIRE_RVAL(cnt <= (self->len - idx), FALSE);
+    spif_mbuff_reclaim(self, 0);
 
     newsize = self->len + ((SPIF_MBUFF_ISNULL(other)) ? (0) : (other->len)) - cnt;
     ptmp = tmp = (spif_byteptr_t) MALLOC(newsize);
@@ -599,7 +1025,7 @@ spif_mbuff_splice(spif_mbuff_t self, spif_memidx_t idx, spif_memidx_t cnt, spif_
         memcpy(ptmp, other->buff, other->len);
         ptmp += other->len;
     }
-    memcpy(ptmp, self->buff + idx + cnt, self->len - idx - cnt + 1);
+    memcpy(ptmp, self->buff + idx + cnt, self->len - idx - cnt);
     if (self->size < newsize) {
         self->buff = (spif_byteptr_t) REALLOC(self->buff, newsize);
         self->size = newsize;
@@ -630,6 +1056,7 @@ spif_mbuff_splice_from_ptr(spif_mbuff_t self, spif_memidx_t idx, spif_memidx_t c
     }
     REQUIRE_RVAL(cnt >= 0, FALSE);
     REQUIRE_RVAL(cnt <= (self->len - idx), FALSE);
+    spif_mbuff_reclaim(self, 0);
 
     newsize = self->len + len - cnt;
     ptmp = tmp = (spif_byteptr_t) MALLOC(newsize);
@@ -656,41 +1083,20 @@ spif_bool_t
 spif_mbuff_sprintf(spif_mbuff_t self, spif_charptr_t format, ...)
 {
     va_list ap;
+    spif_bool_t ret;
 
     ASSERT_RVAL(!SPIF_MBUFF_ISNULL(self), FALSE);
-    va_start(ap, format);
-    if (self->buff != (spif_byteptr_t) NULL) {
+    if (!format || (*format == 0) || SPIF_MBUFF_IS_MAPPED(self)) {
         spif_mbuff_done(self);
     }
-    if (!format) {
-        return FALSE;
-    } else if (*format == 0) {
-        return TRUE;
-    } else {
-        int c;
-        char buff[2];
-
-        va_start(ap, format);
-        c = vsnprintf(buff, sizeof(buff), format, ap);
-        va_end(ap);
-        if (c <= 0) {
-            return FALSE;
-        } else {
-            c++;
-            self->size = c;
-            self->buff = (spif_charptr_t) MALLOC(self->size);
-            va_start(ap, format);
-            c = vsnprintf(self->buff, self->size, format, ap);
-            va_end(ap);
-            if (c > -1 && c < self->size) {
-                self->len = c;
-                return TRUE;
-            } else {
-                return FALSE;
-            }
-        }
+    if (!format || (*format == 0)) {
+        return ((format) ? (TRUE) : (FALSE));
     }
-    ASSERT_NOTREACHED_RVAL(FALSE);
+    self->len = 0;
+    va_start(ap, format);
+    ret = spif_mbuff_append_vprintf(self, format, ap);
+    va_end(ap);
+    return ret;
 }
 
 spif_mbuff_t
@@ -739,6 +1145,8 @@ spif_mbuff_trim(spif_mbuff_t self)
     spif_byteptr_t start, end;
 
     ASSERT_RVAL(!SPIF_MBUFF_ISNULL(self), FALSE);
+    REQUIRE_RVAL(self->len, TRUE);
+    spif_mbuff_reclaim(self, 0);
     start = self->buff;
     end = self->buff + self->len - 1;
     for (; isspace((spif_uchar_t) (*start)) && (start < end); start++);
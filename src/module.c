@@ -113,37 +113,21 @@ spif_module_del(spif_module_t self)
 spif_str_t
 spif_module_show(spif_module_t self, spif_charptr_t name, spif_str_t buff, size_t indent)
 {
-    spif_char_t tmp[4096];
-
     if (SPIF_MODULE_ISNULL(self)) {
-        SPIF_OBJ_SHOW_NULL(module, name, buff, indent, tmp);
+        SPIF_OBJ_SHOW_NULL_INTO(module, name, buff, indent);
         return buff;
     }
 
-    memset(tmp, ' ', indent);
-    snprintf((char *) tmp + indent, sizeof(tmp) - indent,
-             "(spif_module_t) %s:  %10p { \"",
-             name, (spif_ptr_t) self);
-    if (SPIF_STR_ISNULL(buff)) {
-        buff = spif_str_new_from_ptr(tmp);
-    } else {
-        spif_str_append_from_ptr(buff, tmp);
-    }
+    buff = spif_str_show_printf(buff, indent, "(spif_module_t) %s:  %10p { \"",
+                                name, (spif_ptr_t) self);
 
     indent += 2;
-    if (indent < sizeof(tmp)) {
-        memset(tmp, ' ', indent);
-    }
     buff = spif_str_show(self->name, SPIF_CHARPTR("name"), buff, indent);
     buff = spif_str_show(self->path, SPIF_CHARPTR("path"), buff, indent);
-    snprintf((char *) tmp + indent, sizeof(tmp) - indent, "(spif_ptr_t) module_handle:  0x%p\n", self->module_handle);
-    spif_str_append_from_ptr(buff, tmp);
-
-    snprintf((char *) tmp + indent, sizeof(tmp) - indent, "(spif_ptr_t) main_handle:  0x%p\n", self->main_handle);
-    spif_str_append_from_ptr(buff, tmp);
+    buff = spif_str_show_printf(buff, indent, "(spif_ptr_t) module_handle:  0x%p\n", self->module_handle);
+    buff = spif_str_show_printf(buff, indent, "(spif_ptr_t) main_handle:  0x%p\n", self->main_handle);
 
-    snprintf((char *) tmp, sizeof(tmp), "}\n");
-    spif_str_append_from_ptr(buff, tmp);
+    spif_str_append_from_ptr(buff, SPIF_CHARPTR("}\n"));
     return buff;
 }
 
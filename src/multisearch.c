@@ -0,0 +1,447 @@
+/*
+ * Copyright (C) 1997-2013, Michael Jennings <mej@eterm.org>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies of the Software, its documentation and marketing & publicity
+ * materials, and acknowledgment shall be given in the documentation, materials
+ * and software packages that this Software was used.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <libast_internal.h>
+
+/* *INDENT-OFF* */
+static SPIF_CONST_TYPE(class) ms_class = {
+    SPIF_DECL_CLASSNAME(multisearch),
+    (spif_func_t) spif_multisearch_new,
+    (spif_func_t) spif_multisearch_init,
+    (spif_func_t) spif_multisearch_done,
+    (spif_func_t) spif_multisearch_del,
+    (spif_func_t) spif_multisearch_show,
+    (spif_func_t) spif_multisearch_comp,
+    (spif_func_t) spif_multisearch_dup,
+    (spif_func_t) spif_multisearch_type
+};
+SPIF_TYPE(class) SPIF_CLASS_VAR(multisearch) = &ms_class;
+/* *INDENT-ON* */
+
+/*
+ * The automaton is stored as a complete DFA:  delta[s * nclasses + c]
+ * is the state reached from state s on a byte of class c, so each
+ * input byte costs one table lookup.  Bytes are grouped into classes
+ * (those that appear in no pattern all share class 0, and with case
+ * folding the two cases of a letter share one) to keep the rows short.
+ *
+ * out[s] is the first pattern ending at state s, with the rest chained
+ * through next[].  link[s] is the nearest state on s's suffix chain,
+ * s included, where some pattern ends (or -1), and dict[s] is the same
+ * for proper suffixes only, so all the matches ending at a byte are
+ * found by following link[] once and dict[] after that.
+ */
+
+spif_multisearch_t
+spif_multisearch_new(void)
+{
+    spif_multisearch_t self;
+
+    self = SPIF_ALLOC(multisearch);
+    if (!spif_multisearch_init(self)) {
+        SPIF_DEALLOC(self);
+        self = (spif_multisearch_t) NULL;
+    }
+    return self;
+}
+
+spif_multisearch_t
+spif_multisearch_new_from_list(spif_list_t patterns, spif_bool_t casefold)
+{
+    spif_multisearch_t self;
+
+    self = SPIF_ALLOC(multisearch);
+    if (!spif_multisearch_init_from_list(self, patterns, casefold)) {
+        SPIF_DEALLOC(self);
+        self = (spif_multisearch_t) NULL;
+    }
+    return self;
+}
+
+spif_bool_t
+spif_multisearch_init(spif_multisearch_t self)
+{
+    ASSERT_RVAL(!SPIF_MULTISEARCH_ISNULL(self), FALSE);
+    if (!spif_obj_init(SPIF_OBJ(self))) {
+        return FALSE;
+    }
+    spif_obj_set_class(SPIF_OBJ(self), SPIF_CLASS_VAR(multisearch));
+    self->npatterns = 0;
+    self->lens = (spif_memidx_t *) NULL;
+    self->next = (spif_listidx_t *) NULL;
+    self->casefold = FALSE;
+    memset(self->classes, 0, sizeof(self->classes));
+
+    /* With no patterns, every byte leads back to the root. */
+    self->nclasses = 1;
+    self->nstates = 1;
+    self->delta = (spif_int32_t *) MALLOC(sizeof(spif_int32_t));
+    self->out = (spif_int32_t *) MALLOC(sizeof(spif_int32_t));
+    self->link = (spif_int32_t *) MALLOC(sizeof(spif_int32_t));
+    self->dict = (spif_int32_t *) MALLOC(sizeof(spif_int32_t));
+    self->delta[0] = 0;
+    self->out[0] = self->link[0] = self->dict[0] = -1;
+    self->state = 0;
+    self->pos = 0;
+    return TRUE;
+}
+
+/* Fetch the bytes of one pattern from the list. */
+static spif_bool_t
+spif_multisearch_pattern(spif_obj_t obj, spif_byteptr_t *ptr, spif_memidx_t *len)
+{
+    if (SPIF_OBJ_IS_STR(obj)) {
+        *ptr = (spif_byteptr_t) SPIF_STR_STR(obj);
+        *len = spif_str_get_len(SPIF_STR(obj));
+    } else if (SPIF_OBJ_IS_MBUFF(obj)) {
+        *ptr = SPIF_MBUFF_BUFF(obj);
+        *len = spif_mbuff_get_len(SPIF_MBUFF(obj));
+    } else {
+        *ptr = (spif_byteptr_t) NULL;
+        *len = 0;
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/**
+ * Compile a list of patterns.
+ *
+ * Builds the automaton for the strings and/or buffers in @a patterns.
+ * Pattern IDs reported to the callback are indexes into this list.
+ * The list is not needed after this returns.
+ *
+ * @param self     The matcher.
+ * @param patterns A list of spif_str_t and/or spif_mbuff_t patterns.
+ * @param casefold TRUE to ignore case when matching.
+ * @return         TRUE on success, FALSE on error.
+ */
+spif_bool_t
+spif_multisearch_init_from_list(spif_multisearch_t self, spif_list_t patterns, spif_bool_t casefold)
+{
+    spif_iterator_t it;
+    spif_byteptr_t *ptrs, p;
+    spif_uint16_t map[256];
+    spif_int32_t *fail, *queue, k, s, t, f, c, head, tail;
+    spif_listidx_t i, n;
+    spif_memidx_t j, total;
+
+    ASSERT_RVAL(!SPIF_MULTISEARCH_ISNULL(self), FALSE);
+    REQUIRE_RVAL(!SPIF_LIST_ISNULL(patterns), FALSE);
+    if (!spif_multisearch_init(self)) {
+        return FALSE;
+    }
+
+    /* Collect the patterns and assign a class to each byte used. */
+    /* SPIF_LIST_COUNT() narrows a generic pointer return; call the
+       method through its real type instead. */
+    n = ((spif_listidx_t (*)(spif_list_t)) SPIF_LIST_CALL_METHOD(patterns, count))(patterns);
+    self->casefold = casefold;
+    self->npatterns = n;
+    self->lens = (spif_memidx_t *) MALLOC(sizeof(spif_memidx_t) * (n + 1));
+    self->next = (spif_listidx_t *) MALLOC(sizeof(spif_listidx_t) * (n + 1));
+    ptrs = (spif_byteptr_t *) MALLOC(sizeof(spif_byteptr_t) * (n + 1));
+    memset(map, 0, sizeof(map));
+    k = 1;
+    total = 0;
+    it = SPIF_LIST_ITERATOR(patterns);
+    for (i = 0; (i < n) && SPIF_ITERATOR_HAS_NEXT(it); i++) {
+        spif_multisearch_pattern(SPIF_ITERATOR_NEXT(it), &ptrs[i], &self->lens[i]);
+        for (j = 0; j < self->lens[i]; j++) {
+            c = ((casefold) ? (tolower(ptrs[i][j])) : (ptrs[i][j]));
+            if (!map[c]) {
+                map[c] = k++;
+            }
+        }
+        total += self->lens[i];
+    }
+    SPIF_ITERATOR_DEL(it);
+    for (; i < n; i++) {
+        ptrs[i] = (spif_byteptr_t) NULL;
+        self->lens[i] = 0;
+    }
+    for (c = 0; c < 256; c++) {
+        self->classes[c] = ((casefold) ? (map[tolower(c)]) : (map[c]));
+    }
+    self->nclasses = k;
+
+    /* Build the trie.  Patterns are added last to first so that each
+       state's out[] chain lists them in order. */
+    self->delta = (spif_int32_t *) REALLOC(self->delta, sizeof(spif_int32_t) * (total + 1) * k);
+    self->out = (spif_int32_t *) REALLOC(self->out, sizeof(spif_int32_t) * (total + 1));
+    memset(self->delta, 0xff, sizeof(spif_int32_t) * (total + 1) * k);
+    memset(self->out, 0xff, sizeof(spif_int32_t) * (total + 1));
+    self->nstates = 1;
+    for (i = n; i-- > 0;) {
+        if (!self->lens[i]) {
+            continue;
+        }
+        for (s = 0, p = ptrs[i], j = 0; j < self->lens[i]; j++) {
+            c = self->classes[p[j]];
+            if (self->delta[s * k + c] < 0) {
+                self->delta[s * k + c] = self->nstates++;
+            }
+            s = self->delta[s * k + c];
+        }
+        self->next[i] = self->out[s];
+        self->out[s] = i;
+    }
+    FREE(ptrs);
+    self->delta = (spif_int32_t *) REALLOC(self->delta, sizeof(spif_int32_t) * self->nstates * k);
+    self->out = (spif_int32_t *) REALLOC(self->out, sizeof(spif_int32_t) * self->nstates);
+    self->link = (spif_int32_t *) REALLOC(self->link, sizeof(spif_int32_t) * self->nstates);
+    self->dict = (spif_int32_t *) REALLOC(self->dict, sizeof(spif_int32_t) * self->nstates);
+
+    /* Breadth-first, find each state's failure state (its longest
+       proper suffix in the trie) and fill in the missing transitions
+       from it.  A state's failure state is always shallower, so its
+       row is already complete by the time we need it. */
+    fail = (spif_int32_t *) MALLOC(sizeof(spif_int32_t) * self->nstates);
+    queue = (spif_int32_t *) MALLOC(sizeof(spif_int32_t) * self->nstates);
+    fail[0] = 0;
+    self->link[0] = self->dict[0] = -1;
+    head = tail = 0;
+    queue[tail++] = 0;
+    while (head < tail) {
+        s = queue[head++];
+        for (c = 0; c < k; c++) {
+            t = self->delta[s * k + c];
+            f = ((s) ? (self->delta[fail[s] * k + c]) : (0));
+            if (t < 0) {
+                self->delta[s * k + c] = f;
+                continue;
+            }
+            fail[t] = f;
+            self->dict[t] = ((self->out[f] >= 0) ? (f) : (self->dict[f]));
+            self->link[t] = ((self->out[t] >= 0) ? (t) : (self->dict[t]));
+            queue[tail++] = t;
+        }
+    }
+    FREE(queue);
+    FREE(fail);
+    return TRUE;
+}
+
+spif_bool_t
+spif_multisearch_done(spif_multisearch_t self)
+{
+    ASSERT_RVAL(!SPIF_MULTISEARCH_ISNULL(self), FALSE);
+    if (self->lens) {
+        FREE(self->lens);
+    }
+    if (self->next) {
+        FREE(self->next);
+    }
+    if (self->delta) {
+        FREE(self->delta);
+    }
+    if (self->out) {
+        FREE(self->out);
+    }
+    if (self->link) {
+        FREE(self->link);
+    }
+    if (self->dict) {
+        FREE(self->dict);
+    }
+    self->npatterns = 0;
+    self->nclasses = 0;
+    self->nstates = 0;
+    self->state = 0;
+    self->pos = 0;
+    return TRUE;
+}
+
+spif_bool_t
+spif_multisearch_del(spif_multisearch_t self)
+{
+    ASSERT_RVAL(!SPIF_MULTISEARCH_ISNULL(self), FALSE);
+    spif_multisearch_done(self);
+    SPIF_DEALLOC(self);
+    return TRUE;
+}
+
+spif_str_t
+spif_multisearch_show(spif_multisearch_t self, spif_charptr_t name, spif_str_t buff, size_t indent)
+{
+    if (SPIF_MULTISEARCH_ISNULL(self)) {
+        SPIF_OBJ_SHOW_NULL_INTO(multisearch, name, buff, indent);
+        return buff;
+    }
+
+    buff = spif_str_show_printf(buff, indent, "(spif_multisearch_t) %s:  %10p { %ld patterns%s, %ld states, %ld byte classes, stream offset %lu }\n",
+                                name, (spif_ptr_t) self, (long) self->npatterns, ((self->casefold) ? (" (ignoring case)") : ("")),
+                                (long) self->nstates, (long) self->nclasses, (unsigned long) self->pos);
+    return buff;
+}
+
+spif_cmp_t
+spif_multisearch_comp(spif_multisearch_t self, spif_multisearch_t other)
+{
+    return spif_obj_comp(SPIF_OBJ(self), SPIF_OBJ(other));
+}
+
+/* The copy matches the same patterns but starts a fresh stream. */
+spif_multisearch_t
+spif_multisearch_dup(spif_multisearch_t self)
+{
+    spif_multisearch_t tmp;
+
+    ASSERT_RVAL(!SPIF_MULTISEARCH_ISNULL(self), (spif_multisearch_t) NULL);
+    tmp = spif_multisearch_new();
+    tmp->npatterns = self->npatterns;
+    tmp->lens = (spif_memidx_t *) MALLOC(sizeof(spif_memidx_t) * (self->npatterns + 1));
+    memcpy(tmp->lens, self->lens, sizeof(spif_memidx_t) * self->npatterns);
+    tmp->next = (spif_listidx_t *) MALLOC(sizeof(spif_listidx_t) * (self->npatterns + 1));
+    memcpy(tmp->next, self->next, sizeof(spif_listidx_t) * self->npatterns);
+    tmp->casefold = self->casefold;
+    memcpy(tmp->classes, self->classes, sizeof(self->classes));
+    tmp->nclasses = self->nclasses;
+    tmp->nstates = self->nstates;
+    tmp->delta = (spif_int32_t *) REALLOC(tmp->delta, sizeof(spif_int32_t) * self->nstates * self->nclasses);
+    memcpy(tmp->delta, self->delta, sizeof(spif_int32_t) * self->nstates * self->nclasses);
+    tmp->out = (spif_int32_t *) REALLOC(tmp->out, sizeof(spif_int32_t) * self->nstates);
+    memcpy(tmp->out, self->out, sizeof(spif_int32_t) * self->nstates);
+    tmp->link = (spif_int32_t *) REALLOC(tmp->link, sizeof(spif_int32_t) * self->nstates);
+    memcpy(tmp->link, self->link, sizeof(spif_int32_t) * self->nstates);
+    tmp->dict = (spif_int32_t *) REALLOC(tmp->dict, sizeof(spif_int32_t) * self->nstates);
+    memcpy(tmp->dict, self->dict, sizeof(spif_int32_t) * self->nstates);
+    return tmp;
+}
+
+spif_classname_t
+spif_multisearch_type(spif_multisearch_t self)
+{
+    ASSERT_RVAL(!SPIF_MULTISEARCH_ISNULL(self), (spif_classname_t) NULL);
+    return SPIF_OBJ_CLASSNAME(self);
+}
+
+/* Return the number of patterns, including any that can never match. */
+spif_listidx_t
+spif_multisearch_count(spif_multisearch_t self)
+{
+    ASSERT_RVAL(!SPIF_MULTISEARCH_ISNULL(self), 0);
+    return self->npatterns;
+}
+
+/**
+ * Search a buffer.
+ *
+ * Calls @a func for each match in @a buff, with offsets relative to
+ * the start of @a buff.  This starts a new stream, discarding any
+ * partial matches from earlier calls to spif_multisearch_feed().
+ *
+ * @param self The matcher.
+ * @param buff The buffer to search.
+ * @param len  The length of @a buff.
+ * @param func The function to call for each match.
+ * @param data User data passed to @a func.
+ * @return     The number of bytes searched:  @a len, or less if
+ *             @a func stopped the search, or -1 on error.
+ */
+spif_memidx_t
+spif_multisearch_find(spif_multisearch_t self, spif_byteptr_t buff, spif_memidx_t len,
+                      spif_multisearch_func_t func, spif_ptr_t data)
+{
+    ASSERT_RVAL(!SPIF_MULTISEARCH_ISNULL(self), ((spif_memidx_t) -1));
+    spif_multisearch_reset(self);
+    return spif_multisearch_feed(self, buff, len, func, data);
+}
+
+spif_memidx_t
+spif_multisearch_find_str(spif_multisearch_t self, spif_str_t str, spif_multisearch_func_t func, spif_ptr_t data)
+{
+    ASSERT_RVAL(!SPIF_MULTISEARCH_ISNULL(self), ((spif_memidx_t) -1));
+    REQUIRE_RVAL(!SPIF_STR_ISNULL(str), ((spif_memidx_t) -1));
+    return spif_multisearch_find(self, (spif_byteptr_t) SPIF_STR_STR(str), spif_str_get_len(str), func, data);
+}
+
+/**
+ * Search the next chunk of a stream.
+ *
+ * Like spif_multisearch_find(), but continues from where the last
+ * call left off, so matches may start in earlier chunks.  Offsets
+ * passed to @a func are from the start of the stream.  If @a func
+ * stops the search, the bytes after the one that completed the match
+ * have not been searched and may be fed in again.
+ *
+ * @param self The matcher.
+ * @param buff The next chunk of the stream.
+ * @param len  The length of @a buff.
+ * @param func The function to call for each match.
+ * @param data User data passed to @a func.
+ * @return     The number of bytes searched, or -1 on error.
+ */
+spif_memidx_t
+spif_multisearch_feed(spif_multisearch_t self, spif_byteptr_t buff, spif_memidx_t len,
+                      spif_multisearch_func_t func, spif_ptr_t data)
+{
+    const spif_int32_t *delta, *link;
+    const spif_uint16_t *classes;
+    spif_int32_t s, r, k;
+    spif_listidx_t p;
+    spif_memidx_t i;
+
+    ASSERT_RVAL(!SPIF_MULTISEARCH_ISNULL(self), ((spif_memidx_t) -1));
+    REQUIRE_RVAL(((buff != (spif_byteptr_t) NULL) || !len), ((spif_memidx_t) -1));
+    REQUIRE_RVAL((func != (spif_multisearch_func_t) NULL), ((spif_memidx_t) -1));
+
+    delta = self->delta;
+    link = self->link;
+    classes = self->classes;
+    k = self->nclasses;
+    for (s = self->state, i = 0; i < len; i++) {
+        s = delta[s * k + classes[buff[i]]];
+        if (link[s] < 0) {
+            continue;
+        }
+        for (r = link[s]; r >= 0; r = self->dict[r]) {
+            for (p = self->out[r]; p >= 0; p = self->next[p]) {
+                if (!func(p, self->pos + i + 1 - self->lens[p], data)) {
+                    self->state = s;
+                    self->pos += i + 1;
+                    return i + 1;
+                }
+            }
+        }
+    }
+    self->state = s;
+    self->pos += len;
+    return len;
+}
+
+/* Forget any stream in progress and start counting offsets from 0. */
+spif_bool_t
+spif_multisearch_reset(spif_multisearch_t self)
+{
+    ASSERT_RVAL(!SPIF_MULTISEARCH_ISNULL(self), FALSE);
+    self->state = 0;
+    self->pos = 0;
+    return TRUE;
+}
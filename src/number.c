@@ -0,0 +1,556 @@
+/*
+ * Copyright (C) 1997-2013, Michael Jennings <mej@eterm.org>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies of the Software, its documentation and marketing & publicity
+ * materials, and acknowledgment shall be given in the documentation, materials
+ * and software packages that this Software was used.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/**
+ * @file number.c
+ * Length-bounded number parsing and printing.
+ *
+ * These routines convert between numbers and text without needing
+ * the text to be NUL-terminated, so they can work directly on a slice
+ * of a spif_str_t, spif_mbuff_t, or any other buffer.  Parsing
+ * reports how much input was used and whether the value fit;
+ * printing writes into a caller-supplied buffer of at least
+ * SPIFTOOL_NUM_BUFF_SIZE bytes and returns the length.
+ *
+ * Decimal integers are read 8 digits at a time where possible and
+ * written 2 digits at a time from a lookup table.  Doubles with up to
+ * 19 significant digits and a small exponent are converted exactly
+ * with a single multiply or divide; anything else is handed to
+ * strtod().
+ *
+ * @author Michael Jennings <mej@eterm.org>
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <float.h>
+#include <libast_internal.h>
+
+#define NUM_ISDIGIT(c)             (((unsigned) (c) - '0') < 10)
+#define NUM_UINT64_MAX             ((spif_uint64_t) -1)
+#define NUM_INT64_MAX              ((spif_int64_t) (NUM_UINT64_MAX >> 1))
+#define NUM_INT64_MIN              (-NUM_INT64_MAX - 1)
+
+/* The exact fast path for doubles assumes arithmetic is done in
+   double precision and not something wider (e.g., x87). */
+#if defined(FLT_EVAL_METHOD) && (FLT_EVAL_METHOD == 0)
+# define NUM_EXACT_DOUBLE          1
+#else
+# define NUM_EXACT_DOUBLE          0
+#endif
+
+static const char digit_pairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+#if NUM_EXACT_DOUBLE
+/* Powers of ten that are exactly representable as doubles. */
+static const double exact_pow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+#endif
+
+/* Value of an alphanumeric digit in bases up to 36, or 36 if it isn't one. */
+static unsigned
+num_digit_value(unsigned char c)
+{
+    if (NUM_ISDIGIT(c)) {
+        return c - '0';
+    }
+    c |= 0x20;
+    if ((c >= 'a') && (c <= 'z')) {
+        return c - 'a' + 10;
+    }
+    return 36;
+}
+
+#if !(WORDS_BIGENDIAN)
+/* If the 8 bytes at s are all decimal digits, store their value and
+   return TRUE.  The first byte is the most significant digit. */
+static spif_bool_t
+num_eight_digits(const char *s, spif_uint64_t *val)
+{
+    spif_uint64_t v;
+
+    memcpy(&v, s, sizeof(v));
+    if ((((v & 0xf0f0f0f0f0f0f0f0ULL) | (((v + 0x0606060606060606ULL) & 0xf0f0f0f0f0f0f0f0ULL) >> 4))
+         != 0x3333333333333333ULL)) {
+        return FALSE;
+    }
+    v &= 0x0f0f0f0f0f0f0f0fULL;
+    v = (v * 2561) >> 8;
+    v = ((v & 0x00ff00ff00ff00ffULL) * 6553601) >> 16;
+    v = ((v & 0x0000ffff0000ffffULL) * 42949672960001ULL) >> 32;
+    *val = v;
+    return TRUE;
+}
+#endif
+
+/*
+ * Shared front end for the integer parsers.  Skips leading
+ * whitespace, reads an optional sign and base prefix the way
+ * strtoul() does, then reads digits.  Returns the number of bytes
+ * consumed (0 if there was no number), the magnitude, and whether it
+ * overflowed 64 bits.
+ */
+static size_t
+num_parse_magnitude(const char *s, size_t len, int base, spif_uint64_t *mag, spif_bool_t *neg, spif_bool_t *overflow)
+{
+    size_t i, start;
+    spif_uint64_t v, cutoff;
+    unsigned d, cutlim;
+
+    *mag = 0;
+    *neg = FALSE;
+    *overflow = FALSE;
+    if ((base < 0) || (base == 1) || (base > 36)) {
+        return 0;
+    }
+    for (i = 0; (i < len) && isspace((unsigned char) s[i]); i++);
+    if ((i < len) && ((s[i] == '-') || (s[i] == '+'))) {
+        *neg = (s[i] == '-');
+        i++;
+    }
+    if (((base == 0) || (base == 16)) && (i + 2 < len) && (s[i] == '0') && ((s[i + 1] | 0x20) == 'x')
+        && (num_digit_value((unsigned char) s[i + 2]) < 16)) {
+        i += 2;
+        base = 16;
+    } else if (base == 0) {
+        base = (((i < len) && (s[i] == '0')) ? (8) : (10));
+    }
+
+    start = i;
+    v = 0;
+#if !(WORDS_BIGENDIAN)
+    if (base == 10) {
+        spif_uint64_t chunk;
+
+        /* 8 digits at a time for as long as the result can't overflow. */
+        for (; (i + 8 <= len) && (v < 100000000000ULL) && num_eight_digits(s + i, &chunk); i += 8) {
+            v = v * 100000000ULL + chunk;
+        }
+    }
+#endif
+    cutoff = NUM_UINT64_MAX / (unsigned) base;
+    cutlim = (unsigned) (NUM_UINT64_MAX % (unsigned) base);
+    for (; (i < len) && ((d = num_digit_value((unsigned char) s[i])) < (unsigned) base); i++) {
+        if ((v > cutoff) || ((v == cutoff) && (d > cutlim))) {
+            *overflow = TRUE;
+        } else {
+            v = v * (unsigned) base + d;
+        }
+    }
+    if (i == start) {
+        *neg = FALSE;
+        return 0;
+    }
+    *mag = v;
+    return i;
+}
+
+/**
+ * Parse a signed integer from a buffer.
+ *
+ * Reads an integer from the first @a len bytes of @a s, which need
+ * not be NUL-terminated.  Leading whitespace, a sign, and (for base 0
+ * or 16) a "0x" prefix are accepted as with strtol(), and base 0
+ * selects octal, decimal, or hex from the prefix.
+ *
+ * @param s      The text.
+ * @param len    The number of bytes available.
+ * @param base   The base, 2 through 36, or 0.
+ * @param result Where to store the value.  Values out of range are
+ *               clamped to the nearest limit.
+ * @param end    If non-NULL, receives the number of bytes consumed,
+ *               or 0 if no number was found.
+ * @return       TRUE if a number was found and fit, FALSE otherwise.
+ */
+spif_bool_t
+spiftool_parse_int64(const spif_charptr_t s, size_t len, int base, spif_int64_t *result, size_t *end)
+{
+    spif_uint64_t mag;
+    spif_bool_t neg, overflow;
+    size_t n;
+
+    ASSERT_RVAL(result != NULL, FALSE);
+    REQUIRE_RVAL((s != NULL) || (len == 0), FALSE);
+    n = num_parse_magnitude((const char *) s, len, base, &mag, &neg, &overflow);
+    if (end) {
+        *end = n;
+    }
+    if (neg) {
+        if (overflow || (mag > (spif_uint64_t) NUM_INT64_MAX + 1)) {
+            *result = NUM_INT64_MIN;
+            return FALSE;
+        }
+        *result = (spif_int64_t) (0 - mag);
+    } else {
+        if (overflow || (mag > (spif_uint64_t) NUM_INT64_MAX)) {
+            *result = NUM_INT64_MAX;
+            return FALSE;
+        }
+        *result = (spif_int64_t) mag;
+    }
+    return ((n) ? (TRUE) : (FALSE));
+}
+
+/**
+ * Parse an unsigned integer from a buffer.
+ *
+ * Just like spiftool_parse_int64(), except that the result is
+ * unsigned.  As with strtoul(), a leading minus sign negates the
+ * value in unsigned arithmetic.
+ *
+ * @param s      The text.
+ * @param len    The number of bytes available.
+ * @param base   The base, 2 through 36, or 0.
+ * @param result Where to store the value.  Values too large are
+ *               clamped to the maximum.
+ * @param end    If non-NULL, receives the number of bytes consumed,
+ *               or 0 if no number was found.
+ * @return       TRUE if a number was found and fit, FALSE otherwise.
+ */
+spif_bool_t
+spiftool_parse_uint64(const spif_charptr_t s, size_t len, int base, spif_uint64_t *result, size_t *end)
+{
+    spif_uint64_t mag;
+    spif_bool_t neg, overflow;
+    size_t n;
+
+    ASSERT_RVAL(result != NULL, FALSE);
+    REQUIRE_RVAL((s != NULL) || (len == 0), FALSE);
+    n = num_parse_magnitude((const char *) s, len, base, &mag, &neg, &overflow);
+    if (end) {
+        *end = n;
+    }
+    if (overflow) {
+        *result = NUM_UINT64_MAX;
+        return FALSE;
+    }
+    *result = ((neg) ? (0 - mag) : (mag));
+    return ((n) ? (TRUE) : (FALSE));
+}
+
+/* Parse with strtod() from a NUL-terminated copy of the plausible
+   part of the input.  Returns the number of bytes consumed. */
+static size_t
+num_parse_double_slow(const char *s, size_t len, double *result, spif_bool_t *range_ok)
+{
+    char tmp[64], *p, *stop;
+    size_t n;
+    int old_errno;
+
+    for (n = 0; (n < len) && s[n] && (isalnum((unsigned char) s[n]) || strchr(" \t\n\v\f\r.+-()_", s[n])); n++);
+    p = ((n < sizeof(tmp)) ? (tmp) : ((char *) MALLOC(n + 1)));
+    memcpy(p, s, n);
+    p[n] = 0;
+    old_errno = errno;
+    errno = 0;
+    *result = strtod(p, &stop);
+    *range_ok = !((errno == ERANGE) && ((*result == HUGE_VAL) || (*result == -HUGE_VAL)));
+    errno = old_errno;
+    n = stop - p;
+    if (p != tmp) {
+        FREE(p);
+    }
+    return n;
+}
+
+/**
+ * Parse a floating-point number from a buffer.
+ *
+ * Reads a number from the first @a len bytes of @a s, which need not
+ * be NUL-terminated.  Accepts everything strtod() does, including
+ * leading whitespace, exponents, "inf", "nan", and hex floats.
+ * Ordinary decimal numbers are converted without calling strtod()
+ * whenever that can be done exactly.
+ *
+ * @param s      The text.
+ * @param len    The number of bytes available.
+ * @param result Where to store the value.  Values too large become
+ *               HUGE_VAL with the appropriate sign.
+ * @param end    If non-NULL, receives the number of bytes consumed,
+ *               or 0 if no number was found.
+ * @return       TRUE if a number was found and was in range, FALSE
+ *               otherwise.
+ */
+spif_bool_t
+spiftool_parse_double(const spif_charptr_t s, size_t len, double *result, size_t *end)
+{
+    const char *p = (const char *) s;
+    size_t i, n;
+    spif_uint64_t mant;
+    int digits, exp10, eval, esign;
+    spif_bool_t neg, seen, range_ok;
+
+    ASSERT_RVAL(result != NULL, FALSE);
+    *result = 0.0;
+    if (end) {
+        *end = 0;
+    }
+    REQUIRE_RVAL((s != NULL) || (len == 0), FALSE);
+
+    for (i = 0; (i < len) && isspace((unsigned char) p[i]); i++);
+    neg = FALSE;
+    if ((i < len) && ((p[i] == '-') || (p[i] == '+'))) {
+        neg = (p[i] == '-');
+        i++;
+    }
+    if ((i + 1 < len) && (p[i] == '0') && ((p[i + 1] | 0x20) == 'x')) {
+        /* Hex floats go the long way. */
+        goto slow;
+    }
+
+    /* Significand:  up to 19 significant digits, ignoring leading zeros. */
+    mant = 0;
+    digits = 0;
+    exp10 = 0;
+    seen = FALSE;
+    for (; (i < len) && NUM_ISDIGIT(p[i]); i++) {
+        seen = TRUE;
+        if (digits < 19) {
+            mant = mant * 10 + (p[i] - '0');
+            digits += ((mant) ? (1) : (0));
+        } else {
+            goto slow;
+        }
+    }
+    if ((i < len) && (p[i] == '.')) {
+        for (i++; (i < len) && NUM_ISDIGIT(p[i]); i++) {
+            seen = TRUE;
+            if (digits < 19) {
+                mant = mant * 10 + (p[i] - '0');
+                digits += ((mant) ? (1) : (0));
+                exp10--;
+            } else {
+                goto slow;
+            }
+        }
+    }
+    if (!seen) {
+        /* No digits; could still be "inf" or "nan". */
+        goto slow;
+    }
+
+    /* Exponent, only if there are digits after the 'e' and sign. */
+    if ((i < len) && ((p[i] | 0x20) == 'e')) {
+        n = i + 1;
+        esign = 1;
+        if ((n < len) && ((p[n] == '-') || (p[n] == '+'))) {
+            esign = ((p[n] == '-') ? (-1) : (1));
+            n++;
+        }
+        if ((n < len) && NUM_ISDIGIT(p[n])) {
+            for (eval = 0; (n < len) && NUM_ISDIGIT(p[n]); n++) {
+                if (eval < 10000) {
+                    eval = eval * 10 + (p[n] - '0');
+                }
+            }
+            exp10 += esign * eval;
+            i = n;
+        }
+    }
+
+    if (mant == 0) {
+        *result = ((neg) ? (-0.0) : (0.0));
+        if (end) {
+            *end = i;
+        }
+        return TRUE;
+    }
+#if NUM_EXACT_DOUBLE
+    if ((mant <= ((spif_uint64_t) 1 << 53)) && (exp10 >= -22) && (exp10 <= 22)) {
+        double d = (double) mant;
+
+        d = ((exp10 < 0) ? (d / exact_pow10[-exp10]) : (d * exact_pow10[exp10]));
+        *result = ((neg) ? (-d) : (d));
+        if (end) {
+            *end = i;
+        }
+        return TRUE;
+    }
+#endif
+
+  slow:
+    n = num_parse_double_slow(p, len, result, &range_ok);
+    if (end) {
+        *end = n;
+    }
+    return (((n) && (range_ok)) ? (TRUE) : (FALSE));
+}
+
+/**
+ * Print an unsigned integer in decimal.
+ *
+ * @param buff The output buffer, at least SPIFTOOL_NUM_BUFF_SIZE
+ *             bytes.  The result is NUL-terminated.
+ * @param num  The value.
+ * @return     The number of characters written, not counting the NUL.
+ */
+size_t
+spiftool_format_uint64(spif_charptr_t buff, spif_uint64_t num)
+{
+    char tmp[24], *p;
+    size_t len;
+
+    ASSERT_RVAL(buff != NULL, 0);
+    p = tmp + sizeof(tmp);
+    while (num >= 100) {
+        p -= 2;
+        memcpy(p, digit_pairs + (num % 100) * 2, 2);
+        num /= 100;
+    }
+    if (num >= 10) {
+        p -= 2;
+        memcpy(p, digit_pairs + num * 2, 2);
+    } else {
+        *(--p) = (char) ('0' + num);
+    }
+    len = tmp + sizeof(tmp) - p;
+    memcpy(buff, p, len);
+    buff[len] = 0;
+    return len;
+}
+
+/**
+ * Print a signed integer in decimal.
+ *
+ * @param buff The output buffer, at least SPIFTOOL_NUM_BUFF_SIZE
+ *             bytes.  The result is NUL-terminated.
+ * @param num  The value.
+ * @return     The number of characters written, not counting the NUL.
+ */
+size_t
+spiftool_format_int64(spif_charptr_t buff, spif_int64_t num)
+{
+    ASSERT_RVAL(buff != NULL, 0);
+    if (num < 0) {
+        *buff = '-';
+        return spiftool_format_uint64(buff + 1, 0 - (spif_uint64_t) num) + 1;
+    }
+    return spiftool_format_uint64(buff, (spif_uint64_t) num);
+}
+
+/**
+ * Print a double in the shortest form that reads back exactly.
+ *
+ * The output looks like printf()'s "%g" with just enough significant
+ * digits (at most 17) that spiftool_parse_double() or strtod() gives
+ * back exactly @a num.  Whole numbers below 10^15 are printed as
+ * integers without going through printf() at all.  Infinities and
+ * NaNs are printed as "inf", "-inf", and "nan".
+ *
+ * @param buff The output buffer, at least SPIFTOOL_NUM_BUFF_SIZE
+ *             bytes.  The result is NUL-terminated.
+ * @param num  The value.
+ * @return     The number of characters written, not counting the NUL.
+ */
+size_t
+spiftool_format_double(spif_charptr_t buff, double num)
+{
+    double check;
+    int prec, len;
+
+    ASSERT_RVAL(buff != NULL, 0);
+    if (num != num) {
+        memcpy(buff, "nan", 4);
+        return 3;
+    } else if (num == HUGE_VAL) {
+        memcpy(buff, "inf", 4);
+        return 3;
+    } else if (num == -HUGE_VAL) {
+        memcpy(buff, "-inf", 5);
+        return 4;
+    } else if ((num > -1e15) && (num < 1e15) && (num == (double) (spif_int64_t) num)) {
+        if ((num == 0.0) && signbit(num)) {
+            memcpy(buff, "-0", 3);
+            return 2;
+        }
+        return spiftool_format_int64(buff, (spif_int64_t) num);
+    }
+
+#if NUM_EXACT_DOUBLE
+    /* Most values are short decimals like 12.75.  Find the fewest
+       decimal places that read back exactly; both the scaled integer
+       and the power of ten are exact, so the division below is
+       exactly what parsing the result would do.  Stopping at 15
+       significant digits means only one candidate can match, so it
+       is the same one printf() would produce. */
+    if ((num > -1e15) && (num < 1e15) && ((num >= 1e-4) || (num <= -1e-4))) {
+        double a = ((num < 0) ? (-num) : (num));
+        char digits[SPIFTOOL_NUM_BUFF_SIZE], *p = (char *) buff;
+        spif_uint64_t m;
+        size_t n;
+
+        for (prec = 1; (prec <= 22) && (a * exact_pow10[prec] < 1e15); prec++) {
+            m = (spif_uint64_t) (a * exact_pow10[prec] + 0.5);
+            if ((double) m / exact_pow10[prec] != a) {
+                continue;
+            }
+            for (; (m % 10) == 0; m /= 10, prec--);
+            n = spiftool_format_uint64(SPIF_CHARPTR(digits), m);
+            if (num < 0) {
+                *p++ = '-';
+            }
+            if (n <= (size_t) prec) {
+                *p++ = '0';
+                *p++ = '.';
+                memset(p, '0', prec - n);
+                p += prec - n;
+                memcpy(p, digits, n);
+            } else {
+                memcpy(p, digits, n - prec);
+                p += n - prec;
+                *p++ = '.';
+                memcpy(p, digits + n - prec, prec);
+            }
+            p += ((n <= (size_t) prec) ? (n) : (prec));
+            *p = 0;
+            return p - (char *) buff;
+        }
+    }
+#endif
+
+    /* Any decimal with 15 significant digits survives a trip through a
+       normal double, so nothing shorter than that needs to be tried.
+       Subnormals have less precision and may need fewer. */
+    for (prec = (((num > -DBL_MIN) && (num < DBL_MIN)) ? (1) : (15)); prec < 17; prec++) {
+        len = snprintf((char *) buff, SPIFTOOL_NUM_BUFF_SIZE, "%.*g", prec, num);
+        if (spiftool_parse_double(buff, len, &check, NULL) && (check == num)) {
+            return len;
+        }
+    }
+    return snprintf((char *) buff, SPIFTOOL_NUM_BUFF_SIZE, "%.17g", num);
+}
@@ -237,22 +237,13 @@ spif_obj_done(spif_obj_t self)
 spif_str_t
 spif_obj_show(spif_obj_t self, spif_charptr_t name, spif_str_t buff, size_t indent)
 {
-    spif_char_t tmp[4096];
-
     if (SPIF_OBJ_ISNULL(self)) {
-        SPIF_OBJ_SHOW_NULL(obj, name, buff, indent, tmp);
+        SPIF_OBJ_SHOW_NULL_INTO(obj, name, buff, indent);
         return buff;
     }
 
-    memset(tmp, ' ', indent);
-    snprintf((char *) tmp + indent, sizeof(tmp) - indent,
-             "(spif_obj_t) %s:  %10p \"%s\"\n",
-             name, (spif_ptr_t) self, SPIF_OBJ_CLASSNAME(self));
-    if (SPIF_STR_ISNULL(buff)) {
-        buff = spif_str_new_from_ptr(tmp);
-    } else {
-        spif_str_append_from_ptr(buff, tmp);
-    }
+    buff = spif_str_show_printf(buff, indent, "(spif_obj_t) %s:  %10p \"%s\"\n",
+                                name, (spif_ptr_t) self, SPIF_OBJ_CLASSNAME(self));
     return buff;
 }
 
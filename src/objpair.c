@@ -114,7 +114,7 @@ spif_objpair_new(void)
 {
     spif_objpair_t self;
 
-    self = SPIF_ALLOC(objpair);
+    self = SPIF_POOL_ALLOC(objpair);
     if (!spif_objpair_init(self)) {
         SPIF_DEALLOC(self);
         self = (spif_objpair_t) NULL;
@@ -138,7 +138,7 @@ spif_objpair_new_from_key(spif_obj_t key)
 {
     spif_objpair_t self;
 
-    self = SPIF_ALLOC(objpair);
+    self = SPIF_POOL_ALLOC(objpair);
     if (!spif_objpair_init_from_key(self, key)) {
         SPIF_DEALLOC(self);
         self = (spif_objpair_t) NULL;
@@ -162,7 +162,7 @@ spif_objpair_new_from_value(spif_obj_t value)
 {
     spif_objpair_t self;
 
-    self = SPIF_ALLOC(objpair);
+    self = SPIF_POOL_ALLOC(objpair);
     if (!spif_objpair_init_from_value(self, value)) {
         SPIF_DEALLOC(self);
         self = (spif_objpair_t) NULL;
@@ -188,7 +188,7 @@ spif_objpair_new_from_both(spif_obj_t key, spif_obj_t value)
 {
     spif_objpair_t self;
 
-    self = SPIF_ALLOC(objpair);
+    self = SPIF_POOL_ALLOC(objpair);
     if (!spif_objpair_init_from_both(self, key, value)) {
         SPIF_DEALLOC(self);
         self = (spif_objpair_t) NULL;
@@ -327,7 +327,8 @@ spif_objpair_done(spif_objpair_t self)
  *
  * This function deletes an instance of an @c objpair.  The done method,
  * spif_objpair_done(), is called to free any object resources prior to
- * deallocation of the object itself.
+ * deallocation of the object itself (or its return to the @c objpair
+ * pool, if one is enabled; see spif_pool_enable()).
  *
  * @param self The @c objpair instance to be deleted.
  * @return     #TRUE if successful, #FALSE otherwise.
@@ -340,7 +341,7 @@ spif_objpair_del(spif_objpair_t self)
 {
     ASSERT_RVAL(!SPIF_OBJPAIR_ISNULL(self), FALSE);
     spif_objpair_done(self);
-    SPIF_DEALLOC(self);
+    SPIF_POOL_DEALLOC(self);
     return TRUE;
 }
 
@@ -363,22 +364,13 @@ spif_objpair_del(spif_objpair_t self)
 spif_str_t
 spif_objpair_show(spif_objpair_t self, spif_charptr_t name, spif_str_t buff, size_t indent)
 {
-    spif_char_t tmp[4096];
-
     if (SPIF_OBJPAIR_ISNULL(self)) {
-        SPIF_OBJ_SHOW_NULL(objpair, name, buff, indent, tmp);
+        SPIF_OBJ_SHOW_NULL_INTO(objpair, name, buff, indent);
         return buff;
     }
 
-    memset(tmp, ' ', indent);
-    snprintf((char *) tmp + indent, sizeof(tmp) - indent,
-             "(spif_objpair_t) %s:  %10p \"%s\"\n",
-             name, (spif_ptr_t) self, SPIF_OBJ_CLASSNAME(self));
-    if (SPIF_STR_ISNULL(buff)) {
-        buff = spif_str_new_from_ptr(tmp);
-    } else {
-        spif_str_append_from_ptr(buff, tmp);
-    }
+    buff = spif_str_show_printf(buff, indent, "(spif_objpair_t) %s:  %10p \"%s\"\n",
+                                name, (spif_ptr_t) self, SPIF_OBJ_CLASSNAME(self));
     return buff;
 }
 
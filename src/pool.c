@@ -0,0 +1,280 @@
+/*
+ * Copyright (C) 1997-2013, Michael Jennings <mej@eterm.org>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies of the Software, its documentation and marketing & publicity
+ * materials, and acknowledgment shall be given in the documentation, materials
+ * and software packages that this Software was used.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <libast_internal.h>
+#include <pthread.h>
+
+/* *INDENT-OFF* */
+SPIF_DECL_TYPE(pool, SPIF_DECL_OBJ_STRUCT(pool));
+
+SPIF_DECL_OBJ_STRUCT(pool) {
+    spif_class_t cls;
+    spif_pthreads_mutex_t lock;
+    spif_listidx_t low;
+    spif_listidx_t high;
+    spif_listidx_t len;
+    spif_obj_t *objs;
+    spif_uint64_t hits;
+    spif_uint64_t misses;
+    spif_uint64_t discards;
+};
+/* *INDENT-ON* */
+
+/* Pools are only ever added to this table, never removed, so lookups
+   can scan it without taking the registry lock. */
+static spif_pool_t pools[SPIF_POOL_MAX_CLASSES];
+static volatile spif_listidx_t pool_count = 0;
+static spif_pthreads_mutex_t pool_registry_lock = (spif_pthreads_mutex_t) NULL;
+static pthread_once_t pool_registry_once = PTHREAD_ONCE_INIT;
+
+static void spif_pool_registry_init(void);
+static spif_pool_t spif_pool_find(spif_class_t);
+static spif_obj_t *spif_pool_shrink(spif_pool_t, spif_listidx_t, spif_listidx_t *);
+static void spif_pool_discard(spif_obj_t *, spif_listidx_t);
+
+static void
+spif_pool_registry_init(void)
+{
+    pool_registry_lock = spif_pthreads_mutex_new();
+}
+
+static spif_pool_t
+spif_pool_find(spif_class_t cls)
+{
+    spif_listidx_t i, n;
+
+    if (!pool_count) {
+        return (spif_pool_t) NULL;
+    }
+    n = pool_count;
+    __sync_synchronize();
+    for (i = 0; i < n; i++) {
+        if (pools[i]->cls == cls) {
+            return pools[i];
+        }
+    }
+    return (spif_pool_t) NULL;
+}
+
+/* Detach everything past the first target objects.  Called with the
+   pool locked; the caller discards the victims after unlocking, since
+   finishing an object may delete others that go back to a pool. */
+static spif_obj_t *
+spif_pool_shrink(spif_pool_t pool, spif_listidx_t target, spif_listidx_t *count)
+{
+    spif_obj_t *victims;
+
+    *count = 0;
+    if (pool->len <= target) {
+        return (spif_obj_t *) NULL;
+    }
+    *count = pool->len - target;
+    victims = (spif_obj_t *) MALLOC(sizeof(spif_obj_t) * (*count));
+    memcpy(victims, pool->objs + target, sizeof(spif_obj_t) * (*count));
+    pool->len = target;
+    pool->discards += *count;
+    return victims;
+}
+
+static void
+spif_pool_discard(spif_obj_t *victims, spif_listidx_t count)
+{
+    spif_listidx_t i;
+
+    if (!victims) {
+        return;
+    }
+    for (i = 0; i < count; i++) {
+        SPIF_OBJ_DONE(victims[i]);
+        SPIF_DEALLOC(victims[i]);
+    }
+    FREE(victims);
+}
+
+spif_bool_t
+spif_pool_enable(spif_class_t cls, spif_listidx_t low, spif_listidx_t high)
+{
+    spif_pool_t pool;
+    spif_obj_t *victims = (spif_obj_t *) NULL;
+    spif_listidx_t count = 0;
+
+    REQUIRE_RVAL(cls != (spif_class_t) NULL, FALSE);
+    REQUIRE_RVAL(high > 0, FALSE);
+    REQUIRE_RVAL(low >= 0 && low <= high, FALSE);
+
+    pthread_once(&pool_registry_once, spif_pool_registry_init);
+    spif_pthreads_mutex_lock(pool_registry_lock);
+    pool = spif_pool_find(cls);
+    if (!pool) {
+        if (pool_count >= SPIF_POOL_MAX_CLASSES) {
+            spif_pthreads_mutex_unlock(pool_registry_lock);
+            return FALSE;
+        }
+        pool = (spif_pool_t) MALLOC(SPIF_SIZEOF_TYPE(pool));
+        memset(pool, 0, SPIF_SIZEOF_TYPE(pool));
+        pool->cls = cls;
+        pool->lock = spif_pthreads_mutex_new();
+        pools[pool_count] = pool;
+        __sync_synchronize();
+        pool_count++;
+    }
+    spif_pthreads_mutex_unlock(pool_registry_lock);
+
+    spif_pthreads_mutex_lock(pool->lock);
+    if (pool->len > high) {
+        victims = spif_pool_shrink(pool, low, &count);
+    }
+    pool->objs = (spif_obj_t *) REALLOC(pool->objs, sizeof(spif_obj_t) * high);
+    pool->low = low;
+    pool->high = high;
+    spif_pthreads_mutex_unlock(pool->lock);
+    spif_pool_discard(victims, count);
+    return TRUE;
+}
+
+spif_bool_t
+spif_pool_disable(spif_class_t cls)
+{
+    spif_pool_t pool;
+    spif_obj_t *victims;
+    spif_listidx_t count;
+
+    pool = spif_pool_find(cls);
+    REQUIRE_RVAL(pool != (spif_pool_t) NULL, FALSE);
+    spif_pthreads_mutex_lock(pool->lock);
+    victims = spif_pool_shrink(pool, 0, &count);
+    pool->low = pool->high = 0;
+    FREE(pool->objs);
+    spif_pthreads_mutex_unlock(pool->lock);
+    spif_pool_discard(victims, count);
+    return TRUE;
+}
+
+spif_bool_t
+spif_pool_trim(spif_class_t cls)
+{
+    spif_pool_t pool;
+    spif_obj_t *victims;
+    spif_listidx_t count;
+
+    pool = spif_pool_find(cls);
+    REQUIRE_RVAL(pool != (spif_pool_t) NULL, FALSE);
+    spif_pthreads_mutex_lock(pool->lock);
+    victims = spif_pool_shrink(pool, pool->low, &count);
+    spif_pthreads_mutex_unlock(pool->lock);
+    spif_pool_discard(victims, count);
+    return TRUE;
+}
+
+spif_obj_t
+spif_pool_take(spif_class_t cls)
+{
+    spif_pool_t pool;
+    spif_obj_t obj = (spif_obj_t) NULL;
+
+    pool = spif_pool_find(cls);
+    if (!pool) {
+        return (spif_obj_t) NULL;
+    }
+    spif_pthreads_mutex_lock(pool->lock);
+    if (pool->len) {
+        obj = pool->objs[--pool->len];
+        pool->hits++;
+    } else if (pool->high) {
+        pool->misses++;
+    }
+    spif_pthreads_mutex_unlock(pool->lock);
+    return obj;
+}
+
+spif_bool_t
+spif_pool_give(spif_obj_t obj)
+{
+    spif_pool_t pool;
+    spif_obj_t *victims = (spif_obj_t *) NULL;
+    spif_listidx_t count = 0;
+    spif_bool_t kept = FALSE;
+
+    REQUIRE_RVAL(!SPIF_OBJ_ISNULL(obj), FALSE);
+    pool = spif_pool_find(SPIF_OBJ_CLASS(obj));
+    if (!pool) {
+        return FALSE;
+    }
+    spif_pthreads_mutex_lock(pool->lock);
+    if (pool->high) {
+        if (pool->len >= pool->high) {
+            victims = spif_pool_shrink(pool, pool->low, &count);
+        }
+        if (pool->len < pool->high) {
+            pool->objs[pool->len++] = obj;
+            kept = TRUE;
+        } else {
+            pool->discards++;
+        }
+    }
+    spif_pthreads_mutex_unlock(pool->lock);
+    spif_pool_discard(victims, count);
+    return kept;
+}
+
+spif_ptr_t
+spif_pool_alloc(spif_class_t cls, size_t size)
+{
+    spif_obj_t obj;
+
+    obj = spif_pool_take(cls);
+    if (SPIF_OBJ_ISNULL(obj)) {
+        return (spif_ptr_t) MALLOC(size);
+    }
+    return (spif_ptr_t) obj;
+}
+
+spif_bool_t
+spif_pool_get_stats(spif_class_t cls, spif_listidx_t *len, spif_uint64_t *hits, spif_uint64_t *misses,
+                    spif_uint64_t *discards)
+{
+    spif_pool_t pool;
+
+    pool = spif_pool_find(cls);
+    REQUIRE_RVAL(pool != (spif_pool_t) NULL, FALSE);
+    spif_pthreads_mutex_lock(pool->lock);
+    if (len) {
+        *len = pool->len;
+    }
+    if (hits) {
+        *hits = pool->hits;
+    }
+    if (misses) {
+        *misses = pool->misses;
+    }
+    if (discards) {
+        *discards = pool->discards;
+    }
+    spif_pthreads_mutex_unlock(pool->lock);
+    return TRUE;
+}
@@ -190,50 +190,28 @@ spif_pthreads_del(spif_pthreads_t self)
 spif_str_t
 spif_pthreads_show(spif_pthreads_t self, spif_charptr_t name, spif_str_t buff, size_t indent)
 {
-    spif_char_t tmp[4096];
-
     if (SPIF_PTHREADS_ISNULL(self)) {
-        SPIF_OBJ_SHOW_NULL(pthreads, name, buff, indent, tmp);
+        SPIF_OBJ_SHOW_NULL_INTO(pthreads, name, buff, indent);
         return buff;
     }
 
-    memset(tmp, ' ', indent);
-    snprintf((char *) tmp + indent, sizeof(tmp) - indent,
-             "(spif_pthreads_t) %s:  %10p { \"",
-             name, (spif_ptr_t) self);
-    if (SPIF_STR_ISNULL(buff)) {
-        buff = spif_str_new_from_ptr(tmp);
-    } else {
-        spif_str_append_from_ptr(buff, tmp);
-    }
+    buff = spif_str_show_printf(buff, indent, "(spif_pthreads_t) %s:  %10p { \"",
+                                name, (spif_ptr_t) self);
 
     indent += 2;
-    if (indent < sizeof(tmp)) {
-        memset(tmp, ' ', indent);
-    }
-    snprintf((char *) tmp + indent, sizeof(tmp) - indent, "(pthread_t) handle:  %ld\n", (long) self->handle);
-    spif_str_append_from_ptr(buff, tmp);
-
-    snprintf((char *) tmp + indent, sizeof(tmp) - indent, "(pthread_t) creator:  %ld\n", (long) self->creator);
-    spif_str_append_from_ptr(buff, tmp);
-
-    snprintf((char *) tmp + indent, sizeof(tmp) - indent, "(pthread_attr_t) attr:  %10p {...}\n", &self->attr);
-    spif_str_append_from_ptr(buff, tmp);
-
-    snprintf((char *) tmp + indent, sizeof(tmp) - indent, "(spif_thread_func_t) main_func:  %10p\n", self->main_func);
-    spif_str_append_from_ptr(buff, tmp);
-
-    snprintf((char *) tmp + indent, sizeof(tmp) - indent, "(spif_thread_data_t) data:  %10p\n", self->data);
-    spif_str_append_from_ptr(buff, tmp);
+    buff = spif_str_show_printf(buff, indent, "(pthread_t) handle:  %ld\n", (long) self->handle);
+    buff = spif_str_show_printf(buff, indent, "(pthread_t) creator:  %ld\n", (long) self->creator);
+    buff = spif_str_show_printf(buff, indent, "(pthread_attr_t) attr:  %10p {...}\n", &self->attr);
+    buff = spif_str_show_printf(buff, indent, "(spif_thread_func_t) main_func:  %10p\n", self->main_func);
+    buff = spif_str_show_printf(buff, indent, "(spif_thread_data_t) data:  %10p\n", self->data);
 
     if (SPIF_LIST_ISNULL(self->tls_keys)) {
-        SPIF_OBJ_SHOW_NULL(list, "tls_keys", buff, indent, tmp);
+        SPIF_OBJ_SHOW_NULL_INTO(list, "tls_keys", buff, indent);
     } else {
         buff = SPIF_LIST_SHOW(self->tls_keys, buff, indent);
     }
 
-    snprintf((char *) tmp, sizeof(tmp), "}\n");
-    spif_str_append_from_ptr(buff, tmp);
+    spif_str_append_from_ptr(buff, SPIF_CHARPTR("}\n"));
     return buff;
 }
 
@@ -458,8 +436,16 @@ spif_pthreads_wait(spif_pthreads_t self, spif_condition_t cond)
 spif_bool_t
 spif_pthreads_wait_for(spif_pthreads_t self, spif_pthreads_t other)
 {
-    ASSERT_RVAL(!SPIF_PTHREADS_ISNULL(self), FALSE);
+    /* self may be NULL when the waiter isn't a spif_pthreads_t of its own. */
+    USE_VAR(self);
     ASSERT_RVAL(!SPIF_PTHREADS_ISNULL(other), FALSE);
+    REQUIRE_RVAL(other->handle, FALSE);
+
+    if (pthread_join(other->handle, NULL)) {
+        return FALSE;
+    }
+    other->handle = (pthread_t) 0;
+    return TRUE;
 }
 
 SPIF_DEFINE_PROPERTY_FUNC_C(pthreads, pthread_t, handle);
@@ -520,38 +506,24 @@ spif_pthreads_mutex_del(spif_pthreads_mutex_t self)
 spif_str_t
 spif_pthreads_mutex_show(spif_pthreads_mutex_t self, spif_charptr_t name, spif_str_t buff, size_t indent)
 {
-    spif_char_t tmp[4096];
-
     if (SPIF_PTHREADS_MUTEX_ISNULL(self)) {
-        SPIF_OBJ_SHOW_NULL(pthreads_mutex, name, buff, indent, tmp);
+        SPIF_OBJ_SHOW_NULL_INTO(pthreads_mutex, name, buff, indent);
         return buff;
     }
 
-    memset(tmp, ' ', indent);
-    snprintf((char *) tmp + indent, sizeof(tmp) - indent,
-             "(spif_pthreads_mutex_t) %s:  %10p { \"",
-             name, (spif_ptr_t) self);
-    if (SPIF_STR_ISNULL(buff)) {
-        buff = spif_str_new_from_ptr(tmp);
-    } else {
-        spif_str_append_from_ptr(buff, tmp);
-    }
+    buff = spif_str_show_printf(buff, indent, "(spif_pthreads_mutex_t) %s:  %10p { \"",
+                                name, (spif_ptr_t) self);
 
     indent += 2;
-    if (indent < sizeof(tmp)) {
-        memset(tmp, ' ', indent);
-    }
     if (SPIF_THREAD_ISNULL(self->creator)) {
-        SPIF_OBJ_SHOW_NULL(thread, "creator", buff, indent, tmp);
+        SPIF_OBJ_SHOW_NULL_INTO(thread, "creator", buff, indent);
     } else {
         buff = SPIF_THREAD_SHOW(self->creator, buff, indent);
     }
 
-    snprintf((char *) tmp + indent, sizeof(tmp) - indent, "(pthread_mutex_t) mutex:  %10p {...}\n", &self->mutex);
-    spif_str_append_from_ptr(buff, tmp);
+    buff = spif_str_show_printf(buff, indent, "(pthread_mutex_t) mutex:  %10p {...}\n", &self->mutex);
 
-    snprintf((char *) tmp, sizeof(tmp), "}\n");
-    spif_str_append_from_ptr(buff, tmp);
+    spif_str_append_from_ptr(buff, SPIF_CHARPTR("}\n"));
     return buff;
 }
 
@@ -583,19 +555,22 @@ spif_pthreads_mutex_type(spif_pthreads_mutex_t self)
 spif_bool_t
 spif_pthreads_mutex_lock(spif_pthreads_mutex_t self)
 {
-
+    ASSERT_RVAL(!SPIF_PTHREADS_MUTEX_ISNULL(self), FALSE);
+    return ((pthread_mutex_lock(&self->mutex)) ? (FALSE) : (TRUE));
 }
 
 spif_bool_t
 spif_pthreads_mutex_lock_nowait(spif_pthreads_mutex_t self)
 {
-
+    ASSERT_RVAL(!SPIF_PTHREADS_MUTEX_ISNULL(self), FALSE);
+    return ((pthread_mutex_trylock(&self->mutex)) ? (FALSE) : (TRUE));
 }
 
 spif_bool_t
 spif_pthreads_mutex_unlock(spif_pthreads_mutex_t self)
 {
-
+    ASSERT_RVAL(!SPIF_PTHREADS_MUTEX_ISNULL(self), FALSE);
+    return ((pthread_mutex_unlock(&self->mutex)) ? (FALSE) : (TRUE));
 }
 
 SPIF_DEFINE_PROPERTY_FUNC(pthreads_mutex, thread, creator);
@@ -648,34 +623,20 @@ spif_pthreads_condition_del(spif_pthreads_condition_t self)
 spif_str_t
 spif_pthreads_condition_show(spif_pthreads_condition_t self, spif_charptr_t name, spif_str_t buff, size_t indent)
 {
-    spif_char_t tmp[4096];
-
     if (SPIF_PTHREADS_CONDITION_ISNULL(self)) {
-        SPIF_OBJ_SHOW_NULL(pthreads_condition, name, buff, indent, tmp);
+        SPIF_OBJ_SHOW_NULL_INTO(pthreads_condition, name, buff, indent);
         return buff;
     }
 
-    memset(tmp, ' ', indent);
-    snprintf((char *) tmp + indent, sizeof(tmp) - indent,
-             "(spif_pthreads_condition_t) %s:  %10p { \"",
-             name, (spif_ptr_t) self);
-    if (SPIF_STR_ISNULL(buff)) {
-        buff = spif_str_new_from_ptr(tmp);
-    } else {
-        spif_str_append_from_ptr(buff, tmp);
-    }
+    buff = spif_str_show_printf(buff, indent, "(spif_pthreads_condition_t) %s:  %10p { \"",
+                                name, (spif_ptr_t) self);
 
     indent += 2;
-    if (indent < sizeof(tmp)) {
-        memset(tmp, ' ', indent);
-    }
     buff = spif_pthreads_mutex_show(SPIF_PTHREADS_MUTEX(self), "self", buff, indent);
 
-    snprintf((char *) tmp + indent, sizeof(tmp) - indent, "(pthread_cond_t) cond:  %10p {...}\n", &self->cond);
-    spif_str_append_from_ptr(buff, tmp);
+    buff = spif_str_show_printf(buff, indent, "(pthread_cond_t) cond:  %10p {...}\n", &self->cond);
 
-    snprintf((char *) tmp, sizeof(tmp), "}\n");
-    spif_str_append_from_ptr(buff, tmp);
+    spif_str_append_from_ptr(buff, SPIF_CHARPTR("}\n"));
     return buff;
 }
 
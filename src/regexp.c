@@ -144,25 +144,14 @@ spif_regexp_del(spif_regexp_t self)
 spif_str_t
 spif_regexp_show(spif_regexp_t self, spif_charptr_t name, spif_str_t buff, size_t indent)
 {
-    spif_char_t tmp[4096];
-
     if (SPIF_REGEXP_ISNULL(self)) {
-        SPIF_OBJ_SHOW_NULL(regexp, name, buff, indent, tmp);
+        SPIF_OBJ_SHOW_NULL_INTO(regexp, name, buff, indent);
         return buff;
     }
 
-    memset(tmp, ' ', indent);
-    snprintf((char *) tmp + indent, sizeof(tmp) - indent,
-             "(spif_regexp_t) %s:  %10p {\n",
-             name, (spif_ptr_t) self);
-    if (SPIF_REGEXP_ISNULL(buff)) {
-        buff = spif_str_new_from_ptr(tmp);
-    } else {
-        spif_str_append_from_ptr(buff, tmp);
-    }
+    buff = spif_str_show_printf(buff, indent, "(spif_regexp_t) %s:  %10p {\n", name, (spif_ptr_t) self);
 
-    snprintf((char *) tmp, sizeof(tmp), "}\n");
-    spif_str_append_from_ptr(buff, tmp);
+    spif_str_append_from_ptr(buff, SPIF_CHARPTR("}\n"));
     return buff;
 }
 
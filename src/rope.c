@@ -0,0 +1,1188 @@
+/*
+ * Copyright (C) 1997-2013, Michael Jennings <mej@eterm.org>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies of the Software, its documentation and marketing & publicity
+ * materials, and acknowledgment shall be given in the documentation, materials
+ * and software packages that this Software was used.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <libast_internal.h>
+
+/* *INDENT-OFF* */
+static SPIF_CONST_TYPE(strclass) r_class = {
+    {
+        SPIF_DECL_CLASSNAME(rope),
+        (spif_func_t) spif_rope_new,
+        (spif_func_t) spif_rope_init,
+        (spif_func_t) spif_rope_done,
+        (spif_func_t) spif_rope_del,
+        (spif_func_t) spif_rope_show,
+        (spif_func_t) spif_rope_comp,
+        (spif_func_t) spif_rope_dup,
+        (spif_func_t) spif_rope_type
+    },
+    (spif_func_t) spif_rope_new_from_ptr,
+    (spif_func_t) spif_rope_new_from_buff,
+    (spif_func_t) spif_rope_new_from_fp,
+    (spif_func_t) spif_rope_new_from_fd,
+    (spif_func_t) spif_rope_new_from_num,
+    (spif_func_t) spif_rope_init_from_ptr,
+    (spif_func_t) spif_rope_init_from_buff,
+    (spif_func_t) spif_rope_init_from_fp,
+    (spif_func_t) spif_rope_init_from_fd,
+    (spif_func_t) spif_rope_init_from_num,
+    (spif_func_t) spif_rope_append,
+    (spif_func_t) spif_rope_append_char,
+    (spif_func_t) spif_rope_append_from_ptr,
+    (spif_func_t) spif_rope_casecmp,
+    (spif_func_t) spif_rope_casecmp_with_ptr,
+    (spif_func_t) spif_rope_clear,
+    (spif_func_t) spif_rope_cmp,
+    (spif_func_t) spif_rope_cmp_with_ptr,
+    (spif_func_t) spif_rope_downcase,
+    (spif_func_t) spif_rope_find,
+    (spif_func_t) spif_rope_find_from_ptr,
+    (spif_func_t) spif_rope_index,
+    (spif_func_t) spif_rope_ncasecmp,
+    (spif_func_t) spif_rope_ncasecmp_with_ptr,
+    (spif_func_t) spif_rope_ncmp,
+    (spif_func_t) spif_rope_ncmp_with_ptr,
+    (spif_func_t) spif_rope_prepend,
+    (spif_func_t) spif_rope_prepend_char,
+    (spif_func_t) spif_rope_prepend_from_ptr,
+    (spif_func_t) spif_rope_reverse,
+    (spif_func_t) spif_rope_rindex,
+    (spif_func_t) spif_rope_splice,
+    (spif_func_t) spif_rope_splice_from_ptr,
+    (spif_func_t) spif_rope_sprintf,
+    (spif_func_t) spif_rope_substr,
+    (spif_func_t) spif_rope_substr_to_ptr,
+    (spif_func_t) spif_rope_to_float,
+    (spif_func_t) spif_rope_to_num,
+    (spif_func_t) spif_rope_trim,
+    (spif_func_t) spif_rope_upcase
+};
+SPIF_TYPE(class) SPIF_CLASS_VAR(rope) = (spif_class_t) &r_class;
+SPIF_TYPE(strclass) SPIF_STRCLASS_VAR(rope) = &r_class;
+/* *INDENT-ON* */
+
+/*
+ * Tree nodes are immutable once built and reference counted, so any
+ * number of ropes can share them.  Leaves (height 0) hold up to
+ * ROPE_LEAF_MAX bytes of text, NUL-terminated for convenience; inner
+ * nodes (height > 0) have exactly two children.  Every edit is done
+ * with two primitives, split and join, which build the few new nodes
+ * along one root-to-leaf path and share everything else.  Joining two
+ * leaves that fit in one merges them, so runs of small edits don't
+ * leave the text in tiny pieces.
+ */
+SPIF_DECL_OBJ_STRUCT(rope_node) {
+    spif_uint32_t refs;
+    spif_uint8_t height;
+    spif_stridx_t len;
+    spif_rope_node_t left, right;
+    char data[1];
+};
+
+#define ROPE_LEAF_MAX           1024
+#define ROPE_IS_LEAF(n)         ((n)->height == 0)
+
+/* Transformations for spif_rope_node_map(). */
+#define ROPE_MAP_DOWNCASE       0
+#define ROPE_MAP_UPCASE         1
+#define ROPE_MAP_CLEAR          2
+#define ROPE_MAP_REVERSE        3
+
+static spif_rope_node_t
+spif_rope_node_retain(spif_rope_node_t node)
+{
+    if (node) {
+        node->refs++;
+    }
+    return node;
+}
+
+static void
+spif_rope_node_release(spif_rope_node_t node)
+{
+    if (!node || --node->refs) {
+        return;
+    }
+    if (!ROPE_IS_LEAF(node)) {
+        spif_rope_node_release(node->left);
+        spif_rope_node_release(node->right);
+    }
+    FREE(node);
+}
+
+static spif_rope_node_t
+spif_rope_node_new_leaf(const char *buff, spif_stridx_t len)
+{
+    spif_rope_node_t node;
+
+    node = (spif_rope_node_t) MALLOC(sizeof(SPIF_DECL_OBJ_STRUCT(rope_node)) + len);
+    node->refs = 1;
+    node->height = 0;
+    node->len = len;
+    node->left = node->right = (spif_rope_node_t) NULL;
+    if (buff) {
+        memcpy(node->data, buff, len);
+    }
+    node->data[len] = 0;
+    return node;
+}
+
+/* Make an inner node, taking over the caller's references to the
+   children. */
+static spif_rope_node_t
+spif_rope_node_new_pair(spif_rope_node_t left, spif_rope_node_t right)
+{
+    spif_rope_node_t node;
+
+    node = (spif_rope_node_t) MALLOC(sizeof(SPIF_DECL_OBJ_STRUCT(rope_node)));
+    node->refs = 1;
+    node->height = MAX(left->height, right->height) + 1;
+    node->len = left->len + right->len;
+    node->left = left;
+    node->right = right;
+    return node;
+}
+
+/* Build a perfectly balanced tree over a buffer. */
+static spif_rope_node_t
+spif_rope_node_build(const char *buff, spif_stridx_t len)
+{
+    spif_stridx_t half;
+
+    if (!len) {
+        return (spif_rope_node_t) NULL;
+    } else if (len <= ROPE_LEAF_MAX) {
+        return spif_rope_node_new_leaf(buff, len);
+    }
+    half = ((len + ROPE_LEAF_MAX - 1) / ROPE_LEAF_MAX / 2) * ROPE_LEAF_MAX;
+    return spif_rope_node_new_pair(spif_rope_node_build(buff, half), spif_rope_node_build(buff + half, len - half));
+}
+
+/* Make an inner node from two subtrees whose heights differ by at most
+   2, rotating to restore the AVL balance if needed.  Takes over the
+   caller's references. */
+static spif_rope_node_t
+spif_rope_node_balance(spif_rope_node_t left, spif_rope_node_t right)
+{
+    spif_rope_node_t node, mid;
+
+    if (left->height > right->height + 1) {
+        if (left->left->height >= left->right->height) {
+            node = spif_rope_node_new_pair(spif_rope_node_retain(left->left),
+                                           spif_rope_node_new_pair(spif_rope_node_retain(left->right), right));
+        } else {
+            mid = left->right;
+            node = spif_rope_node_new_pair(spif_rope_node_new_pair(spif_rope_node_retain(left->left),
+                                                                   spif_rope_node_retain(mid->left)),
+                                           spif_rope_node_new_pair(spif_rope_node_retain(mid->right), right));
+        }
+        spif_rope_node_release(left);
+        return node;
+    } else if (right->height > left->height + 1) {
+        if (right->right->height >= right->left->height) {
+            node = spif_rope_node_new_pair(spif_rope_node_new_pair(left, spif_rope_node_retain(right->left)),
+                                           spif_rope_node_retain(right->right));
+        } else {
+            mid = right->left;
+            node = spif_rope_node_new_pair(spif_rope_node_new_pair(left, spif_rope_node_retain(mid->left)),
+                                           spif_rope_node_new_pair(spif_rope_node_retain(mid->right),
+                                                                   spif_rope_node_retain(right->right)));
+        }
+        spif_rope_node_release(right);
+        return node;
+    }
+    return spif_rope_node_new_pair(left, right);
+}
+
+/* Concatenate two trees in O(|height difference|).  Takes over the
+   caller's references; either may be NULL. */
+static spif_rope_node_t
+spif_rope_node_join(spif_rope_node_t left, spif_rope_node_t right)
+{
+    spif_rope_node_t node;
+
+    if (!left) {
+        return right;
+    } else if (!right) {
+        return left;
+    }
+
+    if (ROPE_IS_LEAF(left) && ROPE_IS_LEAF(right) && (left->len + right->len <= ROPE_LEAF_MAX)) {
+        node = spif_rope_node_new_leaf((const char *) NULL, left->len + right->len);
+        memcpy(node->data, left->data, left->len);
+        memcpy(node->data + left->len, right->data, right->len);
+        spif_rope_node_release(left);
+        spif_rope_node_release(right);
+        return node;
+    } else if (left->height > right->height + 1) {
+        node = spif_rope_node_balance(spif_rope_node_retain(left->left),
+                                      spif_rope_node_join(spif_rope_node_retain(left->right), right));
+        spif_rope_node_release(left);
+        return node;
+    } else if (right->height > left->height + 1) {
+        node = spif_rope_node_balance(spif_rope_node_join(left, spif_rope_node_retain(right->left)),
+                                      spif_rope_node_retain(right->right));
+        spif_rope_node_release(right);
+        return node;
+    }
+    return spif_rope_node_new_pair(left, right);
+}
+
+/* Split a tree into its first idx bytes and the rest.  The tree itself
+   is left alone; the caller gets new references to both halves. */
+static void
+spif_rope_node_split(spif_rope_node_t node, spif_stridx_t idx, spif_rope_node_t *left, spif_rope_node_t *right)
+{
+    spif_rope_node_t tmp;
+
+    if (!node || (idx <= 0)) {
+        *left = (spif_rope_node_t) NULL;
+        *right = spif_rope_node_retain(node);
+    } else if (idx >= node->len) {
+        *left = spif_rope_node_retain(node);
+        *right = (spif_rope_node_t) NULL;
+    } else if (ROPE_IS_LEAF(node)) {
+        *left = spif_rope_node_new_leaf(node->data, idx);
+        *right = spif_rope_node_new_leaf(node->data + idx, node->len - idx);
+    } else if (idx < node->left->len) {
+        spif_rope_node_split(node->left, idx, left, &tmp);
+        *right = spif_rope_node_join(tmp, spif_rope_node_retain(node->right));
+    } else if (idx > node->left->len) {
+        spif_rope_node_split(node->right, idx - node->left->len, &tmp, right);
+        *left = spif_rope_node_join(spif_rope_node_retain(node->left), tmp);
+    } else {
+        *left = spif_rope_node_retain(node->left);
+        *right = spif_rope_node_retain(node->right);
+    }
+}
+
+/* Find the leaf holding byte idx (which must be in range) and store
+   idx's offset within it. */
+static spif_rope_node_t
+spif_rope_node_leaf(spif_rope_node_t node, spif_stridx_t idx, spif_stridx_t *offset)
+{
+    while (!ROPE_IS_LEAF(node)) {
+        if (idx < node->left->len) {
+            node = node->left;
+        } else {
+            idx -= node->left->len;
+            node = node->right;
+        }
+    }
+    *offset = idx;
+    return node;
+}
+
+/* Copy a tree, transforming the text of every leaf. */
+static spif_rope_node_t
+spif_rope_node_map(spif_rope_node_t node, int op, spif_char_t c)
+{
+    spif_rope_node_t tmp;
+    spif_stridx_t i;
+
+    if (!ROPE_IS_LEAF(node)) {
+        if (op == ROPE_MAP_REVERSE) {
+            return spif_rope_node_new_pair(spif_rope_node_map(node->right, op, c), spif_rope_node_map(node->left, op, c));
+        }
+        return spif_rope_node_new_pair(spif_rope_node_map(node->left, op, c), spif_rope_node_map(node->right, op, c));
+    }
+    tmp = spif_rope_node_new_leaf(node->data, node->len);
+    switch (op) {
+        case ROPE_MAP_DOWNCASE:
+            spiftool_downcase_buff(tmp->data, tmp->len);
+            break;
+        case ROPE_MAP_UPCASE:
+            spiftool_upcase_buff(tmp->data, tmp->len);
+            break;
+        case ROPE_MAP_CLEAR:
+            memset(tmp->data, c, tmp->len);
+            break;
+        default:
+            for (i = 0; i < tmp->len; i++) {
+                tmp->data[i] = node->data[node->len - i - 1];
+            }
+            break;
+    }
+    return tmp;
+}
+
+/* Replace the whole tree with a new one, taking over the reference. */
+static void
+spif_rope_set_root(spif_rope_t self, spif_rope_node_t node)
+{
+    spif_rope_node_release(self->root);
+    self->root = node;
+}
+
+/* Replace cnt bytes at idx with the tree ins (whose reference we take
+   over).  The caller has already checked the range. */
+static void
+spif_rope_replace(spif_rope_t self, spif_stridx_t idx, spif_stridx_t cnt, spif_rope_node_t ins)
+{
+    spif_rope_node_t left, mid, right, tmp;
+
+    if (!cnt && (idx == spif_rope_get_len(self))) {
+        self->root = spif_rope_node_join(self->root, ins);
+        return;
+    } else if (!cnt && !idx) {
+        self->root = spif_rope_node_join(ins, self->root);
+        return;
+    }
+    spif_rope_node_split(self->root, idx, &left, &tmp);
+    spif_rope_node_split(tmp, cnt, &mid, &right);
+    spif_rope_node_release(tmp);
+    spif_rope_node_release(mid);
+    spif_rope_set_root(self, spif_rope_node_join(spif_rope_node_join(left, ins), right));
+}
+
+/* Compare the rope's bytes starting at idx with a buffer, which must
+   not run past the end of the rope. */
+static int
+spif_rope_cmp_range(spif_rope_t self, spif_stridx_t idx, const char *buff, spif_stridx_t len, spif_bool_t fold)
+{
+    spif_charptr_t p;
+    spif_stridx_t n, i;
+    int c;
+
+    while (len > 0) {
+        p = spif_rope_chunk(self, idx, &n);
+        n = MIN(n, len);
+        if (fold) {
+            for (i = 0; i < n; i++) {
+                if ((c = tolower((unsigned char) p[i]) - tolower((unsigned char) buff[i])) != 0) {
+                    return c;
+                }
+            }
+        } else if ((c = memcmp(p, buff, n)) != 0) {
+            return c;
+        }
+        idx += n;
+        buff += n;
+        len -= n;
+    }
+    return 0;
+}
+
+/* Compare two ropes, or a rope and a buffer (when other is NULL), over
+   at most cnt bytes (or all of them, if cnt is negative).  A shorter
+   text that is a prefix of a longer one sorts first. */
+static spif_cmp_t
+spif_rope_compare(spif_rope_t self, spif_rope_t other, const char *buff, spif_stridx_t len,
+                  spif_stridx_t cnt, spif_bool_t fold)
+{
+    spif_charptr_t p;
+    spif_stridx_t mylen, m, n, idx;
+    int c;
+
+    mylen = spif_rope_get_len(self);
+    if (other) {
+        len = spif_rope_get_len(other);
+    }
+    if (cnt >= 0) {
+        mylen = MIN(mylen, cnt);
+        len = MIN(len, cnt);
+    }
+    m = MIN(mylen, len);
+    if (other) {
+        for (idx = 0; idx < m; idx += n) {
+            p = spif_rope_chunk(other, idx, &n);
+            n = MIN(n, m - idx);
+            if ((c = spif_rope_cmp_range(self, idx, p, n, fold)) != 0) {
+                return SPIF_CMP_FROM_INT(c);
+            }
+        }
+    } else if ((c = spif_rope_cmp_range(self, 0, buff, m, fold)) != 0) {
+        return SPIF_CMP_FROM_INT(c);
+    }
+    return SPIF_CMP_FROM_INT((mylen < len) ? (-1) : ((mylen > len) ? (1) : (0)));
+}
+
+/* Turn str-style index and count arguments into a range within the
+   rope:  negative indexes count from the end, and a count of 0 or
+   less means that many bytes short of the end. */
+static spif_bool_t
+spif_rope_range(spif_rope_t self, spif_stridx_t *idx, spif_stridx_t *cnt)
+{
+    spif_stridx_t len = spif_rope_get_len(self);
+
+    if (*idx < 0) {
+        *idx += len;
+    }
+    REQUIRE_RVAL(*idx >= 0, FALSE);
+    REQUIRE_RVAL(*idx <= len, FALSE);
+    if (*cnt <= 0) {
+        *cnt += len - *idx;
+    }
+    REQUIRE_RVAL(*cnt >= 0, FALSE);
+    UPPER_BOUND(*cnt, len - *idx);
+    return TRUE;
+}
+
+spif_rope_t
+spif_rope_new(void)
+{
+    spif_rope_t self;
+
+    self = SPIF_ALLOC(rope);
+    if (!spif_rope_init(self)) {
+        SPIF_DEALLOC(self);
+        self = (spif_rope_t) NULL;
+    }
+    return self;
+}
+
+spif_rope_t
+spif_rope_new_from_ptr(spif_charptr_t old)
+{
+    spif_rope_t self;
+
+    self = SPIF_ALLOC(rope);
+    if (!spif_rope_init_from_ptr(self, old)) {
+        SPIF_DEALLOC(self);
+        self = (spif_rope_t) NULL;
+    }
+    return self;
+}
+
+spif_rope_t
+spif_rope_new_from_buff(spif_charptr_t buff, spif_stridx_t len)
+{
+    spif_rope_t self;
+
+    self = SPIF_ALLOC(rope);
+    if (!spif_rope_init_from_buff(self, buff, len)) {
+        SPIF_DEALLOC(self);
+        self = (spif_rope_t) NULL;
+    }
+    return self;
+}
+
+spif_rope_t
+spif_rope_new_from_fp(FILE *fp)
+{
+    spif_rope_t self;
+
+    self = SPIF_ALLOC(rope);
+    if (!spif_rope_init_from_fp(self, fp)) {
+        SPIF_DEALLOC(self);
+        self = (spif_rope_t) NULL;
+    }
+    return self;
+}
+
+spif_rope_t
+spif_rope_new_from_fd(int fd)
+{
+    spif_rope_t self;
+
+    self = SPIF_ALLOC(rope);
+    if (!spif_rope_init_from_fd(self, fd)) {
+        SPIF_DEALLOC(self);
+        self = (spif_rope_t) NULL;
+    }
+    return self;
+}
+
+spif_rope_t
+spif_rope_new_from_num(long num)
+{
+    spif_rope_t self;
+
+    self = SPIF_ALLOC(rope);
+    if (!spif_rope_init_from_num(self, num)) {
+        SPIF_DEALLOC(self);
+        self = (spif_rope_t) NULL;
+    }
+    return self;
+}
+
+spif_rope_t
+spif_rope_new_from_str(spif_str_t str)
+{
+    spif_rope_t self;
+
+    self = SPIF_ALLOC(rope);
+    if (!spif_rope_init_from_str(self, str)) {
+        SPIF_DEALLOC(self);
+        self = (spif_rope_t) NULL;
+    }
+    return self;
+}
+
+spif_bool_t
+spif_rope_del(spif_rope_t self)
+{
+    ASSERT_RVAL(!SPIF_ROPE_ISNULL(self), FALSE);
+    spif_rope_done(self);
+    SPIF_DEALLOC(self);
+    return TRUE;
+}
+
+spif_bool_t
+spif_rope_init(spif_rope_t self)
+{
+    ASSERT_RVAL(!SPIF_ROPE_ISNULL(self), FALSE);
+    if (!spif_obj_init(SPIF_OBJ(self))) {
+        return FALSE;
+    }
+    spif_obj_set_class(SPIF_OBJ(self), SPIF_CLASS_VAR(rope));
+    self->root = (spif_rope_node_t) NULL;
+    return TRUE;
+}
+
+spif_bool_t
+spif_rope_init_from_ptr(spif_rope_t self, spif_charptr_t old)
+{
+    ASSERT_RVAL(!SPIF_ROPE_ISNULL(self), FALSE);
+    REQUIRE_RVAL((old != (spif_charptr_t) NULL), spif_rope_init(self));
+    return spif_rope_init_from_buff(self, old, strlen((const char *) old));
+}
+
+spif_bool_t
+spif_rope_init_from_buff(spif_rope_t self, spif_charptr_t buff, spif_stridx_t len)
+{
+    ASSERT_RVAL(!SPIF_ROPE_ISNULL(self), FALSE);
+    if (!spif_rope_init(self)) {
+        return FALSE;
+    }
+    REQUIRE_RVAL((buff != (spif_charptr_t) NULL), TRUE);
+    REQUIRE_RVAL((len >= 0), FALSE);
+    self->root = spif_rope_node_build(buff, len);
+    return TRUE;
+}
+
+spif_bool_t
+spif_rope_init_from_fp(spif_rope_t self, FILE *fp)
+{
+    spif_str_t tmp;
+    spif_bool_t ret;
+
+    ASSERT_RVAL(!SPIF_ROPE_ISNULL(self), FALSE);
+    ASSERT_RVAL((fp != (FILE *) NULL), FALSE);
+    tmp = spif_str_new_from_fp(fp);
+    ret = spif_rope_init_from_str(self, tmp);
+    spif_str_del(tmp);
+    return ret;
+}
+
+spif_bool_t
+spif_rope_init_from_fd(spif_rope_t self, int fd)
+{
+    spif_byteptr_t buff;
+    size_t len;
+
+    ASSERT_RVAL(!SPIF_ROPE_ISNULL(self), FALSE);
+    ASSERT_RVAL((fd >= 0), FALSE);
+    if (!spif_rope_init(self)) {
+        return FALSE;
+    }
+    buff = spiftool_read_fd(fd, &len, 0);
+    if (buff) {
+        self->root = spif_rope_node_build((const char *) buff, (spif_stridx_t) len);
+        FREE(buff);
+    }
+    return TRUE;
+}
+
+spif_bool_t
+spif_rope_init_from_num(spif_rope_t self, long num)
+{
+    char buff[SPIFTOOL_NUM_BUFF_SIZE];
+
+    ASSERT_RVAL(!SPIF_ROPE_ISNULL(self), FALSE);
+    return spif_rope_init_from_buff(self, buff, spiftool_format_int64(buff, (spif_int64_t) num));
+}
+
+spif_bool_t
+spif_rope_init_from_str(spif_rope_t self, spif_str_t str)
+{
+    ASSERT_RVAL(!SPIF_ROPE_ISNULL(self), FALSE);
+    REQUIRE_RVAL(!SPIF_STR_ISNULL(str), spif_rope_init(self));
+    return spif_rope_init_from_buff(self, SPIF_STR_STR(str), spif_str_get_len(str));
+}
+
+spif_bool_t
+spif_rope_done(spif_rope_t self)
+{
+    ASSERT_RVAL(!SPIF_ROPE_ISNULL(self), FALSE);
+    spif_rope_set_root(self, (spif_rope_node_t) NULL);
+    return TRUE;
+}
+
+spif_str_t
+spif_rope_show(spif_rope_t self, spif_charptr_t name, spif_str_t buff, size_t indent)
+{
+    if (SPIF_ROPE_ISNULL(self)) {
+        SPIF_OBJ_SHOW_NULL_INTO(rope, name, buff, indent);
+        return buff;
+    }
+
+    buff = spif_str_show_printf(buff, indent, "(spif_rope_t) %s:  %10p { %lu bytes, tree height %d }\n",
+                                name, (spif_ptr_t) self, (unsigned long) spif_rope_get_len(self),
+                                ((self->root) ? (self->root->height) : (0)));
+    return buff;
+}
+
+spif_cmp_t
+spif_rope_comp(spif_rope_t self, spif_rope_t other)
+{
+    return spif_rope_cmp(self, other);
+}
+
+/* Duplicating a rope only shares its tree, so it takes constant time. */
+spif_rope_t
+spif_rope_dup(spif_rope_t self)
+{
+    spif_rope_t tmp;
+
+    ASSERT_RVAL(!SPIF_ROPE_ISNULL(self), (spif_rope_t) NULL);
+    tmp = spif_rope_new();
+    tmp->root = spif_rope_node_retain(self->root);
+    return tmp;
+}
+
+spif_classname_t
+spif_rope_type(spif_rope_t self)
+{
+    ASSERT_RVAL(!SPIF_ROPE_ISNULL(self), (spif_classname_t) NULL);
+    return SPIF_OBJ_CLASSNAME(self);
+}
+
+/* Appending another rope shares its tree rather than copying it. */
+spif_bool_t
+spif_rope_append(spif_rope_t self, spif_rope_t other)
+{
+    ASSERT_RVAL(!SPIF_ROPE_ISNULL(self), FALSE);
+    REQUIRE_RVAL(!SPIF_ROPE_ISNULL(other), FALSE);
+    self->root = spif_rope_node_join(self->root, spif_rope_node_retain(other->root));
+    return TRUE;
+}
+
+spif_bool_t
+spif_rope_append_buff(spif_rope_t self, spif_charptr_t buff, spif_stridx_t len)
+{
+    ASSERT_RVAL(!SPIF_ROPE_ISNULL(self), FALSE);
+    REQUIRE_RVAL((buff != (spif_charptr_t) NULL), FALSE);
+    REQUIRE_RVAL((len >= 0), FALSE);
+    self->root = spif_rope_node_join(self->root, spif_rope_node_build(buff, len));
+    return TRUE;
+}
+
+spif_bool_t
+spif_rope_append_char(spif_rope_t self, spif_char_t c)
+{
+    return spif_rope_append_buff(self, (spif_charptr_t) &c, 1);
+}
+
+spif_bool_t
+spif_rope_append_from_ptr(spif_rope_t self, spif_charptr_t other)
+{
+    REQUIRE_RVAL((other != (spif_charptr_t) NULL), FALSE);
+    return spif_rope_append_buff(self, other, strlen((const char *) other));
+}
+
+spif_cmp_t
+spif_rope_casecmp(spif_rope_t self, spif_rope_t other)
+{
+    SPIF_OBJ_COMP_CHECK_NULL(self, other);
+    return spif_rope_compare(self, other, (const char *) NULL, 0, -1, TRUE);
+}
+
+spif_cmp_t
+spif_rope_casecmp_with_ptr(spif_rope_t self, spif_charptr_t other)
+{
+    SPIF_OBJ_COMP_CHECK_NULL(self, other);
+    return spif_rope_compare(self, (spif_rope_t) NULL, other, strlen((const char *) other), -1, TRUE);
+}
+
+/**
+ * Get a single character.
+ *
+ * @param self The rope.
+ * @param idx  The index of the character; negative indexes count back
+ *             from the end.
+ * @return     The character, or 0 if @a idx is out of range.
+ */
+spif_char_t
+spif_rope_char_at(spif_rope_t self, spif_stridx_t idx)
+{
+    spif_rope_node_t leaf;
+    spif_stridx_t offset;
+
+    ASSERT_RVAL(!SPIF_ROPE_ISNULL(self), 0);
+    if (idx < 0) {
+        idx += spif_rope_get_len(self);
+    }
+    REQUIRE_RVAL((idx >= 0) && (idx < spif_rope_get_len(self)), 0);
+    leaf = spif_rope_node_leaf(self->root, idx, &offset);
+    return (spif_char_t) leaf->data[offset];
+}
+
+/**
+ * Get a pointer to contiguous text.
+ *
+ * Finds the chunk holding byte @a idx and returns a pointer to that
+ * byte, storing the number of bytes that follow it in the same chunk
+ * (@a idx's included) in @a len.  The text can be read, but not
+ * modified, in place by calling this repeatedly, adding @a len to
+ * @a idx each time.  The pointer stays valid until the rope is
+ * changed or deleted.
+ *
+ * @param self The rope.
+ * @param idx  The index of the first byte wanted.
+ * @param len  Where to store the number of bytes available.
+ * @return     A pointer to byte @a idx, or NULL if @a idx is out of
+ *             range.
+ */
+spif_charptr_t
+spif_rope_chunk(spif_rope_t self, spif_stridx_t idx, spif_stridx_t *len)
+{
+    spif_rope_node_t leaf;
+    spif_stridx_t offset;
+
+    ASSERT_RVAL(!SPIF_ROPE_ISNULL(self), (spif_charptr_t) NULL);
+    ASSERT_RVAL(!SPIF_PTR_ISNULL(len), (spif_charptr_t) NULL);
+    *len = 0;
+    REQUIRE_RVAL((idx >= 0) && (idx < spif_rope_get_len(self)), (spif_charptr_t) NULL);
+    leaf = spif_rope_node_leaf(self->root, idx, &offset);
+    *len = leaf->len - offset;
+    return leaf->data + offset;
+}
+
+spif_bool_t
+spif_rope_clear(spif_rope_t self, spif_char_t c)
+{
+    ASSERT_RVAL(!SPIF_ROPE_ISNULL(self), FALSE);
+    REQUIRE_RVAL(self->root, TRUE);
+    spif_rope_set_root(self, spif_rope_node_map(self->root, ROPE_MAP_CLEAR, c));
+    return TRUE;
+}
+
+spif_cmp_t
+spif_rope_cmp(spif_rope_t self, spif_rope_t other)
+{
+    SPIF_OBJ_COMP_CHECK_NULL(self, other);
+    return spif_rope_compare(self, other, (const char *) NULL, 0, -1, FALSE);
+}
+
+spif_cmp_t
+spif_rope_cmp_with_ptr(spif_rope_t self, spif_charptr_t other)
+{
+    SPIF_OBJ_COMP_CHECK_NULL(self, other);
+    return spif_rope_compare(self, (spif_rope_t) NULL, other, strlen((const char *) other), -1, FALSE);
+}
+
+/**
+ * Delete text.
+ *
+ * @param self The rope.
+ * @param idx  The index of the first byte to delete; negative indexes
+ *             count back from the end.
+ * @param cnt  The number of bytes to delete.
+ * @return     TRUE on success, FALSE if the range is invalid.
+ */
+spif_bool_t
+spif_rope_delete(spif_rope_t self, spif_stridx_t idx, spif_stridx_t cnt)
+{
+    ASSERT_RVAL(!SPIF_ROPE_ISNULL(self), FALSE);
+    REQUIRE_RVAL(cnt > 0, (cnt == 0));
+    REQUIRE_RVAL(spif_rope_range(self, &idx, &cnt), FALSE);
+    spif_rope_replace(self, idx, cnt, (spif_rope_node_t) NULL);
+    return TRUE;
+}
+
+spif_bool_t
+spif_rope_downcase(spif_rope_t self)
+{
+    ASSERT_RVAL(!SPIF_ROPE_ISNULL(self), FALSE);
+    REQUIRE_RVAL(self->root, TRUE);
+    spif_rope_set_root(self, spif_rope_node_map(self->root, ROPE_MAP_DOWNCASE, 0));
+    return TRUE;
+}
+
+spif_stridx_t
+spif_rope_find(spif_rope_t self, spif_rope_t other)
+{
+    spif_charptr_t tmp;
+    spif_stridx_t ret;
+
+    ASSERT_RVAL(!SPIF_ROPE_ISNULL(self), ((spif_stridx_t) -1));
+    REQUIRE_RVAL(!SPIF_ROPE_ISNULL(other), ((spif_stridx_t) -1));
+    tmp = spif_rope_substr_to_ptr(other, 0, 0);
+    ret = spif_rope_find_from_ptr(self, tmp);
+    FREE(tmp);
+    return ret;
+}
+
+/* Searches chunk by chunk, so matches may span chunks. */
+spif_stridx_t
+spif_rope_find_from_ptr(spif_rope_t self, spif_charptr_t other)
+{
+    spif_searcher_t searcher;
+    spif_charptr_t p;
+    spif_stridx_t idx, len, n;
+    spif_memidx_t match;
+
+    ASSERT_RVAL(!SPIF_ROPE_ISNULL(self), ((spif_stridx_t) -1));
+    REQUIRE_RVAL((other != (spif_charptr_t) NULL), ((spif_stridx_t) -1));
+    REQUIRE_RVAL(*other, 0);
+    len = spif_rope_get_len(self);
+    searcher = spif_searcher_new_from_ptr((spif_byteptr_t) other, strlen((const char *) other));
+    for (idx = 0, match = -1; (idx < len) && (match < 0); idx += n) {
+        p = spif_rope_chunk(self, idx, &n);
+        spif_searcher_feed(searcher, (spif_byteptr_t) p, n, &match);
+    }
+    spif_searcher_del(searcher);
+    return ((match < 0) ? (len) : ((spif_stridx_t) match));
+}
+
+spif_stridx_t
+spif_rope_get_len(spif_rope_t self)
+{
+    ASSERT_RVAL(!SPIF_ROPE_ISNULL(self), ((spif_stridx_t) -1));
+    return ((self->root) ? (self->root->len) : (0));
+}
+
+spif_stridx_t
+spif_rope_index(spif_rope_t self, spif_char_t c)
+{
+    spif_charptr_t p, tmp;
+    spif_stridx_t idx, len, n;
+
+    ASSERT_RVAL(!SPIF_ROPE_ISNULL(self), ((spif_stridx_t) -1));
+    len = spif_rope_get_len(self);
+    for (idx = 0; idx < len; idx += n) {
+        p = spif_rope_chunk(self, idx, &n);
+        if ((tmp = (spif_charptr_t) memchr(p, c, n)) != NULL) {
+            return idx + (tmp - p);
+        }
+    }
+    return len;
+}
+
+/**
+ * Insert another rope.
+ *
+ * The inserted rope's tree is shared, not copied.
+ *
+ * @param self  The rope.
+ * @param idx   Where to insert; negative indexes count back from the
+ *              end, and the length of the rope appends.
+ * @param other The rope to insert.
+ * @return      TRUE on success, FALSE if @a idx is out of range.
+ */
+spif_bool_t
+spif_rope_insert(spif_rope_t self, spif_stridx_t idx, spif_rope_t other)
+{
+    spif_stridx_t cnt = 0;
+
+    ASSERT_RVAL(!SPIF_ROPE_ISNULL(self), FALSE);
+    REQUIRE_RVAL(!SPIF_ROPE_ISNULL(other), FALSE);
+    REQUIRE_RVAL(spif_rope_range(self, &idx, &cnt), FALSE);
+    spif_rope_replace(self, idx, 0, spif_rope_node_retain(other->root));
+    return TRUE;
+}
+
+spif_bool_t
+spif_rope_insert_buff(spif_rope_t self, spif_stridx_t idx, spif_charptr_t buff, spif_stridx_t len)
+{
+    spif_stridx_t cnt = 0;
+
+    ASSERT_RVAL(!SPIF_ROPE_ISNULL(self), FALSE);
+    REQUIRE_RVAL((buff != (spif_charptr_t) NULL), FALSE);
+    REQUIRE_RVAL((len >= 0), FALSE);
+    REQUIRE_RVAL(spif_rope_range(self, &idx, &cnt), FALSE);
+    spif_rope_replace(self, idx, 0, spif_rope_node_build(buff, len));
+    return TRUE;
+}
+
+spif_cmp_t
+spif_rope_ncasecmp(spif_rope_t self, spif_rope_t other, spif_stridx_t cnt)
+{
+    SPIF_OBJ_COMP_CHECK_NULL(self, other);
+    REQUIRE_RVAL(cnt >= 0, SPIF_CMP_EQUAL);
+    return spif_rope_compare(self, other, (const char *) NULL, 0, cnt, TRUE);
+}
+
+spif_cmp_t
+spif_rope_ncasecmp_with_ptr(spif_rope_t self, spif_charptr_t other, spif_stridx_t cnt)
+{
+    SPIF_OBJ_COMP_CHECK_NULL(self, other);
+    REQUIRE_RVAL(cnt >= 0, SPIF_CMP_EQUAL);
+    return spif_rope_compare(self, (spif_rope_t) NULL, other, strnlen((const char *) other, cnt), cnt, TRUE);
+}
+
+spif_cmp_t
+spif_rope_ncmp(spif_rope_t self, spif_rope_t other, spif_stridx_t cnt)
+{
+    SPIF_OBJ_COMP_CHECK_NULL(self, other);
+    REQUIRE_RVAL(cnt >= 0, SPIF_CMP_EQUAL);
+    return spif_rope_compare(self, other, (const char *) NULL, 0, cnt, FALSE);
+}
+
+spif_cmp_t
+spif_rope_ncmp_with_ptr(spif_rope_t self, spif_charptr_t other, spif_stridx_t cnt)
+{
+    SPIF_OBJ_COMP_CHECK_NULL(self, other);
+    REQUIRE_RVAL(cnt >= 0, SPIF_CMP_EQUAL);
+    return spif_rope_compare(self, (spif_rope_t) NULL, other, strnlen((const char *) other, cnt), cnt, FALSE);
+}
+
+spif_bool_t
+spif_rope_prepend(spif_rope_t self, spif_rope_t other)
+{
+    ASSERT_RVAL(!SPIF_ROPE_ISNULL(self), FALSE);
+    REQUIRE_RVAL(!SPIF_ROPE_ISNULL(other), FALSE);
+    self->root = spif_rope_node_join(spif_rope_node_retain(other->root), self->root);
+    return TRUE;
+}
+
+spif_bool_t
+spif_rope_prepend_char(spif_rope_t self, spif_char_t c)
+{
+    return spif_rope_insert_buff(self, 0, (spif_charptr_t) &c, 1);
+}
+
+spif_bool_t
+spif_rope_prepend_from_ptr(spif_rope_t self, spif_charptr_t other)
+{
+    REQUIRE_RVAL((other != (spif_charptr_t) NULL), FALSE);
+    return spif_rope_insert_buff(self, 0, other, strlen((const char *) other));
+}
+
+spif_bool_t
+spif_rope_reverse(spif_rope_t self)
+{
+    ASSERT_RVAL(!SPIF_ROPE_ISNULL(self), FALSE);
+    REQUIRE_RVAL(self->root, TRUE);
+    spif_rope_set_root(self, spif_rope_node_map(self->root, ROPE_MAP_REVERSE, 0));
+    return TRUE;
+}
+
+spif_stridx_t
+spif_rope_rindex(spif_rope_t self, spif_char_t c)
+{
+    spif_rope_node_t leaf;
+    spif_stridx_t idx, len, offset;
+
+    ASSERT_RVAL(!SPIF_ROPE_ISNULL(self), ((spif_stridx_t) -1));
+    len = spif_rope_get_len(self);
+    for (idx = len; idx > 0;) {
+        leaf = spif_rope_node_leaf(self->root, idx - 1, &offset);
+        for (; offset >= 0; offset--) {
+            idx--;
+            if ((spif_char_t) leaf->data[offset] == c) {
+                return idx;
+            }
+        }
+    }
+    return len;
+}
+
+/**
+ * Replace part of a rope with another.
+ *
+ * @param self  The rope.
+ * @param idx   The index of the first byte to replace; negative indexes
+ *              count back from the end, and the length of the rope
+ *              appends.
+ * @param cnt   The number of bytes to replace; 0 or less means that
+ *              many short of the end.
+ * @param other The replacement, or NULL to just delete.
+ * @return      TRUE on success, FALSE if the range is invalid.
+ */
+spif_bool_t
+spif_rope_splice(spif_rope_t self, spif_stridx_t idx, spif_stridx_t cnt, spif_rope_t other)
+{
+    ASSERT_RVAL(!SPIF_ROPE_ISNULL(self), FALSE);
+    REQUIRE_RVAL(spif_rope_range(self, &idx, &cnt), FALSE);
+    spif_rope_replace(self, idx, cnt, ((SPIF_ROPE_ISNULL(other)) ? (NULL) : (spif_rope_node_retain(other->root))));
+    return TRUE;
+}
+
+spif_bool_t
+spif_rope_splice_from_ptr(spif_rope_t self, spif_stridx_t idx, spif_stridx_t cnt, spif_charptr_t other)
+{
+    ASSERT_RVAL(!SPIF_ROPE_ISNULL(self), FALSE);
+    REQUIRE_RVAL(spif_rope_range(self, &idx, &cnt), FALSE);
+    spif_rope_replace(self, idx, cnt,
+                      ((other) ? (spif_rope_node_build(other, strlen((const char *) other))) : (NULL)));
+    return TRUE;
+}
+
+spif_bool_t
+spif_rope_sprintf(spif_rope_t self, spif_charptr_t format, ...)
+{
+    va_list ap;
+    spif_str_t tmp;
+    spif_bool_t ret;
+
+    ASSERT_RVAL(!SPIF_ROPE_ISNULL(self), FALSE);
+    spif_rope_set_root(self, (spif_rope_node_t) NULL);
+    REQUIRE_RVAL((format != (spif_charptr_t) NULL), FALSE);
+    tmp = spif_str_new();
+    va_start(ap, format);
+    ret = spif_str_append_vprintf(tmp, format, ap);
+    va_end(ap);
+    if (ret) {
+        self->root = spif_rope_node_build(SPIF_STR_STR(tmp), spif_str_get_len(tmp));
+    }
+    spif_str_del(tmp);
+    return ret;
+}
+
+/* The substring shares the rope's tree, so this takes O(log n). */
+spif_rope_t
+spif_rope_substr(spif_rope_t self, spif_stridx_t idx, spif_stridx_t cnt)
+{
+    spif_rope_node_t left, tmp, right;
+    spif_rope_t ret;
+
+    ASSERT_RVAL(!SPIF_ROPE_ISNULL(self), (spif_rope_t) NULL);
+    REQUIRE_RVAL(spif_rope_range(self, &idx, &cnt), (spif_rope_t) NULL);
+    ret = spif_rope_new();
+    spif_rope_node_split(self->root, idx, &left, &tmp);
+    spif_rope_node_split(tmp, cnt, &ret->root, &right);
+    spif_rope_node_release(left);
+    spif_rope_node_release(tmp);
+    spif_rope_node_release(right);
+    return ret;
+}
+
+spif_charptr_t
+spif_rope_substr_to_ptr(spif_rope_t self, spif_stridx_t idx, spif_stridx_t cnt)
+{
+    spif_charptr_t ret, p;
+    spif_stridx_t i, n;
+
+    ASSERT_RVAL(!SPIF_ROPE_ISNULL(self), (spif_charptr_t) NULL);
+    REQUIRE_RVAL(spif_rope_range(self, &idx, &cnt), (spif_charptr_t) NULL);
+    ret = (spif_charptr_t) MALLOC(cnt + 1);
+    for (i = 0; i < cnt; i += n) {
+        p = spif_rope_chunk(self, idx + i, &n);
+        n = MIN(n, cnt - i);
+        memcpy(ret + i, p, n);
+    }
+    ret[cnt] = 0;
+    return ret;
+}
+
+double
+spif_rope_to_float(spif_rope_t self)
+{
+    spif_charptr_t tmp;
+    double ret;
+
+    ASSERT_RVAL(!SPIF_ROPE_ISNULL(self), (double) NAN);
+    tmp = spif_rope_substr_to_ptr(self, 0, 0);
+    ret = strtod((const char *) tmp, (char **) NULL);
+    FREE(tmp);
+    return ret;
+}
+
+size_t
+spif_rope_to_num(spif_rope_t self, int base)
+{
+    spif_charptr_t tmp;
+    size_t ret;
+
+    ASSERT_RVAL(!SPIF_ROPE_ISNULL(self), ((size_t) -1));
+    tmp = spif_rope_substr_to_ptr(self, 0, 0);
+    ret = (size_t) strtoul((const char *) tmp, (char **) NULL, base);
+    FREE(tmp);
+    return ret;
+}
+
+/**
+ * Flatten a rope into a string.
+ *
+ * @param self The rope.
+ * @return     A new spif_str_t with the same text.
+ */
+spif_str_t
+spif_rope_to_str(spif_rope_t self)
+{
+    spif_str_t ret;
+    spif_charptr_t p;
+    spif_stridx_t idx, len, n;
+
+    ASSERT_RVAL(!SPIF_ROPE_ISNULL(self), (spif_str_t) NULL);
+    len = spif_rope_get_len(self);
+    ret = spif_str_new();
+    spif_str_reserve(ret, len);
+    for (idx = 0; idx < len; idx += n) {
+        p = spif_rope_chunk(self, idx, &n);
+        spif_str_append_buff(ret, p, n);
+    }
+    return ret;
+}
+
+spif_bool_t
+spif_rope_trim(spif_rope_t self)
+{
+    spif_rope_node_t leaf;
+    spif_charptr_t p;
+    spif_stridx_t start, end, len, n, offset;
+
+    ASSERT_RVAL(!SPIF_ROPE_ISNULL(self), FALSE);
+    len = spif_rope_get_len(self);
+    for (start = 0; start < len; start += n) {
+        p = spif_rope_chunk(self, start, &n);
+        if ((offset = spiftool_span_space(p, n)) < n) {
+            start += offset;
+            break;
+        }
+    }
+    for (end = len; end > start; end--) {
+        leaf = spif_rope_node_leaf(self->root, end - 1, &offset);
+        if (!isspace((unsigned char) leaf->data[offset])) {
+            break;
+        }
+    }
+    if ((start > 0) || (end < len)) {
+        spif_rope_node_t left, mid, right;
+
+        spif_rope_node_split(self->root, end, &left, &right);
+        spif_rope_node_release(right);
+        spif_rope_node_split(left, start, &right, &mid);
+        spif_rope_node_release(right);
+        spif_rope_node_release(left);
+        spif_rope_set_root(self, mid);
+    }
+    return TRUE;
+}
+
+spif_bool_t
+spif_rope_upcase(spif_rope_t self)
+{
+    ASSERT_RVAL(!SPIF_ROPE_ISNULL(self), FALSE);
+    REQUIRE_RVAL(self->root, TRUE);
+    spif_rope_set_root(self, spif_rope_node_map(self->root, ROPE_MAP_UPCASE, 0));
+    return TRUE;
+}
@@ -0,0 +1,418 @@
+/*
+ * Copyright (C) 1997-2013, Michael Jennings <mej@eterm.org>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies of the Software, its documentation and marketing & publicity
+ * materials, and acknowledgment shall be given in the documentation, materials
+ * and software packages that this Software was used.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <libast_internal.h>
+
+/* *INDENT-OFF* */
+static SPIF_CONST_TYPE(class) se_class = {
+    SPIF_DECL_CLASSNAME(searcher),
+    (spif_func_t) spif_searcher_new,
+    (spif_func_t) spif_searcher_init,
+    (spif_func_t) spif_searcher_done,
+    (spif_func_t) spif_searcher_del,
+    (spif_func_t) spif_searcher_show,
+    (spif_func_t) spif_searcher_comp,
+    (spif_func_t) spif_searcher_dup,
+    (spif_func_t) spif_searcher_type
+};
+SPIF_TYPE(class) SPIF_CLASS_VAR(searcher) = &se_class;
+/* *INDENT-ON* */
+
+/* False candidates from the pair filter tolerated (beyond one per 16
+   bytes scanned) before falling back to Horspool. */
+#define SEARCHER_MAX_MISSES     64
+
+spif_searcher_t
+spif_searcher_new(void)
+{
+    spif_searcher_t self;
+
+    self = SPIF_ALLOC(searcher);
+    if (!spif_searcher_init(self)) {
+        SPIF_DEALLOC(self);
+        self = (spif_searcher_t) NULL;
+    }
+    return self;
+}
+
+spif_searcher_t
+spif_searcher_new_from_ptr(spif_byteptr_t needle, spif_memidx_t len)
+{
+    spif_searcher_t self;
+
+    self = SPIF_ALLOC(searcher);
+    if (!spif_searcher_init_from_ptr(self, needle, len)) {
+        SPIF_DEALLOC(self);
+        self = (spif_searcher_t) NULL;
+    }
+    return self;
+}
+
+spif_searcher_t
+spif_searcher_new_from_str(spif_str_t needle)
+{
+    spif_searcher_t self;
+
+    self = SPIF_ALLOC(searcher);
+    if (!spif_searcher_init_from_str(self, needle)) {
+        SPIF_DEALLOC(self);
+        self = (spif_searcher_t) NULL;
+    }
+    return self;
+}
+
+spif_bool_t
+spif_searcher_init(spif_searcher_t self)
+{
+    ASSERT_RVAL(!SPIF_SEARCHER_ISNULL(self), FALSE);
+    if (!spif_obj_init(SPIF_OBJ(self))) {
+        return FALSE;
+    }
+    spif_obj_set_class(SPIF_OBJ(self), SPIF_CLASS_VAR(searcher));
+    self->needle = (spif_byteptr_t) NULL;
+    self->len = 0;
+    self->carry = (spif_byteptr_t) NULL;
+    self->carried = 0;
+    self->pos = 0;
+    return TRUE;
+}
+
+spif_bool_t
+spif_searcher_init_from_ptr(spif_searcher_t self, spif_byteptr_t needle, spif_memidx_t len)
+{
+    ASSERT_RVAL(!SPIF_SEARCHER_ISNULL(self), FALSE);
+    REQUIRE_RVAL((needle != (spif_byteptr_t) NULL), FALSE);
+    if (!spif_searcher_init(self)) {
+        return FALSE;
+    }
+    return spif_searcher_set_needle(self, needle, len);
+}
+
+spif_bool_t
+spif_searcher_init_from_str(spif_searcher_t self, spif_str_t needle)
+{
+    ASSERT_RVAL(!SPIF_SEARCHER_ISNULL(self), FALSE);
+    REQUIRE_RVAL(!SPIF_STR_ISNULL(needle), FALSE);
+    return spif_searcher_init_from_ptr(self, (spif_byteptr_t) SPIF_STR_STR(needle), spif_str_get_len(needle));
+}
+
+spif_bool_t
+spif_searcher_done(spif_searcher_t self)
+{
+    ASSERT_RVAL(!SPIF_SEARCHER_ISNULL(self), FALSE);
+    if (self->needle) {
+        FREE(self->needle);
+    }
+    if (self->carry) {
+        FREE(self->carry);
+    }
+    self->len = 0;
+    self->carried = 0;
+    self->pos = 0;
+    return TRUE;
+}
+
+spif_bool_t
+spif_searcher_del(spif_searcher_t self)
+{
+    ASSERT_RVAL(!SPIF_SEARCHER_ISNULL(self), FALSE);
+    spif_searcher_done(self);
+    SPIF_DEALLOC(self);
+    return TRUE;
+}
+
+spif_str_t
+spif_searcher_show(spif_searcher_t self, spif_charptr_t name, spif_str_t buff, size_t indent)
+{
+    if (SPIF_SEARCHER_ISNULL(self)) {
+        SPIF_OBJ_SHOW_NULL_INTO(searcher, name, buff, indent);
+        return buff;
+    }
+
+    buff = spif_str_show_printf(buff, indent, "(spif_searcher_t) %s:  %10p { %lu-byte needle, stream offset %lu, %lu bytes carried }\n",
+                                name, (spif_ptr_t) self, (unsigned long) self->len, (unsigned long) self->pos,
+                                (unsigned long) self->carried);
+    return buff;
+}
+
+spif_cmp_t
+spif_searcher_comp(spif_searcher_t self, spif_searcher_t other)
+{
+    int c;
+
+    SPIF_OBJ_COMP_CHECK_NULL(self, other);
+    c = memcmp(self->needle, other->needle, MIN(self->len, other->len));
+    if (!c) {
+        c = ((self->len < other->len) ? (-1) : ((self->len > other->len) ? (1) : (0)));
+    }
+    return SPIF_CMP_FROM_INT(c);
+}
+
+/* The copy searches for the same needle but starts a fresh stream. */
+spif_searcher_t
+spif_searcher_dup(spif_searcher_t self)
+{
+    spif_searcher_t tmp;
+
+    ASSERT_RVAL(!SPIF_SEARCHER_ISNULL(self), (spif_searcher_t) NULL);
+    tmp = spif_searcher_new();
+    if (self->needle) {
+        spif_searcher_set_needle(tmp, self->needle, self->len);
+    }
+    return tmp;
+}
+
+spif_classname_t
+spif_searcher_type(spif_searcher_t self)
+{
+    ASSERT_RVAL(!SPIF_SEARCHER_ISNULL(self), (spif_classname_t) NULL);
+    return SPIF_OBJ_CLASSNAME(self);
+}
+
+/**
+ * Change the needle.
+ *
+ * Copies @a needle and builds the Horspool shift table for it.  Any
+ * stream in progress is reset.
+ *
+ * @param self   The searcher.
+ * @param needle The bytes to search for.
+ * @param len    The length of @a needle.
+ * @return       TRUE on success, FALSE on error.
+ */
+spif_bool_t
+spif_searcher_set_needle(spif_searcher_t self, spif_byteptr_t needle, spif_memidx_t len)
+{
+    spif_memidx_t i;
+
+    ASSERT_RVAL(!SPIF_SEARCHER_ISNULL(self), FALSE);
+    REQUIRE_RVAL((needle != (spif_byteptr_t) NULL), FALSE);
+    REQUIRE_RVAL((len >= 0), FALSE);
+
+    self->needle = (spif_byteptr_t) REALLOC(self->needle, len + 1);
+    memcpy(self->needle, needle, len);
+    self->needle[len] = 0;
+    self->len = len;
+
+    /* Room for the tail of one chunk plus the head of the next. */
+    self->carry = (spif_byteptr_t) REALLOC(self->carry, 2 * len + 1);
+    self->carried = 0;
+    self->pos = 0;
+
+    for (i = 0; i < 256; i++) {
+        self->skip[i] = len;
+    }
+    for (i = 0; i + 1 < len; i++) {
+        self->skip[needle[i]] = len - 1 - i;
+    }
+    return TRUE;
+}
+
+/* Return a pointer to the first occurrence of the needle in the n
+   bytes at h, or NULL.
+
+   Candidates are found with the vectorized pair filter, which looks
+   for the needle's first and last bytes at the right distance apart,
+   and then checked with memcmp().  That is much faster than Horspool
+   on ordinary text, but if the haystack is so repetitive that the
+   filter mostly yields false candidates, we switch to Horspool for
+   the rest of the buffer.  Without SIMD support, the filter would be
+   no faster than Horspool, so we go straight to that. */
+static spif_byteptr_t
+spif_searcher_scan(spif_searcher_t self, spif_byteptr_t h, spif_memidx_t n)
+{
+    spif_byteptr_t p, end, needle = self->needle;
+    spif_memidx_t m = self->len;
+    spif_uint8_t last;
+#if LIBAST_SIMD_SUPPORT
+    spif_memidx_t misses;
+    size_t i;
+#endif
+
+    if (m > n) {
+        return (spif_byteptr_t) NULL;
+    } else if (!m) {
+        return h;
+    } else if (m == 1) {
+        return (spif_byteptr_t) memchr(h, needle[0], n);
+    }
+
+    last = needle[m - 1];
+    end = h + n - m + 1;
+#if LIBAST_SIMD_SUPPORT
+    for (p = h, misses = 0; misses < SEARCHER_MAX_MISSES + ((p - h) >> 4); p++, misses++) {
+        i = spiftool_find_pair(p, end - p, needle[0], last, m - 1);
+        p += i;
+        if (p == end) {
+            return (spif_byteptr_t) NULL;
+        } else if (!memcmp(p + 1, needle + 1, m - 2)) {
+            return p;
+        }
+    }
+#else
+    p = h;
+#endif
+
+    for (end--; p <= end; p += self->skip[p[m - 1]]) {
+        if ((p[m - 1] == last) && !memcmp(p, needle, m - 1)) {
+            return p;
+        }
+    }
+    return (spif_byteptr_t) NULL;
+}
+
+/**
+ * Search a buffer.
+ *
+ * @param self The searcher.
+ * @param buff The buffer to search.
+ * @param len  The length of @a buff.
+ * @return     The offset of the first match in @a buff, @a len if
+ *             there is none, or -1 on error.
+ */
+spif_memidx_t
+spif_searcher_find(spif_searcher_t self, spif_byteptr_t buff, spif_memidx_t len)
+{
+    spif_byteptr_t p;
+
+    ASSERT_RVAL(!SPIF_SEARCHER_ISNULL(self), ((spif_memidx_t) -1));
+    REQUIRE_RVAL((self->needle != (spif_byteptr_t) NULL), ((spif_memidx_t) -1));
+    REQUIRE_RVAL(((buff != (spif_byteptr_t) NULL) || !len), ((spif_memidx_t) -1));
+    p = spif_searcher_scan(self, buff, len);
+    return ((p) ? (p - buff) : (len));
+}
+
+/* Same return values as spif_str_find(). */
+spif_stridx_t
+spif_searcher_find_str(spif_searcher_t self, spif_str_t str)
+{
+    ASSERT_RVAL(!SPIF_SEARCHER_ISNULL(self), ((spif_stridx_t) -1));
+    REQUIRE_RVAL(!SPIF_STR_ISNULL(str), ((spif_stridx_t) -1));
+    return (spif_stridx_t) spif_searcher_find(self, (spif_byteptr_t) SPIF_STR_STR(str), spif_str_get_len(str));
+}
+
+/* Same return values as spif_mbuff_find(). */
+spif_memidx_t
+spif_searcher_find_mbuff(spif_searcher_t self, spif_mbuff_t mbuff)
+{
+    ASSERT_RVAL(!SPIF_SEARCHER_ISNULL(self), ((spif_memidx_t) -1));
+    REQUIRE_RVAL(!SPIF_MBUFF_ISNULL(mbuff), ((spif_memidx_t) -1));
+    return spif_searcher_find(self, SPIF_MBUFF_BUFF(mbuff), spif_mbuff_get_len(mbuff));
+}
+
+/**
+ * Search the next chunk of a stream.
+ *
+ * Scans @a buff for the needle, including matches that began in
+ * earlier chunks.  If one is found, its offset from the start of the
+ * stream is stored in @a match and the return value is the number of
+ * bytes of @a buff up to the end of the match; feed the rest of the
+ * chunk in again to look for further (non-overlapping) matches.
+ * Otherwise @a match is set to -1 and the whole chunk is consumed.
+ * Only the last (needle length - 1) bytes are kept between calls, so
+ * the caller may reuse @a buff as soon as this returns.
+ *
+ * An empty needle never matches in a stream.
+ *
+ * @param self  The searcher.
+ * @param buff  The next chunk of the stream.
+ * @param len   The length of @a buff.
+ * @param match Where to store the stream offset of the match.
+ * @return      The number of bytes of @a buff consumed, or -1 on
+ *              error.
+ */
+spif_memidx_t
+spif_searcher_feed(spif_searcher_t self, spif_byteptr_t buff, spif_memidx_t len, spif_memidx_t *match)
+{
+    spif_byteptr_t p;
+    spif_memidx_t keep, n;
+
+    ASSERT_RVAL(!SPIF_SEARCHER_ISNULL(self), ((spif_memidx_t) -1));
+    ASSERT_RVAL(!SPIF_PTR_ISNULL(match), ((spif_memidx_t) -1));
+    *match = -1;
+    REQUIRE_RVAL((self->needle != (spif_byteptr_t) NULL), ((spif_memidx_t) -1));
+    REQUIRE_RVAL(((buff != (spif_byteptr_t) NULL) || !len), ((spif_memidx_t) -1));
+    if (!self->len) {
+        self->pos += len;
+        return len;
+    }
+
+    keep = self->len - 1;
+    if (self->carried) {
+        /* Check for a match that starts in the carried tail.  The first
+           match in the window is the earliest one, so if it starts in
+           this chunk the main scan below will find it anyway. */
+        n = MIN(len, keep);
+        memcpy(self->carry + self->carried, buff, n);
+        p = spif_searcher_scan(self, self->carry, self->carried + n);
+        if (p && (p < self->carry + self->carried)) {
+            n = self->len - (self->carried - (p - self->carry));
+            *match = self->pos - self->carried + (p - self->carry);
+            self->carried = 0;
+            self->pos += n;
+            return n;
+        }
+    }
+
+    p = spif_searcher_scan(self, buff, len);
+    if (p) {
+        n = (p - buff) + self->len;
+        *match = self->pos + (p - buff);
+        self->carried = 0;
+        self->pos += n;
+        return n;
+    }
+
+    /* No match; keep the tail of the stream for the next chunk. */
+    if (len >= keep) {
+        memcpy(self->carry, buff + len - keep, keep);
+        self->carried = keep;
+    } else {
+        if (!self->carried) {
+            memcpy(self->carry, buff, len);
+        }
+        self->carried += len;
+        if (self->carried > keep) {
+            memmove(self->carry, self->carry + self->carried - keep, keep);
+            self->carried = keep;
+        }
+    }
+    self->pos += len;
+    return len;
+}
+
+/* Forget any stream in progress and start counting offsets from 0. */
+spif_bool_t
+spif_searcher_reset(spif_searcher_t self)
+{
+    ASSERT_RVAL(!SPIF_SEARCHER_ISNULL(self), FALSE);
+    self->carried = 0;
+    self->pos = 0;
+    return TRUE;
+}
@@ -0,0 +1,923 @@
+/*
+ * Copyright (C) 1997-2013, Michael Jennings <mej@eterm.org>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies of the Software, its documentation and marketing & publicity
+ * materials, and acknowledgment shall be given in the documentation, materials
+ * and software packages that this Software was used.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/**
+ * @file simd.c
+ * Vectorized string scanning and case mapping.
+ *
+ * This file contains the inner loops behind the string and spif_str_t
+ * routines that inspect every byte:  character search, whitespace
+ * skipping, case mapping, case-insensitive comparison, UTF-8
+ * validation, and the candidate filter used by spif_searcher_t.  Each has
+ * a plain C version and, where the compiler supports it, SSE2 and
+ * AVX2 versions; the best one the CPU can run is picked the first
+ * time any of them is called.
+ *
+ * The vector code only handles ASCII itself.  Any block containing a
+ * byte with the high bit set is handed to the C library's ctype
+ * functions, so results are the same as the plain loops in any locale
+ * whose ASCII letters and whitespace are the usual ones.
+ *
+ * @author Michael Jennings <mej@eterm.org>
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <libast_internal.h>
+
+#if LIBAST_SIMD_SUPPORT
+# include <immintrin.h>
+# define SIMD_TARGET(isa)          __attribute__((target(isa)))
+# define SIMD_FIRST(m)             ((size_t) __builtin_ctz(m))
+# define SIMD_LAST(m)              ((size_t) (31 - __builtin_clz(m)))
+#endif
+
+#define SIMD_LEVEL_NONE            0
+#define SIMD_LEVEL_SSE2            1
+#define SIMD_LEVEL_AVX2            2
+
+#define SIMD_LEVEL()               ((simd_level >= 0) ? (simd_level) : (spiftool_simd_level(-1)))
+#define SIMD_HIGH(c)               ((c) & 0x80)
+
+static int simd_level = -1;
+
+/**
+ * Select the string routine implementation.
+ *
+ * Chooses which version of the string kernels to use:  0 for plain
+ * C, 1 for SSE2, or 2 for AVX2.  Requests for more than the CPU (or
+ * the compiler) supports are lowered to the best available, and a
+ * negative @a level selects the best available.  This is mainly for
+ * testing and benchmarking; the default needs no setup.
+ *
+ * @param level The desired level, or -1 for the best available.
+ * @return      The level now in use.
+ */
+int
+spiftool_simd_level(int level)
+{
+    int max = SIMD_LEVEL_NONE;
+
+#if LIBAST_SIMD_SUPPORT
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        max = SIMD_LEVEL_AVX2;
+    } else if (__builtin_cpu_supports("sse2")) {
+        max = SIMD_LEVEL_SSE2;
+    }
+#endif
+    if ((level < 0) || (level > max)) {
+        level = max;
+    }
+    simd_level = level;
+    return level;
+}
+
+/********************************* Plain C *********************************/
+
+static size_t
+find2_c(const spif_uint8_t *s, size_t len, spif_uint8_t a, spif_uint8_t b)
+{
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        if ((s[i] == a) || (s[i] == b)) {
+            return i;
+        }
+    }
+    return len;
+}
+
+static size_t
+rfind_c(const spif_uint8_t *s, size_t len, spif_uint8_t c)
+{
+    size_t i;
+
+    for (i = len; i-- > 0;) {
+        if (s[i] == c) {
+            return i;
+        }
+    }
+    return len;
+}
+
+static size_t
+find_space_c(const spif_uint8_t *s, size_t len)
+{
+    size_t i;
+
+    for (i = 0; (i < len) && !isspace(s[i]); i++);
+    return i;
+}
+
+static size_t
+skip_space_c(const spif_uint8_t *s, size_t len)
+{
+    size_t i;
+
+    for (i = 0; (i < len) && isspace(s[i]); i++);
+    return i;
+}
+
+static size_t
+rskip_space_c(const spif_uint8_t *s, size_t len)
+{
+    for (; len && isspace(s[len - 1]); len--);
+    return len;
+}
+
+static void
+casemap_c(spif_uint8_t *s, size_t len, spif_bool_t upper)
+{
+    size_t i;
+
+    if (upper) {
+        for (i = 0; i < len; i++) {
+            s[i] = toupper(s[i]);
+        }
+    } else {
+        for (i = 0; i < len; i++) {
+            s[i] = tolower(s[i]);
+        }
+    }
+}
+
+/* Length of the well-formed UTF-8 sequence at s (which must be
+   non-ASCII), or 0 if there isn't one.  Overlong forms, surrogates,
+   and values past U+10FFFF are all rejected, as RFC 3629 requires. */
+static inline size_t
+utf8_seq(const spif_uint8_t *s, size_t len, spif_uint32_t *cp)
+{
+    spif_uint8_t lo = 0x80, hi = 0xbf;
+    spif_uint32_t v;
+    size_t n, i;
+
+    if (s[0] < 0xc2) {
+        return 0;
+    } else if (s[0] < 0xe0) {
+        n = 2;
+        v = s[0] & 0x1f;
+    } else if (s[0] < 0xf0) {
+        n = 3;
+        v = s[0] & 0x0f;
+        if (s[0] == 0xe0) {
+            lo = 0xa0;
+        } else if (s[0] == 0xed) {
+            hi = 0x9f;
+        }
+    } else if (s[0] < 0xf5) {
+        n = 4;
+        v = s[0] & 0x07;
+        if (s[0] == 0xf0) {
+            lo = 0x90;
+        } else if (s[0] == 0xf4) {
+            hi = 0x8f;
+        }
+    } else {
+        return 0;
+    }
+    if (len < n) {
+        return 0;
+    }
+    for (i = 1; i < n; i++, lo = 0x80, hi = 0xbf) {
+        if ((s[i] < lo) || (s[i] > hi)) {
+            return 0;
+        }
+        v = (v << 6) | (s[i] & 0x3f);
+    }
+    *cp = v;
+    return n;
+}
+
+/* Validate UTF-8 from s[i] on, counting characters (each byte of a
+   malformed sequence counts as one), until reaching stop; sequences
+   may run on up to len.  Returns where it stopped, which is stop
+   unless the last sequence ran past it. */
+static size_t
+utf8_block_c(const spif_uint8_t *s, size_t i, size_t stop, size_t len, size_t *count, spif_bool_t *valid)
+{
+    spif_uint32_t cp;
+    size_t n, k;
+
+    for (n = 0; i < stop; n++) {
+        if (s[i] < 0x80) {
+            i++;
+        } else if ((k = utf8_seq(s + i, len - i, &cp))) {
+            i += k;
+        } else {
+            *valid = FALSE;
+            i++;
+        }
+    }
+    *count += n;
+    return i;
+}
+
+static void
+utf8_scan_c(const spif_uint8_t *s, size_t i, size_t len, size_t *count, spif_bool_t *valid)
+{
+    utf8_block_c(s, i, len, len, count, valid);
+}
+
+/* Index of the first i < len with s[i] == a and s[i + dist] == b.
+   s must have len + dist readable bytes. */
+static size_t
+find_pair_c(const spif_uint8_t *s, size_t len, spif_uint8_t a, spif_uint8_t b, size_t dist)
+{
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        if ((s[i] == a) && (s[i + dist] == b)) {
+            return i;
+        }
+    }
+    return len;
+}
+
+/* Index of the first byte at which a case-insensitive comparison of a
+   and b is decided:  the first difference, or the first NUL. */
+static size_t
+casecmp_stop_c(const spif_uint8_t *a, const spif_uint8_t *b, size_t len)
+{
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        if (!a[i] || (tolower(a[i]) != tolower(b[i]))) {
+            return i;
+        }
+    }
+    return len;
+}
+
+#if LIBAST_SIMD_SUPPORT
+/********************************** SSE2 ***********************************/
+
+/* Mask of bytes which are ASCII whitespace:  ' ' or '\t' through '\r'. */
+SIMD_TARGET("sse2") static inline unsigned
+space_mask_sse2(__m128i v)
+{
+    __m128i t = _mm_sub_epi8(v, _mm_set1_epi8('\t'));
+
+    return (unsigned) _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')),
+                                                     _mm_cmpeq_epi8(_mm_min_epu8(t, _mm_set1_epi8('\r' - '\t')), t)));
+}
+
+/* Mask of bytes in [lo, lo + 25], i.e., one case of ASCII letters. */
+SIMD_TARGET("sse2") static inline __m128i
+alpha_sse2(__m128i v, char lo)
+{
+    __m128i t = _mm_sub_epi8(v, _mm_set1_epi8(lo));
+
+    return _mm_cmpeq_epi8(_mm_min_epu8(t, _mm_set1_epi8(25)), t);
+}
+
+SIMD_TARGET("sse2") static inline __m128i
+fold_sse2(__m128i v)
+{
+    return _mm_or_si128(v, _mm_and_si128(alpha_sse2(v, 'A'), _mm_set1_epi8(0x20)));
+}
+
+SIMD_TARGET("sse2") static size_t
+find2_sse2(const spif_uint8_t *s, size_t len, spif_uint8_t a, spif_uint8_t b)
+{
+    __m128i va = _mm_set1_epi8((char) a), vb = _mm_set1_epi8((char) b), v;
+    unsigned m;
+    size_t i;
+
+    for (i = 0; i + 16 <= len; i += 16) {
+        v = _mm_loadu_si128((const __m128i *) (s + i));
+        m = (unsigned) _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, va), _mm_cmpeq_epi8(v, vb)));
+        if (m) {
+            return i + SIMD_FIRST(m);
+        }
+    }
+    return i + find2_c(s + i, len - i, a, b);
+}
+
+SIMD_TARGET("sse2") static size_t
+rfind_sse2(const spif_uint8_t *s, size_t len, spif_uint8_t c)
+{
+    __m128i vc = _mm_set1_epi8((char) c);
+    unsigned m;
+    size_t i, j;
+
+    for (i = len; i >= 16;) {
+        i -= 16;
+        m = (unsigned) _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *) (s + i)), vc));
+        if (m) {
+            return i + SIMD_LAST(m);
+        }
+    }
+    j = rfind_c(s, i, c);
+    return ((j == i) ? (len) : (j));
+}
+
+SIMD_TARGET("sse2") static size_t
+find_space_sse2(const spif_uint8_t *s, size_t len)
+{
+    __m128i v;
+    unsigned m;
+    size_t i, j;
+
+    for (i = 0; i + 16 <= len; i += 16) {
+        v = _mm_loadu_si128((const __m128i *) (s + i));
+        for (m = space_mask_sse2(v) | (unsigned) _mm_movemask_epi8(v); m; m &= m - 1) {
+            j = i + SIMD_FIRST(m);
+            if (!SIMD_HIGH(s[j]) || isspace(s[j])) {
+                return j;
+            }
+        }
+    }
+    return i + find_space_c(s + i, len - i);
+}
+
+SIMD_TARGET("sse2") static size_t
+skip_space_sse2(const spif_uint8_t *s, size_t len)
+{
+    unsigned m;
+    size_t i, j;
+
+    for (i = 0; i + 16 <= len; i += 16) {
+        for (m = ~space_mask_sse2(_mm_loadu_si128((const __m128i *) (s + i))) & 0xffff; m; m &= m - 1) {
+            j = i + SIMD_FIRST(m);
+            if (!SIMD_HIGH(s[j]) || !isspace(s[j])) {
+                return j;
+            }
+        }
+    }
+    return i + skip_space_c(s + i, len - i);
+}
+
+SIMD_TARGET("sse2") static size_t
+rskip_space_sse2(const spif_uint8_t *s, size_t len)
+{
+    unsigned m;
+    size_t j;
+
+    for (; len >= 16; len -= 16) {
+        for (m = ~space_mask_sse2(_mm_loadu_si128((const __m128i *) (s + len - 16))) & 0xffff; m;
+             m &= ~(1U << SIMD_LAST(m))) {
+            j = len - 16 + SIMD_LAST(m);
+            if (!SIMD_HIGH(s[j]) || !isspace(s[j])) {
+                return j + 1;
+            }
+        }
+    }
+    return rskip_space_c(s, len);
+}
+
+SIMD_TARGET("sse2") static void
+casemap_sse2(spif_uint8_t *s, size_t len, spif_bool_t upper)
+{
+    __m128i v;
+    size_t i;
+
+    for (i = 0; i + 16 <= len; i += 16) {
+        v = _mm_loadu_si128((const __m128i *) (s + i));
+        if (_mm_movemask_epi8(v)) {
+            casemap_c(s + i, 16, upper);
+        } else {
+            v = _mm_xor_si128(v, _mm_and_si128(alpha_sse2(v, ((upper) ? ('a') : ('A'))), _mm_set1_epi8(0x20)));
+            _mm_storeu_si128((__m128i *) (s + i), v);
+        }
+    }
+    casemap_c(s + i, len - i, upper);
+}
+
+SIMD_TARGET("sse2") static size_t
+find_pair_sse2(const spif_uint8_t *s, size_t len, spif_uint8_t a, spif_uint8_t b, size_t dist)
+{
+    __m128i va = _mm_set1_epi8((char) a), vb = _mm_set1_epi8((char) b), v;
+    unsigned m;
+    size_t i;
+
+    for (i = 0; i + 16 <= len; i += 16) {
+        v = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *) (s + i)), va);
+        m = (unsigned) _mm_movemask_epi8(_mm_and_si128(v, _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *) (s + i + dist)), vb)));
+        if (m) {
+            return i + SIMD_FIRST(m);
+        }
+    }
+    return i + find_pair_c(s + i, len - i, a, b, dist);
+}
+
+SIMD_TARGET("sse2") static size_t
+casecmp_stop_sse2(const spif_uint8_t *a, const spif_uint8_t *b, size_t len)
+{
+    __m128i va, vb;
+    unsigned m;
+    size_t i, j;
+
+    for (i = 0; i + 16 <= len; i += 16) {
+        va = _mm_loadu_si128((const __m128i *) (a + i));
+        vb = _mm_loadu_si128((const __m128i *) (b + i));
+        if (_mm_movemask_epi8(_mm_or_si128(va, vb))) {
+            if ((j = casecmp_stop_c(a + i, b + i, 16)) < 16) {
+                return i + j;
+            }
+            continue;
+        }
+        m = ~(unsigned) _mm_movemask_epi8(_mm_cmpeq_epi8(fold_sse2(va), fold_sse2(vb))) & 0xffff;
+        m |= (unsigned) _mm_movemask_epi8(_mm_cmpeq_epi8(va, _mm_setzero_si128()));
+        if (m) {
+            return i + SIMD_FIRST(m);
+        }
+    }
+    return i + casecmp_stop_c(a + i, b + i, len - i);
+}
+
+SIMD_TARGET("sse2") static void
+utf8_scan_sse2(const spif_uint8_t *s, size_t i, size_t len, size_t *count, spif_bool_t *valid)
+{
+    while (i + 16 <= len) {
+        if (_mm_movemask_epi8(_mm_loadu_si128((const __m128i *) (s + i)))) {
+            i = utf8_block_c(s, i, i + 16, len, count, valid);
+        } else {
+            *count += 16;
+            i += 16;
+        }
+    }
+    utf8_scan_c(s, i, len, count, valid);
+}
+
+/********************************** AVX2 ***********************************/
+
+SIMD_TARGET("avx2") static inline unsigned
+space_mask_avx2(__m256i v)
+{
+    __m256i t = _mm256_sub_epi8(v, _mm256_set1_epi8('\t'));
+
+    return (unsigned) _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')),
+                                                           _mm256_cmpeq_epi8(_mm256_min_epu8(t, _mm256_set1_epi8('\r' - '\t')), t)));
+}
+
+SIMD_TARGET("avx2") static inline __m256i
+alpha_avx2(__m256i v, char lo)
+{
+    __m256i t = _mm256_sub_epi8(v, _mm256_set1_epi8(lo));
+
+    return _mm256_cmpeq_epi8(_mm256_min_epu8(t, _mm256_set1_epi8(25)), t);
+}
+
+SIMD_TARGET("avx2") static inline __m256i
+fold_avx2(__m256i v)
+{
+    return _mm256_or_si256(v, _mm256_and_si256(alpha_avx2(v, 'A'), _mm256_set1_epi8(0x20)));
+}
+
+SIMD_TARGET("avx2") static size_t
+find2_avx2(const spif_uint8_t *s, size_t len, spif_uint8_t a, spif_uint8_t b)
+{
+    __m256i va = _mm256_set1_epi8((char) a), vb = _mm256_set1_epi8((char) b), v;
+    unsigned m;
+    size_t i;
+
+    for (i = 0; i + 32 <= len; i += 32) {
+        v = _mm256_loadu_si256((const __m256i *) (s + i));
+        m = (unsigned) _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(v, va), _mm256_cmpeq_epi8(v, vb)));
+        if (m) {
+            return i + SIMD_FIRST(m);
+        }
+    }
+    return i + find2_sse2(s + i, len - i, a, b);
+}
+
+SIMD_TARGET("avx2") static size_t
+rfind_avx2(const spif_uint8_t *s, size_t len, spif_uint8_t c)
+{
+    __m256i vc = _mm256_set1_epi8((char) c);
+    unsigned m;
+    size_t i, j;
+
+    for (i = len; i >= 32;) {
+        i -= 32;
+        m = (unsigned) _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *) (s + i)), vc));
+        if (m) {
+            return i + SIMD_LAST(m);
+        }
+    }
+    j = rfind_sse2(s, i, c);
+    return ((j == i) ? (len) : (j));
+}
+
+SIMD_TARGET("avx2") static size_t
+find_space_avx2(const spif_uint8_t *s, size_t len)
+{
+    __m256i v;
+    unsigned m;
+    size_t i, j;
+
+    for (i = 0; i + 32 <= len; i += 32) {
+        v = _mm256_loadu_si256((const __m256i *) (s + i));
+        for (m = space_mask_avx2(v) | (unsigned) _mm256_movemask_epi8(v); m; m &= m - 1) {
+            j = i + SIMD_FIRST(m);
+            if (!SIMD_HIGH(s[j]) || isspace(s[j])) {
+                return j;
+            }
+        }
+    }
+    return i + find_space_sse2(s + i, len - i);
+}
+
+SIMD_TARGET("avx2") static size_t
+skip_space_avx2(const spif_uint8_t *s, size_t len)
+{
+    unsigned m;
+    size_t i, j;
+
+    for (i = 0; i + 32 <= len; i += 32) {
+        for (m = ~space_mask_avx2(_mm256_loadu_si256((const __m256i *) (s + i))); m; m &= m - 1) {
+            j = i + SIMD_FIRST(m);
+            if (!SIMD_HIGH(s[j]) || !isspace(s[j])) {
+                return j;
+            }
+        }
+    }
+    return i + skip_space_sse2(s + i, len - i);
+}
+
+SIMD_TARGET("avx2") static size_t
+rskip_space_avx2(const spif_uint8_t *s, size_t len)
+{
+    unsigned m;
+    size_t j;
+
+    for (; len >= 32; len -= 32) {
+        for (m = ~space_mask_avx2(_mm256_loadu_si256((const __m256i *) (s + len - 32))); m;
+             m &= ~(1U << SIMD_LAST(m))) {
+            j = len - 32 + SIMD_LAST(m);
+            if (!SIMD_HIGH(s[j]) || !isspace(s[j])) {
+                return j + 1;
+            }
+        }
+    }
+    return rskip_space_sse2(s, len);
+}
+
+SIMD_TARGET("avx2") static void
+casemap_avx2(spif_uint8_t *s, size_t len, spif_bool_t upper)
+{
+    __m256i v;
+    size_t i;
+
+    for (i = 0; i + 32 <= len; i += 32) {
+        v = _mm256_loadu_si256((const __m256i *) (s + i));
+        if (_mm256_movemask_epi8(v)) {
+            casemap_c(s + i, 32, upper);
+        } else {
+            v = _mm256_xor_si256(v, _mm256_and_si256(alpha_avx2(v, ((upper) ? ('a') : ('A'))), _mm256_set1_epi8(0x20)));
+            _mm256_storeu_si256((__m256i *) (s + i), v);
+        }
+    }
+    casemap_sse2(s + i, len - i, upper);
+}
+
+SIMD_TARGET("avx2") static size_t
+find_pair_avx2(const spif_uint8_t *s, size_t len, spif_uint8_t a, spif_uint8_t b, size_t dist)
+{
+    __m256i va = _mm256_set1_epi8((char) a), vb = _mm256_set1_epi8((char) b), v;
+    unsigned m;
+    size_t i;
+
+    for (i = 0; i + 32 <= len; i += 32) {
+        v = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *) (s + i)), va);
+        m = (unsigned) _mm256_movemask_epi8(_mm256_and_si256(v, _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *) (s + i + dist)), vb)));
+        if (m) {
+            return i + SIMD_FIRST(m);
+        }
+    }
+    return i + find_pair_sse2(s + i, len - i, a, b, dist);
+}
+
+SIMD_TARGET("avx2") static size_t
+casecmp_stop_avx2(const spif_uint8_t *a, const spif_uint8_t *b, size_t len)
+{
+    __m256i va, vb;
+    unsigned m;
+    size_t i, j;
+
+    for (i = 0; i + 32 <= len; i += 32) {
+        va = _mm256_loadu_si256((const __m256i *) (a + i));
+        vb = _mm256_loadu_si256((const __m256i *) (b + i));
+        if (_mm256_movemask_epi8(_mm256_or_si256(va, vb))) {
+            if ((j = casecmp_stop_c(a + i, b + i, 32)) < 32) {
+                return i + j;
+            }
+            continue;
+        }
+        m = ~(unsigned) _mm256_movemask_epi8(_mm256_cmpeq_epi8(fold_avx2(va), fold_avx2(vb)));
+        m |= (unsigned) _mm256_movemask_epi8(_mm256_cmpeq_epi8(va, _mm256_setzero_si256()));
+        if (m) {
+            return i + SIMD_FIRST(m);
+        }
+    }
+    return i + casecmp_stop_sse2(a + i, b + i, len - i);
+}
+
+SIMD_TARGET("avx2") static void
+utf8_scan_avx2(const spif_uint8_t *s, size_t i, size_t len, size_t *count, spif_bool_t *valid)
+{
+    while (i + 32 <= len) {
+        if (_mm256_movemask_epi8(_mm256_loadu_si256((const __m256i *) (s + i)))) {
+            i = utf8_block_c(s, i, i + 32, len, count, valid);
+        } else {
+            *count += 32;
+            i += 32;
+        }
+    }
+    utf8_scan_sse2(s, i, len, count, valid);
+}
+
+# define SIMD_DISPATCH(name, args)  ((SIMD_LEVEL() == SIMD_LEVEL_AVX2) ? (name ## _avx2 args) \
+                                     : ((SIMD_LEVEL() == SIMD_LEVEL_SSE2) ? (name ## _sse2 args) : (name ## _c args)))
+#else
+# define SIMD_DISPATCH(name, args)  (name ## _c args)
+#endif
+
+/******************************** Interface ********************************/
+
+/**
+ * Bounded strchr().
+ *
+ * Looks for @a c in the first @a len bytes of @a s, stopping at a NUL
+ * just as strchr() would.  @a s need not be NUL-terminated.
+ *
+ * @param s   The string to search.
+ * @param len The maximum number of bytes to search.
+ * @param c   The character to find.
+ * @return    A pointer to the first @a c, or NULL if none was found.
+ */
+spif_charptr_t
+spiftool_strnchr(const spif_charptr_t s, size_t len, spif_char_t c)
+{
+    const spif_uint8_t *p = (const spif_uint8_t *) s;
+    size_t i;
+
+    ASSERT_RVAL(s != (spif_ptr_t) NULL, (spif_ptr_t) NULL);
+    i = SIMD_DISPATCH(find2, (p, len, (spif_uint8_t) c, 0));
+    return (((i < len) && (p[i] == (spif_uint8_t) c)) ? (s + i) : ((spif_charptr_t) NULL));
+}
+
+/**
+ * Bounded strrchr().
+ *
+ * Like spiftool_strnchr(), but finds the last @a c before the first
+ * NUL (or before @a len bytes).
+ *
+ * @param s   The string to search.
+ * @param len The maximum number of bytes to search.
+ * @param c   The character to find.
+ * @return    A pointer to the last @a c, or NULL if none was found.
+ */
+spif_charptr_t
+spiftool_strnrchr(const spif_charptr_t s, size_t len, spif_char_t c)
+{
+    const spif_uint8_t *p = (const spif_uint8_t *) s;
+    size_t i, end;
+
+    ASSERT_RVAL(s != (spif_ptr_t) NULL, (spif_ptr_t) NULL);
+    end = SIMD_DISPATCH(find2, (p, len, 0, 0));
+    if (!c) {
+        return ((end < len) ? (s + end) : ((spif_charptr_t) NULL));
+    }
+    i = SIMD_DISPATCH(rfind, (p, end, (spif_uint8_t) c));
+    return ((i < end) ? (s + i) : ((spif_charptr_t) NULL));
+}
+
+/**
+ * Find a pair of bytes a fixed distance apart.
+ *
+ * This is the candidate filter for substring search:  with @a a and
+ * @a b the first and last bytes of a needle and @a dist its length
+ * minus one, every match of the needle starts at a position this
+ * returns.
+ *
+ * @param s    The buffer to search.
+ * @param len  The number of positions to try; @a s must have
+ *             @a len + @a dist readable bytes.
+ * @param a    The byte to find at the position.
+ * @param b    The byte to find @a dist bytes after it.
+ * @param dist The distance between them.
+ * @return     The first position i with s[i] == @a a and
+ *             s[i + @a dist] == @a b, or @a len if there is none.
+ */
+size_t
+spiftool_find_pair(const spif_byteptr_t s, size_t len, spif_uint8_t a, spif_uint8_t b, size_t dist)
+{
+    ASSERT_RVAL(s != (spif_ptr_t) NULL, len);
+    return SIMD_DISPATCH(find_pair, ((const spif_uint8_t *) s, len, a, b, dist));
+}
+
+/**
+ * Find whitespace.
+ *
+ * @param s   The buffer to search.
+ * @param len The length of the buffer.
+ * @return    The index of the first whitespace character in @a s, or
+ *            @a len if there is none.
+ */
+size_t
+spiftool_find_space(const spif_charptr_t s, size_t len)
+{
+    ASSERT_RVAL(s != (spif_ptr_t) NULL, 0);
+    return SIMD_DISPATCH(find_space, ((const spif_uint8_t *) s, len));
+}
+
+/**
+ * Measure leading whitespace.
+ *
+ * @param s   The buffer to examine.
+ * @param len The length of the buffer.
+ * @return    The number of whitespace characters at the start of @a s.
+ */
+size_t
+spiftool_span_space(const spif_charptr_t s, size_t len)
+{
+    ASSERT_RVAL(s != (spif_ptr_t) NULL, 0);
+    return SIMD_DISPATCH(skip_space, ((const spif_uint8_t *) s, len));
+}
+
+/**
+ * Measure trailing whitespace.
+ *
+ * @param s   The buffer to examine.
+ * @param len The length of the buffer.
+ * @return    The number of whitespace characters at the end of @a s.
+ */
+size_t
+spiftool_rspan_space(const spif_charptr_t s, size_t len)
+{
+    ASSERT_RVAL(s != (spif_ptr_t) NULL, 0);
+    return len - SIMD_DISPATCH(rskip_space, ((const spif_uint8_t *) s, len));
+}
+
+/**
+ * Convert a buffer to lowercase in place.
+ *
+ * @param s   The buffer to convert.
+ * @param len The length of the buffer.
+ */
+void
+spiftool_downcase_buff(spif_charptr_t s, size_t len)
+{
+    ASSERT(s != (spif_ptr_t) NULL);
+    SIMD_DISPATCH(casemap, ((spif_uint8_t *) s, len, FALSE));
+}
+
+/**
+ * Convert a buffer to uppercase in place.
+ *
+ * @param s   The buffer to convert.
+ * @param len The length of the buffer.
+ */
+void
+spiftool_upcase_buff(spif_charptr_t s, size_t len)
+{
+    ASSERT(s != (spif_ptr_t) NULL);
+    SIMD_DISPATCH(casemap, ((spif_uint8_t *) s, len, TRUE));
+}
+
+/**
+ * strncasecmp() work-alike.
+ *
+ * Unlike strncasecmp(), this may read all @a len bytes of both
+ * strings even if one ends sooner, so both must be at least that long
+ * (counting the NUL).
+ *
+ * @param a   The first string.
+ * @param b   The second string.
+ * @param len The maximum number of bytes to compare.
+ * @return    An integer less than, equal to, or greater than zero, as
+ *            with strncasecmp().
+ */
+int
+spiftool_strncasecmp(const spif_charptr_t a, const spif_charptr_t b, size_t len)
+{
+    size_t i;
+
+    ASSERT_RVAL(a != (spif_ptr_t) NULL, 0);
+    ASSERT_RVAL(b != (spif_ptr_t) NULL, 0);
+    i = SIMD_DISPATCH(casecmp_stop, ((const spif_uint8_t *) a, (const spif_uint8_t *) b, len));
+    if (i == len) {
+        return 0;
+    }
+    return tolower((spif_uint8_t) a[i]) - tolower((spif_uint8_t) b[i]);
+}
+
+/**
+ * Decode one UTF-8 character.
+ *
+ * A malformed or truncated sequence decodes as a single byte with
+ * the value U+FFFD, so walking a buffer with this always makes
+ * progress and counts characters the same way spiftool_utf8_scan()
+ * does.
+ *
+ * @param s   The buffer to decode from.
+ * @param len The number of bytes available at @a s (at least 1).
+ * @param cp  Where to store the code point.
+ * @return    The number of bytes consumed.
+ */
+size_t
+spiftool_utf8_decode(const spif_charptr_t s, size_t len, spif_uint32_t *cp)
+{
+    const spif_uint8_t *p = (const spif_uint8_t *) s;
+    size_t n;
+
+    ASSERT_RVAL(s != (spif_ptr_t) NULL, 1);
+    ASSERT_RVAL(cp != NULL, 1);
+    if (p[0] < 0x80) {
+        *cp = p[0];
+        return 1;
+    } else if ((n = utf8_seq(p, len, cp))) {
+        return n;
+    }
+    *cp = 0xfffd;
+    return 1;
+}
+
+/**
+ * Encode one character as UTF-8.
+ *
+ * @param s  Where to store the encoding; 4 bytes is always enough.
+ * @param cp The code point.  Surrogates and values past U+10FFFF are
+ *           encoded as U+FFFD.
+ * @return   The number of bytes stored.
+ */
+size_t
+spiftool_utf8_encode(spif_charptr_t s, spif_uint32_t cp)
+{
+    spif_uint8_t *p = (spif_uint8_t *) s;
+
+    ASSERT_RVAL(s != (spif_ptr_t) NULL, 0);
+    if (cp < 0x80) {
+        p[0] = (spif_uint8_t) cp;
+        return 1;
+    } else if (cp < 0x800) {
+        p[0] = (spif_uint8_t) (0xc0 | (cp >> 6));
+        p[1] = (spif_uint8_t) (0x80 | (cp & 0x3f));
+        return 2;
+    } else if ((cp > 0x10ffff) || ((cp >= 0xd800) && (cp < 0xe000))) {
+        cp = 0xfffd;
+    }
+    if (cp < 0x10000) {
+        p[0] = (spif_uint8_t) (0xe0 | (cp >> 12));
+        p[1] = (spif_uint8_t) (0x80 | ((cp >> 6) & 0x3f));
+        p[2] = (spif_uint8_t) (0x80 | (cp & 0x3f));
+        return 3;
+    }
+    p[0] = (spif_uint8_t) (0xf0 | (cp >> 18));
+    p[1] = (spif_uint8_t) (0x80 | ((cp >> 12) & 0x3f));
+    p[2] = (spif_uint8_t) (0x80 | ((cp >> 6) & 0x3f));
+    p[3] = (spif_uint8_t) (0x80 | (cp & 0x3f));
+    return 4;
+}
+
+/**
+ * Validate UTF-8 and count characters.
+ *
+ * Runs of ASCII are skipped a vector at a time; only blocks with the
+ * high bit set somewhere are decoded.  NUL bytes are ordinary
+ * characters here.
+ *
+ * @param s     The buffer to check.
+ * @param len   The length of the buffer.
+ * @param count Where to store the number of characters, counting each
+ *              byte of a malformed sequence as one, or NULL.
+ * @return      TRUE if all of @a s is well-formed UTF-8, FALSE if not.
+ */
+spif_bool_t
+spiftool_utf8_scan(const spif_charptr_t s, size_t len, size_t *count)
+{
+    spif_bool_t valid = TRUE;
+    size_t n = 0;
+
+    ASSERT_RVAL(s != (spif_ptr_t) NULL, FALSE);
+    SIMD_DISPATCH(utf8_scan, ((const spif_uint8_t *) s, 0, len, &n, &valid));
+    if (count) {
+        *count = n;
+    }
+    return valid;
+}
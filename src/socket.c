@@ -160,52 +160,28 @@ spif_socket_del(spif_socket_t self)
 spif_str_t
 spif_socket_show(spif_socket_t self, spif_charptr_t name, spif_str_t buff, size_t indent)
 {
-    spif_char_t tmp[4096];
-
     if (SPIF_SOCKET_ISNULL(self)) {
-        SPIF_OBJ_SHOW_NULL(socket, name, buff, indent, tmp);
+        SPIF_OBJ_SHOW_NULL_INTO(socket, name, buff, indent);
         return buff;
     }
         
-    memset(tmp, ' ', indent);
-    snprintf((char *) tmp + indent, sizeof(tmp) - indent,
-             "(spif_socket_t) %s:  %10p {\n",
-             name, (spif_ptr_t) self);
-    if (SPIF_STR_ISNULL(buff)) {
-        buff = spif_str_new_from_ptr(tmp);
-    } else {
-        spif_str_append_from_ptr(buff, tmp);
-    }
+    buff = spif_str_show_printf(buff, indent, "(spif_socket_t) %s:  %10p {\n",
+                                name, (spif_ptr_t) self);
 
     indent += 2;
-    memset(tmp, ' ', indent);
-    snprintf((char *) tmp + indent, sizeof(tmp) - indent, "(spif_sockfd_t) fd:  %d\n", self->fd);
-    spif_str_append_from_ptr(buff, tmp);
-
-    snprintf((char *) tmp + indent, sizeof(tmp) - indent, "(spif_sockfamily_t) fam:  %d\n", (int) self->fam);
-    spif_str_append_from_ptr(buff, tmp);
-
-    snprintf((char *) tmp + indent, sizeof(tmp) - indent, "(spif_socktype_t) type:  %d\n", (int) self->type);
-    spif_str_append_from_ptr(buff, tmp);
-
-    snprintf((char *) tmp + indent, sizeof(tmp) - indent, "(spif_sockproto_t) proto:  %d\n", (int) self->proto);
-    spif_str_append_from_ptr(buff, tmp);
-
-    snprintf((char *) tmp + indent, sizeof(tmp) - indent, "(spif_sockaddr_t) addr:  %10p\n", (spif_ptr_t) self->addr);
-    spif_str_append_from_ptr(buff, tmp);
-
-    snprintf((char *) tmp + indent, sizeof(tmp) - indent, "(spif_sockaddr_len_t) len:  %lu\n", (unsigned long) self->len);
-    spif_str_append_from_ptr(buff, tmp);
-
-    snprintf((char *) tmp + indent, sizeof(tmp) - indent, "(spif_uint32_t) flags:  0x%08x\n", (unsigned) self->flags);
-    spif_str_append_from_ptr(buff, tmp);
+    buff = spif_str_show_printf(buff, indent, "(spif_sockfd_t) fd:  %d\n", self->fd);
+    buff = spif_str_show_printf(buff, indent, "(spif_sockfamily_t) fam:  %d\n", (int) self->fam);
+    buff = spif_str_show_printf(buff, indent, "(spif_socktype_t) type:  %d\n", (int) self->type);
+    buff = spif_str_show_printf(buff, indent, "(spif_sockproto_t) proto:  %d\n", (int) self->proto);
+    buff = spif_str_show_printf(buff, indent, "(spif_sockaddr_t) addr:  %10p\n", (spif_ptr_t) self->addr);
+    buff = spif_str_show_printf(buff, indent, "(spif_sockaddr_len_t) len:  %lu\n", (unsigned long) self->len);
+    buff = spif_str_show_printf(buff, indent, "(spif_uint32_t) flags:  0x%08x\n", (unsigned) self->flags);
 
     spif_url_show(self->local_url, SPIF_CHARPTR("local_url"), buff, indent);
     spif_url_show(self->remote_url, SPIF_CHARPTR("remote_url"), buff, indent);
 
     indent -= 2;
-    snprintf((char *) tmp + indent, sizeof(tmp) - indent, "}\n");
-    spif_str_append_from_ptr(buff, tmp);
+    buff = spif_str_show_printf(buff, indent, "}\n");
 
     return buff;
 }
@@ -86,27 +86,136 @@ SPIF_TYPE(strclass) SPIF_STRCLASS_VAR(str) = &s_class;
 /* *INDENT-ON* */
 
 static const size_t buff_inc = 4096;
+static const size_t pool_keep_max = 16384;
 
-spif_str_t
-spif_str_new(void)
+/* Point self at fresh storage for size bytes, inline if it fits.
+   Whatever buffer self had before is ignored, not freed. */
+static void
+spif_str_alloc(spif_str_t self, spif_stridx_t size)
+{
+    self->size = size;
+    if (size <= SPIF_STR_INLINE_SIZE) {
+        self->s = self->inl;
+    } else {
+        self->s = (spif_charptr_t) MALLOC(size);
+    }
+}
+
+/* Change the size of self's buffer, keeping its contents.  Moves the
+   string between the inline buffer and the heap as needed.  A string
+   with no buffer yet gets an empty one. */
+static void
+spif_str_resize(spif_str_t self, spif_stridx_t size)
+{
+    spif_charptr_t heap;
+
+    if (self->s == (spif_charptr_t) NULL) {
+        spif_str_alloc(self, size);
+        self->s[0] = 0;
+        return;
+    } else if (size <= SPIF_STR_INLINE_SIZE) {
+        if (!SPIF_STR_IS_INLINE(self)) {
+            memcpy(self->inl, self->s, MIN(self->size, size));
+            FREE(self->s);
+            self->s = self->inl;
+        }
+    } else if (SPIF_STR_IS_INLINE(self)) {
+        heap = (spif_charptr_t) MALLOC(size);
+        memcpy(heap, self->inl, MIN(self->size, size));
+        self->s = heap;
+    } else {
+        self->s = (spif_charptr_t) REALLOC(self->s, size);
+    }
+    self->size = size;
+}
+
+/* Make sure self's buffer holds at least size bytes.  Capacity grows
+   geometrically, so a run of appends costs amortized linear time. */
+static void
+spif_str_grow(spif_str_t self, spif_stridx_t size)
+{
+    if (self->size < size) {
+        spif_str_resize(self, MAX(size, self->size * 2));
+    }
+}
+
+/* Case-insensitively compare self with a string of length len,
+   looking at no more than cnt bytes if cnt isn't negative.  Like
+   strncasecmp(), the comparison stops at the first NUL; the lengths
+   keep the vectorized compare from reading past either string. */
+static spif_cmp_t
+spif_str_casecmp_buff(spif_str_t self, spif_charptr_t other, spif_stridx_t len, spif_stridx_t cnt)
+{
+    spif_stridx_t n;
+
+    n = MIN(self->len, len) + 1;
+    if ((cnt >= 0) && (cnt < n)) {
+        n = cnt;
+    }
+    return SPIF_CMP_FROM_INT(spiftool_strncasecmp(((self->s) ? (self->s) : (SPIF_CHARPTR(""))),
+                                                  ((other) ? (other) : (SPIF_CHARPTR(""))), n));
+}
+
+/* Compare self with a string of length len, looking at no more than
+   cnt bytes if cnt isn't negative.  The lengths are known, so this is
+   a memcmp() of the common prefix rather than a walk for the NUL. */
+static spif_cmp_t
+spif_str_cmp_buff(spif_str_t self, spif_charptr_t other, spif_stridx_t len, spif_stridx_t cnt)
+{
+    spif_stridx_t n, self_len;
+    int c;
+
+    self_len = self->len;
+    if (cnt >= 0) {
+        self_len = MIN(self_len, cnt);
+        len = MIN(len, cnt);
+    }
+    n = MIN(self_len, len);
+    c = ((n) ? (memcmp(self->s, other, n)) : (0));
+    if (c) {
+        return SPIF_CMP_FROM_INT(c);
+    }
+    return SPIF_CMP_FROM_INT((self_len > len) - (self_len < len));
+}
+
+/* Get an empty string object, recycled from the str pool if there is
+   one.  A recycled string keeps its buffer if it can hold size bytes. */
+static spif_str_t
+spif_str_take(spif_stridx_t size)
 {
     spif_str_t self;
 
-    self = SPIF_ALLOC(str);
-    if (!spif_str_init(self)) {
-        SPIF_DEALLOC(self);
-        self = (spif_str_t) NULL;
+    self = SPIF_STR(spif_pool_take(SPIF_CLASS_VAR(str)));
+    if (SPIF_STR_ISNULL(self)) {
+        self = SPIF_ALLOC(str);
+        spif_str_init(self);
+    } else if (self->size < size) {
+        spif_str_done(self);
     }
     return self;
 }
 
+spif_str_t
+spif_str_new(void)
+{
+    return spif_str_take(0);
+}
+
 spif_str_t
 spif_str_new_from_ptr(spif_charptr_t old)
 {
     spif_str_t self;
+    spif_stridx_t len;
 
-    self = SPIF_ALLOC(str);
-    if (!spif_str_init_from_ptr(self, old)) {
+    if (old == (spif_charptr_t) NULL) {
+        return spif_str_new();
+    }
+    len = strlen((const char *) old);
+    self = spif_str_take(len + 1);
+    if (self->size) {
+        memcpy(self->s, old, len + 1);
+        self->len = len;
+    } else if (!spif_str_init_from_ptr(self, old)) {
         SPIF_DEALLOC(self);
         self = (spif_str_t) NULL;
     }
@@ -117,9 +226,17 @@ spif_str_t
 spif_str_new_from_buff(spif_charptr_t buff, spif_stridx_t size)
 {
     spif_str_t self;
+    spif_stridx_t len;
 
-    self = SPIF_ALLOC(str);
-    if (!spif_str_init_from_buff(self, buff, size)) {
+    len = ((buff != (spif_charptr_t) NULL) ? ((spif_stridx_t) strnlen((const char *) buff, size)) : (0));
+    self = spif_str_take(MAX(size, len + 1));
+    if (self->size) {
+        if (len) {
+            memcpy(self->s, buff, len);
+        }
+        self->s[len] = 0;
+        self->len = len;
+    } else if (!spif_str_init_from_buff(self, buff, size)) {
         SPIF_DEALLOC(self);
         self = (spif_str_t) NULL;
     }
@@ -152,6 +269,19 @@ spif_str_new_from_fd(int fd)
     return self;
 }
 
+spif_str_t
+spif_str_new_from_file(spif_charptr_t path)
+{
+    spif_str_t self;
+
+    self = SPIF_ALLOC(str);
+    if (!spif_str_init_from_file(self, path)) {
+        SPIF_DEALLOC(self);
+        self = (spif_str_t) NULL;
+    }
+    return self;
+}
+
 spif_str_t
 spif_str_new_from_num(long num)
 {
@@ -171,6 +301,7 @@ spif_str_init(spif_str_t self)
     ASSERT_RVAL(!SPIF_STR_ISNULL(self), FALSE);
     /* ***NOT NEEDED*** spif_obj_init(SPIF_OBJ(self)); */
     spif_obj_set_class(SPIF_OBJ(self), SPIF_CLASS(SPIF_STRCLASS_VAR(str)));
+    SPIF_STR_CHANGED(self);
     self->s = (spif_charptr_t) NULL;
     self->len = 0;
     self->size = 0;
@@ -184,9 +315,9 @@ spif_str_init_from_ptr(spif_str_t self, spif_charptr_t old)
     REQUIRE_RVAL((old != (spif_charptr_t) NULL), spif_str_init(self));
     /* ***NOT NEEDED*** spif_obj_init(SPIF_OBJ(self)); */
     spif_obj_set_class(SPIF_OBJ(self), SPIF_CLASS(SPIF_STRCLASS_VAR(str)));
+    SPIF_STR_CHANGED(self);
     self->len = strlen((const char *) old);
-    self->size = self->len + 1;
-    self->s = (spif_charptr_t) MALLOC(self->size);
+    spif_str_alloc(self, self->len + 1);
     memcpy(self->s, old, self->size);
     return TRUE;
 }
@@ -197,6 +328,7 @@ spif_str_init_from_buff(spif_str_t self, spif_charptr_t buff, spif_stridx_t size
     ASSERT_RVAL(!SPIF_STR_ISNULL(self), FALSE);
     /* ***NOT NEEDED*** spif_obj_init(SPIF_OBJ(self)); */
     spif_obj_set_class(SPIF_OBJ(self), SPIF_CLASS(SPIF_STRCLASS_VAR(str)));
+    SPIF_STR_CHANGED(self);
     self->size = size;
     if (buff != (spif_charptr_t) NULL) {
         self->len = strnlen((const char *) buff, size);
@@ -206,7 +338,7 @@ spif_str_init_from_buff(spif_str_t self, spif_charptr_t buff, spif_stridx_t size
     if (self->size == self->len) {
         self->size++;
     }
-    self->s = (spif_charptr_t) MALLOC(self->size);
+    spif_str_alloc(self, self->size);
     if (buff != (spif_charptr_t) NULL) {
         memcpy(self->s, buff, self->len);
     }
@@ -218,72 +350,88 @@ spif_bool_t
 spif_str_init_from_fp(spif_str_t self, FILE *fp)
 {
     spif_charptr_t p, end = NULL;
+    spif_stridx_t used;
 
     ASSERT_RVAL(!SPIF_STR_ISNULL(self), FALSE);
     ASSERT_RVAL((fp != (FILE *) NULL), FALSE);
     /* ***NOT NEEDED*** spif_obj_init(SPIF_OBJ(self)); */
     spif_obj_set_class(SPIF_OBJ(self), SPIF_CLASS(SPIF_STRCLASS_VAR(str)));
-    self->size = buff_inc;
+    SPIF_STR_CHANGED(self);
     self->len = 0;
-    self->s = (spif_charptr_t) MALLOC(self->size);
+    spif_str_alloc(self, buff_inc);
 
-    for (p = self->s; fgets((char *)p, buff_inc, fp); p += buff_inc) {
-        if (!(end = (spif_charptr_t)strchr((const char *)p, '\n'))) {
-            self->size += buff_inc;
-            self->s = (spif_charptr_t) REALLOC(self->s, self->size);
-        } else {
+    self->s[0] = 0;
+    for (used = 0; fgets((char *) self->s + used, self->size - used, fp); ) {
+        p = self->s + used;
+        if ((end = (spif_charptr_t) strchr((const char *) p, '\n'))) {
             *end = 0;
             break;
         }
+        used += strlen((const char *) p);
+        spif_str_grow(self, used + buff_inc);
     }
     self->len = (spif_stridx_t) ((end)
                           ? (end - self->s)
                           : ((int) strlen((const char *)self->s)));
-    self->size = self->len + 1;
-    self->s = (spif_charptr_t) REALLOC(self->s, self->size);
+    spif_str_resize(self, self->len + 1);
     return TRUE;
 }
 
 spif_bool_t
 spif_str_init_from_fd(spif_str_t self, int fd)
 {
-    int n;
-    spif_charptr_t p;
+    size_t len;
 
     ASSERT_RVAL(!SPIF_STR_ISNULL(self), FALSE);
     ASSERT_RVAL((fd >= 0), FALSE);
     /* ***NOT NEEDED*** spif_obj_init(SPIF_OBJ(self)); */
     spif_obj_set_class(SPIF_OBJ(self), SPIF_CLASS(SPIF_STRCLASS_VAR(str)));
-    self->size = buff_inc;
-    self->len = 0;
-    self->s = (spif_charptr_t) MALLOC(self->size);
-
-    for (p = self->s; ((n = read(fd, p, buff_inc)) > 0) || (errno == EINTR);) {
-        self->size += n;
-        self->s = (spif_charptr_t) REALLOC(self->s, self->size);
-        p += n;
+    SPIF_STR_CHANGED(self);
+    self->s = SPIF_CHARPTR(spiftool_read_fd(fd, &len, 1));
+    if (!self->s) {
+        spif_str_init(self);
+        return FALSE;
     }
-    self->len = self->size - buff_inc;
+    self->len = (spif_stridx_t) len;
     self->size = self->len + 1;
-    self->s = (spif_charptr_t) REALLOC(self->s, self->size);
     self->s[self->len] = 0;
+    if (self->size <= SPIF_STR_INLINE_SIZE) {
+        /* Small enough to live in the object itself. */
+        spif_str_resize(self, self->size);
+    }
     return TRUE;
 }
 
+spif_bool_t
+spif_str_init_from_file(spif_str_t self, spif_charptr_t path)
+{
+    spif_bool_t ret;
+    int fd;
+
+    ASSERT_RVAL(!SPIF_STR_ISNULL(self), FALSE);
+    REQUIRE_RVAL((path != NULL), spif_str_init(self));
+    if ((fd = open((const char *) path, O_RDONLY)) < 0) {
+        spif_str_init(self);
+        return FALSE;
+    }
+    ret = spif_str_init_from_fd(self, fd);
+    close(fd);
+    return ret;
+}
+
 spif_bool_t
 spif_str_init_from_num(spif_str_t self, long num)
 {
-    spif_char_t buff[28];
+    spif_char_t buff[SPIFTOOL_NUM_BUFF_SIZE];
 
     ASSERT_RVAL(!SPIF_STR_ISNULL(self), FALSE);
     /* ***NOT NEEDED*** spif_obj_init(SPIF_OBJ(self)); */
     spif_obj_set_class(SPIF_OBJ(self), SPIF_CLASS(SPIF_STRCLASS_VAR(str)));
+    SPIF_STR_CHANGED(self);
 
-    snprintf((char *) buff, sizeof(buff), "%ld", num);
-    self->len = strlen((char *) buff);
-    self->size = self->len + 1;
-    self->s = (spif_charptr_t) MALLOC(self->size);
-    strcpy((char *) self->s, (char *) buff);
+    self->len = (spif_stridx_t) spiftool_format_int64((spif_charptr_t) buff, (spif_int64_t) num);
+    spif_str_alloc(self, self->len + 1);
+    memcpy(self->s, buff, self->len + 1);
 
     return TRUE;
 }
@@ -292,8 +440,11 @@ spif_bool_t
 spif_str_done(spif_str_t self)
 {
     ASSERT_RVAL(!SPIF_STR_ISNULL(self), FALSE);
+    SPIF_STR_CHANGED(self);
     if (self->size) {
-        FREE(self->s);
+        if (!SPIF_STR_IS_INLINE(self)) {
+            FREE(self->s);
+        }
         self->len = 0;
         self->size = 0;
         self->s = (spif_charptr_t) NULL;
@@ -305,36 +456,62 @@ spif_bool_t
 spif_str_del(spif_str_t self)
 {
     ASSERT_RVAL(!SPIF_STR_ISNULL(self), FALSE);
-    spif_str_done(self);
-    SPIF_DEALLOC(self);
+    if (self->size > (spif_stridx_t) pool_keep_max) {
+        spif_str_done(self);
+    } else if (self->size) {
+        self->len = 0;
+        self->s[0] = 0;
+    }
+    SPIF_STR_CHANGED(self);
+    if (!spif_pool_give(SPIF_OBJ(self))) {
+        spif_str_done(self);
+        SPIF_DEALLOC(self);
+    }
     return TRUE;
 }
 
 spif_str_t
 spif_str_show(spif_str_t self, spif_charptr_t name, spif_str_t buff, size_t indent)
 {
-    spif_char_t tmp[4096];
-
     if (SPIF_STR_ISNULL(self)) {
-        SPIF_OBJ_SHOW_NULL(str, name, buff, indent, tmp);
+        SPIF_OBJ_SHOW_NULL_INTO(str, name, buff, indent);
         return buff;
     }
 
-    memset(tmp, ' ', indent);
-    snprintf((char *) tmp + indent, sizeof(tmp) - indent,
-             "(spif_str_t) %s:  %10p { \"",
-             name, (spif_ptr_t) self);
-    if (SPIF_STR_ISNULL(buff)) {
-        buff = spif_str_new_from_ptr(tmp);
-    } else {
-        spif_str_append_from_ptr(buff, tmp);
-    }
-
+    buff = spif_str_show_printf(buff, indent, "(spif_str_t) %s:  %10p { \"", name, (spif_ptr_t) self);
     spif_str_append(buff, self);
+    spif_str_append_printf(buff, "\", len %lu, size %lu }\n", (unsigned long) self->len,
+                           (unsigned long) self->size);
+    return buff;
+}
+
+/**
+ * Append an indented line of formatted text to a show() buffer.
+ *
+ * This is the building block for the show() methods:  it creates the
+ * buffer if it's NULL, then writes @a indent spaces and the formatted
+ * text directly into it.
+ *
+ * @param buff   The buffer to append to, or NULL for a new one.
+ * @param indent The number of spaces to indent.
+ * @param format A printf()-style format.
+ * @return       @a buff, or the new buffer.
+ */
+spif_str_t
+spif_str_show_printf(spif_str_t buff, size_t indent, spif_charptr_t format, ...)
+{
+    va_list ap;
 
-    snprintf((char *) tmp, sizeof(tmp), "\", len %lu, size %lu }\n", (unsigned long) self->len,
-             (unsigned long) self->size);
-    spif_str_append_from_ptr(buff, tmp);
+    if (SPIF_STR_ISNULL(buff)) {
+        buff = spif_str_new();
+    }
+    spif_str_grow(buff, buff->len + indent + 1);
+    memset(buff->s + buff->len, ' ', indent);
+    buff->len += indent;
+    buff->s[buff->len] = 0;
+    va_start(ap, format);
+    spif_str_append_vprintf(buff, format, ap);
+    va_end(ap);
     return buff;
 }
 
@@ -350,11 +527,18 @@ spif_str_dup(spif_str_t self)
     spif_str_t tmp;
 
     ASSERT_RVAL(!SPIF_STR_ISNULL(self), (spif_str_t) NULL);
-    tmp = SPIF_ALLOC(str);
-    memcpy(tmp, self, SPIF_SIZEOF_TYPE(str));
-    tmp->s = (spif_charptr_t) STRDUP((const char *) SPIF_STR_STR(self));
+    tmp = spif_str_take(self->len + 1);
+    spif_obj_set_class(SPIF_OBJ(tmp), SPIF_OBJ_CLASS(self));
+    if (!self->s) {
+        return tmp;
+    }
+    if (!tmp->size) {
+        spif_str_alloc(tmp, self->len + 1);
+    }
+    memcpy(tmp->s, self->s, self->len + 1);
     tmp->len = self->len;
-    tmp->size = self->size;
+    tmp->hash = self->hash;
+    tmp->hashed = self->hashed;
     return tmp;
 }
 
@@ -370,9 +554,9 @@ spif_str_append(spif_str_t self, spif_str_t other)
 {
     ASSERT_RVAL(!SPIF_STR_ISNULL(self), FALSE);
     REQUIRE_RVAL(!SPIF_STR_ISNULL(other), FALSE);
+    SPIF_STR_CHANGED(self);
     if (other->size && other->len) {
-        self->size += other->size - 1;
-        self->s = (spif_charptr_t) REALLOC(self->s, self->size);
+        spif_str_grow(self, self->len + other->len + 1);
         memcpy(self->s + self->len, SPIF_STR_STR(other), other->len + 1);
         self->len += other->len;
     }
@@ -380,19 +564,49 @@ spif_str_append(spif_str_t self, spif_str_t other)
 }
 
 spif_bool_t
-spif_str_append_char(spif_str_t self, spif_char_t c)
+spif_str_append_buff(spif_str_t self, spif_charptr_t buff, spif_stridx_t len)
 {
     ASSERT_RVAL(!SPIF_STR_ISNULL(self), FALSE);
-    self->len++;
-    if (self->size <= self->len) {
-        self->size++;
-        self->s = (spif_charptr_t) REALLOC(self->s, self->size);
+    REQUIRE_RVAL(len >= 0, FALSE);
+    REQUIRE_RVAL((buff != (spif_charptr_t) NULL) || (len == 0), FALSE);
+    SPIF_STR_CHANGED(self);
+    spif_str_grow(self, self->len + len + 1);
+    if (len) {
+        memmove(self->s + self->len, buff, len);
+        self->len += len;
     }
-    self->s[self->len - 1] = c;
     self->s[self->len] = 0;
     return TRUE;
 }
 
+spif_bool_t
+spif_str_append_char(spif_str_t self, spif_char_t c)
+{
+    ASSERT_RVAL(!SPIF_STR_ISNULL(self), FALSE);
+    SPIF_STR_CHANGED(self);
+    spif_str_grow(self, self->len + 2);
+    self->s[self->len++] = c;
+    self->s[self->len] = 0;
+    return TRUE;
+}
+
+/**
+ * Append a double in its shortest exact form.
+ *
+ * @param self The string.
+ * @param num  The value, printed by spiftool_format_double().
+ * @return     TRUE on success, FALSE otherwise.
+ */
+spif_bool_t
+spif_str_append_double(spif_str_t self, double num)
+{
+    ASSERT_RVAL(!SPIF_STR_ISNULL(self), FALSE);
+    SPIF_STR_CHANGED(self);
+    spif_str_grow(self, self->len + SPIFTOOL_NUM_BUFF_SIZE);
+    self->len += (spif_stridx_t) spiftool_format_double(self->s + self->len, num);
+    return TRUE;
+}
+
 spif_bool_t
 spif_str_append_from_ptr(spif_str_t self, spif_charptr_t other)
 {
@@ -400,40 +614,125 @@ spif_str_append_from_ptr(spif_str_t self, spif_charptr_t other)
 
     ASSERT_RVAL(!SPIF_STR_ISNULL(self), FALSE);
     REQUIRE_RVAL((other != (spif_charptr_t) NULL), FALSE);
+    SPIF_STR_CHANGED(self);
     len = strlen((const char *) other);
     if (len) {
-        self->size += len;
-        self->s = (spif_charptr_t) REALLOC(self->s, self->size);
+        spif_str_grow(self, self->len + len + 1);
         memcpy(self->s + self->len, other, len + 1);
         self->len += len;
     }
     return TRUE;
 }
 
+/**
+ * Append a signed integer in decimal.
+ *
+ * This is the fast equivalent of appending "%lld" and never goes
+ * through printf().
+ *
+ * @param self The string.
+ * @param num  The value.
+ * @return     TRUE on success, FALSE otherwise.
+ */
+spif_bool_t
+spif_str_append_int(spif_str_t self, spif_int64_t num)
+{
+    ASSERT_RVAL(!SPIF_STR_ISNULL(self), FALSE);
+    SPIF_STR_CHANGED(self);
+    spif_str_grow(self, self->len + SPIFTOOL_NUM_BUFF_SIZE);
+    self->len += (spif_stridx_t) spiftool_format_int64(self->s + self->len, num);
+    return TRUE;
+}
+
+/* Grow function for spiftool_vformat(). */
+static spif_charptr_t
+spif_str_format_grow(spif_obj_t obj, spif_stridx_t size, spif_stridx_t *newsize)
+{
+    spif_str_t self = SPIF_STR(obj);
+
+    spif_str_grow(self, size);
+    *newsize = self->size;
+    return self->s;
+}
+
+spif_bool_t
+spif_str_append_printf(spif_str_t self, spif_charptr_t format, ...)
+{
+    va_list ap;
+    spif_bool_t ret;
+
+    va_start(ap, format);
+    ret = spif_str_append_vprintf(self, format, ap);
+    va_end(ap);
+    return ret;
+}
+
+/**
+ * Append formatted text.
+ *
+ * The text is formatted straight into the string's spare capacity in
+ * one pass, growing it as needed.  If the format is invalid, the
+ * string is left as it was.
+ *
+ * @param self   The string.
+ * @param format A printf()-style format.
+ * @param ap     The arguments.
+ * @return       TRUE on success, FALSE if the format is invalid.
+ */
+spif_bool_t
+spif_str_append_vprintf(spif_str_t self, spif_charptr_t format, va_list ap)
+{
+    spif_stridx_t len;
+
+    ASSERT_RVAL(!SPIF_STR_ISNULL(self), FALSE);
+    REQUIRE_RVAL((format != (spif_charptr_t) NULL), FALSE);
+    SPIF_STR_CHANGED(self);
+    len = spiftool_vformat(SPIF_OBJ(self), spif_str_format_grow, self->s, self->size, self->len,
+                           (const char *) format, ap);
+    if (len < 0) {
+        self->s[self->len] = 0;
+        return FALSE;
+    }
+    self->len = len;
+    return TRUE;
+}
+
+/**
+ * Append an unsigned integer in decimal.
+ *
+ * @param self The string.
+ * @param num  The value.
+ * @return     TRUE on success, FALSE otherwise.
+ */
+spif_bool_t
+spif_str_append_uint(spif_str_t self, spif_uint64_t num)
+{
+    ASSERT_RVAL(!SPIF_STR_ISNULL(self), FALSE);
+    SPIF_STR_CHANGED(self);
+    spif_str_grow(self, self->len + SPIFTOOL_NUM_BUFF_SIZE);
+    self->len += (spif_stridx_t) spiftool_format_uint64(self->s + self->len, num);
+    return TRUE;
+}
+
 spif_cmp_t
 spif_str_casecmp(spif_str_t self, spif_str_t other)
 {
-    int c;
-
     SPIF_OBJ_COMP_CHECK_NULL(self, other);
-    c = strcasecmp((char *) SPIF_STR_STR(self), (char *) SPIF_STR_STR(other));
-    return SPIF_CMP_FROM_INT(c);
+    return spif_str_casecmp_buff(self, other->s, other->len, -1);
 }
 
 spif_cmp_t
 spif_str_casecmp_with_ptr(spif_str_t self, spif_charptr_t other)
 {
-    int c;
-
     SPIF_OBJ_COMP_CHECK_NULL(self, other);
-    c = strcasecmp((char *) SPIF_STR_STR(self), (char *) other);
-    return SPIF_CMP_FROM_INT(c);
+    return spif_str_casecmp_buff(self, other, strnlen((const char *) other, self->len + 1), -1);
 }
 
 spif_bool_t
 spif_str_clear(spif_str_t self, spif_char_t c)
 {
     ASSERT_RVAL(!SPIF_STR_ISNULL(self), FALSE);
+    SPIF_STR_CHANGED(self);
     memset(self->s, c, self->size);
     self->s[self->len] = 0;
     return TRUE;
@@ -442,31 +741,50 @@ spif_str_clear(spif_str_t self, spif_char_t c)
 spif_cmp_t
 spif_str_cmp(spif_str_t self, spif_str_t other)
 {
-    int c;
-
     SPIF_OBJ_COMP_CHECK_NULL(self, other);
-    c = strcmp((char *) SPIF_STR_STR(self), (char *) SPIF_STR_STR(other));
-    return SPIF_CMP_FROM_INT(c);
+    return spif_str_cmp_buff(self, other->s, other->len, -1);
 }
 
 spif_cmp_t
 spif_str_cmp_with_ptr(spif_str_t self, spif_charptr_t other)
 {
-    int c;
-
     SPIF_OBJ_COMP_CHECK_NULL(self, other);
-    c = strcmp((char *) SPIF_STR_STR(self), (char *) other);
-    return SPIF_CMP_FROM_INT(c);
+    return spif_str_cmp_buff(self, other, strnlen((const char *) other, self->len + 1), -1);
 }
 
 spif_bool_t
-spif_str_downcase(spif_str_t self)
+spif_str_eq(spif_str_t self, spif_str_t other)
 {
-    spif_charptr_t tmp;
+    if (self == other) {
+        return TRUE;
+    } else if (SPIF_STR_ISNULL(self) || SPIF_STR_ISNULL(other)) {
+        return FALSE;
+    } else if (self->len != other->len) {
+        return FALSE;
+    } else if (self->hashed && other->hashed && (self->hash != other->hash)) {
+        return FALSE;
+    }
+    return ((self->len) ? (!memcmp(self->s, other->s, self->len)) : (TRUE));
+}
+
+spif_bool_t
+spif_str_eq_with_ptr(spif_str_t self, spif_charptr_t other)
+{
+    REQUIRE_RVAL(!SPIF_STR_ISNULL(self), FALSE);
+    REQUIRE_RVAL((other != (spif_charptr_t) NULL), FALSE);
+    if (strnlen((const char *) other, self->len + 1) != (size_t) self->len) {
+        return FALSE;
+    }
+    return ((self->len) ? (!memcmp(self->s, other, self->len)) : (TRUE));
+}
 
+spif_bool_t
+spif_str_downcase(spif_str_t self)
+{
     ASSERT_RVAL(!SPIF_STR_ISNULL(self), FALSE);
-    for (tmp = self->s; *tmp; tmp++) {
-        *tmp = tolower(*tmp);
+    SPIF_STR_CHANGED(self);
+    if (self->len) {
+        spiftool_downcase_buff(self->s, self->len);
     }
     return TRUE;
 }
@@ -503,15 +821,47 @@ spif_str_find_from_ptr(spif_str_t self, spif_charptr_t other)
     }
 }
 
+spif_bool_t
+spif_str_finish(spif_str_t self)
+{
+    ASSERT_RVAL(!SPIF_STR_ISNULL(self), FALSE);
+    if (self->size > self->len + 1) {
+        spif_str_resize(self, self->len + 1);
+    }
+    return TRUE;
+}
+
+/**
+ * Hash a string.
+ *
+ * The hash is the same one spif_strview_hash() computes over the same
+ * bytes.  It's cached in the string until the next change to it, so
+ * repeated lookups of the same key only hash it once.
+ *
+ * @param self The string.
+ * @return     The string's hash.
+ */
+spif_uint32_t
+spif_str_hash(spif_str_t self)
+{
+    ASSERT_RVAL(!SPIF_STR_ISNULL(self), 0);
+    if (!self->hashed) {
+        self->hash = spifhash_jenkins((spif_uint8_t *) SPIF_STR_STR(self), (spif_uint32_t) self->len, 0);
+        self->hashed = TRUE;
+    }
+    return self->hash;
+}
+
 spif_stridx_t
 spif_str_index(spif_str_t self, spif_char_t c)
 {
-    char *tmp;
+    spif_charptr_t tmp;
 
     ASSERT_RVAL(!SPIF_STR_ISNULL(self), ((spif_stridx_t) -1));
-    tmp = index((const char *) SPIF_STR_STR(self), c);
+    REQUIRE_RVAL(self->len, 0);
+    tmp = spiftool_strnchr(self->s, self->len, c);
     if (tmp) {
-        return (spif_stridx_t) ((spif_long_t) tmp - (spif_long_t) (SPIF_STR_STR(self)));
+        return (spif_stridx_t) (tmp - self->s);
     } else {
         return (spif_stridx_t) (self->len);
     }
@@ -520,41 +870,128 @@ spif_str_index(spif_str_t self, spif_char_t c)
 spif_cmp_t
 spif_str_ncasecmp(spif_str_t self, spif_str_t other, spif_stridx_t cnt)
 {
-    int c;
-
     SPIF_OBJ_COMP_CHECK_NULL(self, other);
-    c = strncasecmp((char *) SPIF_STR_STR(self), (char *) SPIF_STR_STR(other), cnt);
-    return SPIF_CMP_FROM_INT(c);
+    return spif_str_casecmp_buff(self, other->s, other->len, cnt);
 }
 
 spif_cmp_t
 spif_str_ncasecmp_with_ptr(spif_str_t self, spif_charptr_t other, spif_stridx_t cnt)
 {
-    int c;
-
     SPIF_OBJ_COMP_CHECK_NULL(self, other);
-    c = strncasecmp((char *) SPIF_STR_STR(self), (char *) other, cnt);
-    return SPIF_CMP_FROM_INT(c);
+    return spif_str_casecmp_buff(self, other, strnlen((const char *) other, self->len + 1), cnt);
 }
 
 spif_cmp_t
 spif_str_ncmp(spif_str_t self, spif_str_t other, spif_stridx_t cnt)
 {
-    int c;
-
     SPIF_OBJ_COMP_CHECK_NULL(self, other);
-    c = strncmp((char *) SPIF_STR_STR(self), (char *) SPIF_STR_STR(other), cnt);
-    return SPIF_CMP_FROM_INT(c);
+    return spif_str_cmp_buff(self, other->s, other->len, cnt);
 }
 
 spif_cmp_t
 spif_str_ncmp_with_ptr(spif_str_t self, spif_charptr_t other, spif_stridx_t cnt)
 {
-    int c;
-
     SPIF_OBJ_COMP_CHECK_NULL(self, other);
-    c = strncmp((char *) SPIF_STR_STR(self), (char *) other, cnt);
-    return SPIF_CMP_FROM_INT(c);
+    return spif_str_cmp_buff(self, other, strnlen((const char *) other, self->len + 1), cnt);
+}
+
+/**
+ * Parse a double from part of a string.
+ *
+ * Works like spif_str_parse_int(), using spiftool_parse_double().
+ *
+ * @param self   The string.
+ * @param idx    Where to start; negative values count from the end.
+ * @param result Where to store the value.
+ * @param end    If non-NULL, receives the index just past the number.
+ * @return       TRUE if a number was found and was in range.
+ */
+spif_bool_t
+spif_str_parse_double(spif_str_t self, spif_stridx_t idx, double *result, spif_stridx_t *end)
+{
+    spif_bool_t ret;
+    size_t n;
+
+    ASSERT_RVAL(!SPIF_STR_ISNULL(self), FALSE);
+    ASSERT_RVAL(result != NULL, FALSE);
+    if (idx < 0) {
+        idx = self->len + idx;
+    }
+    REQUIRE_RVAL(idx >= 0, FALSE);
+    REQUIRE_RVAL(idx <= self->len, FALSE);
+    ret = spiftool_parse_double(SPIF_STR_STR(self) + idx, self->len - idx, result, &n);
+    if (end) {
+        *end = idx + n;
+    }
+    return ret;
+}
+
+/**
+ * Parse a signed integer from part of a string.
+ *
+ * Reads an integer starting at @a idx with spiftool_parse_int64(),
+ * stopping at the end of the string even if it contains NULs.
+ * Unlike spif_str_to_num(), the caller learns where the number ended
+ * and whether it fit.
+ *
+ * @param self   The string.
+ * @param idx    Where to start; negative values count from the end.
+ * @param base   The base, 2 through 36, or 0 to use the prefix.
+ * @param result Where to store the value.
+ * @param end    If non-NULL, receives the index just past the number
+ *               (@a idx if there was none).
+ * @return       TRUE if a number was found and fit, FALSE otherwise.
+ */
+spif_bool_t
+spif_str_parse_int(spif_str_t self, spif_stridx_t idx, int base, spif_int64_t *result, spif_stridx_t *end)
+{
+    spif_bool_t ret;
+    size_t n;
+
+    ASSERT_RVAL(!SPIF_STR_ISNULL(self), FALSE);
+    ASSERT_RVAL(result != NULL, FALSE);
+    if (idx < 0) {
+        idx = self->len + idx;
+    }
+    REQUIRE_RVAL(idx >= 0, FALSE);
+    REQUIRE_RVAL(idx <= self->len, FALSE);
+    ret = spiftool_parse_int64(SPIF_STR_STR(self) + idx, self->len - idx, base, result, &n);
+    if (end) {
+        *end = idx + n;
+    }
+    return ret;
+}
+
+/**
+ * Parse an unsigned integer from part of a string.
+ *
+ * Works like spif_str_parse_int(), using spiftool_parse_uint64().
+ *
+ * @param self   The string.
+ * @param idx    Where to start; negative values count from the end.
+ * @param base   The base, 2 through 36, or 0 to use the prefix.
+ * @param result Where to store the value.
+ * @param end    If non-NULL, receives the index just past the number.
+ * @return       TRUE if a number was found and fit, FALSE otherwise.
+ */
+spif_bool_t
+spif_str_parse_uint(spif_str_t self, spif_stridx_t idx, int base, spif_uint64_t *result, spif_stridx_t *end)
+{
+    spif_bool_t ret;
+    size_t n;
+
+    ASSERT_RVAL(!SPIF_STR_ISNULL(self), FALSE);
+    ASSERT_RVAL(result != NULL, FALSE);
+    if (idx < 0) {
+        idx = self->len + idx;
+    }
+    REQUIRE_RVAL(idx >= 0, FALSE);
+    REQUIRE_RVAL(idx <= self->len, FALSE);
+    ret = spiftool_parse_uint64(SPIF_STR_STR(self) + idx, self->len - idx, base, result, &n);
+    if (end) {
+        *end = idx + n;
+    }
+    return ret;
 }
 
 spif_bool_t
@@ -562,9 +999,9 @@ spif_str_prepend(spif_str_t self, spif_str_t other)
 {
     ASSERT_RVAL(!SPIF_STR_ISNULL(self), FALSE);
     REQUIRE_RVAL(!SPIF_STR_ISNULL(other), FALSE);
+    SPIF_STR_CHANGED(self);
     if (other->size && other->len) {
-        self->size += other->size - 1;
-        self->s = (spif_charptr_t) REALLOC(self->s, self->size);
+        spif_str_grow(self, self->len + other->len + 1);
         memmove(self->s + other->len, self->s, self->len + 1);
         memcpy(self->s, SPIF_STR_STR(other), other->len);
         self->len += other->len;
@@ -576,12 +1013,9 @@ spif_bool_t
 spif_str_prepend_char(spif_str_t self, spif_char_t c)
 {
     ASSERT_RVAL(!SPIF_STR_ISNULL(self), FALSE);
-    self->len++;
-    if (self->size <= self->len) {
-        self->size++;
-        self->s = (spif_charptr_t) REALLOC(self->s, self->size);
-    }
-    memmove(self->s + 1, self->s, self->len + 1);
+    SPIF_STR_CHANGED(self);
+    spif_str_grow(self, self->len + 2);
+    memmove(self->s + 1, self->s, ++self->len);
     self->s[0] = (spif_uchar_t) c;
     return TRUE;
 }
@@ -593,10 +1027,10 @@ spif_str_prepend_from_ptr(spif_str_t self, spif_charptr_t other)
 
     ASSERT_RVAL(!SPIF_STR_ISNULL(self), FALSE);
     REQUIRE_RVAL((other != (spif_charptr_t) NULL), FALSE);
+    SPIF_STR_CHANGED(self);
     len = strlen((const char *) other);
     if (len) {
-        self->size += len;
-        self->s = (spif_charptr_t) REALLOC(self->s, self->size);
+        spif_str_grow(self, self->len + len + 1);
         memmove(self->s + len, self->s, self->len + 1);
         memcpy(self->s, other, len);
         self->len += len;
@@ -604,22 +1038,55 @@ spif_str_prepend_from_ptr(spif_str_t self, spif_charptr_t other)
     return TRUE;
 }
 
+spif_stridx_t
+spif_str_read_up_to(spif_str_t self, int fd, spif_stridx_t cnt)
+{
+    ssize_t n;
+
+    ASSERT_RVAL(!SPIF_STR_ISNULL(self), ((spif_stridx_t) -1));
+    ASSERT_RVAL((fd >= 0), ((spif_stridx_t) -1));
+    REQUIRE_RVAL((cnt > 0), 0);
+    SPIF_STR_CHANGED(self);
+    spif_str_grow(self, self->len + cnt + 1);
+    do {
+        n = read(fd, self->s + self->len, cnt);
+    } while ((n < 0) && (errno == EINTR));
+    if (n > 0) {
+        self->len += n;
+    }
+    self->s[self->len] = 0;
+    return (spif_stridx_t) n;
+}
+
+spif_bool_t
+spif_str_reserve(spif_str_t self, spif_stridx_t len)
+{
+    ASSERT_RVAL(!SPIF_STR_ISNULL(self), FALSE);
+    REQUIRE_RVAL(len >= 0, FALSE);
+    if (self->size < len + 1) {
+        spif_str_resize(self, len + 1);
+    }
+    return TRUE;
+}
+
 spif_bool_t
 spif_str_reverse(spif_str_t self)
 {
     ASSERT_RVAL(!SPIF_STR_ISNULL(self), FALSE);
+    SPIF_STR_CHANGED(self);
     return ((strrev((char *) self->s)) ? TRUE : FALSE);
 }
 
 spif_stridx_t
 spif_str_rindex(spif_str_t self, spif_char_t c)
 {
-    char *tmp;
+    spif_charptr_t tmp;
 
     ASSERT_RVAL(!SPIF_STR_ISNULL(self), ((spif_stridx_t) -1));
-    tmp = rindex((const char *) SPIF_STR_STR(self), c);
+    REQUIRE_RVAL(self->len, 0);
+    tmp = spiftool_strnrchr(self->s, self->len, c);
     if (tmp) {
-        return (spif_stridx_t) ((spif_long_t) tmp - (spif_long_t) (SPIF_STR_STR(self)));
+        return (spif_stridx_t) (tmp - self->s);
     } else {
         return (spif_stridx_t) (self->len);
     }
@@ -632,6 +1099,7 @@ spif_str_splice(spif_str_t self, spif_stridx_t idx, spif_stridx_t cnt, spif_str_
     spif_stridx_t newsize;
 
     ASSERT_RVAL(!SPIF_STR_ISNULL(self), FALSE);
+    SPIF_STR_CHANGED(self);
     if (idx < 0) {
         idx = self->len + idx;
     }
@@ -654,10 +1122,7 @@ spif_str_splice(spif_str_t self, spif_stridx_t idx, spif_stridx_t cnt, spif_str_
         ptmp += other->len;
     }
     memcpy(ptmp, self->s + idx + cnt, self->len - idx - cnt + 1);
-    if (self->size < newsize) {
-        self->s = (spif_charptr_t) REALLOC(self->s, newsize);
-        self->size = newsize;
-    }
+    spif_str_grow(self, newsize);
     self->len = newsize - 1;
     memcpy(self->s, tmp, newsize);
     FREE(tmp);
@@ -671,6 +1136,7 @@ spif_str_splice_from_ptr(spif_str_t self, spif_stridx_t idx, spif_stridx_t cnt,
     spif_stridx_t len, newsize;
 
     ASSERT_RVAL(!SPIF_STR_ISNULL(self), FALSE);
+    SPIF_STR_CHANGED(self);
     len = (other ? strlen((const char *) other) : 0);
     if (idx < 0) {
         idx = self->len + idx;
@@ -694,10 +1160,7 @@ spif_str_splice_from_ptr(spif_str_t self, spif_stridx_t idx, spif_stridx_t cnt,
         ptmp += len;
     }
     memcpy(ptmp, self->s + idx + cnt, self->len - idx - cnt + 1);
-    if (self->size < newsize) {
-        self->s = (spif_charptr_t) REALLOC(self->s, newsize);
-        self->size = newsize;
-    }
+    spif_str_grow(self, newsize);
     self->len = newsize - 1;
     memcpy(self->s, tmp, newsize);
     FREE(tmp);
@@ -708,40 +1171,23 @@ spif_bool_t
 spif_str_sprintf(spif_str_t self, spif_charptr_t format, ...)
 {
     va_list ap;
+    spif_bool_t ret;
 
     ASSERT_RVAL(!SPIF_STR_ISNULL(self), FALSE);
-    if (self->s != (spif_charptr_t) NULL) {
+    SPIF_STR_CHANGED(self);
+    if (!format || (*format == 0)) {
         spif_str_done(self);
+        return ((format) ? (TRUE) : (FALSE));
     }
-    if (!format) {
-        return FALSE;
-    } else if (*format == 0) {
-        return TRUE;
-    } else {
-        int c;
-        char buff[2];
-
-        va_start(ap, format);
-        c = vsnprintf(buff, sizeof(buff), format, ap);
-        va_end(ap);
-        if (c <= 0) {
-            return FALSE;
-        } else {
-            self->size = c + 1;
-            self->s = (spif_charptr_t) MALLOC(self->size);
-            va_start(ap, format);
-            c = vsnprintf(self->s, self->size, format, ap);
-            va_end(ap);
-            if (c > -1 && c < self->size) {
-                self->len = c;
-                return TRUE;
-            } else {
-                self->s[0] = 0;
-                return FALSE;
-            }
-        }
+    /* Reuse the existing buffer rather than freeing it. */
+    if (self->s) {
+        self->len = 0;
+        self->s[0] = 0;
     }
-    ASSERT_NOTREACHED_RVAL(FALSE);
+    va_start(ap, format);
+    ret = spif_str_append_vprintf(self, format, ap);
+    va_end(ap);
+    return ret;
 }
 
 spif_str_t
@@ -787,46 +1233,49 @@ spif_str_substr_to_ptr(spif_str_t self, spif_stridx_t idx, spif_stridx_t cnt)
 double
 spif_str_to_float(spif_str_t self)
 {
+    double ret;
+
     ASSERT_RVAL(!SPIF_STR_ISNULL(self), (double) NAN);
-    return (double) (strtod((const char *)SPIF_STR_STR(self), (char **) NULL));
+    spiftool_parse_double(SPIF_STR_STR(self), self->len, &ret, NULL);
+    return ret;
 }
 
 size_t
 spif_str_to_num(spif_str_t self, int base)
 {
+    spif_uint64_t ret;
+
     ASSERT_RVAL(!SPIF_STR_ISNULL(self), ((size_t) -1));
-    return (size_t) (strtoul((const char *) SPIF_STR_STR(self), (char **) NULL, base));
+    spiftool_parse_uint64(SPIF_STR_STR(self), self->len, base, &ret, NULL);
+    return (size_t) ret;
 }
 
 spif_bool_t
 spif_str_trim(spif_str_t self)
 {
-    spif_charptr_t start, end;
+    spif_stridx_t start;
 
     ASSERT_RVAL(!SPIF_STR_ISNULL(self), FALSE);
-    start = self->s;
-    end = self->s + self->len - 1;
-    for (; isspace((spif_uchar_t) (*start)) && (start < end); start++);
-    for (; isspace((spif_uchar_t) (*end)) && (start < end); end--);
-    if (start > end) {
+    REQUIRE_RVAL(self->len, TRUE);
+    SPIF_STR_CHANGED(self);
+    start = (spif_stridx_t) spiftool_span_space(self->s, self->len);
+    if (start == self->len) {
         return spif_str_done(self);
     }
-    *(++end) = 0;
-    self->len = (spif_stridx_t) (end - start);
-    self->size = self->len + 1;
-    memmove(self->s, start, self->size);
-    self->s = (spif_charptr_t) REALLOC(self->s, self->size);
+    self->len -= start + (spif_stridx_t) spiftool_rspan_space(self->s + start, self->len - start);
+    memmove(self->s, self->s + start, self->len);
+    self->s[self->len] = 0;
+    spif_str_resize(self, self->len + 1);
     return TRUE;
 }
 
 spif_bool_t
 spif_str_upcase(spif_str_t self)
 {
-    spif_charptr_t tmp;
-
     ASSERT_RVAL(!SPIF_STR_ISNULL(self), FALSE);
-    for (tmp = self->s; *tmp; tmp++) {
-        *tmp = toupper(*tmp);
+    SPIF_STR_CHANGED(self);
+    if (self->len) {
+        spiftool_upcase_buff(self->s, self->len);
     }
     return TRUE;
 }
@@ -340,91 +340,257 @@ spiftool_regexp_match_r(register const spif_charptr_t str, register const spif_c
 }
 #endif
 
-#define IS_DELIM(c)  ((delim) ? (strchr((char *)delim, (c))) : (isspace(c)))
-#define IS_QUOTE(c)  (quote && quote == (c))
+/* Test a byte against the bits of a delimiter set. */
+#define IS_DELIM(set, c)      ((set)[(spif_uchar_t) (c) >> 3] & (1 << ((spif_uchar_t) (c) & 7)))
+
+/* Scan the word starting at *pstr, which must not be a delimiter, and
+   return its length once quotes and escaping backslashes are removed.
+   The word is copied to dest unless dest is NULL.  It is never longer
+   than the text it came from, so dest may be *pstr itself.  *pstr is
+   left at the delimiter or NUL which ended the word.
+
+   Quotes (" or ') group delimiters into a word and are dropped; a quote
+   of the other kind inside them is kept.  A backslash escapes a
+   delimiter, or the current quote inside quotes. */
+static size_t
+split_word(const spif_uint8_t *set, spif_charptr_t *pstr, spif_charptr_t dest)
+{
+    spif_charptr_t p;
+    size_t n = 0;
+    char quote = 0;
+
+    for (p = *pstr; *p && (quote || !IS_DELIM(set, *p)); p++) {
+        if ((*p == '\"') || (*p == '\'')) {
+            if (!quote) {
+                quote = *p;
+                continue;
+            } else if (quote == *p) {
+                quote = 0;
+                continue;
+            }
+        } else if ((*p == '\\') && (IS_DELIM(set, p[1]) || (quote && (quote == p[1])))) {
+            p++;
+        }
+        if (dest) {
+            dest[n] = *p;
+        }
+        n++;
+    }
+    *pstr = p;
+    return n;
+}
 
+/* Count the words in str, and find its length. */
+static size_t
+split_count(const spif_uint8_t *set, const spif_charptr_t str, size_t *len)
+{
+    spif_charptr_t p = str;
+    size_t cnt = 0;
+
+    for (;; cnt++) {
+        for (; *p && IS_DELIM(set, *p); p++);
+        if (!*p) {
+            break;
+        }
+        split_word(set, &p, NULL);
+    }
+    if (len) {
+        *len = p - str;
+    }
+    return cnt;
+}
+
+/**
+ * Split a string into words.
+ *
+ * Words are separated by runs of the characters in @a delim (or of
+ * whitespace if @a delim is NULL) and may be quoted; see
+ * spiftool_split_next().  Each word is allocated separately, so the
+ * result is freed with spiftool_free_array().
+ *
+ * @param delim The delimiter characters, or NULL for whitespace.
+ * @param str   The string to split.
+ * @return      A NULL-terminated array of words, or NULL if @a str
+ *              has none.
+ */
 spif_charptr_t *
 spiftool_split(const spif_charptr_t delim, const spif_charptr_t str)
 {
+    spiftool_splitset_t dset;
+    spif_uint8_t *set = dset.bits;
     spif_charptr_t *slist;
-    register spif_charptr_t pstr;
-    register spif_charptr_t pdest;
-    char quote = 0;
-    unsigned short cnt = 0;
-    unsigned long len;
+    spif_charptr_t pstr, ptmp;
+    size_t cnt, i, n;
 
     REQUIRE_RVAL(str != NULL, (spif_charptr_t *) NULL);
-
-    if (!(slist = (spif_charptr_t *)MALLOC(sizeof(spif_charptr_t)))) {
+    spiftool_split_set(delim, &dset);
+    if (!(cnt = split_count(set, str, NULL))) {
+        return ((spif_charptr_t *) NULL);
+    }
+    if (!(slist = (spif_charptr_t *) MALLOC(sizeof(spif_charptr_t) * (cnt + 1)))) {
         libast_print_error("split():  Unable to allocate memory -- %s\n", strerror(errno));
         return ((spif_charptr_t *) NULL);
     }
+    for (pstr = str, i = 0; i < cnt; i++) {
+        for (; IS_DELIM(set, *pstr); pstr++);
+        ptmp = pstr;
+        n = split_word(set, &ptmp, NULL);
+        slist[i] = (spif_charptr_t) MALLOC(n + 1);
+        split_word(set, &pstr, slist[i]);
+        slist[i][n] = 0;
+    }
+    slist[cnt] = (spif_charptr_t) NULL;
+    return slist;
+}
 
-    /* Before we do anything, skip leading "whitespace." */
-    for (pstr = (spif_charptr_t) str; *pstr && IS_DELIM(*pstr); pstr++);
+/**
+ * Split a string into words in a single allocation.
+ *
+ * Like spiftool_split(), but the pointer table and all the words share
+ * one block, so the result is freed with a single FREE().  The string
+ * is scanned once to size the block and once to fill it.
+ *
+ * @param delim The delimiter characters, or NULL for whitespace.
+ * @param str   The string to split.
+ * @param count Where to store the number of words, or NULL.
+ * @return      A NULL-terminated array of words, or NULL if @a str
+ *              has none.
+ */
+spif_charptr_t *
+spiftool_split_packed(const spif_charptr_t delim, const spif_charptr_t str, size_t *count)
+{
+    spiftool_splitset_t dset;
+    spif_uint8_t *set = dset.bits;
+    spif_charptr_t *slist;
+    spif_charptr_t pstr, pdest;
+    size_t cnt, len, i, n;
 
-    /* The outermost for loop is where we traverse the string.  Each new
-       word brings us back to the top where we resize our string list. */
-    for (; *pstr; cnt++) {
-        /* First, resize the list to two bigger than our count.  Why two?
-           One for the string we're about to do, and one for a trailing NULL. */
-        if (!(slist = (spif_charptr_t *)REALLOC(slist, sizeof(spif_charptr_t) * (cnt + 2)))) {
-            libast_print_error("split():  Unable to allocate memory -- %s\n", strerror(errno));
-            return ((spif_charptr_t *) NULL);
-        }
+    if (count) {
+        *count = 0;
+    }
+    REQUIRE_RVAL(str != NULL, (spif_charptr_t *) NULL);
+    spiftool_split_set(delim, &dset);
+    if (!(cnt = split_count(set, str, &len))) {
+        return ((spif_charptr_t *) NULL);
+    }
+
+    /* Every word but the last is followed by at least one delimiter,
+       so the words and their NULs fit in len + 1 bytes. */
+    if (!(slist = (spif_charptr_t *) MALLOC(sizeof(spif_charptr_t) * (cnt + 1) + len + 1))) {
+        libast_print_error("split():  Unable to allocate memory -- %s\n", strerror(errno));
+        return ((spif_charptr_t *) NULL);
+    }
+    pdest = (spif_charptr_t) (slist + cnt + 1);
+    for (pstr = str, i = 0; i < cnt; i++) {
+        for (; IS_DELIM(set, *pstr); pstr++);
+        slist[i] = pdest;
+        n = split_word(set, &pstr, pdest);
+        pdest[n] = 0;
+        pdest += n + 1;
+    }
+    slist[cnt] = (spif_charptr_t) NULL;
+    if (count) {
+        *count = cnt;
+    }
+    return slist;
+}
 
-        /* The string we're about to create can't possibly be larger than the remainder
-           of the string we have yet to parse, so allocate that much space to start. */
-        len = strlen((char *) pstr) + 1;
-        if (!(slist[cnt] = (spif_charptr_t)MALLOC(len))) {
-            libast_print_error("split():  Unable to allocate memory -- %s.\n", strerror(errno));
-            return ((spif_charptr_t *) NULL);
+/**
+ * Build a delimiter set for the split functions.
+ *
+ * @param delim The delimiter characters, or NULL for whitespace.  NUL
+ *              is never a delimiter.
+ * @param set   The set to fill in.
+ */
+void
+spiftool_split_set(const spif_charptr_t delim, spiftool_splitset_t *set)
+{
+    spif_charptr_t p;
+    int c;
+
+    ASSERT(set != NULL);
+    memset(set->bits, 0, sizeof(set->bits));
+    if (delim) {
+        for (p = delim; *p; p++) {
+            set->bits[(spif_uchar_t) *p >> 3] |= 1 << ((spif_uchar_t) *p & 7);
         }
-        pdest = slist[cnt];
-
-        /* This for loop is where we process each character. */
-        for (; *pstr && (quote || !IS_DELIM(*pstr));) {
-            if (*pstr == '\"' || *pstr == '\'') {
-                /* It's a quote character, so set or reset the quote variable. */
-                if (quote) {
-                    if (quote == *pstr) {
-                        quote = 0;
-                    } else {
-                        /* It's a single quote inside double quotes, or vice versa.  Leave it alone. */
-                        *pdest++ = *pstr++;
-                    }
-                } else {
-                    quote = *pstr;
-                }
-                pstr++;
-            } else {
-                /* Handle any backslashes that are escaping delimiters or quotes. */
-                if ((*pstr == '\\') && (IS_DELIM(*(pstr + 1)) || IS_QUOTE(*(pstr + 1)))) {
-                    /* Incrementing pstr here moves us past the backslash so that the line
-                       below will copy the next character to the new token, no questions asked. */
-                    pstr++;
-                }
-                *pdest++ = *pstr++;
+    } else {
+        for (c = 1; c < 256; c++) {
+            if (isspace(c)) {
+                set->bits[c >> 3] |= 1 << (c & 7);
             }
         }
-        /* Add the trailing \0 to terminate the new string. */
-        *pdest = 0;
+    }
+}
 
-        /* Reallocate the new string to be just the right size. */
-        len = strlen((char *) slist[cnt]) + 1;
-        slist[cnt] = (spif_charptr_t) REALLOC(slist[cnt], len);
+/**
+ * Get the next word from a string.
+ *
+ * The iterator form of spiftool_split():  each call copies one word to
+ * @a word and advances @a str past it, so no array is built.  @a word
+ * must have room for the rest of the string (strlen(*@a str) + 1
+ * bytes), or may be *@a str itself to split a writable string in
+ * place.
+ *
+ * This builds the delimiter set on every call; loops should build it
+ * once with spiftool_split_set() and call spiftool_split_next_set().
+ *
+ * @param delim The delimiter characters, or NULL for whitespace.
+ * @param str   The position in the string; updated on return.
+ * @param word  Where to store the word.
+ * @param len   Where to store the length of the word, or NULL.
+ * @return      TRUE if a word was found, FALSE if only delimiters (or
+ *              nothing) remained.
+ */
+spif_bool_t
+spiftool_split_next(const spif_charptr_t delim, spif_charptr_t *str, spif_charptr_t word, size_t *len)
+{
+    spiftool_splitset_t set;
 
-        /* Move past any trailing "whitespace." */
-        for (; *pstr && IS_DELIM(*pstr); pstr++);
+    spiftool_split_set(delim, &set);
+    return spiftool_split_next_set(&set, str, word, len);
+}
+
+/**
+ * Get the next word from a string using a prebuilt delimiter set.
+ *
+ * Identical to spiftool_split_next(), except that the delimiters come
+ * from @a set, so each word costs only the bytes scanned.
+ *
+ * @param set   The delimiters, from spiftool_split_set().
+ * @param str   The position in the string; updated on return.
+ * @param word  Where to store the word.
+ * @param len   Where to store the length of the word, or NULL.
+ * @return      TRUE if a word was found, FALSE if only delimiters (or
+ *              nothing) remained.
+ */
+spif_bool_t
+spiftool_split_next_set(const spiftool_splitset_t *set, spif_charptr_t *str, spif_charptr_t word, size_t *len)
+{
+    spif_charptr_t pstr;
+    size_t n;
+
+    ASSERT_RVAL(set != NULL, FALSE);
+    ASSERT_RVAL(str != NULL, FALSE);
+    ASSERT_RVAL(word != NULL, FALSE);
+    REQUIRE_RVAL(*str != NULL, FALSE);
+    for (pstr = *str; IS_DELIM(set->bits, *pstr); pstr++);
+    if (!*pstr) {
+        *str = pstr;
+        return FALSE;
     }
-    if (cnt == 0) {
-        FREE(slist);
-        return NULL;
-    } else {
-        /* The last element of slist[] should be NULL. */
-        slist[cnt] = 0;
-        return slist;
+    n = split_word(set->bits, &pstr, word);
+    if (*pstr) {
+        /* Step over the delimiter before the NUL goes in, in case that
+           is where it goes. */
+        pstr++;
+    }
+    word[n] = 0;
+    *str = pstr;
+    if (len) {
+        *len = n;
     }
+    return TRUE;
 }
 
 spif_charptr_t *
@@ -435,12 +601,19 @@ spiftool_split_regexp(const spif_charptr_t regexp, const spif_charptr_t str)
     return (NULL);
 }
 
+/**
+ * Join an array of strings.
+ *
+ * @param sep   The separator to put between them, or NULL for none.
+ * @param slist A NULL-terminated array of strings.
+ * @return      A newly-allocated string, or NULL if @a slist is empty.
+ */
 spif_charptr_t 
 spiftool_join(spif_charptr_t sep, spif_charptr_t *slist)
 {
     register unsigned long i;
-    size_t len, slen;
-    spif_charptr_t new_str;
+    size_t len, slen, n;
+    spif_charptr_t new_str, p;
 
     ASSERT_RVAL(slist != (spif_ptr_t) NULL, (spif_ptr_t) NULL);
     REQUIRE_RVAL(*slist != (spif_ptr_t) NULL, (spif_ptr_t) NULL);
@@ -452,14 +625,17 @@ spiftool_join(spif_charptr_t sep, spif_charptr_t *slist)
         len += strlen((char *) slist[i]);
     }
     len += slen * (i - 1);
-    new_str = (spif_charptr_t) MALLOC(len + 1);
-    strcpy((char *) new_str, (char *) slist[0]);
-    for (i = 1; slist[i]; i++) {
-        if (slen) {
-            strcat((char *) new_str, (char *) sep);
+    p = new_str = (spif_charptr_t) MALLOC(len + 1);
+    for (i = 0; slist[i]; i++) {
+        if (i && slen) {
+            memcpy(p, sep, slen);
+            p += slen;
         }
-        strcat((char *) new_str, (char *) slist[i]);
+        n = strlen((char *) slist[i]);
+        memcpy(p, slist[i], n);
+        p += n;
     }
+    *p = 0;
     return new_str;
 }
 
@@ -605,59 +781,52 @@ spiftool_chomp(spif_charptr_t s)
     return (s);
 }
 
-spif_charptr_t 
+spif_charptr_t
 spiftool_downcase_str(spif_charptr_t str)
 {
-    register spif_charptr_t tmp;
-
     ASSERT_RVAL(str != (spif_ptr_t) NULL, (spif_ptr_t) NULL);
-    for (tmp = str; *tmp; tmp++) {
-        *tmp = tolower(*tmp);
-    }
+    spiftool_downcase_buff(str, strlen((char *) str));
     D_STRINGS(("downcase_str() returning %s\n", str));
     return (str);
 }
 
-spif_charptr_t 
+spif_charptr_t
 spiftool_upcase_str(spif_charptr_t str)
 {
-    register spif_charptr_t tmp;
-
     ASSERT_RVAL(str != (spif_ptr_t) NULL, (spif_ptr_t) NULL);
-    for (tmp = str; *tmp; tmp++) {
-        *tmp = toupper(*tmp);
-    }
+    spiftool_upcase_buff(str, strlen((char *) str));
     D_STRINGS(("upcase_str() returning %s\n", str));
     return (str);
 }
 
-spif_charptr_t 
+spif_charptr_t
 spiftool_condense_whitespace(spif_charptr_t s)
 {
-
-    register unsigned char gotspc = 0;
-    register spif_charptr_t pbuff = s, pbuff2 = s;
+    register spif_charptr_t pbuff = s;
+    size_t i, n, len;
 
     ASSERT_RVAL(s != (spif_ptr_t) NULL, (spif_ptr_t) NULL);
     D_STRINGS(("condense_whitespace(%s) called.\n", s));
-    for (; *pbuff2; pbuff2++) {
-        if (isspace(*pbuff2)) {
-            if (!gotspc) {
-                *pbuff = ' ';
-                gotspc = 1;
-                pbuff++;
-            }
-        } else {
-            *pbuff = *pbuff2;
-            gotspc = 0;
-            pbuff++;
+    len = strlen((char *) s);
+    for (i = 0; i < len;) {
+        /* Move the next run of non-whitespace down, then replace the
+           whitespace which follows it with a single space. */
+        n = spiftool_find_space(s + i, len - i);
+        if (pbuff != s + i) {
+            memmove(pbuff, s + i, n);
+        }
+        pbuff += n;
+        i += n;
+        if (i < len) {
+            *pbuff++ = ' ';
+            i += spiftool_span_space(s + i, len - i);
         }
     }
-    if ((pbuff >= s) && (isspace(*(pbuff - 1))))
+    if ((pbuff > s) && (*(pbuff - 1) == ' '))
         pbuff--;
     *pbuff = 0;
     D_STRINGS(("condense_whitespace() returning \"%s\".\n", s));
-    return ((spif_charptr_t) REALLOC(s, strlen((char *) s) + 1));
+    return ((spif_charptr_t) REALLOC(s, (pbuff - s) + 1));
 }
 
 spif_charptr_t 
@@ -0,0 +1,275 @@
+/*
+ * Copyright (C) 1997-2013, Michael Jennings <mej@eterm.org>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies of the Software, its documentation and marketing & publicity
+ * materials, and acknowledgment shall be given in the documentation, materials
+ * and software packages that this Software was used.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <libast_internal.h>
+
+/* Views which point at nothing compare less than any other view,
+   including empty ones, just as NULL strings do. */
+#define STRVIEW_COMP_CHECK_NULL(a, b)  do { \
+                                           if (SPIF_STRVIEW_ISNULL(a) && SPIF_STRVIEW_ISNULL(b)) { \
+                                               return SPIF_CMP_EQUAL; \
+                                           } else if (SPIF_STRVIEW_ISNULL(a)) { \
+                                               return SPIF_CMP_LESS; \
+                                           } else if (SPIF_STRVIEW_ISNULL(b)) { \
+                                               return SPIF_CMP_GREATER; \
+                                           } \
+                                       } while (0)
+
+static const spif_strview_t null_view = { (spif_charptr_t) NULL, 0 };
+
+spif_strview_t
+spif_strview_from_ptr(spif_charptr_t s)
+{
+    REQUIRE_RVAL((s != (spif_charptr_t) NULL), null_view);
+    return spif_strview_from_buff(s, (spif_stridx_t) strlen((const char *) s));
+}
+
+spif_strview_t
+spif_strview_from_buff(spif_charptr_t s, spif_stridx_t len)
+{
+    spif_strview_t view;
+
+    REQUIRE_RVAL((s != (spif_charptr_t) NULL), null_view);
+    REQUIRE_RVAL((len >= 0), null_view);
+    view.s = s;
+    view.len = len;
+    return view;
+}
+
+spif_strview_t
+spif_strview_from_str(spif_str_t str)
+{
+    REQUIRE_RVAL(!SPIF_STR_ISNULL(str), null_view);
+    return spif_strview_from_buff(SPIF_STR_STR(str), spif_str_get_len(str));
+}
+
+spif_str_t
+spif_strview_to_str(spif_strview_t self)
+{
+    spif_str_t tmp;
+
+    /* Copy exactly len bytes; a view of binary data may hold NULs. */
+    tmp = spif_str_new();
+    if (!SPIF_STRVIEW_ISNULL(self)) {
+        spif_str_append_buff(tmp, self.s, self.len);
+    }
+    return tmp;
+}
+
+spif_cmp_t
+spif_strview_casecmp(spif_strview_t self, spif_strview_t other)
+{
+    spif_stridx_t i, len;
+    int c;
+
+    STRVIEW_COMP_CHECK_NULL(self, other);
+    len = MIN(self.len, other.len);
+    for (i = 0; i < len; i++) {
+        c = tolower((spif_uchar_t) self.s[i]) - tolower((spif_uchar_t) other.s[i]);
+        if (c) {
+            return SPIF_CMP_FROM_INT(c);
+        }
+    }
+    return SPIF_CMP_FROM_INT(self.len - other.len);
+}
+
+spif_cmp_t
+spif_strview_casecmp_with_ptr(spif_strview_t self, spif_charptr_t other)
+{
+    return spif_strview_casecmp(self, spif_strview_from_ptr(other));
+}
+
+spif_cmp_t
+spif_strview_cmp(spif_strview_t self, spif_strview_t other)
+{
+    int c;
+
+    STRVIEW_COMP_CHECK_NULL(self, other);
+    c = memcmp(self.s, other.s, MIN(self.len, other.len));
+    if (c) {
+        return SPIF_CMP_FROM_INT(c);
+    }
+    return SPIF_CMP_FROM_INT(self.len - other.len);
+}
+
+spif_cmp_t
+spif_strview_cmp_with_ptr(spif_strview_t self, spif_charptr_t other)
+{
+    return spif_strview_cmp(self, spif_strview_from_ptr(other));
+}
+
+spif_stridx_t
+spif_strview_find(spif_strview_t self, spif_strview_t other)
+{
+    char *tmp;
+
+    REQUIRE_RVAL(!SPIF_STRVIEW_ISNULL(other), ((spif_stridx_t) -1));
+    REQUIRE_RVAL(!SPIF_STRVIEW_ISNULL(self), self.len);
+    tmp = (char *) memmem(self.s, self.len, other.s, other.len);
+    if (tmp) {
+        return (spif_stridx_t) ((spif_long_t) tmp - (spif_long_t) (self.s));
+    } else {
+        return self.len;
+    }
+}
+
+spif_stridx_t
+spif_strview_find_from_ptr(spif_strview_t self, spif_charptr_t other)
+{
+    REQUIRE_RVAL((other != (spif_charptr_t) NULL), ((spif_stridx_t) -1));
+    return spif_strview_find(self, spif_strview_from_ptr(other));
+}
+
+/* Matches the hash used for spif_str_t keys in maps and caches, so a
+   view can be used to probe for a string without copying it. */
+spif_uint32_t
+spif_strview_hash(spif_strview_t self)
+{
+    REQUIRE_RVAL(!SPIF_STRVIEW_ISNULL(self), 0);
+    return spifhash_jenkins((spif_uint8_t *) self.s, (spif_uint32_t) self.len, 0);
+}
+
+spif_stridx_t
+spif_strview_index(spif_strview_t self, spif_char_t c)
+{
+    char *tmp;
+
+    REQUIRE_RVAL(!SPIF_STRVIEW_ISNULL(self), self.len);
+    tmp = (char *) memchr(self.s, c, self.len);
+    if (tmp) {
+        return (spif_stridx_t) ((spif_long_t) tmp - (spif_long_t) (self.s));
+    } else {
+        return self.len;
+    }
+}
+
+/**
+ * Split the next token off of a view.
+ *
+ * Skips any leading delimiters in @a rest, stores the run of
+ * non-delimiter characters that follows in @a token, and advances
+ * @a rest past it.  No copies are made and nothing is modified, so
+ * this is the allocation-free counterpart of spiftool_split().
+ *
+ * @param rest   The view still to be tokenized; updated on return.
+ * @param delims The delimiter characters, or NULL for whitespace.
+ * @param token  Where to store the token.
+ * @return       TRUE if a token was found, FALSE if only delimiters
+ *               (or nothing) remained.
+ */
+spif_bool_t
+spif_strview_next_token(spif_strview_t *rest, spif_charptr_t delims, spif_strview_t *token)
+{
+    spif_charptr_t p, end;
+
+    ASSERT_RVAL(!SPIF_PTR_ISNULL(rest), FALSE);
+    ASSERT_RVAL(!SPIF_PTR_ISNULL(token), FALSE);
+    REQUIRE_RVAL(!SPIF_STRVIEW_ISNULL(*rest), FALSE);
+
+    end = rest->s + rest->len;
+#define STRVIEW_IS_DELIM(c)  ((delims) ? (strchr((const char *) delims, (c)) != NULL) : (isspace((spif_uchar_t) (c))))
+    for (p = rest->s; (p < end) && STRVIEW_IS_DELIM(*p); p++);
+    token->s = p;
+    for (; (p < end) && !STRVIEW_IS_DELIM(*p); p++);
+#undef STRVIEW_IS_DELIM
+    token->len = p - token->s;
+    rest->s = p;
+    rest->len = end - p;
+    return ((token->len) ? (TRUE) : (FALSE));
+}
+
+spif_stridx_t
+spif_strview_rindex(spif_strview_t self, spif_char_t c)
+{
+    spif_stridx_t i;
+
+    REQUIRE_RVAL(!SPIF_STRVIEW_ISNULL(self), self.len);
+    for (i = self.len - 1; i >= 0; i--) {
+        if (self.s[i] == (char) c) {
+            return i;
+        }
+    }
+    return self.len;
+}
+
+spif_strview_t
+spif_strview_substr(spif_strview_t self, spif_stridx_t idx, spif_stridx_t cnt)
+{
+    REQUIRE_RVAL(!SPIF_STRVIEW_ISNULL(self), null_view);
+    if (idx < 0) {
+        idx = self.len + idx;
+    }
+    REQUIRE_RVAL(idx >= 0, null_view);
+    REQUIRE_RVAL(idx < self.len, null_view);
+    if (cnt <= 0) {
+        cnt = self.len - idx + cnt;
+    }
+    REQUIRE_RVAL(cnt >= 0, null_view);
+    UPPER_BOUND(cnt, self.len - idx);
+    return spif_strview_from_buff(self.s + idx, cnt);
+}
+
+double
+spif_strview_to_float(spif_strview_t self)
+{
+    double ret;
+
+    REQUIRE_RVAL(!SPIF_STRVIEW_ISNULL(self), (double) NAN);
+    spiftool_parse_double(self.s, self.len, &ret, NULL);
+    return ret;
+}
+
+size_t
+spif_strview_to_num(spif_strview_t self, int base)
+{
+    spif_uint64_t ret;
+
+    REQUIRE_RVAL(!SPIF_STRVIEW_ISNULL(self), ((size_t) -1));
+    spiftool_parse_uint64(self.s, self.len, base, &ret, NULL);
+    return (size_t) ret;
+}
+
+spif_strview_t
+spif_strview_trim(spif_strview_t self)
+{
+    spif_charptr_t start, end;
+
+    REQUIRE_RVAL(!SPIF_STRVIEW_ISNULL(self), self);
+    start = self.s;
+    end = self.s + self.len;
+    for (; (start < end) && isspace((spif_uchar_t) *start); start++);
+    for (; (end > start) && isspace((spif_uchar_t) end[-1]); end--);
+    return spif_strview_from_buff(start, end - start);
+}
+
+spif_strview_t
+spif_str_substr_view(spif_str_t self, spif_stridx_t idx, spif_stridx_t cnt)
+{
+    ASSERT_RVAL(!SPIF_STR_ISNULL(self), null_view);
+    return spif_strview_substr(spif_strview_from_str(self), idx, cnt);
+}
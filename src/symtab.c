@@ -0,0 +1,500 @@
+/*
+ * Copyright (C) 1997-2013, Michael Jennings <mej@eterm.org>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies of the Software, its documentation and marketing & publicity
+ * materials, and acknowledgment shall be given in the documentation, materials
+ * and software packages that this Software was used.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <libast_internal.h>
+#include <pthread.h>
+
+#define SYMTAB_ALIGN(n)         (((n) + sizeof(spif_int64_t) - 1) & ~((spif_memidx_t) sizeof(spif_int64_t) - 1))
+#define SYMTAB_ATOM_SIZE        SYMTAB_ALIGN(SPIF_SIZEOF_TYPE(atom))
+#define SYMTAB_CHUNK_HEADER     SYMTAB_ALIGN(sizeof(spif_ptr_t))
+#define SYMTAB_INITIAL_BUCKETS  64
+
+static spif_atom_t spif_atom_new(void);
+static spif_bool_t spif_atom_init(spif_atom_t);
+static spif_bool_t spif_atom_done(spif_atom_t);
+static spif_bool_t spif_atom_del(spif_atom_t);
+
+static spif_ptr_t spif_symtab_arena_alloc(spif_symtab_t, spif_memidx_t);
+static spif_atom_t spif_symtab_new_atom(spif_symtab_t, spif_charptr_t, spif_stridx_t, spif_uint32_t);
+static void spif_symtab_grow(spif_symtab_t);
+static spif_atom_t spif_symtab_find(spif_symtab_t, spif_charptr_t, spif_stridx_t, spif_uint32_t);
+static void spif_symtab_global_init(void);
+
+/* *INDENT-OFF* */
+static SPIF_CONST_TYPE(class) a_class = {
+    SPIF_DECL_CLASSNAME(atom),
+    (spif_func_t) spif_atom_new,
+    (spif_func_t) spif_atom_init,
+    (spif_func_t) spif_atom_done,
+    (spif_func_t) spif_atom_del,
+    (spif_func_t) spif_atom_show,
+    (spif_func_t) spif_atom_comp,
+    (spif_func_t) spif_atom_dup,
+    (spif_func_t) spif_atom_type
+};
+SPIF_TYPE(class) SPIF_CLASS_VAR(atom) = &a_class;
+
+static SPIF_CONST_TYPE(class) st_class = {
+    SPIF_DECL_CLASSNAME(symtab),
+    (spif_func_t) spif_symtab_new,
+    (spif_func_t) spif_symtab_init,
+    (spif_func_t) spif_symtab_done,
+    (spif_func_t) spif_symtab_del,
+    (spif_func_t) spif_symtab_show,
+    (spif_func_t) spif_symtab_comp,
+    (spif_func_t) spif_symtab_dup,
+    (spif_func_t) spif_symtab_type
+};
+SPIF_TYPE(class) SPIF_CLASS_VAR(symtab) = &st_class;
+/* *INDENT-ON* */
+
+static spif_symtab_t global_symtab = (spif_symtab_t) NULL;
+static pthread_once_t global_symtab_once = PTHREAD_ONCE_INIT;
+
+/* Atoms only ever come from a symbol table, which also owns their
+   storage, so the generic constructor and destructor refuse. */
+static spif_atom_t
+spif_atom_new(void)
+{
+    return (spif_atom_t) NULL;
+}
+
+static spif_bool_t
+spif_atom_init(spif_atom_t self)
+{
+    USE_VAR(self);
+    return FALSE;
+}
+
+static spif_bool_t
+spif_atom_done(spif_atom_t self)
+{
+    USE_VAR(self);
+    return FALSE;
+}
+
+static spif_bool_t
+spif_atom_del(spif_atom_t self)
+{
+    USE_VAR(self);
+    return FALSE;
+}
+
+spif_str_t
+spif_atom_show(spif_atom_t self, spif_charptr_t name, spif_str_t buff, size_t indent)
+{
+    if (SPIF_ATOM_ISNULL(self)) {
+        SPIF_OBJ_SHOW_NULL_INTO(atom, name, buff, indent);
+        return buff;
+    }
+
+    buff = spif_str_show_printf(buff, indent, "(spif_atom_t) %s:  %10p { \"",
+                                name, (spif_ptr_t) self);
+
+    spif_str_append(buff, SPIF_STR(self));
+
+    spif_str_append_printf(buff, "\", len %lu, hash 0x%08x }\n", (unsigned long) SPIF_STR(self)->len,
+                           (unsigned) self->hash);
+    return buff;
+}
+
+spif_cmp_t
+spif_atom_comp(spif_atom_t self, spif_atom_t other)
+{
+    SPIF_OBJ_COMP_CHECK_NULL(self, other);
+    if (self == other) {
+        return SPIF_CMP_EQUAL;
+    }
+    return spif_str_cmp(SPIF_STR(self), SPIF_STR(other));
+}
+
+spif_str_t
+spif_atom_dup(spif_atom_t self)
+{
+    ASSERT_RVAL(!SPIF_ATOM_ISNULL(self), (spif_str_t) NULL);
+    return spif_str_new_from_buff(SPIF_STR(self)->s, SPIF_STR(self)->len);
+}
+
+spif_classname_t
+spif_atom_type(spif_atom_t self)
+{
+    ASSERT_RVAL(!SPIF_ATOM_ISNULL(self), (spif_classname_t) NULL);
+    return SPIF_OBJ_CLASSNAME(self);
+}
+
+spif_atom_t
+spif_atom_from_ptr(spif_charptr_t ptr)
+{
+    return spif_symtab_intern_from_ptr(spif_symtab_global(), ptr);
+}
+
+spif_atom_t
+spif_atom_from_buff(spif_charptr_t buff, spif_stridx_t len)
+{
+    return spif_symtab_intern_from_buff(spif_symtab_global(), buff, len);
+}
+
+spif_atom_t
+spif_atom_from_str(spif_str_t str)
+{
+    return spif_symtab_intern(spif_symtab_global(), str);
+}
+
+spif_uint32_t
+spif_atom_get_hash(spif_atom_t self)
+{
+    ASSERT_RVAL(!SPIF_ATOM_ISNULL(self), 0);
+    return self->hash;
+}
+
+spif_symtab_t
+spif_atom_get_table(spif_atom_t self)
+{
+    ASSERT_RVAL(!SPIF_ATOM_ISNULL(self), (spif_symtab_t) NULL);
+    return self->table;
+}
+
+
+spif_symtab_t
+spif_symtab_new(void)
+{
+    spif_symtab_t self;
+
+    self = SPIF_ALLOC(symtab);
+    if (!spif_symtab_init(self)) {
+        SPIF_DEALLOC(self);
+        self = (spif_symtab_t) NULL;
+    }
+    return self;
+}
+
+spif_symtab_t
+spif_symtab_new_with_arena(spif_memidx_t chunk)
+{
+    spif_symtab_t self;
+
+    self = SPIF_ALLOC(symtab);
+    if (!spif_symtab_init_with_arena(self, chunk)) {
+        SPIF_DEALLOC(self);
+        self = (spif_symtab_t) NULL;
+    }
+    return self;
+}
+
+spif_bool_t
+spif_symtab_init(spif_symtab_t self)
+{
+    return spif_symtab_init_with_arena(self, 0);
+}
+
+spif_bool_t
+spif_symtab_init_with_arena(spif_symtab_t self, spif_memidx_t chunk)
+{
+    ASSERT_RVAL(!SPIF_SYMTAB_ISNULL(self), FALSE);
+    REQUIRE_RVAL(chunk >= 0, FALSE);
+    if (!spif_obj_init(SPIF_OBJ(self))) {
+        return FALSE;
+    }
+    self->lock = spif_pthreads_mutex_new();
+    if (SPIF_PTHREADS_MUTEX_ISNULL(self->lock)) {
+        return FALSE;
+    }
+    spif_obj_set_class(SPIF_OBJ(self), SPIF_CLASS_VAR(symtab));
+    self->len = 0;
+    self->mask = SYMTAB_INITIAL_BUCKETS - 1;
+    self->buckets = (spif_atom_t *) CALLOC(spif_atom_t, SYMTAB_INITIAL_BUCKETS);
+    self->arena_chunk = ((chunk) ? (MAX(chunk, (spif_memidx_t) (SYMTAB_CHUNK_HEADER + SYMTAB_ATOM_SIZE))) : (0));
+    self->arena = (spif_ptr_t) NULL;
+    self->arena_used = 0;
+    return TRUE;
+}
+
+spif_bool_t
+spif_symtab_done(spif_symtab_t self)
+{
+    spif_ptr_t chunk;
+    spif_atom_t atom;
+    spif_uint32_t i;
+
+    ASSERT_RVAL(!SPIF_SYMTAB_ISNULL(self), FALSE);
+    if (self->arena_chunk) {
+        for (; self->arena; self->arena = chunk) {
+            chunk = *((spif_ptr_t *) self->arena);
+            FREE(self->arena);
+        }
+    } else if (self->buckets) {
+        for (i = 0; i <= self->mask; i++) {
+            for (; self->buckets[i]; self->buckets[i] = atom) {
+                atom = self->buckets[i]->next;
+                FREE(self->buckets[i]);
+            }
+        }
+    }
+    if (self->buckets) {
+        FREE(self->buckets);
+    }
+    if (!SPIF_PTHREADS_MUTEX_ISNULL(self->lock)) {
+        spif_pthreads_mutex_del(self->lock);
+        self->lock = (spif_pthreads_mutex_t) NULL;
+    }
+    self->len = 0;
+    self->mask = 0;
+    self->arena_used = 0;
+    return TRUE;
+}
+
+spif_bool_t
+spif_symtab_del(spif_symtab_t self)
+{
+    ASSERT_RVAL(!SPIF_SYMTAB_ISNULL(self), FALSE);
+    spif_symtab_done(self);
+    SPIF_DEALLOC(self);
+    return TRUE;
+}
+
+spif_str_t
+spif_symtab_show(spif_symtab_t self, spif_charptr_t name, spif_str_t buff, size_t indent)
+{
+    if (SPIF_SYMTAB_ISNULL(self)) {
+        SPIF_OBJ_SHOW_NULL_INTO(symtab, name, buff, indent);
+        return buff;
+    }
+
+    buff = spif_str_show_printf(buff, indent, "(spif_symtab_t) %s:  %10p { %lu atoms, %lu buckets, arena chunk %lu }\n",
+                                name, (spif_ptr_t) self, (unsigned long) self->len, (unsigned long) self->mask + 1,
+                                (unsigned long) self->arena_chunk);
+    return buff;
+}
+
+spif_cmp_t
+spif_symtab_comp(spif_symtab_t self, spif_symtab_t other)
+{
+    return spif_obj_comp(SPIF_OBJ(self), SPIF_OBJ(other));
+}
+
+spif_symtab_t
+spif_symtab_dup(spif_symtab_t self)
+{
+    spif_symtab_t tmp;
+    spif_atom_t atom;
+    spif_uint32_t i;
+
+    /* Atoms are tied to their table, so the copy gets its own. */
+    ASSERT_RVAL(!SPIF_SYMTAB_ISNULL(self), (spif_symtab_t) NULL);
+    tmp = spif_symtab_new_with_arena(self->arena_chunk);
+    spif_pthreads_mutex_lock(self->lock);
+    for (i = 0; i <= self->mask; i++) {
+        for (atom = self->buckets[i]; atom; atom = atom->next) {
+            spif_symtab_intern_from_buff(tmp, SPIF_STR(atom)->s, SPIF_STR(atom)->len);
+        }
+    }
+    spif_pthreads_mutex_unlock(self->lock);
+    return tmp;
+}
+
+spif_classname_t
+spif_symtab_type(spif_symtab_t self)
+{
+    ASSERT_RVAL(!SPIF_SYMTAB_ISNULL(self), (spif_classname_t) NULL);
+    return SPIF_OBJ_CLASSNAME(self);
+}
+
+static void
+spif_symtab_global_init(void)
+{
+    global_symtab = spif_symtab_new_with_arena(SPIF_SYMTAB_ARENA_CHUNK);
+}
+
+spif_symtab_t
+spif_symtab_global(void)
+{
+    pthread_once(&global_symtab_once, spif_symtab_global_init);
+    return global_symtab;
+}
+
+spif_atom_t
+spif_symtab_intern(spif_symtab_t self, spif_str_t str)
+{
+    ASSERT_RVAL(!SPIF_SYMTAB_ISNULL(self), (spif_atom_t) NULL);
+    REQUIRE_RVAL(!SPIF_STR_ISNULL(str), (spif_atom_t) NULL);
+    if (SPIF_OBJ_IS_ATOM(str) && SPIF_ATOM(str)->table == self) {
+        return SPIF_ATOM(str);
+    }
+    return spif_symtab_intern_from_buff(self, str->s, str->len);
+}
+
+spif_atom_t
+spif_symtab_intern_from_ptr(spif_symtab_t self, spif_charptr_t ptr)
+{
+    ASSERT_RVAL(!SPIF_SYMTAB_ISNULL(self), (spif_atom_t) NULL);
+    REQUIRE_RVAL(ptr != (spif_charptr_t) NULL, (spif_atom_t) NULL);
+    return spif_symtab_intern_from_buff(self, ptr, (spif_stridx_t) strlen((char *) ptr));
+}
+
+spif_atom_t
+spif_symtab_intern_from_buff(spif_symtab_t self, spif_charptr_t buff, spif_stridx_t len)
+{
+    spif_atom_t atom;
+    spif_uint32_t hash;
+
+    ASSERT_RVAL(!SPIF_SYMTAB_ISNULL(self), (spif_atom_t) NULL);
+    REQUIRE_RVAL(buff != (spif_charptr_t) NULL || len == 0, (spif_atom_t) NULL);
+    REQUIRE_RVAL(len >= 0, (spif_atom_t) NULL);
+
+    hash = spifhash_jenkins((spif_uint8_t *) buff, (spif_uint32_t) len, 0);
+    spif_pthreads_mutex_lock(self->lock);
+    atom = spif_symtab_find(self, buff, len, hash);
+    if (SPIF_ATOM_ISNULL(atom)) {
+        atom = spif_symtab_new_atom(self, buff, len, hash);
+        atom->next = self->buckets[hash & self->mask];
+        self->buckets[hash & self->mask] = atom;
+        if ((spif_uint32_t) ++self->len > self->mask) {
+            spif_symtab_grow(self);
+        }
+    }
+    spif_pthreads_mutex_unlock(self->lock);
+    return atom;
+}
+
+spif_atom_t
+spif_symtab_lookup_from_buff(spif_symtab_t self, spif_charptr_t buff, spif_stridx_t len)
+{
+    spif_atom_t atom;
+    spif_uint32_t hash;
+
+    ASSERT_RVAL(!SPIF_SYMTAB_ISNULL(self), (spif_atom_t) NULL);
+    REQUIRE_RVAL(buff != (spif_charptr_t) NULL || len == 0, (spif_atom_t) NULL);
+    REQUIRE_RVAL(len >= 0, (spif_atom_t) NULL);
+
+    hash = spifhash_jenkins((spif_uint8_t *) buff, (spif_uint32_t) len, 0);
+    spif_pthreads_mutex_lock(self->lock);
+    atom = spif_symtab_find(self, buff, len, hash);
+    spif_pthreads_mutex_unlock(self->lock);
+    return atom;
+}
+
+spif_listidx_t
+spif_symtab_get_len(spif_symtab_t self)
+{
+    ASSERT_RVAL(!SPIF_SYMTAB_ISNULL(self), 0);
+    return self->len;
+}
+
+static spif_atom_t
+spif_symtab_find(spif_symtab_t self, spif_charptr_t buff, spif_stridx_t len, spif_uint32_t hash)
+{
+    spif_atom_t atom;
+
+    for (atom = self->buckets[hash & self->mask]; atom; atom = atom->next) {
+        if (atom->hash == hash && SPIF_STR(atom)->len == len && !memcmp(SPIF_STR(atom)->s, buff, len)) {
+            break;
+        }
+    }
+    return atom;
+}
+
+static void
+spif_symtab_grow(spif_symtab_t self)
+{
+    spif_atom_t *buckets, atom, next;
+    spif_uint32_t i, mask;
+
+    mask = (self->mask << 1) | 1;
+    buckets = (spif_atom_t *) CALLOC(spif_atom_t, mask + 1);
+    for (i = 0; i <= self->mask; i++) {
+        for (atom = self->buckets[i]; atom; atom = next) {
+            next = atom->next;
+            atom->next = buckets[atom->hash & mask];
+            buckets[atom->hash & mask] = atom;
+        }
+    }
+    FREE(self->buckets);
+    self->buckets = buckets;
+    self->mask = mask;
+}
+
+/* Carve size bytes out of the current arena chunk, starting a new one
+   when it runs out.  Atoms too big for a chunk get one to themselves,
+   linked in behind the current chunk so its free space isn't lost. */
+static spif_ptr_t
+spif_symtab_arena_alloc(spif_symtab_t self, spif_memidx_t size)
+{
+    spif_ptr_t chunk;
+
+    size = SYMTAB_ALIGN(size);
+    if (self->arena && self->arena_used + size <= self->arena_chunk) {
+        chunk = (spif_ptr_t) ((spif_uint8_t *) self->arena + self->arena_used);
+        self->arena_used += size;
+        return chunk;
+    }
+
+    if (self->arena && SYMTAB_CHUNK_HEADER + size > self->arena_chunk) {
+        chunk = MALLOC(SYMTAB_CHUNK_HEADER + size);
+        *((spif_ptr_t *) chunk) = *((spif_ptr_t *) self->arena);
+        *((spif_ptr_t *) self->arena) = chunk;
+    } else {
+        chunk = MALLOC(MAX(self->arena_chunk, SYMTAB_CHUNK_HEADER + size));
+        *((spif_ptr_t *) chunk) = self->arena;
+        self->arena = chunk;
+        self->arena_used = SYMTAB_CHUNK_HEADER + size;
+    }
+    return (spif_ptr_t) ((spif_uint8_t *) chunk + SYMTAB_CHUNK_HEADER);
+}
+
+/* An atom and its bytes live in one block, freed only with the table. */
+static spif_atom_t
+spif_symtab_new_atom(spif_symtab_t self, spif_charptr_t buff, spif_stridx_t len, spif_uint32_t hash)
+{
+    spif_atom_t atom;
+    spif_memidx_t size;
+
+    /* Short names fit in the str's own inline buffer. */
+    size = SYMTAB_ATOM_SIZE + ((len < SPIF_STR_INLINE_SIZE) ? (0) : (len + 1));
+    if (self->arena_chunk) {
+        atom = (spif_atom_t) spif_symtab_arena_alloc(self, size);
+    } else {
+        atom = (spif_atom_t) MALLOC(size);
+    }
+    spif_obj_set_class(SPIF_OBJ(atom), SPIF_CLASS_VAR(atom));
+    if (len < SPIF_STR_INLINE_SIZE) {
+        SPIF_STR(atom)->s = SPIF_STR(atom)->inl;
+    } else {
+        SPIF_STR(atom)->s = (spif_charptr_t) atom + SYMTAB_ATOM_SIZE;
+    }
+    if (len) {
+        memcpy(SPIF_STR(atom)->s, buff, len);
+    }
+    SPIF_STR(atom)->s[len] = 0;
+    SPIF_STR(atom)->len = len;
+    SPIF_STR(atom)->size = len + 1;
+    SPIF_STR(atom)->hash = hash;
+    SPIF_STR(atom)->hashed = TRUE;
+    atom->hash = hash;
+    atom->table = self;
+    atom->next = (spif_atom_t) NULL;
+    return atom;
+}
@@ -187,22 +187,13 @@ spif_url_del(spif_url_t self)
 spif_str_t
 spif_url_show(spif_url_t self, spif_charptr_t name, spif_str_t buff, size_t indent)
 {
-    spif_char_t tmp[4096];
-
     if (SPIF_URL_ISNULL(self)) {
-        SPIF_OBJ_SHOW_NULL(url, name, buff, indent, tmp);
+        SPIF_OBJ_SHOW_NULL_INTO(url, name, buff, indent);
         return buff;
     }
 
-    memset(tmp, ' ', indent);
-    snprintf((char *) tmp + indent, sizeof(tmp) - indent,
-             "(spif_url_t) %s:  %10p {\n",
-             name, (spif_ptr_t) self);
-    if (SPIF_STR_ISNULL(buff)) {
-        buff = spif_str_new_from_ptr(tmp);
-    } else {
-        spif_str_append_from_ptr(buff, tmp);
-    }
+    buff = spif_str_show_printf(buff, indent, "(spif_url_t) %s:  %10p {\n",
+                                name, (spif_ptr_t) self);
 
     buff = spif_str_show(self->proto, SPIF_CHARPTR("proto"), buff, indent + 2);
     buff = spif_str_show(self->user, SPIF_CHARPTR("user"), buff, indent + 2);
@@ -212,8 +203,7 @@ spif_url_show(spif_url_t self, spif_charptr_t name, spif_str_t buff, size_t inde
     buff = spif_str_show(self->path, SPIF_CHARPTR("path"), buff, indent + 2);
     buff = spif_str_show(self->query, SPIF_CHARPTR("query"), buff, indent + 2);
 
-    snprintf((char *) tmp + indent, sizeof(tmp) - indent, "}\n");
-    spif_str_append_from_ptr(buff, tmp);
+    buff = spif_str_show_printf(buff, indent, "}\n");
     return buff;
 }
 
@@ -87,6 +87,257 @@ SPIF_TYPE(strclass) SPIF_STRCLASS_VAR(ustr) = &s_class;
 
 const size_t buff_inc = 4096;
 
+/*
+ * Lengths and sizes (len, size, and the counts given to the ncmp
+ * methods) are in bytes, but every position (index, find, substr,
+ * splice, parse) is in characters.  Malformed UTF-8 is tolerated:  each
+ * byte of a bad sequence counts as one character.  Finding a character
+ * position needs the character count and, for non-ASCII text, the
+ * sparse offset index; both are built on first use and kept until the
+ * string changes, so repeated positional access costs O(1) rather than
+ * a scan from the start.
+ */
+
+#define USTR_ISSPACE(c)  ((!((spif_uchar_t) (c) & 0x80)) && isspace((spif_uchar_t) (c)))
+
+static void
+spif_ustr_reset(spif_ustr_t self)
+{
+    self->chars = -1;
+    self->valid = FALSE;
+    self->offsets = (spif_ustridx_t *) NULL;
+}
+
+/* Forget everything cached about the contents. */
+static void
+spif_ustr_invalidate(spif_ustr_t self)
+{
+    if (self->offsets) {
+        FREE(self->offsets);
+    }
+    self->chars = -1;
+}
+
+/* Update the cache after n bytes at added were inserted at a character
+   boundary and removed characters were deleted.  A well-formed string
+   stays well-formed when well-formed text is spliced into it, so the
+   count can be kept without rescanning the rest. */
+static void
+spif_ustr_edited(spif_ustr_t self, const spif_charptr_t added, spif_ustridx_t n, spif_ustridx_t removed)
+{
+    size_t count = 0;
+
+    if (self->offsets) {
+        FREE(self->offsets);
+    }
+    if ((self->chars >= 0) && self->valid && (!n || spiftool_utf8_scan(added, (size_t) n, &count))) {
+        self->chars += (spif_ustridx_t) count - removed;
+    } else {
+        self->chars = -1;
+    }
+}
+
+static void
+spif_ustr_scan(spif_ustr_t self)
+{
+    size_t count = 0;
+
+    if (self->chars < 0) {
+        self->valid = ((self->s && self->len) ? (spiftool_utf8_scan(self->s, (size_t) self->len, &count)) : (TRUE));
+        self->chars = (spif_ustridx_t) count;
+    }
+}
+
+/* Length in bytes of the character at byte offset off. */
+static spif_ustridx_t
+spif_ustr_next(spif_ustr_t self, spif_ustridx_t off)
+{
+    spif_uint32_t cp;
+
+    if (self->valid) {
+        return SPIF_UTF8_CHAR_LEN(self->s + off);
+    }
+    return (spif_ustridx_t) spiftool_utf8_decode(self->s + off, (size_t) (self->len - off), &cp);
+}
+
+static void
+spif_ustr_build_index(spif_ustr_t self)
+{
+    spif_ustridx_t c, off;
+
+    self->offsets = (spif_ustridx_t *) MALLOC((self->chars / SPIF_USTR_INDEX_STEP + 1) * sizeof(spif_ustridx_t));
+    for (c = 0, off = 0; off < self->len; c++) {
+        if (!(c % SPIF_USTR_INDEX_STEP)) {
+            self->offsets[c / SPIF_USTR_INDEX_STEP] = off;
+        }
+        off += spif_ustr_next(self, off);
+    }
+    if (!(c % SPIF_USTR_INDEX_STEP)) {
+        self->offsets[c / SPIF_USTR_INDEX_STEP] = off;
+    }
+}
+
+/* Byte offset of character idx, 0 <= idx <= chars.  The string must
+   have been scanned. */
+static spif_ustridx_t
+spif_ustr_to_byte(spif_ustr_t self, spif_ustridx_t idx)
+{
+    spif_ustridx_t off, k;
+
+    if (self->chars == self->len) {
+        return idx;
+    }
+    if (!self->offsets) {
+        spif_ustr_build_index(self);
+    }
+    off = self->offsets[idx / SPIF_USTR_INDEX_STEP];
+    for (k = idx % SPIF_USTR_INDEX_STEP; k; k--) {
+        off += spif_ustr_next(self, off);
+    }
+    return off;
+}
+
+/* Index of the character containing byte offset off, 0 <= off <= len.
+   The string must have been scanned. */
+static spif_ustridx_t
+spif_ustr_to_char(spif_ustr_t self, spif_ustridx_t off)
+{
+    spif_ustridx_t lo, hi, mid, c, n, pos;
+
+    if (self->chars == self->len) {
+        return off;
+    }
+    if (!self->offsets) {
+        spif_ustr_build_index(self);
+    }
+    for (lo = 0, hi = self->chars / SPIF_USTR_INDEX_STEP; lo < hi;) {
+        mid = (lo + hi + 1) / 2;
+        if (self->offsets[mid] <= off) {
+            lo = mid;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    for (c = lo * SPIF_USTR_INDEX_STEP, pos = self->offsets[lo]; pos < off; pos += n, c++) {
+        n = spif_ustr_next(self, pos);
+        if (pos + n > off) {
+            break;
+        }
+    }
+    return c;
+}
+
+static void
+spif_ustr_reverse_bytes(spif_charptr_t s, size_t len)
+{
+    spif_charptr_t end;
+    char c;
+
+    if (!len) {
+        return;
+    }
+    for (end = s + len - 1; s < end; s++, end--) {
+        c = *s;
+        *s = *end;
+        *end = c;
+    }
+}
+
+/* Simple one-to-one case mappings for Latin-1, Latin Extended-A,
+   Greek, Cyrillic, and Armenian.  Each maps a two-byte character to
+   another, so strings can be converted in place. */
+static spif_uint32_t
+spif_ustr_map_case(spif_uint32_t cp, spif_bool_t upper)
+{
+    if (upper) {
+        if (((cp >= 0xe0) && (cp <= 0xfe) && (cp != 0xf7))
+            || ((cp >= 0x3b1) && (cp <= 0x3cb) && (cp != 0x3c2))
+            || ((cp >= 0x430) && (cp <= 0x44f))) {
+            return cp - 0x20;
+        } else if (cp == 0xff) {
+            return 0x178;
+        } else if (cp == 0x3c2) {
+            return 0x3a3;
+        } else if (cp == 0x3ac) {
+            return 0x386;
+        } else if ((cp >= 0x3ad) && (cp <= 0x3af)) {
+            return cp - 0x25;
+        } else if (cp == 0x3cc) {
+            return 0x38c;
+        } else if ((cp == 0x3cd) || (cp == 0x3ce)) {
+            return cp - 0x3f;
+        } else if ((cp >= 0x450) && (cp <= 0x45f)) {
+            return cp - 0x50;
+        } else if ((cp >= 0x561) && (cp <= 0x586)) {
+            return cp - 0x30;
+        } else if ((((cp >= 0x100) && (cp <= 0x12f)) || ((cp >= 0x132) && (cp <= 0x137))
+                    || ((cp >= 0x14a) && (cp <= 0x177)) || ((cp >= 0x460) && (cp <= 0x481))
+                    || ((cp >= 0x48a) && (cp <= 0x4bf))) && (cp & 1)) {
+            return cp - 1;
+        } else if ((((cp >= 0x139) && (cp <= 0x148)) || ((cp >= 0x179) && (cp <= 0x17e))) && !(cp & 1)) {
+            return cp - 1;
+        }
+    } else {
+        if (((cp >= 0xc0) && (cp <= 0xde) && (cp != 0xd7))
+            || ((cp >= 0x391) && (cp <= 0x3ab) && (cp != 0x3a2))
+            || ((cp >= 0x410) && (cp <= 0x42f))) {
+            return cp + 0x20;
+        } else if (cp == 0x178) {
+            return 0xff;
+        } else if (cp == 0x386) {
+            return 0x3ac;
+        } else if ((cp >= 0x388) && (cp <= 0x38a)) {
+            return cp + 0x25;
+        } else if (cp == 0x38c) {
+            return 0x3cc;
+        } else if ((cp == 0x38e) || (cp == 0x38f)) {
+            return cp + 0x3f;
+        } else if ((cp >= 0x400) && (cp <= 0x40f)) {
+            return cp + 0x50;
+        } else if ((cp >= 0x531) && (cp <= 0x556)) {
+            return cp + 0x30;
+        } else if ((((cp >= 0x100) && (cp <= 0x12f)) || ((cp >= 0x132) && (cp <= 0x137))
+                    || ((cp >= 0x14a) && (cp <= 0x177)) || ((cp >= 0x460) && (cp <= 0x481))
+                    || ((cp >= 0x48a) && (cp <= 0x4bf))) && !(cp & 1)) {
+            return cp + 1;
+        } else if ((((cp >= 0x139) && (cp <= 0x148)) || ((cp >= 0x179) && (cp <= 0x17e))) && (cp & 1)) {
+            return cp + 1;
+        }
+    }
+    return cp;
+}
+
+/* Case-map in place.  ASCII goes through the vectorized routines; other
+   characters are decoded only where the text isn't pure ASCII.  Byte
+   lengths never change, so the cache stays good. */
+static void
+spif_ustr_casemap(spif_ustr_t self, spif_bool_t upper)
+{
+    spif_ustridx_t i, j;
+    spif_uint32_t cp, mapped;
+    size_t n;
+
+    spif_ustr_scan(self);
+    if (self->chars == self->len) {
+        if (self->len) {
+            ((upper) ? (spiftool_upcase_buff) : (spiftool_downcase_buff)) (self->s, (size_t) self->len);
+        }
+        return;
+    }
+    for (i = 0; i < self->len; i += n) {
+        for (j = i; (j < self->len) && !((spif_uchar_t) self->s[j] & 0x80); j++);
+        if (j > i) {
+            ((upper) ? (spiftool_upcase_buff) : (spiftool_downcase_buff)) (self->s + i, (size_t) (j - i));
+            n = (size_t) (j - i);
+            continue;
+        }
+        n = spiftool_utf8_decode(self->s + i, (size_t) (self->len - i), &cp);
+        if ((n == 2) && ((mapped = spif_ustr_map_case(cp, upper)) != cp)) {
+            spiftool_utf8_encode(self->s + i, mapped);
+        }
+    }
+}
+
 spif_ustr_t
 spif_ustr_new(void)
 {
@@ -174,6 +425,7 @@ spif_ustr_init(spif_ustr_t self)
     self->s = (spif_charptr_t) NULL;
     self->len = 0;
     self->size = 0;
+    spif_ustr_reset(self);
     return TRUE;
 }
 
@@ -184,6 +436,7 @@ spif_ustr_init_from_ptr(spif_ustr_t self, spif_charptr_t old)
     REQUIRE_RVAL((old != (spif_charptr_t) NULL), spif_ustr_init(self));
     /* ***NOT NEEDED*** spif_obj_init(SPIF_OBJ(self)); */
     spif_obj_set_class(SPIF_OBJ(self), SPIF_CLASS_VAR(ustr));
+    spif_ustr_reset(self);
     self->len = strlen((const char *) old);
     self->size = self->len + 1;
     self->s = (spif_charptr_t) MALLOC(self->size);
@@ -197,6 +450,7 @@ spif_ustr_init_from_buff(spif_ustr_t self, spif_charptr_t buff, spif_ustridx_t s
     ASSERT_RVAL(!SPIF_USTR_ISNULL(self), FALSE);
     /* ***NOT NEEDED*** spif_obj_init(SPIF_OBJ(self)); */
     spif_obj_set_class(SPIF_OBJ(self), SPIF_CLASS_VAR(ustr));
+    spif_ustr_reset(self);
     self->size = size;
     if (buff != (spif_charptr_t) NULL) {
         self->len = strnlen((const char *) buff, size);
@@ -223,6 +477,7 @@ spif_ustr_init_from_fp(spif_ustr_t self, FILE *fp)
     ASSERT_RVAL((fp != (FILE *) NULL), FALSE);
     /* ***NOT NEEDED*** spif_obj_init(SPIF_OBJ(self)); */
     spif_obj_set_class(SPIF_OBJ(self), SPIF_CLASS_VAR(ustr));
+    spif_ustr_reset(self);
     self->size = buff_inc;
     self->len = 0;
     self->s = (spif_charptr_t) MALLOC(self->size);
@@ -254,6 +509,7 @@ spif_ustr_init_from_fd(spif_ustr_t self, int fd)
     ASSERT_RVAL((fd >= 0), FALSE);
     /* ***NOT NEEDED*** spif_obj_init(SPIF_OBJ(self)); */
     spif_obj_set_class(SPIF_OBJ(self), SPIF_CLASS_VAR(ustr));
+    spif_ustr_reset(self);
     self->size = buff_inc;
     self->len = 0;
     self->s = (spif_charptr_t) MALLOC(self->size);
@@ -273,17 +529,17 @@ spif_ustr_init_from_fd(spif_ustr_t self, int fd)
 spif_bool_t
 spif_ustr_init_from_num(spif_ustr_t self, long num)
 {
-    spif_char_t buff[28];
+    spif_char_t buff[SPIFTOOL_NUM_BUFF_SIZE];
 
     ASSERT_RVAL(!SPIF_USTR_ISNULL(self), FALSE);
     /* ***NOT NEEDED*** spif_obj_init(SPIF_OBJ(self)); */
     spif_obj_set_class(SPIF_OBJ(self), SPIF_CLASS_VAR(ustr));
+    spif_ustr_reset(self);
 
-    snprintf((char *) buff, sizeof(buff), "%ld", num);
-    self->len = strlen((char *) buff);
+    self->len = (spif_ustridx_t) spiftool_format_int64((spif_charptr_t) buff, (spif_int64_t) num);
     self->size = self->len + 1;
     self->s = (spif_charptr_t) MALLOC(self->size);
-    strcpy((char *) self->s, (char *) buff);
+    memcpy(self->s, buff, self->size);
 
     return TRUE;
 }
@@ -292,6 +548,7 @@ spif_bool_t
 spif_ustr_done(spif_ustr_t self)
 {
     ASSERT_RVAL(!SPIF_USTR_ISNULL(self), FALSE);
+    spif_ustr_invalidate(self);
     if (self->size) {
         FREE(self->s);
         self->len = 0;
@@ -313,28 +570,17 @@ spif_ustr_del(spif_ustr_t self)
 spif_str_t
 spif_ustr_show(spif_ustr_t self, spif_charptr_t name, spif_str_t buff, size_t indent)
 {
-    spif_char_t tmp[4096];
-
     if (SPIF_USTR_ISNULL(self)) {
-        SPIF_OBJ_SHOW_NULL(ustr, name, buff, indent, tmp);
+        SPIF_OBJ_SHOW_NULL_INTO(ustr, name, buff, indent);
         return buff;
     }
 
-    memset(tmp, ' ', indent);
-    snprintf((char *) tmp + indent, sizeof(tmp) - indent,
-             "(spif_ustr_t) %s:  %10p { \"",
-             name, (spif_ptr_t) self);
-    if (SPIF_USTR_ISNULL(buff)) {
-        buff = spif_str_new_from_ptr(tmp);
-    } else {
-        spif_str_append_from_ptr(buff, tmp);
-    }
+    buff = spif_str_show_printf(buff, indent, "(spif_ustr_t) %s:  %10p { \"", name, (spif_ptr_t) self);
 
     /*spif_str_append(buff, self);*/
 
-    snprintf((char *) tmp, sizeof(tmp), "\", len %lu, size %lu }\n", (unsigned long) self->len,
-             (unsigned long) self->size);
-    spif_str_append_from_ptr(buff, tmp);
+    spif_str_append_printf(buff, "\", len %lu, size %lu }\n", (unsigned long) self->len,
+                           (unsigned long) self->size);
     return buff;
 }
 
@@ -352,9 +598,11 @@ spif_ustr_dup(spif_ustr_t self)
     ASSERT_RVAL(!SPIF_USTR_ISNULL(self), (spif_ustr_t) NULL);
     tmp = SPIF_ALLOC(ustr);
     memcpy(tmp, self, SPIF_SIZEOF_TYPE(ustr));
-    tmp->s = (spif_charptr_t) STRDUP((const char *) SPIF_USTR_STR(self));
-    tmp->len = self->len;
-    tmp->size = self->size;
+    if (self->size) {
+        tmp->s = (spif_charptr_t) MALLOC(self->size);
+        memcpy(tmp->s, self->s, self->size);
+    }
+    tmp->offsets = (spif_ustridx_t *) NULL;
     return tmp;
 }
 
@@ -365,16 +613,26 @@ spif_ustr_type(spif_ustr_t self)
     return SPIF_OBJ_CLASSNAME(self);
 }
 
+/* Make sure self's buffer holds at least size bytes. */
+static void
+spif_ustr_reserve(spif_ustr_t self, spif_ustridx_t size)
+{
+    if (self->size < size) {
+        self->size = size;
+        self->s = (spif_charptr_t) REALLOC(self->s, self->size);
+    }
+}
+
 spif_bool_t
 spif_ustr_append(spif_ustr_t self, spif_ustr_t other)
 {
     ASSERT_RVAL(!SPIF_USTR_ISNULL(self), FALSE);
     REQUIRE_RVAL(!SPIF_USTR_ISNULL(other), FALSE);
     if (other->size && other->len) {
-        self->size += other->size - 1;
-        self->s = (spif_charptr_t) REALLOC(self->s, self->size);
+        spif_ustr_reserve(self, self->len + other->len + 1);
         memcpy(self->s + self->len, SPIF_USTR_STR(other), other->len + 1);
         self->len += other->len;
+        spif_ustr_edited(self, self->s + self->len - other->len, other->len, 0);
     }
     return TRUE;
 }
@@ -383,13 +641,25 @@ spif_bool_t
 spif_ustr_append_char(spif_ustr_t self, spif_char_t c)
 {
     ASSERT_RVAL(!SPIF_USTR_ISNULL(self), FALSE);
+    spif_ustr_reserve(self, self->len + 2);
     self->len++;
-    if (self->size <= self->len) {
-        self->size++;
-        self->s = (spif_charptr_t) REALLOC(self->s, self->size);
-    }
     self->s[self->len - 1] = c;
     self->s[self->len] = 0;
+    spif_ustr_edited(self, self->s + self->len - 1, 1, 0);
+    return TRUE;
+}
+
+/* Like spif_str_append_double(). */
+spif_bool_t
+spif_ustr_append_double(spif_ustr_t self, double num)
+{
+    spif_ustridx_t n;
+
+    ASSERT_RVAL(!SPIF_USTR_ISNULL(self), FALSE);
+    spif_ustr_reserve(self, self->len + SPIFTOOL_NUM_BUFF_SIZE);
+    n = (spif_ustridx_t) spiftool_format_double(self->s + self->len, num);
+    self->len += n;
+    spif_ustr_edited(self, self->s + self->len - n, n, 0);
     return TRUE;
 }
 
@@ -402,14 +672,107 @@ spif_ustr_append_from_ptr(spif_ustr_t self, spif_charptr_t other)
     REQUIRE_RVAL((other != (spif_charptr_t) NULL), FALSE);
     len = strlen((const char *) other);
     if (len) {
-        self->size += len;
-        self->s = (spif_charptr_t) REALLOC(self->s, self->size);
+        spif_ustr_reserve(self, self->len + len + 1);
         memcpy(self->s + self->len, other, len + 1);
         self->len += len;
+        spif_ustr_edited(self, self->s + self->len - len, len, 0);
     }
     return TRUE;
 }
 
+/* Like spif_str_append_int(). */
+spif_bool_t
+spif_ustr_append_int(spif_ustr_t self, spif_int64_t num)
+{
+    spif_ustridx_t n;
+
+    ASSERT_RVAL(!SPIF_USTR_ISNULL(self), FALSE);
+    spif_ustr_reserve(self, self->len + SPIFTOOL_NUM_BUFF_SIZE);
+    n = (spif_ustridx_t) spiftool_format_int64(self->s + self->len, num);
+    self->len += n;
+    spif_ustr_edited(self, self->s + self->len - n, n, 0);
+    return TRUE;
+}
+
+/* Like spif_str_append_uint(). */
+spif_bool_t
+spif_ustr_append_uint(spif_ustr_t self, spif_uint64_t num)
+{
+    spif_ustridx_t n;
+
+    ASSERT_RVAL(!SPIF_USTR_ISNULL(self), FALSE);
+    spif_ustr_reserve(self, self->len + SPIFTOOL_NUM_BUFF_SIZE);
+    n = (spif_ustridx_t) spiftool_format_uint64(self->s + self->len, num);
+    self->len += n;
+    spif_ustr_edited(self, self->s + self->len - n, n, 0);
+    return TRUE;
+}
+
+/**
+ * Character access.
+ *
+ * @param self The string.
+ * @param idx  The character position; negative values count back
+ *             from the end.
+ * @return     The code point there (U+FFFD for a byte of a malformed
+ *             sequence), or (spif_uint32_t) -1 if @a idx is out of
+ *             range.
+ */
+spif_uint32_t
+spif_ustr_char_at(spif_ustr_t self, spif_ustridx_t idx)
+{
+    spif_uint32_t cp;
+
+    ASSERT_RVAL(!SPIF_USTR_ISNULL(self), (spif_uint32_t) -1);
+    spif_ustr_scan(self);
+    if (idx < 0) {
+        idx = self->chars + idx;
+    }
+    REQUIRE_RVAL(idx >= 0, (spif_uint32_t) -1);
+    REQUIRE_RVAL(idx < self->chars, (spif_uint32_t) -1);
+    idx = spif_ustr_to_byte(self, idx);
+    spiftool_utf8_decode(self->s + idx, (size_t) (self->len - idx), &cp);
+    return cp;
+}
+
+/**
+ * Character count.
+ *
+ * Counted once and cached until the string changes.
+ *
+ * @param self The string.
+ * @return     The number of characters in @a self.
+ */
+spif_ustridx_t
+spif_ustr_char_count(spif_ustr_t self)
+{
+    ASSERT_RVAL(!SPIF_USTR_ISNULL(self), 0);
+    spif_ustr_scan(self);
+    return self->chars;
+}
+
+/**
+ * Map a character position to a byte offset.
+ *
+ * @param self The string.
+ * @param idx  The character position, from 0 to the character count
+ *             inclusive; negative values count back from the end.
+ * @return     The offset of that character's first byte in
+ *             SPIF_USTR_STR(@a self), or -1 if @a idx is out of range.
+ */
+spif_ustridx_t
+spif_ustr_char_offset(spif_ustr_t self, spif_ustridx_t idx)
+{
+    ASSERT_RVAL(!SPIF_USTR_ISNULL(self), -1);
+    spif_ustr_scan(self);
+    if (idx < 0) {
+        idx = self->chars + idx;
+    }
+    REQUIRE_RVAL(idx >= 0, -1);
+    REQUIRE_RVAL(idx <= self->chars, -1);
+    return spif_ustr_to_byte(self, idx);
+}
+
 spif_cmp_t
 spif_ustr_casecmp(spif_ustr_t self, spif_ustr_t other)
 {
@@ -436,6 +799,7 @@ spif_ustr_clear(spif_ustr_t self, spif_char_t c)
     ASSERT_RVAL(!SPIF_USTR_ISNULL(self), FALSE);
     memset(self->s, c, self->size);
     self->s[self->len] = 0;
+    spif_ustr_invalidate(self);
     return TRUE;
 }
 
@@ -462,12 +826,8 @@ spif_ustr_cmp_with_ptr(spif_ustr_t self, spif_charptr_t other)
 spif_bool_t
 spif_ustr_downcase(spif_ustr_t self)
 {
-    spif_charptr_t tmp;
-
     ASSERT_RVAL(!SPIF_USTR_ISNULL(self), FALSE);
-    for (tmp = self->s; *tmp; tmp++) {
-        *tmp = tolower(*tmp);
-    }
+    spif_ustr_casemap(self, FALSE);
     return TRUE;
 }
 
@@ -480,10 +840,11 @@ spif_ustr_find(spif_ustr_t self, spif_ustr_t other)
     REQUIRE_RVAL(!SPIF_USTR_ISNULL(other), ((spif_stridx_t) -1));
     tmp = strstr((const char *) SPIF_USTR_STR(self),
                  (const char *) SPIF_USTR_STR(other));
+    spif_ustr_scan(self);
     if (tmp) {
-        return (spif_stridx_t) ((spif_long_t) tmp - (spif_long_t) (SPIF_USTR_STR(self)));
+        return spif_ustr_to_char(self, (spif_ustridx_t) (tmp - (char *) SPIF_USTR_STR(self)));
     } else {
-        return (spif_stridx_t) (self->len);
+        return self->chars;
     }
 }
 
@@ -496,27 +857,43 @@ spif_ustr_find_from_ptr(spif_ustr_t self, spif_charptr_t other)
     REQUIRE_RVAL((other != (spif_charptr_t) NULL), ((spif_stridx_t) -1));
     tmp = strstr((const char *) SPIF_USTR_STR(self),
                  (const char *) other);
+    spif_ustr_scan(self);
     if (tmp) {
-        return (spif_stridx_t) ((spif_long_t) tmp - (spif_long_t) (SPIF_USTR_STR(self)));
+        return spif_ustr_to_char(self, (spif_ustridx_t) (tmp - (char *) SPIF_USTR_STR(self)));
     } else {
-        return (spif_stridx_t) (self->len);
+        return self->chars;
     }
 }
 
 spif_ustridx_t
 spif_ustr_index(spif_ustr_t self, spif_char_t c)
 {
-    char *tmp;
+    spif_charptr_t tmp;
 
     ASSERT_RVAL(!SPIF_USTR_ISNULL(self), ((spif_stridx_t) -1));
-    tmp = index((const char *) SPIF_USTR_STR(self), c);
+    spif_ustr_scan(self);
+    tmp = ((self->s) ? (spiftool_strnchr(self->s, (size_t) self->len + 1, c)) : ((spif_charptr_t) NULL));
     if (tmp) {
-        return (spif_stridx_t) ((spif_long_t) tmp - (spif_long_t) (SPIF_USTR_STR(self)));
+        return spif_ustr_to_char(self, (spif_ustridx_t) (tmp - SPIF_USTR_STR(self)));
     } else {
-        return (spif_stridx_t) (self->len);
+        return self->chars;
     }
 }
 
+/**
+ * UTF-8 validity.
+ *
+ * @param self The string.
+ * @return     TRUE if @a self is well-formed UTF-8, FALSE if not.
+ */
+spif_bool_t
+spif_ustr_is_valid(spif_ustr_t self)
+{
+    ASSERT_RVAL(!SPIF_USTR_ISNULL(self), FALSE);
+    spif_ustr_scan(self);
+    return self->valid;
+}
+
 spif_cmp_t
 spif_ustr_ncasecmp(spif_ustr_t self, spif_ustr_t other, spif_ustridx_t cnt)
 {
@@ -557,17 +934,87 @@ spif_ustr_ncmp_with_ptr(spif_ustr_t self, spif_charptr_t other, spif_ustridx_t c
     return SPIF_CMP_FROM_INT(c);
 }
 
+/* Like spif_str_parse_double(). */
+spif_bool_t
+spif_ustr_parse_double(spif_ustr_t self, spif_ustridx_t idx, double *result, spif_ustridx_t *end)
+{
+    spif_bool_t ret;
+    size_t n;
+
+    ASSERT_RVAL(!SPIF_USTR_ISNULL(self), FALSE);
+    ASSERT_RVAL(result != NULL, FALSE);
+    spif_ustr_scan(self);
+    if (idx < 0) {
+        idx = self->chars + idx;
+    }
+    REQUIRE_RVAL(idx >= 0, FALSE);
+    REQUIRE_RVAL(idx <= self->chars, FALSE);
+    idx = spif_ustr_to_byte(self, idx);
+    ret = spiftool_parse_double(SPIF_USTR_STR(self) + idx, self->len - idx, result, &n);
+    if (end) {
+        *end = spif_ustr_to_char(self, idx + (spif_ustridx_t) n);
+    }
+    return ret;
+}
+
+/* Like spif_str_parse_int(). */
+spif_bool_t
+spif_ustr_parse_int(spif_ustr_t self, spif_ustridx_t idx, int base, spif_int64_t *result, spif_ustridx_t *end)
+{
+    spif_bool_t ret;
+    size_t n;
+
+    ASSERT_RVAL(!SPIF_USTR_ISNULL(self), FALSE);
+    ASSERT_RVAL(result != NULL, FALSE);
+    spif_ustr_scan(self);
+    if (idx < 0) {
+        idx = self->chars + idx;
+    }
+    REQUIRE_RVAL(idx >= 0, FALSE);
+    REQUIRE_RVAL(idx <= self->chars, FALSE);
+    idx = spif_ustr_to_byte(self, idx);
+    ret = spiftool_parse_int64(SPIF_USTR_STR(self) + idx, self->len - idx, base, result, &n);
+    if (end) {
+        *end = spif_ustr_to_char(self, idx + (spif_ustridx_t) n);
+    }
+    return ret;
+}
+
+/* Like spif_str_parse_uint(). */
+spif_bool_t
+spif_ustr_parse_uint(spif_ustr_t self, spif_ustridx_t idx, int base, spif_uint64_t *result, spif_ustridx_t *end)
+{
+    spif_bool_t ret;
+    size_t n;
+
+    ASSERT_RVAL(!SPIF_USTR_ISNULL(self), FALSE);
+    ASSERT_RVAL(result != NULL, FALSE);
+    spif_ustr_scan(self);
+    if (idx < 0) {
+        idx = self->chars + idx;
+    }
+    REQUIRE_RVAL(idx >= 0, FALSE);
+    REQUIRE_RVAL(idx <= self->chars, FALSE);
+    idx = spif_ustr_to_byte(self, idx);
+    ret = spiftool_parse_uint64(SPIF_USTR_STR(self) + idx, self->len - idx, base, result, &n);
+    if (end) {
+        *end = spif_ustr_to_char(self, idx + (spif_ustridx_t) n);
+    }
+    return ret;
+}
+
 spif_bool_t
 spif_ustr_prepend(spif_ustr_t self, spif_ustr_t other)
 {
     ASSERT_RVAL(!SPIF_USTR_ISNULL(self), FALSE);
     REQUIRE_RVAL(!SPIF_USTR_ISNULL(other), FALSE);
     if (other->size && other->len) {
-        self->size += other->size - 1;
-        self->s = (spif_charptr_t) REALLOC(self->s, self->size);
-        memmove(self->s + other->len, self->s, self->len + 1);
+        spif_ustr_reserve(self, self->len + other->len + 1);
+        memmove(self->s + other->len, self->s, self->len);
         memcpy(self->s, SPIF_USTR_STR(other), other->len);
         self->len += other->len;
+        self->s[self->len] = 0;
+        spif_ustr_edited(self, self->s, other->len, 0);
     }
     return TRUE;
 }
@@ -576,13 +1023,12 @@ spif_bool_t
 spif_ustr_prepend_char(spif_ustr_t self, spif_char_t c)
 {
     ASSERT_RVAL(!SPIF_USTR_ISNULL(self), FALSE);
-    self->len++;
-    if (self->size <= self->len) {
-        self->size++;
-        self->s = (spif_charptr_t) REALLOC(self->s, self->size);
-    }
-    memmove(self->s + 1, self->s, self->len + 1);
+    spif_ustr_reserve(self, self->len + 2);
+    memmove(self->s + 1, self->s, self->len);
     self->s[0] = (spif_uchar_t) c;
+    self->len++;
+    self->s[self->len] = 0;
+    spif_ustr_edited(self, self->s, 1, 0);
     return TRUE;
 }
 
@@ -595,11 +1041,12 @@ spif_ustr_prepend_from_ptr(spif_ustr_t self, spif_charptr_t other)
     REQUIRE_RVAL((other != (spif_charptr_t) NULL), FALSE);
     len = strlen((const char *) other);
     if (len) {
-        self->size += len;
-        self->s = (spif_charptr_t) REALLOC(self->s, self->size);
-        memmove(self->s + len, self->s, self->len + 1);
+        spif_ustr_reserve(self, self->len + len + 1);
+        memmove(self->s + len, self->s, self->len);
         memcpy(self->s, other, len);
         self->len += len;
+        self->s[self->len] = 0;
+        spif_ustr_edited(self, self->s, len, 0);
     }
     return TRUE;
 }
@@ -607,21 +1054,38 @@ spif_ustr_prepend_from_ptr(spif_ustr_t self, spif_charptr_t other)
 spif_bool_t
 spif_ustr_reverse(spif_ustr_t self)
 {
+    spif_ustridx_t i, n;
+
     ASSERT_RVAL(!SPIF_USTR_ISNULL(self), FALSE);
-    return ((strrev((char *) self->s)) ? TRUE : FALSE);
+    REQUIRE_RVAL(self->s != (spif_charptr_t) NULL, FALSE);
+    spif_ustr_scan(self);
+    if (self->chars != self->len) {
+        /* Reverse each multibyte character in place first so that
+           reversing the whole buffer puts its bytes back in order. */
+        for (i = 0; i < self->len; i += n) {
+            n = spif_ustr_next(self, i);
+            if (n > 1) {
+                spif_ustr_reverse_bytes(self->s + i, (size_t) n);
+            }
+        }
+    }
+    spif_ustr_reverse_bytes(self->s, (size_t) self->len);
+    spif_ustr_edited(self, self->s, 0, 0);
+    return TRUE;
 }
 
 spif_ustridx_t
 spif_ustr_rindex(spif_ustr_t self, spif_char_t c)
 {
-    char *tmp;
+    spif_charptr_t tmp;
 
     ASSERT_RVAL(!SPIF_USTR_ISNULL(self), ((spif_stridx_t) -1));
-    tmp = rindex((const char *) SPIF_USTR_STR(self), c);
+    spif_ustr_scan(self);
+    tmp = ((self->s) ? (spiftool_strnrchr(self->s, (size_t) self->len + 1, c)) : ((spif_charptr_t) NULL));
     if (tmp) {
-        return (spif_stridx_t) ((spif_long_t) tmp - (spif_long_t) (SPIF_USTR_STR(self)));
+        return spif_ustr_to_char(self, (spif_ustridx_t) (tmp - SPIF_USTR_STR(self)));
     } else {
-        return (spif_stridx_t) (self->len);
+        return self->chars;
     }
 }
 
@@ -629,19 +1093,24 @@ spif_bool_t
 spif_ustr_splice(spif_ustr_t self, spif_ustridx_t idx, spif_ustridx_t cnt, spif_ustr_t other)
 {
     spif_charptr_t tmp, ptmp;
-    spif_ustridx_t newsize;
+    spif_ustridx_t newsize, chars;
 
     ASSERT_RVAL(!SPIF_USTR_ISNULL(self), FALSE);
+    spif_ustr_scan(self);
     if (idx < 0) {
-        idx = self->len + idx;
+        idx = self->chars + idx;
     }
     REQUIRE_RVAL(idx >= 0, FALSE);
-    REQUIRE_RVAL(idx < self->len, FALSE);
+    REQUIRE_RVAL(idx < self->chars, FALSE);
     if (cnt < 0) {
-        cnt = idx + self->len + cnt;
+        cnt = idx + self->chars + cnt;
     }
     REQUIRE_RVAL(cnt >= 0, FALSE);
-    REQUIRE_RVAL(cnt <= (self->len - idx), FALSE);
+    REQUIRE_RVAL(cnt <= (self->chars - idx), FALSE);
+    chars = cnt;
+    cnt = spif_ustr_to_byte(self, idx + cnt);
+    idx = spif_ustr_to_byte(self, idx);
+    cnt -= idx;
 
     newsize = self->len + ((SPIF_USTR_ISNULL(other)) ? (0) : (other->len)) - cnt + 1;
     ptmp = tmp = (spif_charptr_t) MALLOC(newsize);
@@ -661,6 +1130,7 @@ spif_ustr_splice(spif_ustr_t self, spif_ustridx_t idx, spif_ustridx_t cnt, spif_
     self->len = newsize - 1;
     memcpy(self->s, tmp, newsize);
     FREE(tmp);
+    spif_ustr_edited(self, self->s + idx, ((SPIF_USTR_ISNULL(other)) ? (0) : (other->len)), chars);
     return TRUE;
 }
 
@@ -668,20 +1138,25 @@ spif_bool_t
 spif_ustr_splice_from_ptr(spif_ustr_t self, spif_ustridx_t idx, spif_ustridx_t cnt, spif_charptr_t other)
 {
     spif_charptr_t tmp, ptmp;
-    spif_ustridx_t len, newsize;
+    spif_ustridx_t len, newsize, chars;
 
     ASSERT_RVAL(!SPIF_USTR_ISNULL(self), FALSE);
     len = (other ? strlen((const char *) other) : 0);
+    spif_ustr_scan(self);
     if (idx < 0) {
-        idx = self->len + idx;
+        idx = self->chars + idx;
     }
     REQUIRE_RVAL(idx >= 0, FALSE);
-    REQUIRE_RVAL(idx < self->len, FALSE);
+    REQUIRE_RVAL(idx < self->chars, FALSE);
     if (cnt < 0) {
-        cnt = idx + self->len + cnt;
+        cnt = idx + self->chars + cnt;
     }
     REQUIRE_RVAL(cnt >= 0, FALSE);
-    REQUIRE_RVAL(cnt <= (self->len - idx), FALSE);
+    REQUIRE_RVAL(cnt <= (self->chars - idx), FALSE);
+    chars = cnt;
+    cnt = spif_ustr_to_byte(self, idx + cnt);
+    idx = spif_ustr_to_byte(self, idx);
+    cnt -= idx;
 
     newsize = self->len + len - cnt + 1;
     ptmp = tmp = (spif_charptr_t) MALLOC(newsize);
@@ -701,63 +1176,67 @@ spif_ustr_splice_from_ptr(spif_ustr_t self, spif_ustridx_t idx, spif_ustridx_t c
     self->len = newsize - 1;
     memcpy(self->s, tmp, newsize);
     FREE(tmp);
+    spif_ustr_edited(self, self->s + idx, len, chars);
     return TRUE;
 }
 
+/* Grow function for spiftool_vformat(). */
+static spif_charptr_t
+spif_ustr_format_grow(spif_obj_t obj, spif_stridx_t size, spif_stridx_t *newsize)
+{
+    spif_ustr_t self = SPIF_USTR(obj);
+
+    if (self->size < size) {
+        self->size = MAX(size, self->size * 2);
+        self->s = (spif_charptr_t) REALLOC(self->s, self->size);
+    }
+    *newsize = self->size;
+    return self->s;
+}
+
 spif_bool_t
 spif_ustr_sprintf(spif_ustr_t self, spif_charptr_t format, ...)
 {
     va_list ap;
+    spif_stridx_t len;
 
     ASSERT_RVAL(!SPIF_USTR_ISNULL(self), FALSE);
-    if (self->s != (spif_charptr_t) NULL) {
+    spif_ustr_invalidate(self);
+    if (!format || (*format == 0)) {
         spif_ustr_done(self);
+        return ((format) ? (TRUE) : (FALSE));
     }
-    if (!format) {
+    /* Reuse the existing buffer rather than freeing it. */
+    self->len = 0;
+    va_start(ap, format);
+    len = spiftool_vformat(SPIF_OBJ(self), spif_ustr_format_grow, self->s, self->size, 0, (const char *) format, ap);
+    va_end(ap);
+    if (len < 0) {
+        self->s[0] = 0;
         return FALSE;
-    } else if (*format == 0) {
-        return TRUE;
-    } else {
-        int c;
-        char buff[2];
-
-        va_start(ap, format);
-        c = vsnprintf(buff, sizeof(buff), format, ap);
-        va_end(ap);
-        if (c <= 0) {
-            return FALSE;
-        } else {
-            self->size = c + 1;
-            self->s = (spif_charptr_t) MALLOC(self->size);
-            va_start(ap, format);
-            c = vsnprintf(self->s, self->size, format, ap);
-            va_end(ap);
-            if (c > -1 && c < self->size) {
-                self->len = c;
-                return TRUE;
-            } else {
-                self->s[0] = 0;
-                return FALSE;
-            }
-        }
     }
-    ASSERT_NOTREACHED_RVAL(FALSE);
+    self->len = len;
+    return TRUE;
 }
 
 spif_ustr_t
 spif_ustr_substr(spif_ustr_t self, spif_ustridx_t idx, spif_ustridx_t cnt)
 {
     ASSERT_RVAL(!SPIF_USTR_ISNULL(self), (spif_ustr_t) NULL);
+    spif_ustr_scan(self);
     if (idx < 0) {
-        idx = self->len + idx;
+        idx = self->chars + idx;
     }
     REQUIRE_RVAL(idx >= 0, (spif_ustr_t) NULL);
-    REQUIRE_RVAL(idx < self->len, (spif_ustr_t) NULL);
+    REQUIRE_RVAL(idx < self->chars, (spif_ustr_t) NULL);
     if (cnt <= 0) {
-        cnt = self->len - idx + cnt;
+        cnt = self->chars - idx + cnt;
     }
     REQUIRE_RVAL(cnt >= 0, (spif_ustr_t) NULL);
-    UPPER_BOUND(cnt, self->len - idx);
+    UPPER_BOUND(cnt, self->chars - idx);
+    cnt = spif_ustr_to_byte(self, idx + cnt);
+    idx = spif_ustr_to_byte(self, idx);
+    cnt -= idx;
     return spif_ustr_new_from_buff(SPIF_USTR_STR(self) + idx, cnt);
 }
 
@@ -767,16 +1246,20 @@ spif_ustr_substr_to_ptr(spif_ustr_t self, spif_ustridx_t idx, spif_ustridx_t cnt
     spif_charptr_t newstr;
 
     ASSERT_RVAL(!SPIF_USTR_ISNULL(self), (spif_charptr_t) NULL);
+    spif_ustr_scan(self);
     if (idx < 0) {
-        idx = self->len + idx;
+        idx = self->chars + idx;
     }
     REQUIRE_RVAL(idx >= 0, (spif_charptr_t) NULL);
-    REQUIRE_RVAL(idx < self->len, (spif_charptr_t) NULL);
+    REQUIRE_RVAL(idx < self->chars, (spif_charptr_t) NULL);
     if (cnt <= 0) {
-        cnt = self->len - idx + cnt;
+        cnt = self->chars - idx + cnt;
     }
     REQUIRE_RVAL(cnt >= 0, (spif_charptr_t) NULL);
-    UPPER_BOUND(cnt, self->len - idx);
+    UPPER_BOUND(cnt, self->chars - idx);
+    cnt = spif_ustr_to_byte(self, idx + cnt);
+    idx = spif_ustr_to_byte(self, idx);
+    cnt -= idx;
 
     newstr = (spif_charptr_t) MALLOC(cnt + 1);
     memcpy(newstr, SPIF_USTR_STR(self) + idx, cnt);
@@ -787,47 +1270,52 @@ spif_ustr_substr_to_ptr(spif_ustr_t self, spif_ustridx_t idx, spif_ustridx_t cnt
 double
 spif_ustr_to_float(spif_ustr_t self)
 {
+    double ret;
+
     ASSERT_RVAL(!SPIF_USTR_ISNULL(self), (double) NAN);
-    return (double) (strtod((const char *)SPIF_USTR_STR(self), (char **) NULL));
+    spiftool_parse_double(SPIF_USTR_STR(self), self->len, &ret, NULL);
+    return ret;
 }
 
 size_t
 spif_ustr_to_num(spif_ustr_t self, int base)
 {
+    spif_uint64_t ret;
+
     ASSERT_RVAL(!SPIF_USTR_ISNULL(self), ((size_t) -1));
-    return (size_t) (strtoul((const char *) SPIF_USTR_STR(self), (char **) NULL, base));
+    spiftool_parse_uint64(SPIF_USTR_STR(self), self->len, base, &ret, NULL);
+    return (size_t) ret;
 }
 
 spif_bool_t
 spif_ustr_trim(spif_ustr_t self)
 {
     spif_charptr_t start, end;
+    spif_ustridx_t removed;
 
     ASSERT_RVAL(!SPIF_USTR_ISNULL(self), FALSE);
     start = self->s;
     end = self->s + self->len - 1;
-    for (; isspace((spif_uchar_t) (*start)) && (start < end); start++);
-    for (; isspace((spif_uchar_t) (*end)) && (start < end); end--);
+    for (; USTR_ISSPACE(*start) && (start < end); start++);
+    for (; USTR_ISSPACE(*end) && (start < end); end--);
     if (start > end) {
         return spif_ustr_done(self);
     }
     *(++end) = 0;
-    self->len = (spif_ustridx_t) (end - start);
+    removed = self->len - (spif_ustridx_t) (end - start);
+    self->len -= removed;
     self->size = self->len + 1;
     memmove(self->s, start, self->size);
     self->s = (spif_charptr_t) REALLOC(self->s, self->size);
+    spif_ustr_edited(self, self->s, 0, removed);
     return TRUE;
 }
 
 spif_bool_t
 spif_ustr_upcase(spif_ustr_t self)
 {
-    spif_charptr_t tmp;
-
     ASSERT_RVAL(!SPIF_USTR_ISNULL(self), FALSE);
-    for (tmp = self->s; *tmp; tmp++) {
-        *tmp = toupper(*tmp);
-    }
+    spif_ustr_casemap(self, TRUE);
     return TRUE;
 }
 